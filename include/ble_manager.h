@@ -9,6 +9,19 @@
  * - Connection management
  * - Service and characteristic discovery
  * - Connection state monitoring
+ *
+ * Each connection has a GattQueue. Connects run on it, so the main loop
+ * starts a connect and later collects the result instead of blocking.
+ * Only one connect is in flight at a time, because the stack initiates
+ * one connection at a time.
+ *
+ * Reconnects skip discovery for a peer the cache can vouch for. Only the
+ * peer each link was last connected to is seeded, never another device with
+ * the same name. Connected peers do not advertise, so while both links are
+ * up the standby scan only sees spares. What it buys on a dropout is the
+ * surviving peer: the bridge ends that link itself, knows the peer is in
+ * range, and reconnects it straight away while the scan looks for the
+ * other one (tools/sim/scenarios/reconnect.scn measures this).
  */
 
 #ifndef BLE_MANAGER_H
@@ -16,6 +29,9 @@
 
 #include <NimBLEDevice.h>
 #include "config.h"
+#include "connect_retry.h"
+#include "gatt_queue.h"
+#include "link_stats.h"
 
 // ============================================================================
 // BLE State Enumeration
@@ -39,8 +55,30 @@ struct DeviceInfo {
     NimBLEAddress address;
     int rssi;
     bool found;
+    unsigned long foundMs;  // millis() when identified
+};
+
+// ============================================================================
+// Advert Cache Entry (filled by both discovery and standby scans)
+// ============================================================================
+
+struct AdvertCacheEntry {
+    char name[32];
+    NimBLEAddress address;
+    int rssi;
+    bool isXbox;
+    bool valid;
+    unsigned long lastSeenMs;
 };
 
+// Connect operation context (read on the queue task)
+struct ConnectRequest {
+    NimBLEClient* client;
+    NimBLEAddress address;
+};
+
+class AdvertisedDeviceCallbacks;
+
 // ============================================================================
 // BLE Manager Class
 // ============================================================================
@@ -56,7 +94,21 @@ public:
     // Scanning
     void startScan(uint32_t duration = BLE_SCAN_DURATION);
     void stopScan();
-    bool isScanning();
+    bool isScanning();          // Also true while paused for a connect
+    unsigned long getScanStartMs();
+
+    // Hot-standby scanning (while ACTIVE)
+    void updateStandbyScan();
+    void reportControlLateness(unsigned long lateMs);
+    void stopStandbyScan();
+    bool isStandbyScanning();
+    uint32_t getStandbyPauseCount();
+
+    // Advert cache
+    void cacheAdvert(const DeviceInfo& info, bool isXbox);
+    bool isKnownAddress(const NimBLEAddress& address, bool* isXbox);
+    void forgetAdvert(const NimBLEAddress& address);
+    bool hasCachedPeer();       // A peer to reconnect needs no discovery scan
 
     // Device discovery
     DeviceInfo getXboxInfo();
@@ -65,9 +117,20 @@ public:
     bool foundLego();
     bool foundBothDevices();
 
-    // Connection
-    bool connectToXbox();
-    bool connectToLego();
+    // Connection - start() queues the connect (false if it cannot start now),
+    // finish() takes the completed future and updates state and retries
+    bool startXboxConnect(GattFuture* future);
+    bool startLegoConnect(GattFuture* future);
+    bool finishXboxConnect(const GattFuture& future);
+    bool finishLegoConnect(const GattFuture& future);
+    bool isConnectInProgress();
+    bool isXboxRetryDue();
+    bool isLegoRetryDue();
+    void abortXboxConnection();
+    void abortLegoConnection();
+    const ConnectRetry& getXboxRetry();
+    const ConnectRetry& getLegoRetry();
+    void resetRetryStats();
     void disconnectXbox();
     void disconnectLego();
     void disconnectAll();
@@ -79,10 +142,20 @@ public:
     bool isLegoConnected();
     bool areBothConnected();
 
+    // Link statistics (samples RSSI, call from loop())
+    void updateLinkStats();
+
+    // Ask for fixed connection intervals (units of 1.25ms, see conn_planner.h)
+    void requestConnIntervals(uint16_t xboxInterval, uint16_t legoInterval);
+
     // Client getters (for other modules to use)
     NimBLEClient* getXboxClient();
     NimBLEClient* getLegoClient();
 
+    // Per-connection GATT operation queues
+    GattQueue& getXboxQueue();
+    GattQueue& getLegoQueue();
+
     // Device info setters (for callbacks)
     void setXboxInfo(const DeviceInfo& info);
     void setLegoInfo(const DeviceInfo& info);
@@ -106,11 +179,48 @@ private:
     // State tracking
     BLEState xboxState;
     BLEState legoState;
+
+    // Connection retries (per peer)
+    ConnectRetry xboxRetry;
+    ConnectRetry legoRetry;
+
+    // GATT operation queues (per peer)
+    GattQueue xboxQueue;
+    GattQueue legoQueue;
+    ConnectRequest xboxConnect;
+    ConnectRequest legoConnect;
     bool scanning;
+    bool scanPaused;
+    unsigned long scanStartMs;
+    uint32_t scanDuration;
+    bool standbyScanning;
+    unsigned long standbyPausedUntil;
+    uint32_t standbyPauseCount;
+
+    // Advert cache (written from the NimBLE host task)
+    AdvertCacheEntry advertCache[BLE_ADVERT_CACHE_SIZE];
+    portMUX_TYPE advertCacheMux;
+    AdvertisedDeviceCallbacks* advertCallbacks;
+
+    // Peers last connected per link - the only ones seeded from the cache
+    DeviceInfo knownXbox;
+    DeviceInfo knownLego;
+    unsigned long xboxReleasedMs;   // We ended its working link (0 = no)
+    unsigned long legoReleasedMs;
+
+    unsigned long lastRssiSampleMs;
 
     // Helper functions
     void resetDeviceInfo(DeviceInfo& info);
+    bool seedFromAdvertCache(DeviceInfo& info, bool isXbox);
+    void configureScan(bool standby);
+    void pauseScan();
+    void resumeScan();
+    void handleConnectFailure(DeviceInfo& info, BLEState& state, ConnectRetry& retry, LinkId link);
+    static bool connectOp(void* context);
     static void scanCompleteCB(NimBLEScanResults results);
+    static void standbyScanCompleteCB(NimBLEScanResults results);
+    static int gapEventCB(struct ble_gap_event* event, void* arg);
 };
 
 // ============================================================================
@@ -135,6 +245,7 @@ public:
     ClientCallbacks(BLEManager* manager, bool isXbox);
     void onConnect(NimBLEClient* pClient) override;
     void onDisconnect(NimBLEClient* pClient) override;
+    bool onConnParamsUpdateRequest(NimBLEClient* pClient, const ble_gap_upd_params* params) override;
 
 private:
     BLEManager* bleManager;
@@ -23,6 +23,16 @@
 // LED Configuration (XIAO ESP32-S3 has built-in RGB LED)
 #define LED_BUILTIN 21  // User LED pin
 
+// OLED Display (optional SSD1306 128x64 on I2C - skipped if not detected)
+#define DISPLAY_ENABLED       1
+#define DISPLAY_I2C_SDA       5        // D4
+#define DISPLAY_I2C_SCL       6        // D5
+#define DISPLAY_I2C_ADDRESS   0x3C
+#define DISPLAY_I2C_FREQ_HZ   400000
+#define DISPLAY_TASK_PRIORITY 1        // Below BLE and loop() - never delays control
+#define DISPLAY_TASK_CORE     0        // loop() runs on core 1
+#define DISPLAY_TASK_STACK    3072
+
 // ============================================================================
 // BLE Configuration
 // ============================================================================
@@ -47,8 +57,53 @@
 #define BLE_SCAN_DURATION 10        // Scan duration in seconds
 #define BLE_SCAN_INTERVAL 0x80      // Scan interval (units of 0.625ms)
 #define BLE_SCAN_WINDOW   0x30      // Scan window (units of 0.625ms)
-#define BLE_CONN_TIMEOUT  5000      // Connection timeout in ms
-#define BLE_MAX_RETRIES   3         // Max connection retry attempts
+#define BLE_CONN_TIMEOUT  2000      // Connection timeout in ms (NimBLE rounds up to whole seconds)
+#define BLE_MAX_RETRIES   3         // Max connection retry attempts (after the first)
+#define BLE_RETRY_BASE_MS        250   // First retry backoff, doubled per retry
+#define BLE_RETRY_MAX_MS         2000  // Backoff cap
+#define BLE_RETRY_JITTER_PERCENT 25    // +/- random spread on each backoff
+
+// Hot-standby scanning (passive, low duty cycle while ACTIVE)
+// A 10ms window every 1s keeps the radio ~1% busy, so at most one control
+// period per second can share airtime with a scan window, and connection
+// events still take priority in the controller's scheduler. The simulator
+// checks the worst case, every event inside a window lost, in reconnect.scn.
+#define BLE_STANDBY_SCAN_ENABLED   1
+#define BLE_STANDBY_SCAN_INTERVAL  0x0640    // 1000ms (units of 0.625ms)
+#define BLE_STANDBY_SCAN_WINDOW    0x0010    // 10ms (units of 0.625ms)
+#define BLE_STANDBY_LATE_MS        (CONTROL_LOOP_PERIOD_MS / 4)  // Control update lateness that counts as load
+#define BLE_STANDBY_PAUSE_MS       5000      // How long to pause standby scanning under load
+#define BLE_ADVERT_CACHE_SIZE      4         // Cached adverts (current peers + spares)
+#define BLE_ADVERT_MAX_AGE_MS      5000      // Adverts (or a link we ended) older than this are not used for reconnect
+
+// GATT operation queues (one worker task per connection, see gatt_queue.h)
+#define GATT_QUEUE_DEPTH           8
+#define GATT_TASK_PRIORITY         2         // Above loop() so queued procedures start promptly
+#define GATT_TASK_STACK            4096
+#define GATT_CONNECT_WAIT_MS       500       // Max queue wait for a connect (the retry backoff takes over)
+#define GATT_SETUP_WAIT_MS         1000      // Max queue wait for discovery + subscribe
+#define GATT_HOUSEKEEPING_WAIT_MS  5000      // Max queue wait for low-priority reads
+#define XBOX_BATTERY_REFRESH_MS    60000     // Battery re-read period while driving
+
+// Link statistics
+#define LINK_RSSI_SAMPLE_PERIOD_MS 1000      // RSSI sampling period for connected links
+
+// Connection interval planning for the two links (see conn_planner.h)
+#define CONN_PLAN_ENABLED          1
+#define CONN_PLAN_CHECK_MS         1000      // Collision check period while driving
+#define CONN_PLAN_GUARD_US         2500      // Event starts closer than this collide
+#define CONN_PLAN_SKIP_LIMIT       5         // Skipped events per check that count as a collision
+#define CONN_PLAN_BAD_CHECKS       3         // Colliding checks in a row before replanning
+#define CONN_PLAN_SETTLE_MS        5000      // No judgement this long after a request
+#define CONN_PLAN_TIMEOUT          400       // Supervision timeout requested (units of 10ms)
+#define CONN_PLAN_COUNT            4
+// {Xbox, hub} intervals in units of 1.25ms - the hub's a whole multiple of the Xbox's
+static const uint16_t CONN_PLANS[CONN_PLAN_COUNT][2] = {
+    { 6, 24 },    // 7.5 / 30 ms
+    { 8, 24 },    // 10 / 30 ms
+    { 6, 18 },    // 7.5 / 22.5 ms
+    { 12, 24 }    // 15 / 30 ms
+};
 
 // ============================================================================
 // Control Configuration
@@ -60,8 +115,24 @@
 #define DEFAULT_TRIGGER_MODE        true // Use triggers for acceleration
 #define DEFAULT_INVERT_STEERING     false
 
+// Left-stick drift estimation (raw stick counts, full scale 32767), see stick_drift.h
+#define STICK_DRIFT_ENABLED         1
+#define STICK_DRIFT_SETTLE_FRAMES   10     // Still frames before a rest frame counts
+#define STICK_DRIFT_MIN_SAMPLES     200    // Rest frames before the calibration is used
+#define STICK_DRIFT_REST_GATE       3277   // Max distance from center while learning (10%)
+#define STICK_DRIFT_MOTION_GATE     512    // Max change between frames at rest
+#define STICK_DRIFT_CENTER_SHIFT    6      // Center average over ~64 rest frames
+#define STICK_DRIFT_NOISE_SHIFT     6
+#define STICK_DRIFT_PEAK_DECAY_SHIFT 10    // Peak halves over ~700 rest frames
+#define STICK_DRIFT_NOISE_MULT      5      // Deadzone vs mean deviation (~4 sigma)
+#define STICK_DRIFT_MARGIN          160
+#define STICK_DRIFT_MIN_DEADZONE    328    // 1%
+#define STICK_DRIFT_MAX_DEADZONE    6554   // 20%
+#define STICK_DRIFT_MAX_CENTER      6554   // 20%
+#define STICK_DRIFT_SAVE_MS         300000 // Re-save period (only while the stick rests)
+
 // Control Loop Timing
-#define CONTROL_LOOP_FREQUENCY_HZ   20   // Control update rate (20Hz = 50ms)
+#define CONTROL_LOOP_FREQUENCY_HZ   20   // Initial control update rate (20Hz = 50ms), then LEGO_AIMD_*
 #define CONTROL_LOOP_PERIOD_MS      (1000 / CONTROL_LOOP_FREQUENCY_HZ)
 
 // Display Update Timing
@@ -71,13 +142,65 @@
 // Serial Update Timing
 #define SERIAL_UPDATE_PERIOD_MS    (3000)
 
+// Serial Commands (newline-terminated text on the USB serial port)
+#define SERIAL_CMD_MAX_LEN         32
+
+// Power Management (per-state locks, see power_manager.h)
+#define POWER_MANAGEMENT_ENABLED   1
+#define POWER_MAX_FREQ_MHZ         240   // Held while driving
+#define POWER_MIN_FREQ_MHZ         40    // XTAL - floor while scanning/idle
+#define POWER_LIGHT_SLEEP          1     // Auto light sleep while scanning/idle (needs tickless idle)
+#define POWER_SCAN_LOOP_DELAY_MS   10    // loop() period while scanning
+#define POWER_IDLE_LOOP_DELAY_MS   50    // loop() period in the error state
+
+// Session log (LittleFS, see session_log.h)
+#define SESSION_LOG_ENABLED        1
+#define SESSION_LOG_BLOCK_SIZE     4096  // RAM staging block = one flash sector
+#define SESSION_LOG_FLUSH_MS       5000  // Partial blocks are written after this long
+#define SESSION_LOG_FILE_MAX       (128 * 1024)
+#define SESSION_LOG_FILES          4     // Current session + 3 older
+#define SESSION_LOG_SNAPSHOT_MS    1000  // Status snapshot period
+#define SESSION_LOG_SLOW_FRAME_US  10000 // Control frames this late (due -> hub write) are traced
+#define SESSION_LOG_TASK_PRIORITY  1
+#define SESSION_LOG_TASK_CORE      0
+#define SESSION_LOG_TASK_STACK     4096
+
+// Macro record/playback (PSRAM, see macro.h)
+#define MACRO_ENABLED              1
+#define MACRO_MAX_FRAMES           60000 // 10 min at 100 Hz, 1.4 MB
+#define MACRO_PLAY_LEAD_US         1000  // Start delay of the first frame
+
+// PC Input (binary controller frames on the same port, see serial_input.h)
+#define SERIAL_INPUT_ENABLED       1     // 1 = PC frames take over while they keep arriving
+#define SERIAL_INPUT_TIMEOUT_MS    250   // Hand back to the controller after this much silence
+
+// ============================================================================
+// Code Placement
+// ============================================================================
+
+// Control-path code (report decode, mapping, frame encode, TX submit) runs
+// from IRAM and its constant tables live in DRAM, so it never waits on a
+// flash cache miss. 0 = leave it in flash, to compare with 'bench hotpath'.
+#define HOT_PATH_IRAM              1
+#define HOT_PATH_BENCH_ITERATIONS  2000  // Control-path runs per load phase
+#define HOT_PATH_BENCH_NVS_BYTES   256   // Blob rewritten by the NVS load task
+
+#if HOT_PATH_IRAM && defined(ESP_PLATFORM)
+    #include <esp_attr.h>
+    #define HOT_PATH IRAM_ATTR
+    #define HOT_DATA DRAM_ATTR
+#else
+    #define HOT_PATH
+    #define HOT_DATA
+#endif
+
 // ============================================================================
 // Lego Hub Protocol Constants
 // ============================================================================
 
 // Command Header (9 bytes)
 #define LEGO_CMD_HEADER_SIZE 9
-static const uint8_t LEGO_CMD_HEADER[LEGO_CMD_HEADER_SIZE] = {
+static const uint8_t LEGO_CMD_HEADER[LEGO_CMD_HEADER_SIZE] HOT_DATA = {
     0x0d, 0x00, 0x81, 0x36, 0x11, 0x51, 0x00, 0x03, 0x00
 };
 
@@ -94,6 +217,37 @@ static const uint8_t LEGO_CMD_HEADER[LEGO_CMD_HEADER_SIZE] = {
 #define LEGO_CALIBRATE_CMD_1  0x10
 #define LEGO_CALIBRATE_CMD_2  0x08
 
+// Hub link transmit pacing
+#define LEGO_TX_MIN_INTERVAL_MS   10   // Min spacing between frames (stop frames bypass this)
+#define LEGO_CALIBRATION_STEP_MS  100  // Delay between the two calibration frames
+#define LEGO_STOP_FLUSH_MS        200  // Max wait for a stop's acknowledgement before a teardown
+
+// Connection-event-aligned transmission (see conn_event_tracker.h)
+#define LEGO_TX_ALIGN_ENABLED     1    // Hold paced frames until just before the hub's next connection event
+#define LEGO_TX_ALIGN_LEAD_US     2500 // Hand the frame to the stack this long before the event (> loop period)
+#define CONN_EVENT_LOCK_SAMPLES   4    // Observations before the event phase is trusted
+#define CONN_EVENT_STALE_MS       5000 // No observation for this long = phase unknown, send immediately
+#define CONN_EVENT_REFRESH_MS     1000 // Connection interval re-read period
+
+// Adaptive (AIMD) drive-frame rate - the control loop runs at this rate
+#define LEGO_AIMD_MIN_RATE_HZ       10     // Never slower than this
+#define LEGO_AIMD_MAX_RATE_HZ       50     // Never faster than this
+#define LEGO_AIMD_START_RATE_HZ     CONTROL_LOOP_FREQUENCY_HZ
+#define LEGO_AIMD_INCREASE_HZ       2      // Added after each healthy window
+#define LEGO_AIMD_DECREASE_PERCENT  50     // Rate kept after a failure or slow write
+#define LEGO_AIMD_WINDOW_WRITES     20     // Writes per window
+#define LEGO_AIMD_LATENCY_LIMIT_US  8000   // Write-without-response slower than this = congestion
+
+// Hub benchmark (serial 'bench hub') - neutral frames at each rate, both write types
+#define HUB_BENCH_STEP_MS         2000 // Duration of each rate step
+#define HUB_BENCH_RATE_COUNT      8
+static const uint16_t HUB_BENCH_RATES_HZ[HUB_BENCH_RATE_COUNT] = {
+    10, 20, 30, 50, 75, 100, 150, 200
+};
+
+// Seqlock benchmark (serial 'bench seqlock') - blocks the loop for 3 phases
+#define SEQLOCK_BENCH_PHASE_MS    500
+
 // ============================================================================
 // Xbox Controller Constants
 // ============================================================================
@@ -105,6 +259,16 @@ static const uint8_t LEGO_CMD_HEADER[LEGO_CMD_HEADER_SIZE] = {
 #define XBOX_TRIGGER_MIN     0
 #define XBOX_TRIGGER_MAX     1023
 
+// Controller input: 0 = wireless over BLE, 1 = wired over USB host (GIP).
+// With USB input the radio only carries the Lego link. USB host takes over
+// the USB-C port: build with ARDUINO_USB_CDC_ON_BOOT=0, read debug output on
+// the UART pins (D6 TX / D7 RX) and power the board and pad from the 5V pin.
+#define XBOX_INPUT_USB          0
+#define XBOX_USB_VENDOR_ID      0x045E   // Microsoft
+#define XBOX_USB_TASK_PRIORITY  5        // Input callbacks run here - above loop()
+#define XBOX_USB_TASK_CORE      0
+#define XBOX_USB_TASK_STACK     4096
+
 // ============================================================================
 // Settings Storage (NVS)
 // ============================================================================
@@ -116,6 +280,7 @@ static const uint8_t LEGO_CMD_HEADER[LEGO_CMD_HEADER_SIZE] = {
 #define NVS_KEY_DEADZONE  "deadzone"
 #define NVS_KEY_TRIGGER_MODE "trig_mode"
 #define NVS_KEY_INVERT_STEER "inv_steer"
+#define NVS_KEY_DRIFT_PREFIX "dr"      // + controller address (12 hex digits)
 #define SETTINGS_VERSION 1
 
 // ============================================================================
@@ -0,0 +1,94 @@
+/**
+ * Connection Event Tracker - Anchor phase estimate for one BLE connection
+ *
+ * Platform: XIAO ESP32-S3 (also builds on the host - no Arduino dependencies)
+ *
+ * A connection only exchanges packets at its connection events, one per
+ * connection interval. A frame handed to the stack just after an event
+ * waits almost a whole interval before it goes on air, and a newer frame
+ * submitted meanwhile cannot replace it. Knowing where the events fall
+ * lets the owner finalize a frame just before the next one instead.
+ *
+ * The stack does not report connection events, so their phase is inferred
+ * from things that can only happen at one: notifications arriving and
+ * acknowledged writes completing. Each observation is folded into the
+ * anchor (a predicted event time, kept near the latest observation):
+ *
+ *   error  = (observed - anchor), wrapped into [-interval/2, interval/2)
+ *   anchor = predicted event nearest the observation + error / 4
+ *
+ * Times are as seen by the host, so the anchor includes the controller ->
+ * host delay; the owner's lead time covers it. The estimate is trusted
+ * ("locked") after CONN_EVENT_LOCK_SAMPLES observations with low jitter,
+ * and dropped after CONN_EVENT_STALE_MS without one. We are the central,
+ * so the anchor does not drift against our own clock. A run of far-off
+ * observations means the events moved (e.g. a parameter update) and the
+ * estimate restarts.
+ *
+ * While observations stream in once per interval, a gap of exactly two
+ * intervals most likely means the event was skipped (e.g. the controller
+ * served another connection instead) and is counted as such.
+ *
+ * The tracker is not thread-safe; the owner serializes.
+ */
+
+#ifndef CONN_EVENT_TRACKER_H
+#define CONN_EVENT_TRACKER_H
+
+#include <stdint.h>
+#include "config.h"
+
+struct ConnEventStats {
+    uint32_t observations;
+    uint32_t outliers;        // Further than interval / 4 from the prediction
+    uint32_t restarts;        // Estimate dropped after consecutive outliers
+    uint32_t jitterUs;        // Smoothed |error| of recent observations
+    uint32_t skipped;         // Two-interval gaps in a once-per-interval stream
+};
+
+// Where the events fall, for planning against another connection
+struct ConnEventPhase {
+    bool locked;
+    uint32_t intervalUs;
+    uint32_t nextEventUs;
+    uint32_t skipped;
+};
+
+class ConnEventTracker {
+public:
+    ConnEventTracker();
+
+    void reset();
+
+    // Connection interval in microseconds (0 = unknown); a change restarts
+    void setInterval(uint32_t intervalUs);
+    uint32_t getIntervalUs() const;
+
+    // Something happened in a connection event at this time
+    void observe(uint32_t eventUs);
+
+    // Phase known well enough to schedule against
+    bool isLocked(uint32_t nowUs) const;
+
+    // First predicted event at or after nowUs (only meaningful when locked)
+    uint32_t nextEventUs(uint32_t nowUs) const;
+
+    ConnEventPhase getPhase(uint32_t nowUs) const;
+
+    const ConnEventStats& getStats() const;
+    void resetStats();
+
+private:
+    uint32_t intervalUs;
+    uint32_t anchorUs;
+    uint32_t lastObservedUs;
+    uint32_t samples;         // Since the last restart
+    uint32_t lastGapUs;       // Between the last two observed events
+    uint8_t outlierRun;
+
+    ConnEventStats stats;
+
+    void restart(uint32_t eventUs);
+};
+
+#endif // CONN_EVENT_TRACKER_H
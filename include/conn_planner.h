@@ -0,0 +1,91 @@
+/**
+ * Connection Planner - Collision-aware intervals for the two BLE links
+ *
+ * Platform: XIAO ESP32-S3 (also builds on the host - no Arduino dependencies)
+ *
+ * The bridge is the central of both connections, and the radio can only
+ * serve one at a time. When an Xbox event and a hub event start too close
+ * together, the controller skips one of them, which shows up as input
+ * jitter or a late hub frame.
+ *
+ * The planner picks the two intervals from CONN_PLANS, where the hub
+ * interval is a whole multiple of the Xbox one. With harmonic intervals
+ * the offset between the two anchors stays fixed, so if the events clear
+ * each other once they always do. The stack does not let us choose the
+ * anchors. Instead, the planner checks where they landed (ConnEventPhase
+ * from each link's ConnEventTracker) every CONN_PLAN_CHECK_MS. A check
+ * collides when:
+ * - the event starts are closer than CONN_PLAN_GUARD_US, or
+ * - the links skipped CONN_PLAN_SKIP_LIMIT or more events since the last check
+ * After CONN_PLAN_BAD_CHECKS colliding checks in a row, it moves to the next
+ * plan. The new connection update also makes the controller place the
+ * anchors again.
+ *
+ * The planner only decides; the caller requests the intervals. It is not
+ * thread-safe; the owner serializes.
+ */
+
+#ifndef CONN_PLANNER_H
+#define CONN_PLANNER_H
+
+#include <stdint.h>
+#include "config.h"
+#include "conn_event_tracker.h"
+
+// Connection intervals in units of 1.25 ms
+struct ConnPlan {
+    uint16_t xboxInterval;
+    uint16_t legoInterval;
+};
+
+enum class ConnPlanVerdict : uint8_t {
+    WAITING = 0,    // Not requested yet, settling, or a phase is unknown
+    CLEAR,
+    COLLIDING
+};
+
+const char* connPlanVerdictName(ConnPlanVerdict verdict);
+
+struct ConnPlanStats {
+    uint32_t checks;            // With both phases known
+    uint32_t overlaps;          // Event starts within CONN_PLAN_GUARD_US
+    uint32_t skipBursts;        // CONN_PLAN_SKIP_LIMIT or more skipped events
+    uint32_t mismatches;        // A link not running its planned interval
+    uint32_t replans;
+    uint32_t separationUs;      // Last measured event-start separation
+    uint32_t minSeparationUs;   // Since resetStats()
+};
+
+class ConnPlanner {
+public:
+    ConnPlanner();
+
+    // Back to the first plan (new connections)
+    void reset();
+
+    // Call every CONN_PLAN_CHECK_MS; true = request getPlan() now
+    bool check(const ConnEventPhase& xbox, const ConnEventPhase& lego, uint32_t nowMs);
+    void planRequested(uint32_t nowMs);
+
+    ConnPlan getPlan() const;
+    uint8_t getPlanIndex() const;
+    ConnPlanVerdict getVerdict() const;
+
+    const ConnPlanStats& getStats() const;
+    void resetStats();
+
+    // Distance between the two links' event starts, modulo the shorter interval
+    static uint32_t separationUs(const ConnEventPhase& a, const ConnEventPhase& b);
+
+private:
+    uint8_t planIndex;
+    bool requested;
+    uint32_t requestedMs;
+    uint8_t badChecks;
+    uint32_t lastSkipped[2];    // Xbox, hub
+    ConnPlanVerdict verdict;
+
+    ConnPlanStats stats;
+};
+
+#endif // CONN_PLANNER_H
@@ -0,0 +1,72 @@
+/**
+ * Connect Retry - Bounded connection retries with jittered backoff
+ *
+ * Platform: XIAO ESP32-S3 (also builds on the host - no Arduino dependencies)
+ *
+ * One instance per peer. The first attempt is immediate; each failure
+ * schedules the next attempt after an exponential backoff (base, 2x base,
+ * ... capped at maxDelayMs) with +/- jitter so two peers, or two bridges,
+ * don't retry in lockstep. After maxAttempts failures the peer is
+ * considered gone and the caller should rescan.
+ *
+ * Time and randomness are passed in so the policy is deterministic on the host.
+ */
+
+#ifndef CONNECT_RETRY_H
+#define CONNECT_RETRY_H
+
+#include <stdint.h>
+
+// ============================================================================
+// Policy and Statistics
+// ============================================================================
+
+struct RetryPolicy {
+    uint8_t maxAttempts;     // Including the first attempt
+    uint32_t baseDelayMs;
+    uint32_t maxDelayMs;
+    uint8_t jitterPercent;   // 0-100
+};
+
+struct RetryStats {
+    uint32_t attempts;       // All attempts, successful or not
+    uint32_t successes;
+    uint32_t exhausted;      // Times all attempts failed
+    uint8_t maxAttemptsUsed; // Worst attempts-to-success seen
+};
+
+// ============================================================================
+// Connect Retry Class
+// ============================================================================
+
+class ConnectRetry {
+public:
+    ConnectRetry(const RetryPolicy& policy);
+
+    // Start over (new device found)
+    void reset();
+
+    // May an attempt be made now?
+    bool isDue(uint32_t nowMs) const;
+    bool isExhausted() const;
+    uint8_t getAttempt() const;  // Attempts made since reset()
+
+    // Record an attempt's outcome; random is any 32-bit random value
+    void recordSuccess();
+    void recordFailure(uint32_t nowMs, uint32_t random);
+
+    uint32_t getNextDelayMs() const;
+    const RetryStats& getStats() const;
+    uint32_t getAttemptsPerSuccessX100() const;
+    void resetStats();
+
+private:
+    RetryPolicy policy;
+    RetryStats stats;
+
+    uint8_t attempt;
+    uint32_t nextAttemptMs;
+    uint32_t nextDelayMs;
+};
+
+#endif // CONNECT_RETRY_H
@@ -0,0 +1,84 @@
+/**
+ * Control Mapper - Xbox controller inputs to Lego car controls
+ *
+ * Platform: XIAO ESP32-S3 (also builds on the host - no Arduino dependencies)
+ *
+ * Mapping:
+ * - Speed: right trigger forward / left trigger reverse (or left stick Y)
+ * - Steering: left stick X
+ * - Lights: A toggles on/off, B cycles modes, RB shows brake lights while held
+ * - Emergency stop: B + X together
+ *
+ * A left-stick calibration (center and deadzone per axis, in raw counts)
+ * replaces the percentage deadzone for that stick once one is set - see
+ * stick_drift.h.
+ */
+
+#ifndef CONTROL_MAPPER_H
+#define CONTROL_MAPPER_H
+
+#include <stdint.h>
+#include "config.h"
+#include "xbox_report.h"
+
+// ============================================================================
+// Settings and Output
+// ============================================================================
+
+struct ControlSettings {
+    uint8_t maxSpeedPercent = DEFAULT_MAX_SPEED_PERCENT;    // 0-100
+    uint8_t deadzonePercent = DEFAULT_DEADZONE_PERCENT;     // 0-50
+    bool triggerAcceleration = DEFAULT_TRIGGER_MODE;        // Use triggers vs stick for speed
+    bool invertSteering = DEFAULT_INVERT_STEERING;
+};
+
+// Left stick axes
+enum StickAxis : uint8_t {
+    STICK_AXIS_X = 0,
+    STICK_AXIS_Y,
+    STICK_AXIS_COUNT
+};
+
+struct StickCalibration {
+    bool valid;
+    int16_t center[STICK_AXIS_COUNT];     // Rest position, raw counts
+    uint16_t deadzone[STICK_AXIS_COUNT];  // Raw counts either side of center
+};
+
+struct MappedControls {
+    int8_t speed;       // -100 to 100
+    int8_t steering;    // -100 to 100
+    uint8_t lights;     // LEGO_LIGHTS_*
+    bool emergencyStop;
+};
+
+// ============================================================================
+// Control Mapper Class
+// ============================================================================
+
+class ControlMapper {
+public:
+    ControlMapper(ControlSettings settings = ControlSettings());
+
+    MappedControls map(const XboxControllerState& xboxState);
+    void updateSettings(ControlSettings settings);
+    ControlSettings getSettings() const;
+    void setStickCalibration(const StickCalibration& calibration);
+
+private:
+    ControlSettings settings;
+    StickCalibration stickCalibration;
+
+    // Button edge detection and light state
+    XboxControllerState previous;
+    bool lightsOn;
+    uint8_t lightMode;
+
+    int8_t applyDeadzone(int32_t value, int32_t fullScale) const;
+    int8_t applyStickDeadzone(int32_t value, StickAxis axis) const;
+    static int8_t scaleOutside(int32_t value, int32_t deadzone, int32_t fullScale);
+    int8_t applySpeedLimit(int8_t speed) const;
+    uint8_t updateLights(const XboxControllerState& xboxState);
+};
+
+#endif // CONTROL_MAPPER_H
@@ -0,0 +1,99 @@
+/**
+ * Display - Asynchronous SSD1306 status display
+ *
+ * Platform: XIAO ESP32-S3
+ * Framework: Arduino
+ *
+ * The control path only hands over a DisplayStatus snapshot; everything
+ * slow happens in a low-priority task:
+ * - Render the snapshot as text into a 128x64 framebuffer
+ * - Diff it against a shadow of the panel, per 8-pixel page, to find the
+ *   dirty column span of each page
+ * - Push only those spans over I2C
+ *
+ * A full refresh is ~1 KB at 400 kHz (~25 ms); a typical status update
+ * changes a few characters and costs well under 1 ms of bus time.
+ */
+
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ============================================================================
+// Geometry
+// ============================================================================
+
+#define DISPLAY_WIDTH       128
+#define DISPLAY_HEIGHT      64
+#define DISPLAY_PAGES       (DISPLAY_HEIGHT / 8)
+#define DISPLAY_TEXT_COLS   (DISPLAY_WIDTH / 6)   // 5x7 font + 1 column spacing
+
+// ============================================================================
+// Status and Statistics
+// ============================================================================
+
+struct DisplayStatus {
+    const char* state;
+    bool xboxConnected;
+    bool legoConnected;
+    uint8_t xboxBattery;     // Percent
+    int8_t speed;
+    int8_t steering;
+    uint8_t lights;
+    bool emergencyStop;
+    uint16_t driveRateHz;
+};
+
+struct DisplayStats {
+    uint32_t framesRendered;
+    uint32_t framesPushed;   // Frames with at least one dirty page
+    uint32_t pagesPushed;
+    uint32_t bytesTransferred;  // I2C payload incl. commands
+    uint32_t i2cErrors;
+    uint32_t lastFrameUs;    // Render + push
+    uint32_t maxFrameUs;
+};
+
+// ============================================================================
+// Display Class
+// ============================================================================
+
+class Display {
+public:
+    Display();
+
+    // Detects the panel and starts the display task; false if absent
+    bool init();
+    bool isPresent();
+
+    // Hand over a new snapshot (never blocks on I2C)
+    void update(const DisplayStatus& status);
+
+    DisplayStats getStats();
+    void resetStats();
+
+private:
+    bool present;
+    TaskHandle_t task;
+    portMUX_TYPE mux;
+
+    DisplayStatus pending;   // Guarded by mux
+    DisplayStats stats;      // Guarded by mux
+
+    // Owned by the display task
+    uint8_t frame[DISPLAY_PAGES][DISPLAY_WIDTH];
+    uint8_t shadow[DISPLAY_PAGES][DISPLAY_WIDTH];
+    bool pageValid[DISPLAY_PAGES];  // Shadow matches the panel
+
+    void render(const DisplayStatus& status);
+    void drawText(uint8_t page, const char* text);
+    uint32_t push();
+    bool sendCommands(const uint8_t* commands, size_t length);
+    bool sendData(const uint8_t* data, size_t length);
+
+    static void taskMain(void* arg);
+};
+
+#endif // DISPLAY_H
@@ -0,0 +1,155 @@
+/**
+ * GATT Queue - Per-connection GATT operation scheduler
+ *
+ * Platform: XIAO ESP32-S3
+ * Framework: Arduino
+ *
+ * NimBLE runs one GATT procedure per connection at a time, and its
+ * client calls (connect, discovery, subscribe, read, write with
+ * response) block until the procedure completes. Each connection gets
+ * a queue with its own worker task that runs operations one after
+ * another, so callers submit and return immediately:
+ * - Highest priority first, FIFO within a priority
+ * - An operation that waited past its timeout is dropped, not run
+ * - Completion through a caller-owned GattFuture (polled) and/or a
+ *   callback on the worker task
+ * - Queue wait and run time are measured per queue, and each finished
+ *   operation can be reported to a trace handler
+ */
+
+#ifndef GATT_QUEUE_H
+#define GATT_QUEUE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+
+// ============================================================================
+// Operations
+// ============================================================================
+
+enum class GattPriority : uint8_t {
+    URGENT = 0,   // Connection bring-up, hub stop frames
+    NORMAL,       // Setup, writes
+    BACKGROUND    // Housekeeping reads
+};
+
+enum class GattOpStatus : uint8_t {
+    IDLE = 0,
+    QUEUED,
+    RUNNING,
+    OK,
+    FAILED,
+    TIMED_OUT,   // Waited past its timeout, never ran
+    CANCELLED
+};
+
+const char* gattOpStatusName(GattOpStatus status);
+
+// Result of one operation, written by the worker task. A future may be
+// reused once it is done; submit() refuses one that is still pending.
+struct GattFuture {
+    std::atomic<uint8_t> status;
+    uint32_t waitUs;  // Queued -> started
+    uint32_t runUs;
+
+    GattFuture() : status((uint8_t)GattOpStatus::IDLE), waitUs(0), runUs(0) {}
+
+    GattOpStatus get() const {
+        return (GattOpStatus)status.load(std::memory_order_acquire);
+    }
+    bool isPending() const {
+        GattOpStatus s = get();
+        return s == GattOpStatus::QUEUED || s == GattOpStatus::RUNNING;
+    }
+    bool isDone() const {
+        return get() >= GattOpStatus::OK;
+    }
+};
+
+// Runs on the worker task; may block on NimBLE client calls
+typedef bool (*GattOpFn)(void* context);
+typedef void (*GattDoneFn)(GattOpStatus status, void* context);
+
+// Receives every operation that ran or timed out (worker task)
+typedef void (*GattTraceHandler)(const char* queue, const char* op, GattOpStatus status,
+                                 uint32_t waitUs, uint32_t runUs);
+
+struct GattOp {
+    const char* name;
+    GattOpFn run;
+    void* context;
+    GattPriority priority;
+    uint32_t timeoutMs;   // Max queue wait, 0 = wait forever
+    GattFuture* future;   // Optional
+    GattDoneFn done;      // Optional, worker task (or cancelAll() caller)
+};
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+struct GattQueueStats {
+    uint32_t submitted;
+    uint32_t rejected;    // Queue full, future still pending or no worker task
+    uint32_t completed;   // Ran and succeeded
+    uint32_t failed;
+    uint32_t timedOut;
+    uint32_t cancelled;
+    uint32_t started;     // Ran (completed + failed)
+    uint64_t waitSumUs;
+    uint32_t waitMaxUs;
+    uint32_t runMaxUs;
+    uint8_t maxDepth;
+};
+
+// ============================================================================
+// GATT Queue Class
+// ============================================================================
+
+class GattQueue {
+public:
+    explicit GattQueue(const char* name);
+
+    bool init();   // Starts the worker task
+
+    // Never blocks; false if the queue is full or op.future is pending. With
+    // no worker task it also marks op.future FAILED.
+    bool submit(const GattOp& op);
+
+    // Drops queued operations as CANCELLED (the running one completes normally)
+    void cancelAll();
+
+    const char* getName();
+    uint8_t getDepth();
+    GattQueueStats getStats();
+    void resetStats();
+
+    // One handler for all queues
+    static void setTraceHandler(GattTraceHandler handler);
+
+private:
+    struct Slot {
+        GattOp op;
+        uint32_t enqueuedUs;
+        uint32_t order;
+        bool used;
+    };
+
+    const char* name;
+    Slot slots[GATT_QUEUE_DEPTH];
+    uint8_t depth;
+    uint32_t nextOrder;
+    portMUX_TYPE mux;
+    TaskHandle_t task;
+    GattQueueStats stats;
+
+    static volatile GattTraceHandler traceHandler;
+
+    bool takeNext(Slot& slot);
+    void execute(const Slot& slot);
+    static void complete(const GattOp& op, GattOpStatus status, uint32_t waitUs, uint32_t runUs);
+    static void taskFn(void* arg);
+};
+
+#endif // GATT_QUEUE_H
@@ -0,0 +1,45 @@
+/**
+ * Hot Path Benchmark - Worst-case control-path time with and without flash load
+ *
+ * Platform: XIAO ESP32-S3
+ * Framework: Arduino
+ *
+ * Times one control-path pass in CPU cycles: decode a controller report,
+ * map it, encode the hub frame and submit it to a TX scheduler. The bench
+ * uses its own mapper and scheduler, so the live links are untouched. Each
+ * pass starts after a tick of sleep, which lets other tasks evict the
+ * cache. That makes the maximum the number to watch. Phases:
+ * - quiet: nothing else running on purpose
+ * - NVS writes: a task on the other core rewrites an NVS blob nonstop
+ *
+ * Placement is a build option (HOT_PATH_IRAM in config.h). Run the bench
+ * on a build with it on and a build with it off, and compare.
+ */
+
+#ifndef HOT_PATH_BENCH_H
+#define HOT_PATH_BENCH_H
+
+#include <Arduino.h>
+#include "config.h"
+
+enum class HotPathLoad : uint8_t {
+    QUIET = 0,
+    NVS_WRITES,
+    COUNT
+};
+
+#define HOT_PATH_LOAD_COUNT ((int)HotPathLoad::COUNT)
+
+struct HotPathBenchResult {
+    const char* name;
+    uint32_t passes;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t sumCycles;
+    uint32_t nvsWrites;   // Completed by the load task during the phase
+};
+
+// Runs all phases; false if the load task could not be started
+bool hotPathBenchRun(uint32_t passes, HotPathBenchResult results[HOT_PATH_LOAD_COUNT]);
+
+#endif // HOT_PATH_BENCH_H
@@ -0,0 +1,91 @@
+/**
+ * Hub Benchmark - Command-rate capacity probe for the Lego hub link
+ *
+ * Platform: XIAO ESP32-S3 (also builds on the host - no Arduino dependencies)
+ *
+ * Drives the hub characteristic with neutral drive frames (the car does not
+ * move) at a ramping rate, first with write-without-response, then with
+ * write-with-response. Each step records frames attempted and accepted by
+ * the stack, write completion latency and hub notifications, counting LWP3
+ * generic error messages separately.
+ *
+ * The benchmark only decides when to send; the caller performs the write
+ * and reports back, so the same sequence can run against a hub model.
+ */
+
+#ifndef HUB_BENCHMARK_H
+#define HUB_BENCHMARK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "config.h"
+#include "lego_protocol.h"
+
+#define HUB_BENCH_STEP_COUNT    (2 * HUB_BENCH_RATE_COUNT)  // Both write types
+#define LWP3_MSG_GENERIC_ERROR  0x05  // Message type byte (offset 2)
+
+// ============================================================================
+// Results
+// ============================================================================
+
+struct HubBenchRow {
+    uint16_t targetHz;
+    bool withResponse;
+    uint32_t attempted;
+    uint32_t accepted;
+    uint32_t failed;
+    uint32_t skipped;        // Frame slots missed because a write was still blocking
+    uint64_t latencySumUs;
+    uint32_t latencyMaxUs;
+    uint32_t notifications;
+    uint32_t hubErrors;
+    uint32_t elapsedUs;
+};
+
+// ============================================================================
+// Hub Benchmark Class
+// ============================================================================
+
+class HubBenchmark {
+public:
+    HubBenchmark();
+
+    void start(uint32_t nowUs);
+    void abort();
+    bool isRunning() const;
+
+    // Completed since the last start() and not yet acknowledged
+    bool hasNewResults() const;
+    void acknowledgeResults();
+
+    // Is a frame due now? Fills the frame and write type if so.
+    bool nextFrame(uint32_t nowUs, LegoFrame& frame, bool& withResponse);
+
+    // Outcome of the write handed out by nextFrame()
+    void recordWrite(bool ok, uint32_t latencyUs);
+
+    // Hub notification (any task)
+    void recordNotification(const uint8_t* data, size_t length);
+
+    int getRowCount() const;
+    const HubBenchRow& getRow(int index) const;
+
+private:
+    HubBenchRow rows[HUB_BENCH_STEP_COUNT];
+    int step;
+    int rowCount;
+    bool running;
+    bool newResults;
+
+    uint32_t stepStartUs;
+    uint32_t nextFrameUs;
+
+    std::atomic<uint32_t> notifications;
+    std::atomic<uint32_t> hubErrors;
+
+    void beginStep(int index, uint32_t nowUs);
+    void endStep(uint32_t nowUs);
+};
+
+#endif // HUB_BENCHMARK_H
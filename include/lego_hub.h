@@ -0,0 +1,157 @@
+/**
+ * Lego Hub - Technic Move Hub link
+ *
+ * Platform: XIAO ESP32-S3
+ * Framework: Arduino
+ *
+ * This module owns the hub's control characteristic:
+ * - Characteristic discovery and feedback subscription
+ * - Drive, light, calibration and emergency stop commands
+ * - Prioritized, paced transmission through LegoTxScheduler
+ * - Adaptive drive-frame rate through TxRateController
+ * - Paced frames timed to land just before the hub's connection events
+ *   (ConnEventTracker), or sent immediately while their phase is unknown
+ *
+ * Commands may be submitted from any task; frames are only written from
+ * service(), which the main loop calls every iteration. Stop frames are
+ * acknowledged, so they run on the hub's GATT queue instead of blocking
+ * the loop for a connection interval. Nothing else is sent until the
+ * acknowledgement arrives, and a failed stop is queued again.
+ */
+
+#ifndef LEGO_HUB_H
+#define LEGO_HUB_H
+
+#include <NimBLEDevice.h>
+#include "config.h"
+#include "conn_event_tracker.h"
+#include "gatt_queue.h"
+#include "lego_tx_scheduler.h"
+#include "tx_rate_controller.h"
+
+// Receives every hub notification (called from the NimBLE task)
+typedef void (*LegoFeedbackHandler)(const uint8_t* data, size_t length);
+
+// How a paced frame was timed against the connection events
+enum class LegoTxTiming : uint8_t {
+    IMMEDIATE = 0,  // Handed to the stack as soon as pacing allowed
+    ALIGNED,        // Held until LEGO_TX_ALIGN_LEAD_US before the next event
+    COUNT
+};
+
+#define LEGO_TX_TIMING_COUNT ((int)LegoTxTiming::COUNT)
+
+const char* legoTxTimingName(LegoTxTiming timing);
+
+// Wait from frame ready (submitted) to the connection event it went out in.
+// Only measurable while the event phase is known; stop frames are excluded.
+struct LegoTxAlignStats {
+    uint32_t frames[LEGO_TX_TIMING_COUNT];
+    uint64_t airWaitSumUs[LEGO_TX_TIMING_COUNT];
+    uint32_t airWaitMaxUs[LEGO_TX_TIMING_COUNT];
+    uint32_t untimed;     // Sent while the phase was unknown
+};
+
+// ============================================================================
+// Lego Hub Class
+// ============================================================================
+
+class LegoHub {
+public:
+    explicit LegoHub(GattQueue& queue);
+
+    // Initialization (after the BLE connection is up, on the hub's GATT
+    // queue). reset() runs on the loop, before init() for a new link.
+    bool init(NimBLEClient* client);
+    void reset();
+    bool isReady();
+    bool hasLink();   // Still bound to a link, connected or not
+
+    // Commands
+    void calibrateSteering();
+    void sendDrive(int8_t speed, int8_t steering, uint8_t lights);
+    void setLights(uint8_t lights);
+    void emergencyStop();
+
+    // Transmit the next frame if pacing allows (call from loop())
+    void service();
+
+    // Wait until a pending stop is acknowledged (false on timeout or link
+    // loss). Blocks - for teardowns only, never on the control path.
+    bool flushStop(uint32_t timeoutMs);
+
+    // Passthrough for benchmarking - writes immediately, bypassing the
+    // scheduler. Don't mix with service() while in use.
+    bool writeDirect(const LegoFrame& frame, bool withResponse);
+    void setFeedbackHandler(LegoFeedbackHandler handler);
+
+    // Adaptive drive-frame rate (the caller submits drive frames at this rate)
+    uint16_t getDriveRateHz();
+    uint32_t getDriveIntervalMs();
+
+    // Connection-event alignment (on by default with LEGO_TX_ALIGN_ENABLED)
+    void setTxAlign(bool enabled);
+    bool isTxAlignEnabled();
+
+    // Statistics
+    LegoTxStats getTxStats();
+    AimdStats getRateStats();
+    LegoTxAlignStats getAlignStats();
+    ConnEventStats getConnEventStats();
+    bool isConnEventLocked();
+    uint32_t getConnIntervalUs();
+    ConnEventPhase getConnEventPhase();
+    uint32_t getWriteFailures();
+    unsigned long getFirstTxMs();  // 0 until the first frame since init()
+    uint32_t getLastControlTxUs(); // micros() of the last drive/stop write
+    // True once the drive or stop frame submitted at submitUs (micros()) has
+    // gone out, with txUs the write that carried it
+    bool isControlSentSince(uint32_t submitUs, uint32_t& txUs);
+    void resetStats();
+
+private:
+    // Acknowledged stop write, run on the GATT queue task
+    struct StopWrite {
+        LegoHub* hub;
+        NimBLERemoteCharacteristic* characteristic;
+        LegoFrame frame;
+        uint32_t submittedUs;
+    };
+
+    NimBLEClient* bleClient;                     // Guarded by txMux (set by init())
+    NimBLERemoteCharacteristic* controlChar;     // Guarded by txMux
+    GattQueue& gattQueue;
+    StopWrite stopWrite;
+    bool stopInFlight;                // Guarded by txMux
+
+    LegoTxScheduler scheduler;
+    TxRateController rateController;
+    ConnEventTracker eventTracker;    // Guarded by txMux (observed from the NimBLE task)
+    LegoTxAlignStats alignStats;
+    portMUX_TYPE txMux;
+    bool txAlign;
+    unsigned long lastIntervalReadMs;
+
+    int8_t currentSpeed;
+    int8_t currentSteering;
+    uint8_t currentLights;
+
+    unsigned long lastTxMs;
+    unsigned long lastCalibrationMs;
+    unsigned long firstTxMs;
+    uint32_t lastControlTxUs;
+    uint32_t writeFailures;
+
+    static volatile LegoFeedbackHandler feedbackHandler;
+
+    void submit(LegoTxClass cls, const LegoFrame& frame);
+    void sendStop(NimBLERemoteCharacteristic* characteristic);
+    static bool stopWriteOp(void* context);
+    static void onStopDone(GattOpStatus status, void* context);
+    NimBLERemoteCharacteristic* getLink(NimBLEClient*& client);
+    void refreshConnInterval(NimBLEClient* client, unsigned long nowMs);
+    void recordAirWait(LegoTxTiming timing, uint32_t waitUs);
+    void onNotify(uint8_t* data, size_t length);
+};
+
+#endif // LEGO_HUB_H
@@ -0,0 +1,48 @@
+/**
+ * Lego Protocol - Technic Move Hub command encoding
+ *
+ * Platform: XIAO ESP32-S3 (also builds on the host - no Arduino dependencies)
+ *
+ * All hub commands share the same 13-byte layout:
+ *   LEGO_CMD_HEADER (9 bytes) | speed | steering | lights/command | 0x00
+ *
+ * Calibration is sent as two frames with the calibration command in the
+ * lights position and speed/steering zeroed.
+ */
+
+#ifndef LEGO_PROTOCOL_H
+#define LEGO_PROTOCOL_H
+
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+
+// ============================================================================
+// Frame Layout
+// ============================================================================
+
+#define LEGO_FRAME_SPEED_OFFSET    9
+#define LEGO_FRAME_STEERING_OFFSET 10
+#define LEGO_FRAME_LIGHTS_OFFSET   11
+
+struct LegoFrame {
+    uint8_t data[LEGO_CMD_TOTAL_SIZE];
+};
+
+// ============================================================================
+// Encoders
+// ============================================================================
+
+inline void legoEncodeDrive(LegoFrame& frame, int8_t speed, int8_t steering, uint8_t lights) {
+    memcpy(frame.data, LEGO_CMD_HEADER, LEGO_CMD_HEADER_SIZE);
+    frame.data[LEGO_FRAME_SPEED_OFFSET] = (uint8_t)speed;
+    frame.data[LEGO_FRAME_STEERING_OFFSET] = (uint8_t)steering;
+    frame.data[LEGO_FRAME_LIGHTS_OFFSET] = lights;
+    frame.data[LEGO_CMD_TOTAL_SIZE - 1] = 0x00;
+}
+
+inline void legoEncodeCalibration(LegoFrame& frame, uint8_t command) {
+    legoEncodeDrive(frame, 0, 0, command);
+}
+
+#endif // LEGO_PROTOCOL_H
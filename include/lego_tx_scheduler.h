@@ -0,0 +1,104 @@
+/**
+ * Lego TX Scheduler - Fixed-priority transmit slots for the hub link
+ *
+ * Platform: XIAO ESP32-S3 (also builds on the host - no Arduino dependencies)
+ *
+ * Every frame for the hub goes through one characteristic, so a frame
+ * waiting in the BLE stack's FIFO delays everything behind it. Instead,
+ * frames wait here in one slot per traffic class and the hub link pulls
+ * the most important one each time it may transmit:
+ *
+ *   STOP        > CALIBRATION > DRIVE        > AUX
+ *   (preempts)    (2-deep FIFO)  (latest-wins)  (latest-wins)
+ *
+ * Submitting a stop discards any pending drive or aux frame. Both carry a
+ * speed, so they are stale by definition. The scheduler is not thread-safe; the owner serializes.
+ */
+
+#ifndef LEGO_TX_SCHEDULER_H
+#define LEGO_TX_SCHEDULER_H
+
+#include <stdint.h>
+#include "lego_protocol.h"
+
+// ============================================================================
+// Traffic Classes (in priority order)
+// ============================================================================
+
+enum class LegoTxClass : uint8_t {
+    STOP = 0,
+    CALIBRATION,
+    DRIVE,
+    AUX,
+    COUNT
+};
+
+#define LEGO_TX_CLASS_COUNT       ((int)LegoTxClass::COUNT)
+#define LEGO_TX_CALIBRATION_DEPTH 2   // Calibration is a two-frame sequence
+
+const char* legoTxClassName(LegoTxClass cls);
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+struct LegoTxStats {
+    uint32_t submitted[LEGO_TX_CLASS_COUNT];
+    uint32_t sent[LEGO_TX_CLASS_COUNT];
+    uint32_t replaced[LEGO_TX_CLASS_COUNT];  // Overwritten before being sent
+    uint32_t drivePreempted;                 // Pending drive frames discarded by a stop
+    uint32_t auxPreempted;                   // Pending aux frames discarded by a stop
+    uint32_t calibrationDropped;             // Calibration FIFO full
+
+    // Queue latency (submit -> handed to the stack), per class
+    uint32_t latencyMaxUs[LEGO_TX_CLASS_COUNT];
+    uint64_t latencySumUs[LEGO_TX_CLASS_COUNT];
+};
+
+// ============================================================================
+// Scheduler
+// ============================================================================
+
+class LegoTxScheduler {
+public:
+    LegoTxScheduler();
+
+    void clear();
+    void resetStats();
+
+    // Queue a frame; returns false if it was dropped
+    bool submit(LegoTxClass cls, const LegoFrame& frame, uint32_t nowUs);
+
+    // Highest-priority pending class, without removing it
+    bool peek(LegoTxClass& cls) const;
+
+    // Remove the highest-priority pending frame
+    bool pop(LegoFrame& frame, LegoTxClass& cls, uint32_t& submittedUs);
+
+    // Record that a popped frame reached the stack
+    void recordSent(LegoTxClass cls, uint32_t submittedUs, uint32_t nowUs);
+
+    bool hasPending() const;
+    const LegoTxStats& getStats() const;
+
+private:
+    struct Slot {
+        LegoFrame frame;
+        uint32_t submittedUs;
+        bool pending;
+    };
+
+    Slot stopSlot;
+    Slot calibrationFifo[LEGO_TX_CALIBRATION_DEPTH];
+    uint8_t calibrationHead;
+    uint8_t calibrationCount;
+    Slot driveSlot;
+    Slot auxSlot;
+
+    LegoTxStats stats;
+
+    void storeLatest(Slot& slot, LegoTxClass cls, const LegoFrame& frame, uint32_t nowUs);
+    void take(Slot& slot, LegoFrame& frame, uint32_t& submittedUs);
+};
+
+#endif // LEGO_TX_SCHEDULER_H
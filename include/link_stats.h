@@ -0,0 +1,95 @@
+/**
+ * Link Statistics - Per-connection counters
+ *
+ * Platform: XIAO ESP32-S3
+ *
+ * One fixed LinkStats struct per peer. Counters are updated with relaxed
+ * atomics from NimBLE callbacks and the main loop, and read lock-free by
+ * the status output. A snapshot may mix values from different instants,
+ * which is fine for diagnostics.
+ */
+
+#ifndef LINK_STATS_H
+#define LINK_STATS_H
+
+#include <stdint.h>
+#include <atomic>
+#include "config.h"
+
+// ============================================================================
+// Link Identifiers
+// ============================================================================
+
+enum class LinkId : uint8_t {
+    XBOX = 0,
+    LEGO,
+    COUNT
+};
+
+#define LINK_COUNT ((int)LinkId::COUNT)
+
+const char* linkName(LinkId link);
+
+// ============================================================================
+// Statistics Structure
+// ============================================================================
+
+// Notification inter-arrival histogram, bucket upper bounds in ms (last is open)
+#define LINK_HIST_BUCKETS 8
+static const uint16_t LINK_HIST_BOUNDS_MS[LINK_HIST_BUCKETS - 1] HOT_DATA = {
+    5, 10, 20, 40, 80, 160, 320
+};
+
+#define LINK_DISCONNECT_HISTORY 4
+
+struct LinkStats {
+    // Notifications
+    std::atomic<uint32_t> notifications;
+    std::atomic<uint32_t> interArrival[LINK_HIST_BUCKETS];
+    std::atomic<uint32_t> lastNotifyUs;
+
+    // Writes
+    std::atomic<uint32_t> writesSubmitted;
+    std::atomic<uint32_t> writesCompleted;
+    std::atomic<uint32_t> writesFailed;
+    std::atomic<uint32_t> retries;
+
+    // RSSI (dBm)
+    std::atomic<int32_t> rssiMin;
+    std::atomic<int32_t> rssiMax;
+    std::atomic<int32_t> rssiSum;
+    std::atomic<uint32_t> rssiSamples;
+
+    // Connection
+    std::atomic<uint32_t> connParamUpdates;
+    std::atomic<uint8_t> txPhy;
+    std::atomic<uint8_t> rxPhy;
+    std::atomic<uint32_t> disconnects;
+    std::atomic<int32_t> disconnectReasons[LINK_DISCONNECT_HISTORY];  // 0x200 + HCI reason, most recent first
+};
+
+// ============================================================================
+// Recording (safe from any task)
+// ============================================================================
+
+LinkStats& linkStats(LinkId link);
+
+void linkStatsReset(LinkId link);
+void linkStatsResetAll();
+
+void linkStatsRecordNotification(LinkId link, uint32_t nowUs);
+void linkStatsRecordWriteSubmitted(LinkId link);
+void linkStatsRecordWriteResult(LinkId link, bool ok);
+void linkStatsRecordRetry(LinkId link);
+void linkStatsRecordRssi(LinkId link, int rssi);
+void linkStatsRecordConnParamUpdate(LinkId link);
+void linkStatsRecordPhy(LinkId link, uint8_t txPhy, uint8_t rxPhy);
+void linkStatsRecordDisconnect(LinkId link, int reason);
+
+// ============================================================================
+// Output
+// ============================================================================
+
+void linkStatsPrint(LinkId link);
+
+#endif // LINK_STATS_H
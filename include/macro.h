@@ -0,0 +1,143 @@
+/**
+ * Macro - Record mapped controls and replay them on a timer
+ *
+ * Platform: XIAO ESP32-S3
+ * Framework: Arduino (esp_timer, PSRAM)
+ *
+ * The recorder stores every control frame sent to the car (speed,
+ * steering, lights, stop) with its time since the start of the recording,
+ * and the controller input it was mapped from. Frames live in PSRAM:
+ * MACRO_MAX_FRAMES at 24 bytes each.
+ *
+ * The player submits the frames to the hub from an esp_timer callback, each
+ * at start + its recorded offset. It does not depend on loop() timing, and
+ * scheduling against the start time keeps one late frame from delaying the
+ * rest. Two timing errors are reported:
+ * - timer: callback dispatch vs. the frame's due time
+ * - write: the hub write that carried the frame vs. its due time (includes
+ *   service() pacing on the loop)
+ *
+ * Each track carries an FNV-1a hash of its frames. Playback hashes the
+ * frames it submits, so a match means the whole sequence went out
+ * unchanged and in order (the input is not hashed - playback does not
+ * send it). 'macro dump' prints the frames and the hash for replay off the
+ * board (format in macro_frame.h). tools/replay_ab.cpp checks the dump
+ * against its hash and replays it through other mapper settings.
+ */
+
+#ifndef MACRO_H
+#define MACRO_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "config.h"
+#include "control_mapper.h"
+#include "lego_hub.h"
+#include "macro_frame.h"
+
+// ============================================================================
+// Track
+// ============================================================================
+
+class MacroTrack {
+public:
+    MacroTrack();
+
+    // Allocates the frame buffer in PSRAM
+    bool init(uint32_t maxFrames);
+    bool isReady() const;
+
+    void clear();
+    bool append(const MacroFrame& frame);   // False when full
+
+    uint32_t getCount() const;
+    uint32_t getCapacity() const;
+    const MacroFrame& getFrame(uint32_t index) const;
+    uint32_t getDurationUs() const;
+    uint32_t getHash() const;
+
+private:
+    MacroFrame* frames;
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t hash;
+};
+
+// ============================================================================
+// Recorder
+// ============================================================================
+
+class MacroRecorder {
+public:
+    MacroRecorder(MacroTrack& track);
+
+    // Replaces the track's contents
+    bool start(uint32_t nowUs);
+    // False when it stops (full)
+    bool record(const XboxControllerState& input, const MappedControls& controls, uint32_t nowUs);
+    void stop();
+    bool isRecording() const;
+
+private:
+    MacroTrack& track;
+    uint32_t startUs;
+    bool recording;
+};
+
+// ============================================================================
+// Player
+// ============================================================================
+
+struct MacroPlaybackStats {
+    uint32_t plays;
+    uint32_t completed;
+    uint32_t hashMatches;        // Completed plays whose submitted frames hashed to the track's
+    uint32_t frames;
+
+    uint32_t timerErrorCount;
+    uint64_t timerErrorSumUs;
+    uint32_t timerErrorMaxUs;
+
+    uint32_t writeErrorCount;
+    uint64_t writeErrorSumUs;
+    uint32_t writeErrorMaxUs;
+};
+
+class MacroPlayer {
+public:
+    MacroPlayer(MacroTrack& track);
+
+    bool init();
+    bool start(LegoHub* hub);
+    void stop();   // No further frame is submitted once this returns
+    bool isPlaying() const;
+
+    // After each LegoHub::service() (loop) - times the pending frame's write
+    void recordTx();
+
+    MacroPlaybackStats getStats();
+    void resetStats();
+
+private:
+    MacroTrack& track;
+    LegoHub* hub;
+    esp_timer_handle_t timer;
+    portMUX_TYPE mux;
+
+    volatile bool playing;
+    uint32_t next;
+    int64_t startUs;
+    uint32_t hash;
+
+    // Last submitted frame, until its hub write is seen
+    bool writePending;
+    uint32_t pendingSubmitUs;
+    uint32_t pendingDueUs;
+
+    MacroPlaybackStats stats;
+
+    void playNext();
+    static void timerCB(void* arg);
+};
+
+#endif // MACRO_H
@@ -0,0 +1,53 @@
+/**
+ * Macro Frame - One recorded control frame, its hash and its dump line
+ *
+ * Platform: XIAO ESP32-S3 (also builds on the host - no Arduino dependencies)
+ *
+ * Shared by the recorder and player (macro.h), 'macro dump' and the host
+ * tools. A dump read back on the host hashes to the value the board
+ * printed only if every frame survived the round trip unchanged.
+ *
+ * Dump format, one frame per line after MACRO_DUMP_HEADER, then a trailer:
+ *   offset_us,speed,steering,lights,stop,buttons,lx,ly,rx,ry,lt,rt
+ *   # <frames> frames, hash 0x<hash>
+ */
+
+#ifndef MACRO_FRAME_H
+#define MACRO_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "xbox_report.h"
+
+#define MACRO_HASH_SEED   2166136261UL
+#define MACRO_DUMP_HEADER "offset_us,speed,steering,lights,stop,buttons,lx,ly,rx,ry,lt,rt"
+
+// ============================================================================
+// Frame
+// ============================================================================
+
+struct MacroFrame {
+    uint32_t offsetUs;    // Since the start of the recording
+    int8_t speed;
+    int8_t steering;
+    uint8_t lights;
+    uint8_t stop;         // Emergency stop instead of a drive frame
+    XboxPackedState input;  // What the mapper was given
+};
+
+// FNV-1a over what playback sends: offset, speed, steering, lights, stop
+uint32_t macroHashFrame(uint32_t hash, const MacroFrame& frame);
+
+// ============================================================================
+// Dump Lines
+// ============================================================================
+
+// Both return the snprintf() length (no newline)
+int macroFormatFrame(char* buffer, size_t size, const MacroFrame& frame);
+int macroFormatTrailer(char* buffer, size_t size, uint32_t count, uint32_t hash);
+
+// False for anything else (header, trailer, other serial output)
+bool macroParseFrame(const char* line, MacroFrame& frame);
+bool macroParseTrailer(const char* line, uint32_t& count, uint32_t& hash);
+
+#endif // MACRO_FRAME_H
@@ -0,0 +1,88 @@
+/**
+ * Power Manager - Per-state CPU clock and light-sleep policy
+ *
+ * Platform: XIAO ESP32-S3
+ * Framework: Arduino (ESP-IDF power management)
+ *
+ * Driving holds ESP-IDF power-management locks for the maximum CPU clock
+ * and against light sleep, so control frames see no wake-up or clock-ramp
+ * delay. Scanning and idle release them: the clock scales down to
+ * POWER_MIN_FREQ_MHZ and the chip may light-sleep between loop() passes,
+ * which also run less often (powerModeLoopDelayMs()).
+ *
+ * Needs CONFIG_PM_ENABLE in the SDK config (and tickless idle for light
+ * sleep). Without it the clock stays fixed; only the loop delay changes.
+ *
+ * Wake-up cost is measured as loop() oversleep: how far past the requested
+ * delay each pass actually resumed, per mode.
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
+
+// ============================================================================
+// Modes
+// ============================================================================
+
+enum class PowerMode : uint8_t {
+    DRIVE = 0,   // Max clock, no light sleep
+    SCAN,        // Scaled clock, light sleep, short loop delay
+    IDLE,        // Scaled clock, light sleep, long loop delay
+    COUNT
+};
+
+#define POWER_MODE_COUNT ((int)PowerMode::COUNT)
+
+const char* powerModeName(PowerMode mode);
+uint32_t powerModeLoopDelayMs(PowerMode mode);
+
+struct PowerModeStats {
+    uint32_t timeMs;          // Residency
+    uint32_t loops;
+    uint32_t oversleepMaxUs;  // Worst wake-up past the requested delay
+    uint64_t oversleepSumUs;
+};
+
+// ============================================================================
+// Power Manager Class
+// ============================================================================
+
+class PowerManager {
+public:
+    PowerManager();
+
+    bool init();
+    bool isScalingActive();   // false if power management is unavailable
+
+    void setMode(PowerMode mode);
+    PowerMode getMode();
+
+    // Replaces loop()'s fixed delay - sleeps for the mode's period and
+    // records the wake-up latency
+    void loopDelay();
+
+    PowerModeStats getStats(PowerMode mode);
+    void resetStats();
+
+private:
+    PowerMode mode;
+    bool scalingActive;
+    unsigned long modeStartMs;
+    PowerModeStats stats[POWER_MODE_COUNT];
+
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_handle_t cpuLock;
+    esp_pm_lock_handle_t sleepLock;
+#endif
+
+    void closeResidency(unsigned long nowMs);
+};
+
+#endif // POWER_MANAGER_H
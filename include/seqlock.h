@@ -0,0 +1,101 @@
+/**
+ * Seqlock - Lock-free publication of a small value to many readers
+ *
+ * Platform: XIAO ESP32-S3 (also builds on the host - no Arduino dependencies)
+ *
+ * One writer, any number of readers, no locks on either side:
+ * - The writer bumps the sequence to odd, stores the value word by word,
+ *   then bumps it to even. It never waits.
+ * - A reader copies the words between two sequence loads and retries if
+ *   the sequence was odd or changed (a torn read).
+ *
+ * The words are relaxed atomics, so a racing copy is well defined and
+ * simply discarded. Readers spin while a write is in progress, so the
+ * writer must not be preempted by a reader on its own core - on the
+ * ESP32 the writer is the BLE/USB task, which outranks every reader.
+ *
+ * T must be trivially copyable and a whole number of 32-bit words.
+ *
+ * test/test_seqlock stresses it on the host with one writer and several
+ * reader threads; seqlock_bench.h runs the same check on the target.
+ */
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+// ============================================================================
+// Seqlock Class
+// ============================================================================
+
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock value must be trivially copyable");
+    static_assert(sizeof(T) % sizeof(uint32_t) == 0, "Seqlock value must be a whole number of words");
+
+public:
+    Seqlock()
+        : sequence(0)
+        , retries(0)
+    {
+        for (size_t i = 0; i < WORD_COUNT; i++) {
+            words[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Single writer only
+    void write(const T& value) {
+        uint32_t buffer[WORD_COUNT];
+        memcpy(buffer, &value, sizeof(T));
+
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORD_COUNT; i++) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // Any number of readers, from any task or core
+    void read(T& value) const {
+        uint32_t buffer[WORD_COUNT];
+        while (true) {
+            uint32_t before = sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                for (size_t i = 0; i < WORD_COUNT; i++) {
+                    buffer[i] = words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before) {
+                    break;
+                }
+            }
+            retries.fetch_add(1, std::memory_order_relaxed);
+        }
+        memcpy(&value, buffer, sizeof(T));
+    }
+
+    // Completed writes (the sequence counts two per write)
+    uint32_t getWriteCount() const {
+        return sequence.load(std::memory_order_relaxed) / 2;
+    }
+
+    // Read attempts discarded because they raced a write
+    uint32_t getRetryCount() const {
+        return retries.load(std::memory_order_relaxed);
+    }
+
+private:
+    static const size_t WORD_COUNT = sizeof(T) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> words[WORD_COUNT];
+    mutable std::atomic<uint32_t> retries;
+};
+
+#endif // SEQLOCK_H
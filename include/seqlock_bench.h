@@ -0,0 +1,44 @@
+/**
+ * Seqlock Benchmark - Stress check and lock comparison for state publication
+ *
+ * Platform: XIAO ESP32-S3
+ * Framework: Arduino
+ *
+ * A writer task on the other core publishes an XboxPackedState as fast as
+ * it can while the calling task reads it back, once per method:
+ * - seqlock (what the controller classes use)
+ * - portMUX spinlock critical section (what they used before)
+ * - FreeRTOS mutex
+ *
+ * Every published value is derived from one counter, so a torn read shows
+ * up as fields that disagree. Each phase blocks the caller for phaseMs.
+ */
+
+#ifndef SEQLOCK_BENCH_H
+#define SEQLOCK_BENCH_H
+
+#include <Arduino.h>
+#include "config.h"
+
+enum class SyncMethod : uint8_t {
+    SEQLOCK = 0,
+    SPINLOCK,
+    MUTEX,
+    COUNT
+};
+
+#define SYNC_METHOD_COUNT ((int)SyncMethod::COUNT)
+
+struct SeqlockBenchResult {
+    const char* name;
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t tornReads;   // Inconsistent copies returned - must be 0
+    uint32_t retries;     // Seqlock only
+    uint32_t elapsedUs;
+};
+
+// Runs all methods; false if the writer task could not be started
+bool seqlockBenchRun(uint32_t phaseMs, SeqlockBenchResult results[SYNC_METHOD_COUNT]);
+
+#endif // SEQLOCK_BENCH_H
@@ -0,0 +1,127 @@
+/**
+ * Serial Input - Binary controller frames from a PC over USB serial
+ *
+ * Platform: XIAO ESP32-S3 (also builds on the host - no Arduino dependencies)
+ *
+ * Lets a PC program drive the car through the same mapper as the Xbox
+ * controller. Frames share the serial port with the text commands: the
+ * sync byte 0xA5 never occurs in text, so every other byte is passed on -
+ * until the first frame is accepted. From then on the port is a binary
+ * link, and payload bytes left over from a broken frame (a dropped byte,
+ * a bad checksum) must not reach the command line:
+ * - After a broken frame, bytes are discarded up to the next 0xA5 0x5A
+ * - Text passes only as whole lines of printable characters; a line with
+ *   anything else in it is discarded, newline included
+ * After SERIAL_INPUT_TIMEOUT_MS without a byte the port is plain text again.
+ *
+ * Frame (20 bytes, little-endian):
+ *   0     0xA5  Sync
+ *   1     0x5A  Sync
+ *   2     Type (0x01 = controller state)
+ *   3     Sequence (uint8, +1 per frame, wraps)
+ *   4-5   Buttons: A B X Y LB RB LS RS View Menu Xbox Share Up Down Left Right
+ *         (bit 0 = A)
+ *   6-13  Left X, Left Y, Right X, Right Y (int16, Y positive = up)
+ *   14-17 Left trigger, Right trigger (uint16, 0..1023)
+ *   18-19 Fletcher-16 of bytes 2-17 (sum1, then sum2)
+ *
+ * Bytes are decoded straight into a spare XboxControllerState as they
+ * arrive - there is no frame buffer - and the spare becomes current once
+ * the checksum passes. Bad frames leave the current state untouched.
+ */
+
+#ifndef SERIAL_INPUT_H
+#define SERIAL_INPUT_H
+
+#include <stdint.h>
+#include "xbox_report.h"
+
+// ============================================================================
+// Protocol
+// ============================================================================
+
+#define SERIAL_INPUT_SYNC1          0xA5
+#define SERIAL_INPUT_SYNC2          0x5A
+#define SERIAL_INPUT_TYPE_CONTROLS  0x01
+#define SERIAL_INPUT_FRAME_SIZE     20
+
+enum class SerialInputResult : uint8_t {
+    NOT_FRAME = 0,   // Not part of a frame - treat as text
+    CONSUMED,        // Part of a frame in progress
+    FRAME_OK,        // Completed a valid frame
+    FRAME_DROPPED,   // Completed a frame that was rejected
+    DISCARDED        // Noise on a binary link - drop it and any partial text line
+};
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+struct SerialInputStats {
+    uint32_t frames;          // Accepted
+    uint32_t checksumErrors;
+    uint32_t syncErrors;      // Bad second sync byte or unknown type
+    uint32_t lostFrames;      // Sequence gaps
+    uint32_t duplicates;      // Repeated sequence, dropped
+    uint32_t discarded;       // Bytes dropped between frames on a binary link
+
+    // Serial byte -> Lego write
+    uint32_t latencyCount;
+    uint64_t latencySumUs;
+    uint32_t latencyMinUs;
+    uint32_t latencyMaxUs;
+};
+
+// ============================================================================
+// Serial Input Parser Class
+// ============================================================================
+
+class SerialInputParser {
+public:
+    SerialInputParser();
+
+    // One received byte, with its arrival time
+    SerialInputResult feed(uint8_t byte, uint32_t nowUs);
+    bool inFrame() const;
+
+    // Last accepted frame
+    const XboxControllerState& getState() const;
+    uint32_t getFrameCount() const;     // Accepted frames, for change detection
+    uint32_t getFrameStartUs() const;   // Arrival of its first byte
+    bool isFresh(uint32_t nowUs, uint32_t timeoutUs) const;
+
+    void recordLatency(uint32_t latencyUs);
+    const SerialInputStats& getStats() const;
+    void resetStats();
+
+private:
+    XboxControllerState states[2];
+    uint8_t current;          // Index of the accepted state; the other is being filled
+
+    uint8_t position;         // Next byte's offset in the frame, 0 = hunting for sync
+    uint8_t sum1;
+    uint8_t sum2;
+    uint8_t lowByte;
+    uint8_t sequence;
+    uint8_t receivedSum1;
+    uint32_t startUs;
+
+    bool haveSequence;
+    uint8_t lastSequence;
+    uint32_t lastFrameStartUs;
+    uint32_t lastFrameEndUs;
+
+    bool binary;              // A frame has been accepted and the link is not quiet
+    bool resyncing;           // Broken frame: discard up to the next sync pair
+    bool lineClean;           // Text since the last frame or newline is printable
+    uint32_t lastByteUs;
+
+    SerialInputStats stats;
+
+    void decodeField(XboxControllerState& state, uint8_t offset, uint16_t value);
+    SerialInputResult finishFrame(uint8_t receivedSum2, uint32_t nowUs);
+    SerialInputResult dropFrame();
+    SerialInputResult filterText(uint8_t byte);
+};
+
+#endif // SERIAL_INPUT_H
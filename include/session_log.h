@@ -0,0 +1,86 @@
+/**
+ * Session Log - Status snapshots and events on the on-board flash
+ *
+ * Platform: XIAO ESP32-S3
+ * Framework: Arduino (LittleFS)
+ *
+ * Keeps a record of each run without a laptop attached. Callers format a
+ * line into a RAM staging block; nothing on the calling side touches the
+ * flash. A background task writes each block in one go:
+ * - A full block (SESSION_LOG_BLOCK_SIZE, one flash sector) is written
+ *   as soon as it fills
+ * - A partial block is written after SESSION_LOG_FLUSH_MS, so at most
+ *   that much is lost on a power cut
+ * - Lines are dropped (and counted) only if both blocks are full, i.e.
+ *   the flash fell a whole block behind
+ *
+ * Files: /session0.log is the current session, /session1.log the one
+ * before, ... Each boot and each file reaching SESSION_LOG_FILE_MAX
+ * rotates them, so flash use is capped at SESSION_LOG_FILES files.
+ */
+
+#ifndef SESSION_LOG_H
+#define SESSION_LOG_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+struct SessionLogStats {
+    uint32_t lines;
+    uint32_t droppedLines;
+    uint32_t fullFlushes;
+    uint32_t partialFlushes;
+    uint32_t bytesWritten;
+    uint32_t writeErrors;
+    uint32_t rotations;
+    uint32_t lastFlushUs;
+    uint32_t maxFlushUs;
+    uint64_t flushSumUs;
+};
+
+// ============================================================================
+// Session Log Class
+// ============================================================================
+
+class SessionLog {
+public:
+    SessionLog();
+
+    // Mounts LittleFS (formatting it if needed), rotates and starts the task
+    bool init();
+    bool isReady();
+
+    // Timestamped line; never blocks on flash, safe from any task
+    void log(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    // File access for the serial commands (reads flash - not while driving)
+    void dump();
+    void clear();
+
+    SessionLogStats getStats();
+    void resetStats();
+
+private:
+    char blocks[2][SESSION_LOG_BLOCK_SIZE];
+    size_t fill[2];
+    uint8_t active;       // Block being filled
+    bool sealed;          // The other block is waiting for the task
+    unsigned long lastSealMs;
+
+    bool ready;
+    portMUX_TYPE mux;
+    TaskHandle_t task;
+    SessionLogStats stats;
+
+    void append(const char* line, size_t length);
+    bool sealActive(bool partialOnly);
+    void writeSealed();
+    void rotate();
+    static void taskMain(void* arg);
+};
+
+#endif // SESSION_LOG_H
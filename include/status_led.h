@@ -0,0 +1,82 @@
+/**
+ * Status LED - Timer-driven blink pattern engine
+ *
+ * Platform: XIAO ESP32-S3
+ * Framework: Arduino
+ *
+ * The LED is stepped by a one-shot esp_timer that re-arms itself for the
+ * next step, so patterns keep their timing while loop() is blocked (e.g.
+ * in a BLE connect) and cost the loop nothing.
+ *
+ * A pattern is a constexpr list of steps, played `repeats` times and then
+ * followed by `pauseMs` off before starting over. A step with durationMs 0
+ * holds forever. Changing pattern is a single setPattern() call; setting
+ * the pattern already playing does nothing.
+ */
+
+#ifndef STATUS_LED_H
+#define STATUS_LED_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "config.h"
+
+// ============================================================================
+// Patterns
+// ============================================================================
+
+struct LedStep {
+    bool on;
+    uint16_t durationMs;  // 0 = hold
+};
+
+struct LedPattern {
+    const LedStep* steps;
+    uint8_t stepCount;
+    uint8_t repeats;      // Times through steps before the pause
+    uint16_t pauseMs;     // Off time after the repeats (0 = none)
+};
+
+constexpr LedStep LED_STEPS_OFF[]        = { {false, 0} };
+constexpr LedStep LED_STEPS_ON[]         = { {true, 0} };
+constexpr LedStep LED_STEPS_SCANNING[]   = { {true, 500}, {false, 500} };
+constexpr LedStep LED_STEPS_CONNECTING[] = { {true, 80}, {false, 80}, {true, 80}, {false, 560} };
+constexpr LedStep LED_STEPS_ERROR[]      = { {true, 150}, {false, 250} };
+
+constexpr LedPattern LED_PATTERN_OFF        = { LED_STEPS_OFF, 1, 1, 0 };
+constexpr LedPattern LED_PATTERN_SCANNING   = { LED_STEPS_SCANNING, 2, 1, 0 };
+constexpr LedPattern LED_PATTERN_CONNECTING = { LED_STEPS_CONNECTING, 4, 1, 0 };
+constexpr LedPattern LED_PATTERN_ACTIVE     = { LED_STEPS_ON, 1, 1, 0 };
+
+// Error: the error code in blinks, then a pause
+constexpr LedPattern ledErrorPattern(ErrorCode error) {
+    return LedPattern{ LED_STEPS_ERROR, 2, (uint8_t)error, 1200 };
+}
+
+// ============================================================================
+// Status LED Class
+// ============================================================================
+
+class StatusLed {
+public:
+    StatusLed();
+
+    void init(uint8_t pin);
+    void setPattern(const LedPattern& pattern);
+
+private:
+    uint8_t pin;
+    esp_timer_handle_t timer;
+    portMUX_TYPE mux;
+
+    LedPattern pattern;
+    uint8_t step;
+    uint8_t repeat;      // Completed passes through the steps
+    bool pausing;
+
+    uint32_t apply();    // Drive the LED for the current step, returns its duration
+    void advance();
+    static void timerCB(void* arg);
+};
+
+#endif // STATUS_LED_H
@@ -0,0 +1,84 @@
+/**
+ * Stick Drift - Online rest-position and noise estimation for the left stick
+ *
+ * Platform: XIAO ESP32-S3 (also builds on the host - no Arduino dependencies)
+ *
+ * Worn sticks do not return to zero, so a fixed deadzone has to be wide
+ * enough to hide the worst pad. This learns each axis's rest position and
+ * noise floor while the stick is left alone, then recenters it and picks
+ * the smallest deadzone that still covers the noise.
+ *
+ * A frame counts as "at rest" when both axes are near the current center,
+ * barely moved since the last frame, both triggers are released, and that
+ * has held for STICK_DRIFT_SETTLE_FRAMES frames (so a stick springing back
+ * is not sampled). Rest frames feed per-axis exponential averages:
+ * - center: the rest position
+ * - noise: mean |deviation| from the center
+ * - peak: largest |deviation|, slowly decaying
+ * and the deadzone is max(noise * STICK_DRIFT_NOISE_MULT, peak) plus a margin.
+ *
+ * All arithmetic is Q8 fixed point with shifts - a handful of integer
+ * operations per frame. The estimate is a plain struct so the caller can
+ * persist it per controller.
+ */
+
+#ifndef STICK_DRIFT_H
+#define STICK_DRIFT_H
+
+#include <stdint.h>
+#include "config.h"
+#include "control_mapper.h"
+#include "xbox_report.h"
+
+#define STICK_DRIFT_RECORD_VERSION 1
+
+// ============================================================================
+// Estimate
+// ============================================================================
+
+struct StickDriftAxis {
+    int32_t centerQ8;     // Rest position
+    uint32_t noiseQ8;     // Mean |deviation| at rest
+    uint32_t peakQ8;      // Largest |deviation| at rest, decaying
+};
+
+// Persisted as-is (NVS blob)
+struct StickDriftRecord {
+    uint8_t version;
+    uint32_t samples;     // Rest frames learned from
+    StickDriftAxis axes[STICK_AXIS_COUNT];
+};
+
+// ============================================================================
+// Stick Drift Estimator Class
+// ============================================================================
+
+class StickDriftEstimator {
+public:
+    StickDriftEstimator();
+
+    // Once per control frame, with the raw controller state
+    void update(const XboxControllerState& state);
+
+    // Center and deadzone per axis; not valid until enough rest frames
+    const StickCalibration& getCalibration() const;
+    bool isResting() const;
+    uint32_t getSamples() const;
+    uint16_t getNoise(StickAxis axis) const;   // Raw counts
+
+    const StickDriftRecord& getRecord() const;
+    bool load(const StickDriftRecord& record);  // False if the version differs
+    void reset();
+
+private:
+    StickDriftRecord record;
+    StickCalibration calibration;
+    int16_t previous[STICK_AXIS_COUNT];
+    uint16_t restFrames;                         // Consecutive, saturating
+
+    bool nearRest(int32_t value, int32_t last, StickAxis axis) const;
+    void learn(int32_t value, StickDriftAxis& axis);
+    void updateCalibration();
+};
+
+#endif // STICK_DRIFT_H
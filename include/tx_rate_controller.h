@@ -0,0 +1,89 @@
+/**
+ * TX Rate Controller - AIMD drive-frame rate for the hub link
+ *
+ * Platform: XIAO ESP32-S3 (also builds on the host - no Arduino dependencies)
+ *
+ * No fixed frame rate suits every hub, firmware and RF environment, so the
+ * drive-frame rate is found at runtime, TCP-style:
+ * - Additive increase: after each window of healthy writes, +increaseHz
+ * - Multiplicative decrease: on a failed write or a write that took longer
+ *   than latencyLimitUs, rate *= decreasePercent / 100
+ * Only one cut is taken per window so a single burst of trouble doesn't
+ * collapse the rate to the minimum. The rate stays within min/max.
+ *
+ * The controller is not thread-safe; the owner serializes.
+ */
+
+#ifndef TX_RATE_CONTROLLER_H
+#define TX_RATE_CONTROLLER_H
+
+#include <stdint.h>
+
+// ============================================================================
+// Policy and Statistics
+// ============================================================================
+
+struct AimdPolicy {
+    uint16_t minRateHz;
+    uint16_t maxRateHz;
+    uint16_t startRateHz;
+    uint16_t increaseHz;       // Added per healthy window
+    uint8_t decreasePercent;   // Rate kept on a cut (50 = halve)
+    uint16_t windowWrites;     // Writes per increase / between cuts
+    uint32_t latencyLimitUs;   // Slower writes count as congestion
+};
+
+enum class AimdDecision : uint8_t {
+    NONE = 0,
+    INCREASE,
+    CUT_FAILURE,
+    CUT_LATENCY
+};
+
+const char* aimdDecisionName(AimdDecision decision);
+
+struct AimdStats {
+    uint32_t increases;
+    uint32_t failureCuts;
+    uint32_t latencyCuts;
+    uint32_t writes;
+    uint32_t failures;
+    uint32_t slowWrites;
+    uint16_t lowestRateHz;     // Since resetStats()
+    uint16_t highestRateHz;
+    AimdDecision lastDecision;
+};
+
+// ============================================================================
+// TX Rate Controller Class
+// ============================================================================
+
+class TxRateController {
+public:
+    TxRateController(const AimdPolicy& policy);
+
+    // Back to the start rate (new connection)
+    void reset();
+
+    // Outcome of each rate-controlled write
+    void recordWrite(bool ok, uint32_t latencyUs);
+
+    uint16_t getRateHz() const;
+    uint32_t getIntervalMs() const;
+
+    const AimdStats& getStats() const;
+    void resetStats();
+
+private:
+    AimdPolicy policy;
+    AimdStats stats;
+
+    uint16_t rateHz;
+    uint16_t healthyWrites;   // Toward the next increase
+    uint16_t writesSinceCut;  // Cuts are held off for one window
+
+    void cut(AimdDecision reason);
+    void noteRate();
+};
+
+#endif // TX_RATE_CONTROLLER_H
@@ -0,0 +1,82 @@
+/**
+ * Xbox Controller - HID over GATT input link
+ *
+ * Platform: XIAO ESP32-S3
+ * Framework: Arduino
+ *
+ * This module handles the Xbox controller once it is connected:
+ * - HID service discovery and input report subscription
+ * - Report decoding into XboxControllerState (NimBLE task)
+ * - Battery level
+ * - Connection event phase, from report arrival times (ConnEventTracker)
+ *
+ * The NimBLE task is the only writer of the decoded state and publishes
+ * it through a seqlock, so the control loop, status output and display
+ * read it without locks and never hold up a report. reset() writes the
+ * neutral state itself, so it first stops the report path and waits out
+ * a report already being decoded; init() opens it again.
+ */
+
+#ifndef XBOX_CONTROLLER_H
+#define XBOX_CONTROLLER_H
+
+#include <NimBLEDevice.h>
+#include <atomic>
+#include "config.h"
+#include "conn_event_tracker.h"
+#include "seqlock.h"
+#include "xbox_report.h"
+
+// ============================================================================
+// Xbox Controller Class
+// ============================================================================
+
+class XboxController {
+public:
+    XboxController();
+
+    // Initialization (after the BLE connection is up). reset() publishes
+    // a neutral state and ignores reports until the next init().
+    bool init(NimBLEClient* client);
+    void reset();
+    bool isReady();
+
+    // Latest decoded input (lock-free, any task)
+    XboxControllerState getState();
+    uint8_t getBatteryLevel();
+    uint32_t getReportCount();
+    uint32_t getReadRetries();  // Reads that raced a report and were repeated
+
+    // Re-reads the battery over GATT (blocks - run it on the GATT queue)
+    bool refreshBatteryLevel();
+
+    // Connection events (call refreshConnInterval() from loop() now and then)
+    void refreshConnInterval();
+    ConnEventPhase getConnEventPhase();
+    ConnEventStats getConnEventStats();
+    void resetConnEventStats();
+
+    // Report handler (NimBLE task)
+    void handleReport(const uint8_t* data, size_t length);
+
+private:
+    NimBLEClient* bleClient;
+    bool subscribed;
+
+    XboxControllerState state;               // Writer's decode target
+    Seqlock<XboxPackedState> published;
+    std::atomic<uint8_t> batteryLevel;
+    uint32_t reportCount;
+    std::atomic<bool> accepting;             // Reports are decoded (init() .. reset())
+    std::atomic<uint8_t> reportsInFlight;    // handleReport() calls past the check
+
+    ConnEventTracker eventTracker;   // Guarded by eventMux
+    portMUX_TYPE eventMux;
+
+    void publish();
+    void decodeReport(const uint8_t* data, size_t length);
+    void readBatteryLevel();
+    static void reportCB(NimBLERemoteCharacteristic* pChar, uint8_t* data, size_t length, bool isNotify);
+};
+
+#endif // XBOX_CONTROLLER_H
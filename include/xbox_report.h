@@ -0,0 +1,97 @@
+/**
+ * Xbox Report - Controller state and HID input report decoding
+ *
+ * Platform: XIAO ESP32-S3 (also builds on the host - no Arduino dependencies)
+ *
+ * Input report layout of the Xbox Wireless Controller over BLE
+ * (model 1914, firmware 5.x), 16 bytes:
+ *   0-1   Left stick X   (uint16, 0..65535, center 32768)
+ *   2-3   Left stick Y   (uint16, 0 = up)
+ *   4-5   Right stick X
+ *   6-7   Right stick Y
+ *   8-9   Left trigger   (uint16, 0..1023)
+ *   10-11 Right trigger  (uint16, 0..1023)
+ *   12    D-pad hat      (0 = released, 1 = N, clockwise to 8 = NW)
+ *   13    A B - X Y - LB RB   (bit 0 = A)
+ *   14    - - View Menu Xbox LS RS -
+ *   15    Share (bit 0)
+ *
+ * Wired (USB) controllers speak GIP instead. Every message starts with a
+ * 4-byte header: command, flags, sequence, payload length. The input
+ * message (command 0x20) is:
+ *   4     - - Menu View A B X Y    (bit 2 = Menu)
+ *   5     Up Down Left Right LB RB LS RS   (bit 0 = Up)
+ *   6-7   Left trigger   (uint16, 0..1023)
+ *   8-9   Right trigger
+ *   10-11 Left stick X   (int16, Y positive = up)
+ *   12-13 Left stick Y
+ *   14-15 Right stick X
+ *   16-17 Right stick Y
+ * The Xbox button arrives separately as command 0x07, payload bit 0.
+ */
+
+#ifndef XBOX_REPORT_H
+#define XBOX_REPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================================
+// Controller State
+// ============================================================================
+
+struct XboxControllerState {
+    // D-pad and buttons
+    bool btn_a, btn_b, btn_x, btn_y;
+    bool btn_lb, btn_rb;
+    bool btn_ls, btn_rs;
+    bool btn_view, btn_menu, btn_xbox, btn_share;
+    bool dpad_up, dpad_down, dpad_left, dpad_right;
+
+    // Analog inputs (-32768 to 32767, Y positive = up)
+    int16_t left_stick_x, left_stick_y;
+    int16_t right_stick_x, right_stick_y;
+
+    // Triggers (0 to 1023)
+    uint16_t left_trigger, right_trigger;
+
+    // Battery
+    uint8_t battery_level;  // 0-100
+};
+
+// Packed form for lock-free publication (see seqlock.h), 16 bytes
+struct XboxPackedState {
+    uint16_t buttons;  // A B X Y LB RB LS RS View Menu Xbox Share Up Down Left Right (bit 0 = A)
+    int16_t left_stick_x, left_stick_y;
+    int16_t right_stick_x, right_stick_y;
+    uint16_t left_trigger, right_trigger;
+    uint8_t battery_level;
+    uint8_t reserved;
+};
+
+#define XBOX_BLE_REPORT_SIZE 16
+
+#define GIP_HEADER_SIZE       4
+#define GIP_CMD_VIRTUAL_KEY   0x07   // Xbox button
+#define GIP_CMD_INPUT         0x20
+#define GIP_INPUT_REPORT_SIZE 18
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+// Neutral state: sticks centered, nothing pressed
+void xboxResetState(XboxControllerState& state);
+
+void xboxPackState(const XboxControllerState& state, XboxPackedState& packed);
+void xboxUnpackState(const XboxPackedState& packed, XboxControllerState& state);
+
+// Decode a BLE HID input report; returns false (state untouched) if malformed.
+// The battery level is not part of the report and is preserved.
+bool xboxParseBleReport(const uint8_t* data, size_t length, XboxControllerState& state);
+
+// Decode a USB GIP message; returns true if it updated the state. Other
+// GIP messages (announce, status, ...) and malformed input return false.
+bool xboxParseGipReport(const uint8_t* data, size_t length, XboxControllerState& state);
+
+#endif // XBOX_REPORT_H
@@ -0,0 +1,84 @@
+/**
+ * Xbox USB - Wired Xbox controller input over USB host (GIP)
+ *
+ * Platform: XIAO ESP32-S3
+ * Framework: Arduino (ESP-IDF USB host library)
+ *
+ * Alternative to XboxController for XBOX_INPUT_USB builds. A wired pad
+ * has no radio latency and leaves the BLE radio to the Lego link alone.
+ * - USB host library and client tasks (input callbacks run there)
+ * - Claims the pad's GIP interface and sends the power-on message
+ * - Decodes GIP input into the same XboxControllerState as the BLE path
+ *
+ * Hot-plug is handled: the state is neutral while no pad is attached.
+ * The client task is the only writer and publishes through a seqlock,
+ * so readers never take a lock.
+ */
+
+#ifndef XBOX_USB_H
+#define XBOX_USB_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#if XBOX_INPUT_USB
+
+#include <usb/usb_host.h>
+#include "seqlock.h"
+#include "xbox_report.h"
+
+// ============================================================================
+// Xbox USB Controller Class
+// ============================================================================
+
+class XboxUsbController {
+public:
+    XboxUsbController();
+
+    // Installs the USB host stack and starts its tasks
+    bool init();
+    void reset();
+    bool isReady();
+
+    // Latest decoded input (neutral while unplugged, lock-free)
+    XboxControllerState getState();
+    uint8_t getBatteryLevel();
+    uint32_t getReportCount();
+    uint32_t getReadRetries();
+
+    // Report handler (USB client task)
+    void handleReport(const uint8_t* data, size_t length);
+
+private:
+    usb_host_client_handle_t clientHandle;
+    usb_device_handle_t deviceHandle;
+    usb_transfer_t* inTransfer;
+    usb_transfer_t* outTransfer;
+
+    uint8_t interfaceNumber;
+    uint8_t inEndpoint;
+    uint8_t outEndpoint;
+    uint16_t inPacketSize;
+    uint8_t sequence;
+    volatile bool ready;
+
+    XboxControllerState state;               // Client task's decode target
+    Seqlock<XboxPackedState> published;
+    uint32_t reportCount;
+
+    void openDevice(uint8_t address);
+    void closeDevice();
+    bool findGipInterface(const usb_config_desc_t* config);
+    bool sendPowerOn();
+    void publish();
+
+    static void hostTask(void* arg);
+    static void clientTask(void* arg);
+    static void clientEventCB(const usb_host_client_event_msg_t* msg, void* arg);
+    static void inTransferCB(usb_transfer_t* transfer);
+    static void outTransferCB(usb_transfer_t* transfer);
+};
+
+#endif // XBOX_INPUT_USB
+
+#endif // XBOX_USB_H
@@ -7,6 +7,16 @@
 // Global pointer for scan callbacks (NimBLE limitation)
 static BLEManager* g_bleManager = nullptr;
 
+// Sees every GAP event before the client callbacks (NimBLE host task)
+static ble_gap_event_listener g_gapListener;
+
+static const RetryPolicy CONNECT_RETRY_POLICY = {
+    1 + BLE_MAX_RETRIES,
+    BLE_RETRY_BASE_MS,
+    BLE_RETRY_MAX_MS,
+    BLE_RETRY_JITTER_PERCENT
+};
+
 // ============================================================================
 // BLEManager Implementation
 // ============================================================================
@@ -16,11 +26,31 @@ BLEManager::BLEManager()
     , legoClient(nullptr)
     , xboxState(BLEState::IDLE)
     , legoState(BLEState::IDLE)
+    , xboxRetry(CONNECT_RETRY_POLICY)
+    , legoRetry(CONNECT_RETRY_POLICY)
+    , xboxQueue("gatt_xbox")
+    , legoQueue("gatt_lego")
     , scanning(false)
+    , scanPaused(false)
+    , scanStartMs(0)
+    , scanDuration(0)
+    , standbyScanning(false)
+    , standbyPausedUntil(0)
+    , standbyPauseCount(0)
+    , advertCacheMux(portMUX_INITIALIZER_UNLOCKED)
+    , advertCallbacks(nullptr)
+    , xboxReleasedMs(0)
+    , legoReleasedMs(0)
+    , lastRssiSampleMs(0)
 {
     g_bleManager = this;
     resetDeviceInfo(xboxInfo);
     resetDeviceInfo(legoInfo);
+    resetDeviceInfo(knownXbox);
+    resetDeviceInfo(knownLego);
+    for (int i = 0; i < BLE_ADVERT_CACHE_SIZE; i++) {
+        advertCache[i].valid = false;
+    }
 }
 
 BLEManager::~BLEManager() {
@@ -37,6 +67,9 @@ void BLEManager::init() {
     // Set power level to maximum
     NimBLEDevice::setPower(ESP_PWR_LVL_P9);
 
+    // The Xbox controller only serves HID reports over a bonded, encrypted link
+    NimBLEDevice::setSecurityAuth(true, false, true);
+
     // Create clients
     xboxClient = NimBLEDevice::createClient();
     legoClient = NimBLEDevice::createClient();
@@ -48,10 +81,27 @@ void BLEManager::init() {
         return;
     }
 
+    // Short connect timeout - retries with backoff cover slow peers
+    uint8_t timeoutS = (BLE_CONN_TIMEOUT + 999) / 1000;
+    xboxClient->setConnectTimeout(timeoutS);
+    legoClient->setConnectTimeout(timeoutS);
+
+    // One GATT procedure at a time per connection, off the main loop
+    xboxConnect.client = xboxClient;
+    legoConnect.client = legoClient;
+    xboxQueue.init();
+    legoQueue.init();
+
     // Set up client callbacks for disconnect detection
     xboxClient->setClientCallbacks(new ClientCallbacks(this, true));
     legoClient->setClientCallbacks(new ClientCallbacks(this, false));
 
+    // onDisconnect() does not get the HCI reason, the GAP event has it
+    ble_gap_event_listener_register(&g_gapListener, gapEventCB, this);
+
+    // Shared by discovery and standby scans
+    advertCallbacks = new AdvertisedDeviceCallbacks(this);
+
     DEBUG_BLE_PRINTLN("[BLE] BLE Manager initialized successfully");
     DEBUG_BLE_PRINTF("[BLE] Device name: %s\n", BLE_DEVICE_NAME);
 }
@@ -62,25 +112,55 @@ void BLEManager::startScan(uint32_t duration) {
     DEBUG_BLE_PRINTF("[BLE]   - Xbox Controller: %s*\n", XBOX_CONTROLLER_NAME_PREFIX);
     DEBUG_BLE_PRINTF("[BLE]   - Lego Hub: %s\n", LEGO_HUB_NAME);
 
-    // Reset device info
-    resetDeviceInfo(xboxInfo);
-    resetDeviceInfo(legoInfo);
+    // A discovery scan replaces any standby scan
+    stopStandbyScan();
+
+    // Reset device info of peers that are not up, then reuse the last
+    // connected peer if it is known to be in range. A peer connected earlier
+    // in the pipeline, or with a connect in flight, stays.
+    if (!isXboxConnected() && xboxState != BLEState::CONNECTING) {
+        resetDeviceInfo(xboxInfo);
+        xboxRetry.reset();
+        if (seedFromAdvertCache(xboxInfo, true)) {
+            DEBUG_BLE_PRINTF("[BLE] Using cached Xbox advert (%s)\n", xboxInfo.address.toString().c_str());
+        }
+        xboxState = BLEState::SCANNING;
+    }
+    if (!isLegoConnected() && legoState != BLEState::CONNECTING) {
+        resetDeviceInfo(legoInfo);
+        legoRetry.reset();
+        if (seedFromAdvertCache(legoInfo, false)) {
+            DEBUG_BLE_PRINTF("[BLE] Using cached Lego advert (%s)\n", legoInfo.address.toString().c_str());
+        }
+        legoState = BLEState::SCANNING;
+    }
+    scanPaused = false;
 
-    // Get scan object
-    NimBLEScan* pScan = NimBLEDevice::getScan();
+    if (foundBothDevices()) {
+        // Nothing left to discover - connect straight from the cached adverts
+        DEBUG_BLE_PRINTLN("[BLE] Both devices seeded from advert cache, skipping scan");
+        scanning = false;
+        return;
+    }
 
-    // Set scan callbacks
-    pScan->setAdvertisedDeviceCallbacks(new AdvertisedDeviceCallbacks(this), true);
+    scanStartMs = millis();
+    scanDuration = duration;
 
-    // Configure scan parameters
-    pScan->setInterval(BLE_SCAN_INTERVAL);
-    pScan->setWindow(BLE_SCAN_WINDOW);
-    pScan->setActiveScan(true);  // Active scan uses more power but gets more info
+    if (isConnectInProgress()) {
+        // The stack cannot scan while it initiates - start when the connect
+        // finishes, like a paused scan
+        DEBUG_BLE_PRINTLN("[BLE] Connect in progress, scan starts after it");
+        scanning = false;
+        scanPaused = true;
+        return;
+    }
+
+    // Get scan object
+    NimBLEScan* pScan = NimBLEDevice::getScan();
+    configureScan(false);
 
     // Start scanning
     scanning = true;
-    xboxState = BLEState::SCANNING;
-    legoState = BLEState::SCANNING;
 
     // Start async scan (non-blocking)
     pScan->start(duration, scanCompleteCB, false);
@@ -89,6 +169,7 @@ void BLEManager::startScan(uint32_t duration) {
 }
 
 void BLEManager::stopScan() {
+    scanPaused = false;
     if (scanning) {
         DEBUG_BLE_PRINTLN("[BLE] Stopping scan...");
         NimBLEDevice::getScan()->stop();
@@ -105,7 +186,227 @@ void BLEManager::stopScan() {
 }
 
 bool BLEManager::isScanning() {
-    return scanning;
+    // A scan paused for a connect attempt resumes when the attempt finishes
+    return scanning || scanPaused;
+}
+
+unsigned long BLEManager::getScanStartMs() {
+    return scanStartMs;
+}
+
+void BLEManager::pauseScan() {
+    // Initiating a connection and scanning cannot overlap in the stack
+    if (scanning) {
+        scanPaused = true;
+        scanning = false;
+        NimBLEDevice::getScan()->stop();
+    }
+}
+
+void BLEManager::resumeScan() {
+    if (!scanPaused) {
+        return;
+    }
+    scanPaused = false;
+
+    if (foundBothDevices()) {
+        return;
+    }
+
+    // Keep looking for the other peer for what is left of the scan window
+    uint32_t elapsedS = (millis() - scanStartMs) / 1000;
+    if (elapsedS >= scanDuration) {
+        return;
+    }
+
+    configureScan(false);
+    scanning = true;
+    if (!NimBLEDevice::getScan()->start(scanDuration - elapsedS, scanCompleteCB, false)) {
+        scanning = false;
+        return;
+    }
+    DEBUG_BLE_PRINTLN("[BLE] Scan resumed for remaining device");
+}
+
+void BLEManager::updateStandbyScan() {
+#if BLE_STANDBY_SCAN_ENABLED
+    if (standbyScanning || scanning) {
+        return;
+    }
+    if ((long)(millis() - standbyPausedUntil) < 0) {
+        return;
+    }
+
+    configureScan(true);
+    standbyScanning = true;
+
+    // Duration 0 = scan until stopped
+    if (!NimBLEDevice::getScan()->start(0, standbyScanCompleteCB, false)) {
+        standbyScanning = false;
+        standbyPausedUntil = millis() + BLE_STANDBY_PAUSE_MS;
+        return;
+    }
+    DEBUG_BLE_PRINTLN("[BLE] Standby scan started (passive, low duty)");
+#endif
+}
+
+void BLEManager::reportControlLateness(unsigned long lateMs) {
+    if (lateMs < BLE_STANDBY_LATE_MS) {
+        return;
+    }
+
+    // Control loop is falling behind - give the radio and CPU back to it
+    standbyPausedUntil = millis() + BLE_STANDBY_PAUSE_MS;
+    if (standbyScanning) {
+        DEBUG_BLE_PRINTF("[BLE] Control update %lums late, pausing standby scan\n", lateMs);
+        standbyPauseCount++;
+        stopStandbyScan();
+    }
+}
+
+void BLEManager::stopStandbyScan() {
+    if (standbyScanning) {
+        standbyScanning = false;
+        NimBLEDevice::getScan()->stop();
+    }
+}
+
+bool BLEManager::isStandbyScanning() {
+    return standbyScanning;
+}
+
+uint32_t BLEManager::getStandbyPauseCount() {
+    return standbyPauseCount;
+}
+
+void BLEManager::cacheAdvert(const DeviceInfo& info, bool isXbox) {
+    unsigned long now = millis();
+
+    portENTER_CRITICAL(&advertCacheMux);
+
+    // Refresh an existing entry, otherwise take a free or the stalest slot
+    int slot = -1;
+    for (int i = 0; i < BLE_ADVERT_CACHE_SIZE; i++) {
+        if (advertCache[i].valid && advertCache[i].address == info.address) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        for (int i = 0; i < BLE_ADVERT_CACHE_SIZE; i++) {
+            if (!advertCache[i].valid) {
+                slot = i;
+                break;
+            }
+            if (slot < 0 || advertCache[i].lastSeenMs < advertCache[slot].lastSeenMs) {
+                slot = i;
+            }
+        }
+    }
+
+    AdvertCacheEntry& entry = advertCache[slot];
+    if (info.name.length() > 0 || !entry.valid || entry.address != info.address) {
+        // Passive adverts often carry no name - keep the one from the scan response
+        strncpy(entry.name, info.name.c_str(), sizeof(entry.name) - 1);
+        entry.name[sizeof(entry.name) - 1] = '\0';
+    }
+    entry.address = info.address;
+    entry.rssi = info.rssi;
+    entry.isXbox = isXbox;
+    entry.valid = true;
+    entry.lastSeenMs = now;
+
+    portEXIT_CRITICAL(&advertCacheMux);
+}
+
+bool BLEManager::isKnownAddress(const NimBLEAddress& address, bool* isXbox) {
+    bool known = false;
+
+    portENTER_CRITICAL(&advertCacheMux);
+    for (int i = 0; i < BLE_ADVERT_CACHE_SIZE; i++) {
+        if (advertCache[i].valid && advertCache[i].address == address) {
+            *isXbox = advertCache[i].isXbox;
+            known = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&advertCacheMux);
+
+    return known;
+}
+
+void BLEManager::forgetAdvert(const NimBLEAddress& address) {
+    portENTER_CRITICAL(&advertCacheMux);
+    for (int i = 0; i < BLE_ADVERT_CACHE_SIZE; i++) {
+        if (advertCache[i].valid && advertCache[i].address == address) {
+            advertCache[i].valid = false;
+        }
+    }
+    portEXIT_CRITICAL(&advertCacheMux);
+}
+
+bool BLEManager::hasCachedPeer() {
+    DeviceInfo scratch;
+    return (!isXboxConnected() && seedFromAdvertCache(scratch, true))
+        || (!isLegoConnected() && seedFromAdvertCache(scratch, false));
+}
+
+bool BLEManager::seedFromAdvertCache(DeviceInfo& info, bool isXbox) {
+    const DeviceInfo& known = isXbox ? knownXbox : knownLego;
+    unsigned long releasedMs = isXbox ? xboxReleasedMs : legoReleasedMs;
+    unsigned long now = millis();
+
+    // Only the peer this link was connected to - a scan picks anything new
+    if (!known.found) {
+        return false;
+    }
+
+    // A link we ended ourselves: the peer was in range a moment ago and
+    // advertises again (while connected it sent no adverts to cache)
+    bool fresh = releasedMs != 0 && now - releasedMs <= BLE_ADVERT_MAX_AGE_MS;
+    int rssi = known.rssi;
+
+    portENTER_CRITICAL(&advertCacheMux);
+    for (int i = 0; i < BLE_ADVERT_CACHE_SIZE; i++) {
+        const AdvertCacheEntry& entry = advertCache[i];
+        if (entry.valid && entry.address == known.address
+            && now - entry.lastSeenMs <= BLE_ADVERT_MAX_AGE_MS) {
+            fresh = true;
+            rssi = entry.rssi;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&advertCacheMux);
+
+    if (!fresh) {
+        return false;
+    }
+
+    info = known;
+    info.rssi = rssi;
+    info.foundMs = now;
+    return true;
+}
+
+void BLEManager::configureScan(bool standby) {
+    NimBLEScan* pScan = NimBLEDevice::getScan();
+
+    // Set scan callbacks
+    pScan->setAdvertisedDeviceCallbacks(advertCallbacks, true);
+
+    if (standby) {
+        // Passive and sparse: only refresh adverts we already know about
+        pScan->setInterval(BLE_STANDBY_SCAN_INTERVAL);
+        pScan->setWindow(BLE_STANDBY_SCAN_WINDOW);
+        pScan->setActiveScan(false);
+        pScan->setMaxResults(0);  // Results live in the advert cache only
+    } else {
+        // Configure scan parameters
+        pScan->setInterval(BLE_SCAN_INTERVAL);
+        pScan->setWindow(BLE_SCAN_WINDOW);
+        pScan->setActiveScan(true);  // Active scan uses more power but gets more info
+        pScan->setMaxResults(0xFF);
+    }
 }
 
 DeviceInfo BLEManager::getXboxInfo() {
@@ -125,58 +426,180 @@ bool BLEManager::foundLego() {
 }
 
 bool BLEManager::foundBothDevices() {
+#if XBOX_INPUT_USB
+    // The controller is wired - only the hub is discovered over BLE
+    return legoInfo.found;
+#else
     return xboxInfo.found && legoInfo.found;
+#endif
 }
 
-bool BLEManager::connectToXbox() {
+bool BLEManager::startXboxConnect(GattFuture* future) {
     if (!xboxInfo.found) {
         DEBUG_BLE_PRINTLN("[BLE] ERROR: Cannot connect to Xbox - device not found");
         return false;
     }
+    if (isConnectInProgress()) {
+        return false;
+    }
 
     DEBUG_BLE_PRINTF("[BLE] Connecting to Xbox controller at %s...\n",
                      xboxInfo.address.toString().c_str());
 
+    // Scanning for the other peer resumes in finishXboxConnect()
+    pauseScan();
+    xboxConnect.address = xboxInfo.address;
+    GattOp op = { "connect", connectOp, &xboxConnect, GattPriority::URGENT,
+                  GATT_CONNECT_WAIT_MS, future, nullptr };
+    if (!xboxQueue.submit(op)) {
+        resumeScan();
+        return false;
+    }
+
     xboxState = BLEState::CONNECTING;
+    if (xboxRetry.getAttempt() > 0) {
+        linkStatsRecordRetry(LinkId::XBOX);
+    }
+    return true;
+}
+
+bool BLEManager::finishXboxConnect(const GattFuture& future) {
+    resumeScan();
 
-    // Attempt connection
-    if (xboxClient->connect(xboxInfo.address)) {
+    if (future.get() == GattOpStatus::OK) {
         DEBUG_BLE_PRINTLN("[BLE] Connected to Xbox controller!");
+        xboxRetry.recordSuccess();
         xboxState = BLEState::CONNECTED;
+        knownXbox = xboxInfo;
+        xboxReleasedMs = 0;
         return true;
     } else {
-        DEBUG_BLE_PRINTLN("[BLE] ERROR: Failed to connect to Xbox controller");
-        xboxState = BLEState::ERROR;
+        DEBUG_BLE_PRINTF("[BLE] ERROR: Failed to connect to Xbox controller (%s)\n",
+                         gattOpStatusName(future.get()));
+        handleConnectFailure(xboxInfo, xboxState, xboxRetry, LinkId::XBOX);
         return false;
     }
 }
 
-bool BLEManager::connectToLego() {
+bool BLEManager::startLegoConnect(GattFuture* future) {
     if (!legoInfo.found) {
         DEBUG_BLE_PRINTLN("[BLE] ERROR: Cannot connect to Lego hub - device not found");
         return false;
     }
+    if (isConnectInProgress()) {
+        return false;
+    }
 
     DEBUG_BLE_PRINTF("[BLE] Connecting to Lego hub at %s...\n",
                      legoInfo.address.toString().c_str());
 
+    // Scanning for the other peer resumes in finishLegoConnect()
+    pauseScan();
+    legoConnect.address = legoInfo.address;
+    GattOp op = { "connect", connectOp, &legoConnect, GattPriority::URGENT,
+                  GATT_CONNECT_WAIT_MS, future, nullptr };
+    if (!legoQueue.submit(op)) {
+        resumeScan();
+        return false;
+    }
+
     legoState = BLEState::CONNECTING;
+    if (legoRetry.getAttempt() > 0) {
+        linkStatsRecordRetry(LinkId::LEGO);
+    }
+    return true;
+}
 
-    // Attempt connection
-    if (legoClient->connect(legoInfo.address)) {
+bool BLEManager::finishLegoConnect(const GattFuture& future) {
+    resumeScan();
+
+    if (future.get() == GattOpStatus::OK) {
         DEBUG_BLE_PRINTLN("[BLE] Connected to Lego hub!");
+        legoRetry.recordSuccess();
         legoState = BLEState::CONNECTED;
+        knownLego = legoInfo;
+        legoReleasedMs = 0;
         return true;
     } else {
-        DEBUG_BLE_PRINTLN("[BLE] ERROR: Failed to connect to Lego hub");
-        legoState = BLEState::ERROR;
+        DEBUG_BLE_PRINTF("[BLE] ERROR: Failed to connect to Lego hub (%s)\n",
+                         gattOpStatusName(future.get()));
+        handleConnectFailure(legoInfo, legoState, legoRetry, LinkId::LEGO);
         return false;
     }
 }
 
+bool BLEManager::isConnectInProgress() {
+    return xboxState == BLEState::CONNECTING || legoState == BLEState::CONNECTING;
+}
+
+bool BLEManager::connectOp(void* context) {
+    ConnectRequest* request = static_cast<ConnectRequest*>(context);
+    if (request->client->isConnected()) {
+        return true;  // A connect that outlived a reset - reuse the link
+    }
+    return request->client->connect(request->address);
+}
+
+bool BLEManager::isXboxRetryDue() {
+    return xboxInfo.found && xboxRetry.isDue(millis());
+}
+
+bool BLEManager::isLegoRetryDue() {
+    return legoInfo.found && legoRetry.isDue(millis());
+}
+
+void BLEManager::abortXboxConnection() {
+    // Connected but unusable (e.g. discovery failed) - counts as a failed attempt
+    if (xboxClient && xboxClient->isConnected()) {
+        xboxClient->disconnect();
+    }
+    handleConnectFailure(xboxInfo, xboxState, xboxRetry, LinkId::XBOX);
+}
+
+void BLEManager::abortLegoConnection() {
+    if (legoClient && legoClient->isConnected()) {
+        legoClient->disconnect();
+    }
+    handleConnectFailure(legoInfo, legoState, legoRetry, LinkId::LEGO);
+}
+
+const ConnectRetry& BLEManager::getXboxRetry() {
+    return xboxRetry;
+}
+
+const ConnectRetry& BLEManager::getLegoRetry() {
+    return legoRetry;
+}
+
+void BLEManager::resetRetryStats() {
+    xboxRetry.resetStats();
+    legoRetry.resetStats();
+}
+
+void BLEManager::handleConnectFailure(DeviceInfo& info, BLEState& state, ConnectRetry& retry, LinkId link) {
+    retry.recordFailure(millis(), esp_random());
+
+    if (retry.isExhausted()) {
+        // Give up on this address; the next scan looks for the device again
+        DEBUG_BLE_PRINTF("[BLE] %s: %u attempts failed, dropping device for rescan\n",
+                         linkName(link), retry.getAttempt());
+        forgetAdvert(info.address);
+        resetDeviceInfo(info);
+        state = BLEState::IDLE;
+        return;
+    }
+
+    DEBUG_BLE_PRINTF("[BLE] %s: attempt %u failed, retrying in %lu ms\n",
+                     linkName(link), retry.getAttempt(), (unsigned long)retry.getNextDelayMs());
+    state = BLEState::DISCONNECTED;
+}
+
 void BLEManager::disconnectXbox() {
     if (xboxClient && xboxClient->isConnected()) {
         DEBUG_BLE_PRINTLN("[BLE] Disconnecting from Xbox controller...");
+        if (xboxState == BLEState::CONNECTED) {
+            xboxReleasedMs = millis();  // Still in range - see seedFromAdvertCache()
+        }
         xboxClient->disconnect();
         xboxState = BLEState::DISCONNECTED;
     }
@@ -185,6 +608,9 @@ void BLEManager::disconnectXbox() {
 void BLEManager::disconnectLego() {
     if (legoClient && legoClient->isConnected()) {
         DEBUG_BLE_PRINTLN("[BLE] Disconnecting from Lego hub...");
+        if (legoState == BLEState::CONNECTED) {
+            legoReleasedMs = millis();
+        }
         legoClient->disconnect();
         legoState = BLEState::DISCONNECTED;
     }
@@ -212,7 +638,36 @@ bool BLEManager::isLegoConnected() {
 }
 
 bool BLEManager::areBothConnected() {
+#if XBOX_INPUT_USB
+    return isLegoConnected();
+#else
     return isXboxConnected() && isLegoConnected();
+#endif
+}
+
+void BLEManager::updateLinkStats() {
+    unsigned long now = millis();
+    if (now - lastRssiSampleMs < LINK_RSSI_SAMPLE_PERIOD_MS) {
+        return;
+    }
+    lastRssiSampleMs = now;
+
+    if (isXboxConnected()) {
+        linkStatsRecordRssi(LinkId::XBOX, xboxClient->getRssi());
+    }
+    if (isLegoConnected()) {
+        linkStatsRecordRssi(LinkId::LEGO, legoClient->getRssi());
+    }
+}
+
+void BLEManager::requestConnIntervals(uint16_t xboxInterval, uint16_t legoInterval) {
+    // Min = max, so the controller has no room to pick something else
+    if (isXboxConnected()) {
+        xboxClient->updateConnParams(xboxInterval, xboxInterval, 0, CONN_PLAN_TIMEOUT);
+    }
+    if (isLegoConnected()) {
+        legoClient->updateConnParams(legoInterval, legoInterval, 0, CONN_PLAN_TIMEOUT);
+    }
 }
 
 NimBLEClient* BLEManager::getXboxClient() {
@@ -223,6 +678,14 @@ NimBLEClient* BLEManager::getLegoClient() {
     return legoClient;
 }
 
+GattQueue& BLEManager::getXboxQueue() {
+    return xboxQueue;
+}
+
+GattQueue& BLEManager::getLegoQueue() {
+    return legoQueue;
+}
+
 void BLEManager::setXboxInfo(const DeviceInfo& info) {
     xboxInfo = info;
 }
@@ -244,16 +707,20 @@ void BLEManager::handleLegoDisconnect() {
 void BLEManager::resetForReconnection() {
     DEBUG_BLE_PRINTLN("[BLE] Resetting for reconnection...");
 
-    // Disconnect both devices if connected
+    // Drop queued procedures for the old links, then disconnect
+    xboxQueue.cancelAll();
+    legoQueue.cancelAll();
     disconnectAll();
 
-    // Reset device info
+    // Reset device info (the advert cache is kept for a fast restart)
     resetDeviceInfo(xboxInfo);
     resetDeviceInfo(legoInfo);
 
     // Reset states
     xboxState = BLEState::IDLE;
     legoState = BLEState::IDLE;
+    xboxRetry.reset();
+    legoRetry.reset();
 
     DEBUG_BLE_PRINTLN("[BLE] Reset complete, ready to scan");
 }
@@ -263,11 +730,15 @@ void BLEManager::resetDeviceInfo(DeviceInfo& info) {
     info.address = NimBLEAddress("");
     info.rssi = 0;
     info.found = false;
+    info.foundMs = 0;
 }
 
 void BLEManager::scanCompleteCB(NimBLEScanResults results) {
     if (g_bleManager) {
         g_bleManager->scanning = false;
+        if (g_bleManager->scanPaused) {
+            return;  // Paused for a connection attempt, not finished
+        }
         DEBUG_BLE_PRINTLN("[BLE] Scan complete");
         DEBUG_BLE_PRINTF("[BLE] Found %d devices\n", results.getCount());
         DEBUG_BLE_PRINTF("[BLE] Xbox found: %s\n", g_bleManager->foundXbox() ? "YES" : "NO");
@@ -275,6 +746,31 @@ void BLEManager::scanCompleteCB(NimBLEScanResults results) {
     }
 }
 
+int BLEManager::gapEventCB(struct ble_gap_event* event, void* arg) {
+    if (event->type != BLE_GAP_EVENT_DISCONNECT) {
+        return 0;
+    }
+
+    // Listeners run before the client's own handler, so the clients still
+    // hold the connection handle
+    BLEManager* manager = static_cast<BLEManager*>(arg);
+    uint16_t handle = event->disconnect.conn.conn_handle;
+    if (manager->xboxClient && manager->xboxClient->getConnId() == handle) {
+        linkStatsRecordDisconnect(LinkId::XBOX, event->disconnect.reason);
+    } else if (manager->legoClient && manager->legoClient->getConnId() == handle) {
+        linkStatsRecordDisconnect(LinkId::LEGO, event->disconnect.reason);
+    }
+    return 0;
+}
+
+void BLEManager::standbyScanCompleteCB(NimBLEScanResults results) {
+    if (g_bleManager) {
+        // Stopped by load, by a discovery scan or by a connection attempt;
+        // updateStandbyScan() restarts it while ACTIVE
+        g_bleManager->standbyScanning = false;
+    }
+}
+
 // ============================================================================
 // AdvertisedDeviceCallbacks Implementation
 // ============================================================================
@@ -290,46 +786,53 @@ void AdvertisedDeviceCallbacks::onResult(NimBLEAdvertisedDevice* advertisedDevic
     int rssi = advertisedDevice->getRSSI();
 
     // Only log devices we're interested in (Xbox or Lego)
-    bool isXbox = deviceName.startsWith(XBOX_CONTROLLER_NAME_PREFIX);
+    bool isXbox = !XBOX_INPUT_USB && deviceName.startsWith(XBOX_CONTROLLER_NAME_PREFIX);
     bool isLego = deviceName.indexOf(LEGO_HUB_NAME) >= 0;
 
-    if (isXbox || isLego) {
-        DEBUG_BLE_PRINTF("[BLE] Found device: %s (%s) RSSI: %d\n",
-                         deviceName.c_str(),
-                         deviceAddress.toString().c_str(),
-                         rssi);
+    // Passive (standby) adverts usually lack the name - match known addresses
+    bool knownIsXbox = false;
+    if (!isXbox && !isLego && bleManager->isKnownAddress(deviceAddress, &knownIsXbox)) {
+        isXbox = knownIsXbox;
+        isLego = !knownIsXbox;
+    }
+
+    if (!isXbox && !isLego) {
+        return;
+    }
+
+    DeviceInfo info;
+    info.name = deviceName;
+    info.address = deviceAddress;
+    info.rssi = rssi;
+    info.found = true;
+    info.foundMs = millis();
+
+    // Keep the advert cache fresh for reconnects, current peers and spares alike
+    bleManager->cacheAdvert(info, isXbox);
+
+    if (bleManager->isStandbyScanning()) {
+        return;
     }
 
+    DEBUG_BLE_PRINTF("[BLE] Found device: %s (%s) RSSI: %d\n",
+                     deviceName.c_str(),
+                     deviceAddress.toString().c_str(),
+                     rssi);
+
     // Check if this is an Xbox controller
     if (!bleManager->foundXbox() && isXbox) {
         DEBUG_BLE_PRINTLN("[BLE] *** FOUND XBOX CONTROLLER! ***");
-        DeviceInfo info;
-        info.name = deviceName;
-        info.address = deviceAddress;
-        info.rssi = rssi;
-        info.found = true;
-
-        if (bleManager) {
-            bleManager->setXboxInfo(info);
-        }
+        bleManager->setXboxInfo(info);
     }
 
     // Check if this is a Lego hub
     if (!bleManager->foundLego() && isLego) {
         DEBUG_BLE_PRINTLN("[BLE] *** FOUND LEGO HUB! ***");
-        DeviceInfo info;
-        info.name = deviceName;
-        info.address = deviceAddress;
-        info.rssi = rssi;
-        info.found = true;
-
-        if (bleManager) {
-            bleManager->setLegoInfo(info);
-        }
+        bleManager->setLegoInfo(info);
     }
 
     // Stop scan if both devices are found
-    if (bleManager && bleManager->foundBothDevices()) {
+    if (bleManager->foundBothDevices()) {
         DEBUG_BLE_PRINTLN("[BLE] Both devices found! Stopping scan...");
         NimBLEDevice::getScan()->stop();
     }
@@ -348,12 +851,25 @@ ClientCallbacks::ClientCallbacks(BLEManager* manager, bool isXbox)
 void ClientCallbacks::onConnect(NimBLEClient* pClient) {
     const char* deviceType = isXboxController ? "Xbox controller" : "Lego hub";
     DEBUG_BLE_PRINTF("[BLE] %s connected (callback)\n", deviceType);
+
+    uint8_t txPhy = 0;
+    uint8_t rxPhy = 0;
+    if (ble_gap_read_le_phy(pClient->getConnId(), &txPhy, &rxPhy) == 0) {
+        linkStatsRecordPhy(isXboxController ? LinkId::XBOX : LinkId::LEGO, txPhy, rxPhy);
+    }
+}
+
+bool ClientCallbacks::onConnParamsUpdateRequest(NimBLEClient* pClient, const ble_gap_upd_params* params) {
+    linkStatsRecordConnParamUpdate(isXboxController ? LinkId::XBOX : LinkId::LEGO);
+    return true;  // Accept the peer's parameters
 }
 
 void ClientCallbacks::onDisconnect(NimBLEClient* pClient) {
     const char* deviceType = isXboxController ? "Xbox controller" : "Lego hub";
     DEBUG_BLE_PRINTF("[BLE] %s disconnected (callback)\n", deviceType);
 
+    // The link stats get the reason from the GAP event (gapEventCB())
+
     if (bleManager) {
         if (isXboxController) {
             bleManager->handleXboxDisconnect();
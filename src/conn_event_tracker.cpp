@@ -0,0 +1,136 @@
+/**
+ * Connection Event Tracker Implementation
+ */
+
+#include <string.h>
+#include "conn_event_tracker.h"
+
+#define OUTLIER_RESTART_RUN 3   // Consecutive outliers that mean the events moved
+
+// ============================================================================
+// ConnEventTracker Implementation
+// ============================================================================
+
+ConnEventTracker::ConnEventTracker()
+    : intervalUs(0)
+{
+    reset();
+    resetStats();
+}
+
+void ConnEventTracker::reset() {
+    anchorUs = 0;
+    lastObservedUs = 0;
+    samples = 0;
+    lastGapUs = 0;
+    outlierRun = 0;
+    stats.jitterUs = 0;
+}
+
+void ConnEventTracker::setInterval(uint32_t newIntervalUs) {
+    if (newIntervalUs != intervalUs) {
+        intervalUs = newIntervalUs;
+        reset();
+    }
+}
+
+uint32_t ConnEventTracker::getIntervalUs() const {
+    return intervalUs;
+}
+
+void HOT_PATH ConnEventTracker::observe(uint32_t eventUs) {
+    if (intervalUs == 0) {
+        return;
+    }
+    stats.observations++;
+
+    if (samples == 0) {
+        restart(eventUs);
+        return;
+    }
+
+    // Distance to the nearest predicted event
+    int32_t sinceAnchor = (int32_t)(eventUs - anchorUs);
+    int32_t phase = sinceAnchor % (int32_t)intervalUs;
+    if (phase < 0) {
+        phase += intervalUs;
+    }
+    int32_t error = phase < (int32_t)(intervalUs / 2) ? phase : phase - (int32_t)intervalUs;
+    uint32_t absError = error < 0 ? -error : error;
+
+    if (absError > intervalUs / 4) {
+        stats.outliers++;
+        if (++outlierRun >= OUTLIER_RESTART_RUN) {
+            stats.restarts++;
+            restart(eventUs);
+        }
+        return;
+    }
+    outlierRun = 0;
+
+    // Several observations in one event don't make a gap
+    uint32_t gapUs = eventUs - lastObservedUs;
+    if (gapUs >= intervalUs / 2) {
+        bool streaming = lastGapUs != 0 && lastGapUs < intervalUs + intervalUs / 2;
+        if (streaming && gapUs >= intervalUs + intervalUs / 2 && gapUs < 2 * intervalUs + intervalUs / 2) {
+            stats.skipped++;
+        }
+        lastGapUs = gapUs;
+    }
+
+    anchorUs = eventUs - error + error / 4;
+    lastObservedUs = eventUs;
+    samples++;
+    stats.jitterUs += ((int32_t)absError - (int32_t)stats.jitterUs) / 8;
+}
+
+bool HOT_PATH ConnEventTracker::isLocked(uint32_t nowUs) const {
+    return intervalUs != 0
+        && samples >= CONN_EVENT_LOCK_SAMPLES
+        && stats.jitterUs <= intervalUs / 8
+        && nowUs - lastObservedUs < CONN_EVENT_STALE_MS * 1000UL;
+}
+
+uint32_t HOT_PATH ConnEventTracker::nextEventUs(uint32_t nowUs) const {
+    if (intervalUs == 0) {
+        return nowUs;
+    }
+
+    int32_t sinceAnchor = (int32_t)(nowUs - anchorUs);
+    if (sinceAnchor <= 0) {
+        // Observed after nowUs was read (another task) - step back from it
+        return anchorUs - ((uint32_t)-sinceAnchor / intervalUs) * intervalUs;
+    }
+    uint32_t elapsed = (uint32_t)sinceAnchor;
+    uint32_t intoInterval = elapsed % intervalUs;
+    return intoInterval == 0 ? nowUs : nowUs + (intervalUs - intoInterval);
+}
+
+ConnEventPhase ConnEventTracker::getPhase(uint32_t nowUs) const {
+    ConnEventPhase phase;
+    phase.locked = isLocked(nowUs);
+    phase.intervalUs = intervalUs;
+    phase.nextEventUs = nextEventUs(nowUs);
+    phase.skipped = stats.skipped;
+    return phase;
+}
+
+const ConnEventStats& ConnEventTracker::getStats() const {
+    return stats;
+}
+
+void ConnEventTracker::resetStats() {
+    uint32_t jitterUs = stats.jitterUs;
+    memset(&stats, 0, sizeof(stats));
+    stats.jitterUs = jitterUs;  // Part of the estimate, not a counter
+}
+
+void ConnEventTracker::restart(uint32_t eventUs) {
+    anchorUs = eventUs;
+    lastObservedUs = eventUs;
+    samples = 1;
+    lastGapUs = 0;
+    outlierRun = 0;
+    // Start pessimistic so a lock needs several consistent observations
+    stats.jitterUs = intervalUs / 4;
+}
@@ -0,0 +1,130 @@
+/**
+ * Connection Planner Implementation
+ */
+
+#include <string.h>
+#include "conn_planner.h"
+
+const char* connPlanVerdictName(ConnPlanVerdict verdict) {
+    switch (verdict) {
+        case ConnPlanVerdict::WAITING:   return "waiting";
+        case ConnPlanVerdict::CLEAR:     return "clear";
+        case ConnPlanVerdict::COLLIDING: return "colliding";
+        default:                         return "?";
+    }
+}
+
+// ============================================================================
+// ConnPlanner Implementation
+// ============================================================================
+
+ConnPlanner::ConnPlanner() {
+    reset();
+    resetStats();
+}
+
+void ConnPlanner::reset() {
+    planIndex = 0;
+    requested = false;
+    requestedMs = 0;
+    badChecks = 0;
+    lastSkipped[0] = 0;
+    lastSkipped[1] = 0;
+    verdict = ConnPlanVerdict::WAITING;
+}
+
+bool ConnPlanner::check(const ConnEventPhase& xbox, const ConnEventPhase& lego, uint32_t nowMs) {
+    if (!requested) {
+        return true;
+    }
+
+    uint32_t skipped = (xbox.skipped - lastSkipped[0]) + (lego.skipped - lastSkipped[1]);
+    lastSkipped[0] = xbox.skipped;
+    lastSkipped[1] = lego.skipped;
+
+    // Give the update time to apply and both trackers time to lock again
+    if (nowMs - requestedMs < CONN_PLAN_SETTLE_MS || !xbox.locked || !lego.locked) {
+        verdict = ConnPlanVerdict::WAITING;
+        return false;
+    }
+    stats.checks++;
+
+    // The peer may have asked for something else since (and we accept)
+    ConnPlan plan = getPlan();
+    if (xbox.intervalUs != plan.xboxInterval * 1250UL || lego.intervalUs != plan.legoInterval * 1250UL) {
+        stats.mismatches++;
+    }
+
+    uint32_t separation = separationUs(xbox, lego);
+    stats.separationUs = separation;
+    if (separation < stats.minSeparationUs) {
+        stats.minSeparationUs = separation;
+    }
+
+    bool overlap = separation < CONN_PLAN_GUARD_US;
+    bool skipping = skipped >= CONN_PLAN_SKIP_LIMIT;
+    if (overlap) {
+        stats.overlaps++;
+    }
+    if (skipping) {
+        stats.skipBursts++;
+    }
+    if (!overlap && !skipping) {
+        badChecks = 0;
+        verdict = ConnPlanVerdict::CLEAR;
+        return false;
+    }
+
+    verdict = ConnPlanVerdict::COLLIDING;
+    if (++badChecks < CONN_PLAN_BAD_CHECKS) {
+        return false;
+    }
+    badChecks = 0;
+    planIndex = (planIndex + 1) % CONN_PLAN_COUNT;
+    stats.replans++;
+    return true;
+}
+
+void ConnPlanner::planRequested(uint32_t nowMs) {
+    requested = true;
+    requestedMs = nowMs;
+    verdict = ConnPlanVerdict::WAITING;
+}
+
+ConnPlan ConnPlanner::getPlan() const {
+    ConnPlan plan;
+    plan.xboxInterval = CONN_PLANS[planIndex][0];
+    plan.legoInterval = CONN_PLANS[planIndex][1];
+    return plan;
+}
+
+uint8_t ConnPlanner::getPlanIndex() const {
+    return planIndex;
+}
+
+ConnPlanVerdict ConnPlanner::getVerdict() const {
+    return verdict;
+}
+
+const ConnPlanStats& ConnPlanner::getStats() const {
+    return stats;
+}
+
+void ConnPlanner::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+    stats.minSeparationUs = UINT32_MAX;
+}
+
+uint32_t ConnPlanner::separationUs(const ConnEventPhase& a, const ConnEventPhase& b) {
+    uint32_t shorter = a.intervalUs < b.intervalUs ? a.intervalUs : b.intervalUs;
+    if (shorter == 0) {
+        return 0;
+    }
+
+    int32_t offset = (int32_t)(b.nextEventUs - a.nextEventUs) % (int32_t)shorter;
+    if (offset < 0) {
+        offset += shorter;
+    }
+    uint32_t distance = (uint32_t)offset;
+    return distance < shorter - distance ? distance : shorter - distance;
+}
@@ -0,0 +1,92 @@
+/**
+ * Connect Retry Implementation
+ */
+
+#include <string.h>
+#include "connect_retry.h"
+
+// ============================================================================
+// ConnectRetry Implementation
+// ============================================================================
+
+ConnectRetry::ConnectRetry(const RetryPolicy& policy)
+    : policy(policy)
+{
+    reset();
+    resetStats();
+}
+
+void ConnectRetry::reset() {
+    attempt = 0;
+    nextAttemptMs = 0;
+    nextDelayMs = 0;
+}
+
+bool ConnectRetry::isDue(uint32_t nowMs) const {
+    if (isExhausted()) {
+        return false;
+    }
+    return attempt == 0 || (int32_t)(nowMs - nextAttemptMs) >= 0;
+}
+
+bool ConnectRetry::isExhausted() const {
+    return attempt >= policy.maxAttempts;
+}
+
+uint8_t ConnectRetry::getAttempt() const {
+    return attempt;
+}
+
+void ConnectRetry::recordSuccess() {
+    stats.attempts++;
+    stats.successes++;
+    attempt++;
+    if (attempt > stats.maxAttemptsUsed) {
+        stats.maxAttemptsUsed = attempt;
+    }
+    reset();
+}
+
+void ConnectRetry::recordFailure(uint32_t nowMs, uint32_t random) {
+    stats.attempts++;
+    attempt++;
+
+    if (isExhausted()) {
+        stats.exhausted++;
+        return;
+    }
+
+    // Exponential backoff: base, 2x, 4x ... capped
+    uint32_t delayMs = policy.baseDelayMs;
+    for (uint8_t i = 1; i < attempt && delayMs < policy.maxDelayMs; i++) {
+        delayMs *= 2;
+    }
+    if (delayMs > policy.maxDelayMs) {
+        delayMs = policy.maxDelayMs;
+    }
+
+    // Jitter uniformly within +/- jitterPercent
+    uint32_t span = 2 * (uint32_t)policy.jitterPercent + 1;
+    uint32_t percent = 100 - policy.jitterPercent + (random % span);
+    nextDelayMs = delayMs * percent / 100;
+    nextAttemptMs = nowMs + nextDelayMs;
+}
+
+uint32_t ConnectRetry::getNextDelayMs() const {
+    return nextDelayMs;
+}
+
+const RetryStats& ConnectRetry::getStats() const {
+    return stats;
+}
+
+uint32_t ConnectRetry::getAttemptsPerSuccessX100() const {
+    if (stats.successes == 0) {
+        return 0;
+    }
+    return stats.attempts * 100 / stats.successes;
+}
+
+void ConnectRetry::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+}
@@ -0,0 +1,116 @@
+/**
+ * Control Mapper Implementation
+ */
+
+#include "control_mapper.h"
+
+// Light modes cycled by the B button
+static const uint8_t LIGHT_MODES[] HOT_DATA = {
+    LEGO_LIGHTS_BOTH,
+    LEGO_LIGHTS_BRAKE,
+    LEGO_LIGHTS_REAR_ONLY
+};
+#define LIGHT_MODE_COUNT (sizeof(LIGHT_MODES) / sizeof(LIGHT_MODES[0]))
+
+// ============================================================================
+// ControlMapper Implementation
+// ============================================================================
+
+ControlMapper::ControlMapper(ControlSettings settings)
+    : settings(settings)
+    , lightsOn(true)
+    , lightMode(0)
+{
+    stickCalibration.valid = false;
+    xboxResetState(previous);
+}
+
+MappedControls HOT_PATH ControlMapper::map(const XboxControllerState& xboxState) {
+    MappedControls controls;
+
+    // Speed
+    int8_t speed;
+    if (settings.triggerAcceleration) {
+        int32_t throttle = (int32_t)xboxState.right_trigger - (int32_t)xboxState.left_trigger;
+        speed = applyDeadzone(throttle, XBOX_TRIGGER_MAX);
+    } else {
+        speed = applyStickDeadzone(xboxState.left_stick_y, STICK_AXIS_Y);
+    }
+    controls.speed = applySpeedLimit(speed);
+
+    // Steering
+    int8_t steering = applyStickDeadzone(xboxState.left_stick_x, STICK_AXIS_X);
+    controls.steering = settings.invertSteering ? (int8_t)-steering : steering;
+
+    // Lights and emergency stop
+    controls.emergencyStop = xboxState.btn_b && xboxState.btn_x;
+    controls.lights = updateLights(xboxState);
+
+    previous = xboxState;
+    return controls;
+}
+
+void ControlMapper::updateSettings(ControlSettings newSettings) {
+    settings = newSettings;
+}
+
+ControlSettings ControlMapper::getSettings() const {
+    return settings;
+}
+
+void ControlMapper::setStickCalibration(const StickCalibration& calibration) {
+    stickCalibration = calibration;
+}
+
+int8_t HOT_PATH ControlMapper::applyDeadzone(int32_t value, int32_t fullScale) const {
+    return scaleOutside(value, fullScale * settings.deadzonePercent / 100, fullScale);
+}
+
+int8_t HOT_PATH ControlMapper::applyStickDeadzone(int32_t value, StickAxis axis) const {
+    if (!stickCalibration.valid) {
+        return applyDeadzone(value, XBOX_STICK_MAX);
+    }
+    // Scale each side separately so full deflection still reaches 100%
+    int32_t center = stickCalibration.center[axis];
+    int32_t offset = value - center;
+    int32_t range = offset > 0 ? XBOX_STICK_MAX - center : XBOX_STICK_MAX + center;
+    return scaleOutside(offset, stickCalibration.deadzone[axis], range);
+}
+
+int8_t HOT_PATH ControlMapper::scaleOutside(int32_t value, int32_t deadzone, int32_t fullScale) {
+    int32_t magnitude = value < 0 ? -value : value;
+
+    if (magnitude <= deadzone) {
+        return 0;
+    }
+    if (magnitude > fullScale) {
+        magnitude = fullScale;
+    }
+
+    // Rescale so output starts at 0 just outside the deadzone
+    int32_t scaled = (magnitude - deadzone) * 100 / (fullScale - deadzone);
+    return (int8_t)(value < 0 ? -scaled : scaled);
+}
+
+int8_t HOT_PATH ControlMapper::applySpeedLimit(int8_t speed) const {
+    return (int8_t)((int32_t)speed * settings.maxSpeedPercent / 100);
+}
+
+uint8_t HOT_PATH ControlMapper::updateLights(const XboxControllerState& xboxState) {
+    bool stopCombo = xboxState.btn_b && xboxState.btn_x;
+
+    if (xboxState.btn_a && !previous.btn_a) {
+        lightsOn = !lightsOn;
+    }
+    if (xboxState.btn_b && !previous.btn_b && !stopCombo) {
+        lightMode = (lightMode + 1) % LIGHT_MODE_COUNT;
+    }
+
+    if (!lightsOn) {
+        return LEGO_LIGHTS_OFF;
+    }
+    if (xboxState.btn_rb || stopCombo) {
+        return LEGO_LIGHTS_BRAKE;
+    }
+    return LIGHT_MODES[lightMode];
+}
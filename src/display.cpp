@@ -0,0 +1,303 @@
+/**
+ * Display Implementation
+ */
+
+#include <Wire.h>
+#include "display.h"
+
+// ============================================================================
+// SSD1306 Constants
+// ============================================================================
+
+#define SSD1306_CONTROL_COMMAND  0x00
+#define SSD1306_CONTROL_DATA     0x40
+#define SSD1306_SET_COLUMNS      0x21
+#define SSD1306_SET_PAGES        0x22
+#define DISPLAY_I2C_CHUNK        32    // Data bytes per I2C transaction (Wire buffer)
+
+static const uint8_t SSD1306_INIT[] = {
+    0xAE,         // Display off
+    0xD5, 0x80,   // Clock divide
+    0xA8, 0x3F,   // Multiplex 64
+    0xD3, 0x00,   // No display offset
+    0x40,         // Start line 0
+    0x8D, 0x14,   // Charge pump on
+    0x20, 0x00,   // Horizontal addressing
+    0xA1,         // Segment remap
+    0xC8,         // COM scan descending
+    0xDA, 0x12,   // COM pins
+    0x81, 0xCF,   // Contrast
+    0xD9, 0xF1,   // Precharge
+    0xDB, 0x40,   // VCOMH
+    0xA4,         // Display from RAM
+    0xA6,         // Normal (not inverted)
+    0xAF          // Display on
+};
+
+// 5x7 font, ASCII 0x20-0x7E, one byte per column (LSB = top)
+static const uint8_t FONT_5X7[][5] = {
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+    {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x55,0x22,0x50}, {0x00,0x05,0x03,0x00,0x00},
+    {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x08,0x2A,0x1C,0x2A,0x08}, {0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02},
+    {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31},
+    {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03},
+    {0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00},
+    {0x08,0x14,0x22,0x41,0x00}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x51,0x09,0x06},
+    {0x32,0x49,0x79,0x41,0x3E}, {0x7E,0x11,0x11,0x11,0x7E}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x01,0x01}, {0x3E,0x41,0x41,0x51,0x32},
+    {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+    {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x04,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31},
+    {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x7F,0x20,0x18,0x20,0x7F},
+    {0x63,0x14,0x08,0x14,0x63}, {0x03,0x04,0x78,0x04,0x03}, {0x61,0x51,0x49,0x45,0x43}, {0x00,0x00,0x7F,0x41,0x41},
+    {0x02,0x04,0x08,0x10,0x20}, {0x41,0x41,0x7F,0x00,0x00}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+    {0x00,0x01,0x02,0x04,0x00}, {0x20,0x54,0x54,0x54,0x78}, {0x7F,0x48,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x20},
+    {0x38,0x44,0x44,0x48,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x08,0x7E,0x09,0x01,0x02}, {0x08,0x14,0x54,0x54,0x3C},
+    {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x44,0x3D,0x00}, {0x00,0x7F,0x10,0x28,0x44},
+    {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x18,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+    {0x7C,0x14,0x14,0x14,0x08}, {0x08,0x14,0x14,0x18,0x7C}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x20},
+    {0x04,0x3F,0x44,0x40,0x20}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+    {0x44,0x28,0x10,0x28,0x44}, {0x0C,0x50,0x50,0x50,0x3C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+    {0x00,0x00,0x7F,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x10,0x08,0x08,0x10,0x08}
+};
+
+#define FONT_FIRST_CHAR ' '
+#define FONT_LAST_CHAR  '~'
+
+// ============================================================================
+// Display Implementation
+// ============================================================================
+
+Display::Display()
+    : present(false)
+    , task(nullptr)
+    , mux(portMUX_INITIALIZER_UNLOCKED)
+    , pending()
+    , stats()
+{
+    pending.state = "";
+    memset(pageValid, 0, sizeof(pageValid));
+}
+
+bool Display::init() {
+#if DISPLAY_ENABLED
+    Wire.begin(DISPLAY_I2C_SDA, DISPLAY_I2C_SCL, DISPLAY_I2C_FREQ_HZ);
+
+    // Probe - a missing panel is not an error, the display is optional
+    Wire.beginTransmission(DISPLAY_I2C_ADDRESS);
+    if (Wire.endTransmission() != 0) {
+        DEBUG_PRINTLN("[DISP] No display detected");
+        return false;
+    }
+
+    if (!sendCommands(SSD1306_INIT, sizeof(SSD1306_INIT))) {
+        DEBUG_PRINTLN("[DISP] ERROR: Display init failed");
+        return false;
+    }
+
+    // The first frame is pushed in full, covering whatever is in panel RAM
+    memset(pageValid, 0, sizeof(pageValid));
+    present = true;
+
+    if (xTaskCreatePinnedToCore(taskMain, "display", DISPLAY_TASK_STACK, this,
+                                DISPLAY_TASK_PRIORITY, &task, DISPLAY_TASK_CORE) != pdPASS) {
+        DEBUG_PRINTLN("[DISP] ERROR: Failed to start display task");
+        present = false;
+        return false;
+    }
+
+    DEBUG_PRINTLN("[DISP] Display ready");
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Display::isPresent() {
+    return present;
+}
+
+void Display::update(const DisplayStatus& status) {
+    if (!present) {
+        return;
+    }
+
+    portENTER_CRITICAL(&mux);
+    pending = status;
+    portEXIT_CRITICAL(&mux);
+
+    xTaskNotifyGive(task);
+}
+
+DisplayStats Display::getStats() {
+    portENTER_CRITICAL(&mux);
+    DisplayStats copy = stats;
+    portEXIT_CRITICAL(&mux);
+    return copy;
+}
+
+void Display::resetStats() {
+    portENTER_CRITICAL(&mux);
+    stats = DisplayStats();
+    portEXIT_CRITICAL(&mux);
+}
+
+// ============================================================================
+// Display Task
+// ============================================================================
+
+void Display::taskMain(void* arg) {
+    Display* display = static_cast<Display*>(arg);
+
+    while (true) {
+        // Updates arriving while a frame is pushed coalesce into one
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        DisplayStatus status;
+        portENTER_CRITICAL(&display->mux);
+        status = display->pending;
+        portEXIT_CRITICAL(&display->mux);
+
+        uint32_t startUs = micros();
+        display->render(status);
+        uint32_t pages = display->push();
+        uint32_t frameUs = micros() - startUs;
+
+        portENTER_CRITICAL(&display->mux);
+        display->stats.framesRendered++;
+        if (pages > 0) {
+            display->stats.framesPushed++;
+            display->stats.pagesPushed += pages;
+        }
+        display->stats.lastFrameUs = frameUs;
+        if (frameUs > display->stats.maxFrameUs) {
+            display->stats.maxFrameUs = frameUs;
+        }
+        portEXIT_CRITICAL(&display->mux);
+    }
+}
+
+void Display::render(const DisplayStatus& status) {
+    memset(frame, 0, sizeof(frame));
+
+    char line[DISPLAY_TEXT_COLS + 1];
+
+    snprintf(line, sizeof(line), "XboxLego %s", status.state);
+    drawText(0, line);
+
+    if (status.xboxConnected) {
+        snprintf(line, sizeof(line), "Xbox: OK  bat %u%%", status.xboxBattery);
+    } else {
+        snprintf(line, sizeof(line), "Xbox: --");
+    }
+    drawText(2, line);
+
+    if (status.legoConnected) {
+        snprintf(line, sizeof(line), "Lego: OK  %u Hz", status.driveRateHz);
+    } else {
+        snprintf(line, sizeof(line), "Lego: --");
+    }
+    drawText(3, line);
+
+    snprintf(line, sizeof(line), "Speed %4d%%", status.speed);
+    drawText(5, line);
+    snprintf(line, sizeof(line), "Steer %4d%%", status.steering);
+    drawText(6, line);
+
+    if (status.emergencyStop) {
+        snprintf(line, sizeof(line), "** STOP **");
+    } else {
+        snprintf(line, sizeof(line), "Lights %s",
+            status.lights == LEGO_LIGHTS_OFF ? "off" :
+            status.lights == LEGO_LIGHTS_BRAKE ? "brake" :
+            status.lights == LEGO_LIGHTS_REAR_ONLY ? "rear" : "on");
+    }
+    drawText(7, line);
+}
+
+void Display::drawText(uint8_t page, const char* text) {
+    uint8_t* row = frame[page];
+    for (int col = 0; text[col] != '\0' && col < DISPLAY_TEXT_COLS; col++) {
+        char c = text[col];
+        if (c < FONT_FIRST_CHAR || c > FONT_LAST_CHAR) {
+            c = '?';
+        }
+        memcpy(row + col * 6, FONT_5X7[c - FONT_FIRST_CHAR], 5);
+    }
+}
+
+uint32_t Display::push() {
+    uint32_t pagesPushed = 0;
+
+    for (uint8_t page = 0; page < DISPLAY_PAGES; page++) {
+        // Dirty span of this page
+        int first = 0;
+        int last = DISPLAY_WIDTH - 1;
+        if (pageValid[page]) {
+            while (first < DISPLAY_WIDTH && frame[page][first] == shadow[page][first]) {
+                first++;
+            }
+            if (first == DISPLAY_WIDTH) {
+                continue;
+            }
+            while (frame[page][last] == shadow[page][last]) {
+                last--;
+            }
+        }
+
+        uint8_t window[] = {
+            SSD1306_SET_COLUMNS, (uint8_t)first, (uint8_t)last,
+            SSD1306_SET_PAGES, page, page
+        };
+        if (!sendCommands(window, sizeof(window))
+            || !sendData(&frame[page][first], last - first + 1)) {
+            // Panel contents unknown - push the whole page next frame
+            pageValid[page] = false;
+            portENTER_CRITICAL(&mux);
+            stats.i2cErrors++;
+            portEXIT_CRITICAL(&mux);
+            continue;
+        }
+
+        memcpy(&shadow[page][first], &frame[page][first], last - first + 1);
+        pageValid[page] = true;
+        pagesPushed++;
+    }
+    return pagesPushed;
+}
+
+bool Display::sendCommands(const uint8_t* commands, size_t length) {
+    Wire.beginTransmission(DISPLAY_I2C_ADDRESS);
+    Wire.write(SSD1306_CONTROL_COMMAND);
+    Wire.write(commands, length);
+    bool ok = Wire.endTransmission() == 0;
+
+    portENTER_CRITICAL(&mux);
+    stats.bytesTransferred += length + 1;
+    portEXIT_CRITICAL(&mux);
+    return ok;
+}
+
+bool Display::sendData(const uint8_t* data, size_t length) {
+    // The column/page window keeps the RAM pointer moving across transactions
+    for (size_t offset = 0; offset < length; offset += DISPLAY_I2C_CHUNK) {
+        size_t chunk = length - offset;
+        if (chunk > DISPLAY_I2C_CHUNK) {
+            chunk = DISPLAY_I2C_CHUNK;
+        }
+
+        Wire.beginTransmission(DISPLAY_I2C_ADDRESS);
+        Wire.write(SSD1306_CONTROL_DATA);
+        Wire.write(data + offset, chunk);
+        bool ok = Wire.endTransmission() == 0;
+
+        portENTER_CRITICAL(&mux);
+        stats.bytesTransferred += chunk + 1;
+        portEXIT_CRITICAL(&mux);
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
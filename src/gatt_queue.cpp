@@ -0,0 +1,241 @@
+/**
+ * GATT Queue Implementation
+ */
+
+#include "gatt_queue.h"
+
+const char* gattOpStatusName(GattOpStatus status) {
+    switch (status) {
+        case GattOpStatus::IDLE:      return "idle";
+        case GattOpStatus::QUEUED:    return "queued";
+        case GattOpStatus::RUNNING:   return "running";
+        case GattOpStatus::OK:        return "ok";
+        case GattOpStatus::FAILED:    return "failed";
+        case GattOpStatus::TIMED_OUT: return "timed out";
+        case GattOpStatus::CANCELLED: return "cancelled";
+        default:                      return "?";
+    }
+}
+
+// ============================================================================
+// GattQueue Implementation
+// ============================================================================
+
+volatile GattTraceHandler GattQueue::traceHandler = nullptr;
+
+GattQueue::GattQueue(const char* name)
+    : name(name)
+    , depth(0)
+    , nextOrder(0)
+    , mux(portMUX_INITIALIZER_UNLOCKED)
+    , task(nullptr)
+{
+    for (int i = 0; i < GATT_QUEUE_DEPTH; i++) {
+        slots[i].used = false;
+    }
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool GattQueue::init() {
+    if (task) {
+        return true;
+    }
+    if (xTaskCreate(taskFn, name, GATT_TASK_STACK, this, GATT_TASK_PRIORITY, &task) != pdPASS) {
+        DEBUG_BLE_PRINTF("[GATT] ERROR: Failed to start the %s queue task\n", name);
+        return false;
+    }
+    return true;
+}
+
+bool GattQueue::submit(const GattOp& op) {
+    if (op.future && op.future->isPending()) {
+        portENTER_CRITICAL(&mux);
+        stats.rejected++;
+        portEXIT_CRITICAL(&mux);
+        return false;
+    }
+
+    // Without a worker nothing would ever run it (init() not called or failed)
+    if (!task) {
+        portENTER_CRITICAL(&mux);
+        stats.rejected++;
+        portEXIT_CRITICAL(&mux);
+        if (op.future) {
+            op.future->status.store((uint8_t)GattOpStatus::FAILED, std::memory_order_release);
+        }
+        return false;
+    }
+
+    portENTER_CRITICAL(&mux);
+    int free = -1;
+    for (int i = 0; i < GATT_QUEUE_DEPTH; i++) {
+        if (!slots[i].used) {
+            free = i;
+            break;
+        }
+    }
+    if (free < 0) {
+        stats.rejected++;
+        portEXIT_CRITICAL(&mux);
+        return false;
+    }
+
+    Slot& slot = slots[free];
+    slot.op = op;
+    slot.enqueuedUs = micros();
+    slot.order = nextOrder++;
+    slot.used = true;
+    depth++;
+    if (depth > stats.maxDepth) {
+        stats.maxDepth = depth;
+    }
+    stats.submitted++;
+    if (op.future) {
+        op.future->status.store((uint8_t)GattOpStatus::QUEUED, std::memory_order_release);
+    }
+    portEXIT_CRITICAL(&mux);
+
+    xTaskNotifyGive(task);
+    return true;
+}
+
+void GattQueue::cancelAll() {
+    Slot cancelled[GATT_QUEUE_DEPTH];
+    int count = 0;
+
+    portENTER_CRITICAL(&mux);
+    for (int i = 0; i < GATT_QUEUE_DEPTH; i++) {
+        if (slots[i].used) {
+            cancelled[count++] = slots[i];
+            slots[i].used = false;
+        }
+    }
+    depth = 0;
+    stats.cancelled += count;
+    portEXIT_CRITICAL(&mux);
+
+    uint32_t nowUs = micros();
+    for (int i = 0; i < count; i++) {
+        complete(cancelled[i].op, GattOpStatus::CANCELLED, nowUs - cancelled[i].enqueuedUs, 0);
+    }
+}
+
+const char* GattQueue::getName() {
+    return name;
+}
+
+uint8_t GattQueue::getDepth() {
+    return depth;
+}
+
+GattQueueStats GattQueue::getStats() {
+    portENTER_CRITICAL(&mux);
+    GattQueueStats copy = stats;
+    portEXIT_CRITICAL(&mux);
+    return copy;
+}
+
+void GattQueue::resetStats() {
+    portENTER_CRITICAL(&mux);
+    memset(&stats, 0, sizeof(stats));
+    stats.maxDepth = depth;
+    portEXIT_CRITICAL(&mux);
+}
+
+// ============================================================================
+// Worker
+// ============================================================================
+
+bool GattQueue::takeNext(Slot& slot) {
+    portENTER_CRITICAL(&mux);
+    int best = -1;
+    for (int i = 0; i < GATT_QUEUE_DEPTH; i++) {
+        if (!slots[i].used) {
+            continue;
+        }
+        if (best < 0
+            || slots[i].op.priority < slots[best].op.priority
+            || (slots[i].op.priority == slots[best].op.priority
+                && (int32_t)(slots[i].order - slots[best].order) < 0)) {
+            best = i;
+        }
+    }
+    if (best >= 0) {
+        slot = slots[best];
+        slots[best].used = false;
+        depth--;
+    }
+    portEXIT_CRITICAL(&mux);
+    return best >= 0;
+}
+
+void GattQueue::execute(const Slot& slot) {
+    const GattOp& op = slot.op;
+    uint32_t startUs = micros();
+    uint32_t waitUs = startUs - slot.enqueuedUs;
+
+    GattOpStatus status;
+    if (op.timeoutMs && waitUs > op.timeoutMs * 1000) {
+        status = GattOpStatus::TIMED_OUT;
+        DEBUG_BLE_PRINTF("[GATT] %s: '%s' waited %lu ms - dropped\n",
+                         name, op.name, (unsigned long)(waitUs / 1000));
+    } else {
+        if (op.future) {
+            op.future->status.store((uint8_t)GattOpStatus::RUNNING, std::memory_order_release);
+        }
+        status = op.run(op.context) ? GattOpStatus::OK : GattOpStatus::FAILED;
+    }
+    uint32_t runUs = micros() - startUs;
+
+    portENTER_CRITICAL(&mux);
+    if (status == GattOpStatus::TIMED_OUT) {
+        stats.timedOut++;
+    } else {
+        stats.started++;
+        stats.waitSumUs += waitUs;
+        if (waitUs > stats.waitMaxUs) {
+            stats.waitMaxUs = waitUs;
+        }
+        if (runUs > stats.runMaxUs) {
+            stats.runMaxUs = runUs;
+        }
+        if (status == GattOpStatus::OK) {
+            stats.completed++;
+        } else {
+            stats.failed++;
+        }
+    }
+    portEXIT_CRITICAL(&mux);
+
+    GattTraceHandler handler = traceHandler;
+    if (handler) {
+        handler(name, op.name, status, waitUs, runUs);
+    }
+    complete(op, status, waitUs, runUs);
+}
+
+void GattQueue::complete(const GattOp& op, GattOpStatus status, uint32_t waitUs, uint32_t runUs) {
+    if (op.future) {
+        op.future->waitUs = waitUs;
+        op.future->runUs = runUs;
+        op.future->status.store((uint8_t)status, std::memory_order_release);
+    }
+    if (op.done) {
+        op.done(status, op.context);
+    }
+}
+
+void GattQueue::setTraceHandler(GattTraceHandler handler) {
+    traceHandler = handler;
+}
+
+void GattQueue::taskFn(void* arg) {
+    GattQueue* queue = static_cast<GattQueue*>(arg);
+    Slot slot;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (queue->takeNext(slot)) {
+            queue->execute(slot);
+        }
+    }
+}
@@ -0,0 +1,121 @@
+/**
+ * Hot Path Benchmark Implementation
+ */
+
+#include <Preferences.h>
+#include "hot_path_bench.h"
+#include "control_mapper.h"
+#include "lego_tx_scheduler.h"
+#include "xbox_report.h"
+
+#define NVS_BENCH_KEY "hp_bench"
+
+static const char* const LOAD_NAMES[HOT_PATH_LOAD_COUNT] = { "quiet", "NVS writes" };
+
+static volatile bool loadStop = false;
+static volatile uint32_t loadWrites = 0;
+static TaskHandle_t benchTask = nullptr;
+
+// ============================================================================
+// NVS Load
+// ============================================================================
+
+static void nvsLoadTaskFn(void* arg) {
+    uint8_t blob[HOT_PATH_BENCH_NVS_BYTES];
+    uint32_t count = 0;
+
+    Preferences prefs;
+    prefs.begin(NVS_NAMESPACE, false);
+    while (!loadStop) {
+        // A changed value every time, or NVS skips the write
+        memset(blob, (uint8_t)count, sizeof(blob));
+        if (prefs.putBytes(NVS_BENCH_KEY, blob, sizeof(blob)) == sizeof(blob)) {
+            count++;
+        }
+    }
+    prefs.remove(NVS_BENCH_KEY);
+    prefs.end();
+
+    loadWrites = count;
+    xTaskNotifyGive(benchTask);
+    vTaskDelete(nullptr);
+}
+
+// ============================================================================
+// Control Path
+// ============================================================================
+
+static uint32_t timePass(uint32_t pass, ControlMapper& mapper, LegoTxScheduler& scheduler) {
+    // A BLE input report with moving sticks and triggers
+    uint8_t report[XBOX_BLE_REPORT_SIZE] = {};
+    uint16_t axis = (uint16_t)(pass * 977);
+    report[0] = (uint8_t)axis;
+    report[1] = (uint8_t)(axis >> 8);
+    report[2] = (uint8_t)~axis;
+    report[3] = (uint8_t)(~axis >> 8);
+    report[10] = (uint8_t)pass;
+    report[11] = (uint8_t)((pass >> 8) & 0x03);
+
+    XboxControllerState state;
+    state.battery_level = 0;
+    LegoFrame frame;
+
+    uint32_t start = ESP.getCycleCount();
+    xboxParseBleReport(report, sizeof(report), state);
+    MappedControls controls = mapper.map(state);
+    legoEncodeDrive(frame, controls.speed, controls.steering, controls.lights);
+    scheduler.submit(LegoTxClass::DRIVE, frame, pass);
+    uint32_t cycles = ESP.getCycleCount() - start;
+
+    LegoTxClass cls;
+    uint32_t submittedUs;
+    scheduler.pop(frame, cls, submittedUs);
+    return cycles;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool hotPathBenchRun(uint32_t passes, HotPathBenchResult results[HOT_PATH_LOAD_COUNT]) {
+    benchTask = xTaskGetCurrentTaskHandle();
+    int loadCore = xPortGetCoreID() ^ 1;
+
+    for (int l = 0; l < HOT_PATH_LOAD_COUNT; l++) {
+        HotPathLoad load = (HotPathLoad)l;
+        HotPathBenchResult& result = results[l];
+        memset(&result, 0, sizeof(result));
+        result.name = LOAD_NAMES[l];
+        result.minCycles = UINT32_MAX;
+
+        if (load == HotPathLoad::NVS_WRITES) {
+            loadStop = false;
+            if (xTaskCreatePinnedToCore(nvsLoadTaskFn, "nvs_load", 4096, nullptr,
+                                        1, nullptr, loadCore) != pdPASS) {
+                return false;
+            }
+        }
+
+        ControlMapper mapper;
+        LegoTxScheduler scheduler;
+        for (uint32_t pass = 0; pass < passes; pass++) {
+            vTaskDelay(1);
+            uint32_t cycles = timePass(pass, mapper, scheduler);
+            result.passes++;
+            result.sumCycles += cycles;
+            if (cycles < result.minCycles) {
+                result.minCycles = cycles;
+            }
+            if (cycles > result.maxCycles) {
+                result.maxCycles = cycles;
+            }
+        }
+
+        if (load == HotPathLoad::NVS_WRITES) {
+            loadStop = true;
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            result.nvsWrites = loadWrites;
+        }
+    }
+    return true;
+}
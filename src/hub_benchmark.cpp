@@ -0,0 +1,135 @@
+/**
+ * Hub Benchmark Implementation
+ */
+
+#include "hub_benchmark.h"
+
+// ============================================================================
+// HubBenchmark Implementation
+// ============================================================================
+
+HubBenchmark::HubBenchmark()
+    : step(0)
+    , rowCount(0)
+    , running(false)
+    , newResults(false)
+    , stepStartUs(0)
+    , nextFrameUs(0)
+    , notifications(0)
+    , hubErrors(0)
+{
+}
+
+void HubBenchmark::start(uint32_t nowUs) {
+    rowCount = 0;
+    newResults = false;
+    running = true;
+    beginStep(0, nowUs);
+}
+
+void HubBenchmark::abort() {
+    running = false;
+}
+
+bool HubBenchmark::isRunning() const {
+    return running;
+}
+
+bool HubBenchmark::hasNewResults() const {
+    return newResults;
+}
+
+void HubBenchmark::acknowledgeResults() {
+    newResults = false;
+}
+
+bool HubBenchmark::nextFrame(uint32_t nowUs, LegoFrame& frame, bool& withResponse) {
+    if (!running) {
+        return false;
+    }
+
+    if (nowUs - stepStartUs >= (uint32_t)HUB_BENCH_STEP_MS * 1000) {
+        endStep(nowUs);
+        if (step + 1 >= HUB_BENCH_STEP_COUNT) {
+            running = false;
+            newResults = true;
+            return false;
+        }
+        beginStep(step + 1, nowUs);
+    }
+
+    if ((int32_t)(nowUs - nextFrameUs) < 0) {
+        return false;
+    }
+
+    HubBenchRow& row = rows[step];
+    uint32_t periodUs = 1000000UL / row.targetHz;
+
+    // A blocking write that overran the schedule costs frame slots rather
+    // than producing a catch-up burst
+    uint32_t behindUs = nowUs - nextFrameUs;
+    if (behindUs >= periodUs) {
+        row.skipped += behindUs / periodUs;
+        nextFrameUs += (behindUs / periodUs) * periodUs;
+    }
+    nextFrameUs += periodUs;
+
+    legoEncodeDrive(frame, 0, 0, LEGO_LIGHTS_BOTH);
+    withResponse = row.withResponse;
+    row.attempted++;
+    return true;
+}
+
+void HubBenchmark::recordWrite(bool ok, uint32_t latencyUs) {
+    if (!running) {
+        return;
+    }
+
+    HubBenchRow& row = rows[step];
+    if (ok) {
+        row.accepted++;
+        row.latencySumUs += latencyUs;
+        if (latencyUs > row.latencyMaxUs) {
+            row.latencyMaxUs = latencyUs;
+        }
+    } else {
+        row.failed++;
+    }
+}
+
+void HubBenchmark::recordNotification(const uint8_t* data, size_t length) {
+    notifications.fetch_add(1, std::memory_order_relaxed);
+    if (length >= 3 && data[2] == LWP3_MSG_GENERIC_ERROR) {
+        hubErrors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+int HubBenchmark::getRowCount() const {
+    return rowCount;
+}
+
+const HubBenchRow& HubBenchmark::getRow(int index) const {
+    return rows[index];
+}
+
+void HubBenchmark::beginStep(int index, uint32_t nowUs) {
+    step = index;
+
+    HubBenchRow& row = rows[step];
+    row = HubBenchRow();
+    row.targetHz = HUB_BENCH_RATES_HZ[step % HUB_BENCH_RATE_COUNT];
+    row.withResponse = step >= HUB_BENCH_RATE_COUNT;
+
+    notifications.store(0, std::memory_order_relaxed);
+    hubErrors.store(0, std::memory_order_relaxed);
+    stepStartUs = nowUs;
+    nextFrameUs = nowUs;
+}
+
+void HubBenchmark::endStep(uint32_t nowUs) {
+    HubBenchRow& row = rows[step];
+    row.elapsedUs = nowUs - stepStartUs;
+    row.notifications = notifications.load(std::memory_order_relaxed);
+    row.hubErrors = hubErrors.load(std::memory_order_relaxed);
+    rowCount = step + 1;
+}
@@ -0,0 +1,500 @@
+/**
+ * Lego Hub Implementation
+ */
+
+#include "lego_hub.h"
+#include "link_stats.h"
+
+const char* legoTxTimingName(LegoTxTiming timing) {
+    switch (timing) {
+        case LegoTxTiming::IMMEDIATE: return "immediate";
+        case LegoTxTiming::ALIGNED:   return "aligned";
+        default:                      return "?";
+    }
+}
+
+// ============================================================================
+// LegoHub Implementation
+// ============================================================================
+
+volatile LegoFeedbackHandler LegoHub::feedbackHandler = nullptr;
+
+static const AimdPolicy DRIVE_RATE_POLICY = {
+    LEGO_AIMD_MIN_RATE_HZ,
+    LEGO_AIMD_MAX_RATE_HZ,
+    LEGO_AIMD_START_RATE_HZ,
+    LEGO_AIMD_INCREASE_HZ,
+    LEGO_AIMD_DECREASE_PERCENT,
+    LEGO_AIMD_WINDOW_WRITES,
+    LEGO_AIMD_LATENCY_LIMIT_US
+};
+
+LegoHub::LegoHub(GattQueue& queue)
+    : bleClient(nullptr)
+    , controlChar(nullptr)
+    , gattQueue(queue)
+    , stopInFlight(false)
+    , rateController(DRIVE_RATE_POLICY)
+    , txMux(portMUX_INITIALIZER_UNLOCKED)
+    , txAlign(LEGO_TX_ALIGN_ENABLED)
+    , lastIntervalReadMs(0)
+    , currentSpeed(0)
+    , currentSteering(0)
+    , currentLights(LEGO_LIGHTS_BOTH)
+    , lastTxMs(0)
+    , lastCalibrationMs(0)
+    , firstTxMs(0)
+    , lastControlTxUs(0)
+    , writeFailures(0)
+{
+    memset(&alignStats, 0, sizeof(alignStats));
+    memset(&stopWrite, 0, sizeof(stopWrite));
+    stopWrite.hub = this;
+}
+
+// GATT queue task - the loop has reset() the hub since the last link
+bool LegoHub::init(NimBLEClient* client) {
+    if (!client || !client->isConnected()) {
+        DEBUG_PRINTLN("[LEGO] ERROR: Hub is not connected");
+        return false;
+    }
+
+    NimBLERemoteService* service = client->getService(LEGO_SERVICE_UUID);
+    if (!service) {
+        DEBUG_PRINTLN("[LEGO] ERROR: Hub service not found");
+        return false;
+    }
+
+    NimBLERemoteCharacteristic* characteristic = service->getCharacteristic(LEGO_CHAR_UUID);
+    if (!characteristic) {
+        DEBUG_PRINTLN("[LEGO] ERROR: Hub characteristic not found");
+        return false;
+    }
+
+    // Hub feedback (port values, errors) arrives as notifications, which
+    // also mark the link's connection events
+    notify_callback onNotifyCB = [this](NimBLERemoteCharacteristic* pChar, uint8_t* data,
+                                        size_t length, bool isNotify) {
+        onNotify(data, length);
+    };
+    if (characteristic->canNotify() && !characteristic->subscribe(true, onNotifyCB)) {
+        DEBUG_PRINTLN("[LEGO] WARNING: Failed to subscribe to hub notifications");
+    }
+
+    // Published last, so service() sees the whole link or none of it. The
+    // interval is read by the first service() (lastIntervalReadMs is 0).
+    portENTER_CRITICAL(&txMux);
+    bleClient = client;
+    controlChar = characteristic;
+    portEXIT_CRITICAL(&txMux);
+    DEBUG_PRINTLN("[LEGO] Hub link ready");
+    return true;
+}
+
+void LegoHub::reset() {
+    portENTER_CRITICAL(&txMux);
+    bleClient = nullptr;
+    controlChar = nullptr;
+    scheduler.clear();
+    eventTracker.setInterval(0);
+    portEXIT_CRITICAL(&txMux);
+    rateController.reset();
+
+    firstTxMs = 0;
+    lastIntervalReadMs = 0;
+    currentSpeed = 0;
+    currentSteering = 0;
+}
+
+bool LegoHub::isReady() {
+    NimBLEClient* client;
+    return getLink(client) != nullptr && client->isConnected();
+}
+
+bool LegoHub::hasLink() {
+    NimBLEClient* client;
+    return getLink(client) != nullptr;
+}
+
+void LegoHub::calibrateSteering() {
+    DEBUG_PRINTLN("[LEGO] Queueing steering calibration");
+
+    LegoFrame frame;
+    legoEncodeCalibration(frame, LEGO_CALIBRATE_CMD_1);
+    submit(LegoTxClass::CALIBRATION, frame);
+    legoEncodeCalibration(frame, LEGO_CALIBRATE_CMD_2);
+    submit(LegoTxClass::CALIBRATION, frame);
+}
+
+void HOT_PATH LegoHub::sendDrive(int8_t speed, int8_t steering, uint8_t lights) {
+    currentSpeed = speed;
+    currentSteering = steering;
+    currentLights = lights;
+
+    LegoFrame frame;
+    legoEncodeDrive(frame, speed, steering, lights);
+    submit(LegoTxClass::DRIVE, frame);
+}
+
+void LegoHub::setLights(uint8_t lights) {
+    currentLights = lights;
+
+    LegoFrame frame;
+    legoEncodeDrive(frame, currentSpeed, currentSteering, lights);
+    submit(LegoTxClass::AUX, frame);
+}
+
+void HOT_PATH LegoHub::emergencyStop() {
+    currentSpeed = 0;
+
+    LegoFrame frame;
+    legoEncodeDrive(frame, 0, currentSteering, LEGO_LIGHTS_BRAKE);
+    submit(LegoTxClass::STOP, frame);
+}
+
+void LegoHub::service() {
+    // One snapshot per pass - init() and reset() may replace the link
+    NimBLEClient* client;
+    NimBLERemoteCharacteristic* characteristic = getLink(client);
+    if (!characteristic || !client->isConnected()) {
+        return;
+    }
+
+    unsigned long nowMs = millis();
+    refreshConnInterval(client, nowMs);
+
+    // Nothing overtakes a stop that is still waiting for its acknowledgement
+    LegoTxClass cls;
+    portENTER_CRITICAL(&txMux);
+    bool pending = !stopInFlight && scheduler.peek(cls);
+    portEXIT_CRITICAL(&txMux);
+    if (!pending) {
+        return;
+    }
+
+    // Stop frames go out immediately, everything else is paced so frames
+    // wait in the scheduler (where they can be replaced) rather than in the stack
+    if (cls == LegoTxClass::STOP) {
+        sendStop(characteristic);
+        return;
+    }
+    if (nowMs - lastTxMs < LEGO_TX_MIN_INTERVAL_MS) {
+        return;
+    }
+    if (cls == LegoTxClass::CALIBRATION && nowMs - lastCalibrationMs < LEGO_CALIBRATION_STEP_MS) {
+        return;
+    }
+
+    // Handed over earlier, a frame would only wait for the event in the stack,
+    // where a newer one can't replace it - hold it here until just before
+    uint32_t readyUs = micros();
+    portENTER_CRITICAL(&txMux);
+    bool timed = eventTracker.isLocked(readyUs);
+    uint32_t eventUs = eventTracker.nextEventUs(readyUs);
+    portEXIT_CRITICAL(&txMux);
+    bool align = timed && txAlign;
+    if (align && eventUs - readyUs > LEGO_TX_ALIGN_LEAD_US) {
+        return;
+    }
+
+    LegoFrame frame;
+    uint32_t submittedUs;
+    portENTER_CRITICAL(&txMux);
+    pending = scheduler.pop(frame, cls, submittedUs);
+    portEXIT_CRITICAL(&txMux);
+    if (!pending) {
+        return;
+    }
+
+    // Fire-and-forget: the write time only says how full the stack is
+    linkStatsRecordWriteSubmitted(LinkId::LEGO);
+    uint32_t writeStartUs = micros();
+    bool ok = characteristic->writeValue(frame.data, LEGO_CMD_TOTAL_SIZE, false);
+    uint32_t nowUs = micros();
+    linkStatsRecordWriteResult(LinkId::LEGO, ok);
+    rateController.recordWrite(ok, nowUs - writeStartUs);
+
+    portENTER_CRITICAL(&txMux);
+    if (ok) {
+        scheduler.recordSent(cls, submittedUs, nowUs);
+        if (timed) {
+            // On air at the first event after the stack took it
+            recordAirWait(align ? LegoTxTiming::ALIGNED : LegoTxTiming::IMMEDIATE,
+                          eventTracker.nextEventUs(nowUs) - submittedUs);
+        } else {
+            alignStats.untimed++;
+        }
+    } else {
+        writeFailures++;
+    }
+    portEXIT_CRITICAL(&txMux);
+
+    lastTxMs = nowMs;
+    if (ok && firstTxMs == 0) {
+        firstTxMs = nowMs;
+    }
+    if (ok && cls == LegoTxClass::DRIVE) {
+        lastControlTxUs = nowUs;
+    }
+    if (cls == LegoTxClass::CALIBRATION) {
+        lastCalibrationMs = nowMs;
+    }
+}
+
+bool LegoHub::flushStop(uint32_t timeoutMs) {
+    unsigned long startMs = millis();
+    for (;;) {
+        service();
+
+        LegoTxClass cls;
+        portENTER_CRITICAL(&txMux);
+        bool waiting = stopInFlight || (scheduler.peek(cls) && cls == LegoTxClass::STOP);
+        portEXIT_CRITICAL(&txMux);
+        if (!waiting) {
+            return true;
+        }
+        if (!isReady() || millis() - startMs >= timeoutMs) {
+            return false;
+        }
+        delay(1);
+    }
+}
+
+void LegoHub::sendStop(NimBLERemoteCharacteristic* characteristic) {
+    // stopWrite is free: the previous stop is done (stopInFlight is clear)
+    LegoTxClass cls;
+    portENTER_CRITICAL(&txMux);
+    bool pending = scheduler.pop(stopWrite.frame, cls, stopWrite.submittedUs);
+    stopInFlight = pending;
+    portEXIT_CRITICAL(&txMux);
+    if (!pending) {
+        return;
+    }
+    stopWrite.characteristic = characteristic;
+
+    // Ahead of anything else on the hub's queue, and never dropped for waiting
+    GattOp op = { "stop", stopWriteOp, &stopWrite, GattPriority::URGENT, 0, nullptr, onStopDone };
+    if (gattQueue.submit(op)) {
+        linkStatsRecordWriteSubmitted(LinkId::LEGO);
+        return;
+    }
+
+    // Queue full or not running - back to its slot for the next service()
+    portENTER_CRITICAL(&txMux);
+    stopInFlight = false;
+    scheduler.submit(LegoTxClass::STOP, stopWrite.frame, stopWrite.submittedUs);
+    portEXIT_CRITICAL(&txMux);
+}
+
+// GATT queue task
+bool LegoHub::stopWriteOp(void* context) {
+    StopWrite* write = static_cast<StopWrite*>(context);
+    return write->characteristic->writeValue(write->frame.data, LEGO_CMD_TOTAL_SIZE, true);
+}
+
+// GATT queue task, or the caller of cancelAll()
+void LegoHub::onStopDone(GattOpStatus status, void* context) {
+    StopWrite* write = static_cast<StopWrite*>(context);
+    LegoHub* hub = write->hub;
+    uint32_t nowUs = micros();
+    bool ok = (status == GattOpStatus::OK);
+    bool cancelled = (status == GattOpStatus::CANCELLED);
+    bool retry = false;
+
+    if (!cancelled) {
+        linkStatsRecordWriteResult(LinkId::LEGO, ok);
+    }
+
+    portENTER_CRITICAL(&hub->txMux);
+    if (ok) {
+        // The response came back in a connection event
+        hub->scheduler.recordSent(LegoTxClass::STOP, write->submittedUs, nowUs);
+        hub->eventTracker.observe(nowUs);
+        hub->lastControlTxUs = nowUs;
+    } else if (!cancelled) {
+        hub->writeFailures++;
+
+        // Never lose a stop on the same link (a newer one may be waiting)
+        LegoTxClass next;
+        if (hub->controlChar == write->characteristic
+            && !(hub->scheduler.peek(next) && next == LegoTxClass::STOP)) {
+            hub->scheduler.submit(LegoTxClass::STOP, write->frame, write->submittedUs);
+            retry = true;
+        }
+    }
+    hub->stopInFlight = false;
+    portEXIT_CRITICAL(&hub->txMux);
+
+    if (ok && hub->firstTxMs == 0) {
+        hub->firstTxMs = millis();
+    }
+    if (retry) {
+        linkStatsRecordRetry(LinkId::LEGO);
+    }
+}
+
+bool LegoHub::writeDirect(const LegoFrame& frame, bool withResponse) {
+    NimBLEClient* client;
+    NimBLERemoteCharacteristic* characteristic = getLink(client);
+    if (!characteristic || !client->isConnected()) {
+        return false;
+    }
+
+    linkStatsRecordWriteSubmitted(LinkId::LEGO);
+    bool ok = characteristic->writeValue(frame.data, LEGO_CMD_TOTAL_SIZE, withResponse);
+    linkStatsRecordWriteResult(LinkId::LEGO, ok);
+    if (!ok) {
+        writeFailures++;
+    }
+    return ok;
+}
+
+void LegoHub::setFeedbackHandler(LegoFeedbackHandler handler) {
+    feedbackHandler = handler;
+}
+
+uint16_t LegoHub::getDriveRateHz() {
+    return rateController.getRateHz();
+}
+
+uint32_t LegoHub::getDriveIntervalMs() {
+    return rateController.getIntervalMs();
+}
+
+LegoTxStats LegoHub::getTxStats() {
+    portENTER_CRITICAL(&txMux);
+    LegoTxStats stats = scheduler.getStats();
+    portEXIT_CRITICAL(&txMux);
+    return stats;
+}
+
+AimdStats LegoHub::getRateStats() {
+    return rateController.getStats();
+}
+
+void LegoHub::setTxAlign(bool enabled) {
+    txAlign = enabled;
+}
+
+bool LegoHub::isTxAlignEnabled() {
+    return txAlign;
+}
+
+LegoTxAlignStats LegoHub::getAlignStats() {
+    portENTER_CRITICAL(&txMux);
+    LegoTxAlignStats stats = alignStats;
+    portEXIT_CRITICAL(&txMux);
+    return stats;
+}
+
+ConnEventStats LegoHub::getConnEventStats() {
+    portENTER_CRITICAL(&txMux);
+    ConnEventStats stats = eventTracker.getStats();
+    portEXIT_CRITICAL(&txMux);
+    return stats;
+}
+
+bool LegoHub::isConnEventLocked() {
+    uint32_t nowUs = micros();
+    portENTER_CRITICAL(&txMux);
+    bool locked = eventTracker.isLocked(nowUs);
+    portEXIT_CRITICAL(&txMux);
+    return locked;
+}
+
+uint32_t LegoHub::getConnIntervalUs() {
+    portENTER_CRITICAL(&txMux);
+    uint32_t intervalUs = eventTracker.getIntervalUs();
+    portEXIT_CRITICAL(&txMux);
+    return intervalUs;
+}
+
+ConnEventPhase LegoHub::getConnEventPhase() {
+    uint32_t nowUs = micros();
+    portENTER_CRITICAL(&txMux);
+    ConnEventPhase phase = eventTracker.getPhase(nowUs);
+    portEXIT_CRITICAL(&txMux);
+    return phase;
+}
+
+uint32_t LegoHub::getWriteFailures() {
+    return writeFailures;
+}
+
+unsigned long LegoHub::getFirstTxMs() {
+    return firstTxMs;
+}
+
+uint32_t LegoHub::getLastControlTxUs() {
+    return lastControlTxUs;
+}
+
+bool LegoHub::isControlSentSince(uint32_t submitUs, uint32_t& txUs) {
+    // The scheduler replaces queued drive frames, so the first control
+    // write after submission carries this frame (or a newer one)
+    txUs = lastControlTxUs;
+    return (int32_t)(txUs - submitUs) >= 0;
+}
+
+void LegoHub::resetStats() {
+    portENTER_CRITICAL(&txMux);
+    scheduler.resetStats();
+    eventTracker.resetStats();
+    memset(&alignStats, 0, sizeof(alignStats));
+    writeFailures = 0;
+    portEXIT_CRITICAL(&txMux);
+    rateController.resetStats();
+}
+
+void HOT_PATH LegoHub::submit(LegoTxClass cls, const LegoFrame& frame) {
+    uint32_t nowUs = micros();
+    portENTER_CRITICAL(&txMux);
+    scheduler.submit(cls, frame, nowUs);
+    portEXIT_CRITICAL(&txMux);
+}
+
+NimBLERemoteCharacteristic* LegoHub::getLink(NimBLEClient*& client) {
+    portENTER_CRITICAL(&txMux);
+    client = bleClient;
+    NimBLERemoteCharacteristic* characteristic = controlChar;
+    portEXIT_CRITICAL(&txMux);
+    return characteristic;
+}
+
+void LegoHub::refreshConnInterval(NimBLEClient* client, unsigned long nowMs) {
+    // Parameter updates are not reported after the fact, so poll
+    if (lastIntervalReadMs != 0 && nowMs - lastIntervalReadMs < CONN_EVENT_REFRESH_MS) {
+        return;
+    }
+    lastIntervalReadMs = nowMs;
+
+    uint32_t intervalUs = (uint32_t)client->getConnInfo().getConnInterval() * 1250;
+    portENTER_CRITICAL(&txMux);
+    eventTracker.setInterval(intervalUs);
+    portEXIT_CRITICAL(&txMux);
+}
+
+// Caller holds txMux
+void LegoHub::recordAirWait(LegoTxTiming timing, uint32_t waitUs) {
+    int t = (int)timing;
+    alignStats.frames[t]++;
+    alignStats.airWaitSumUs[t] += waitUs;
+    if (waitUs > alignStats.airWaitMaxUs[t]) {
+        alignStats.airWaitMaxUs[t] = waitUs;
+    }
+}
+
+void LegoHub::onNotify(uint8_t* data, size_t length) {
+    uint32_t nowUs = micros();
+    linkStatsRecordNotification(LinkId::LEGO, nowUs);
+
+    portENTER_CRITICAL(&txMux);
+    eventTracker.observe(nowUs);
+    portEXIT_CRITICAL(&txMux);
+
+    // Hub feedback is not interpreted here, only passed on
+    LegoFeedbackHandler handler = feedbackHandler;
+    if (handler) {
+        handler(data, length);
+    }
+}
@@ -0,0 +1,165 @@
+/**
+ * Lego TX Scheduler Implementation
+ */
+
+#include "lego_tx_scheduler.h"
+
+const char* legoTxClassName(LegoTxClass cls) {
+    switch (cls) {
+        case LegoTxClass::STOP:        return "stop";
+        case LegoTxClass::CALIBRATION: return "calib";
+        case LegoTxClass::DRIVE:       return "drive";
+        case LegoTxClass::AUX:         return "aux";
+        default:                       return "?";
+    }
+}
+
+// ============================================================================
+// LegoTxScheduler Implementation
+// ============================================================================
+
+LegoTxScheduler::LegoTxScheduler() {
+    clear();
+    resetStats();
+}
+
+void LegoTxScheduler::clear() {
+    stopSlot.pending = false;
+    for (int i = 0; i < LEGO_TX_CALIBRATION_DEPTH; i++) {
+        calibrationFifo[i].pending = false;
+    }
+    calibrationHead = 0;
+    calibrationCount = 0;
+    driveSlot.pending = false;
+    auxSlot.pending = false;
+}
+
+void LegoTxScheduler::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool HOT_PATH LegoTxScheduler::submit(LegoTxClass cls, const LegoFrame& frame, uint32_t nowUs) {
+    if (cls >= LegoTxClass::COUNT) {
+        return false;
+    }
+    stats.submitted[(int)cls]++;
+
+    switch (cls) {
+        case LegoTxClass::STOP:
+            // Anything still waiting to drive is stale once a stop is issued
+            // (aux frames are drive frames with new lights, at the old speed)
+            if (driveSlot.pending) {
+                driveSlot.pending = false;
+                stats.drivePreempted++;
+            }
+            if (auxSlot.pending) {
+                auxSlot.pending = false;
+                stats.auxPreempted++;
+            }
+            storeLatest(stopSlot, cls, frame, nowUs);
+            return true;
+
+        case LegoTxClass::CALIBRATION: {
+            if (calibrationCount >= LEGO_TX_CALIBRATION_DEPTH) {
+                stats.calibrationDropped++;
+                return false;
+            }
+            uint8_t tail = (calibrationHead + calibrationCount) % LEGO_TX_CALIBRATION_DEPTH;
+            calibrationFifo[tail].frame = frame;
+            calibrationFifo[tail].submittedUs = nowUs;
+            calibrationFifo[tail].pending = true;
+            calibrationCount++;
+            return true;
+        }
+
+        case LegoTxClass::DRIVE:
+            storeLatest(driveSlot, cls, frame, nowUs);
+            return true;
+
+        case LegoTxClass::AUX:
+            storeLatest(auxSlot, cls, frame, nowUs);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+bool HOT_PATH LegoTxScheduler::peek(LegoTxClass& cls) const {
+    if (stopSlot.pending) {
+        cls = LegoTxClass::STOP;
+    } else if (calibrationCount > 0) {
+        cls = LegoTxClass::CALIBRATION;
+    } else if (driveSlot.pending) {
+        cls = LegoTxClass::DRIVE;
+    } else if (auxSlot.pending) {
+        cls = LegoTxClass::AUX;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool HOT_PATH LegoTxScheduler::pop(LegoFrame& frame, LegoTxClass& cls, uint32_t& submittedUs) {
+    if (!peek(cls)) {
+        return false;
+    }
+
+    switch (cls) {
+        case LegoTxClass::STOP:
+            take(stopSlot, frame, submittedUs);
+            break;
+        case LegoTxClass::CALIBRATION:
+            take(calibrationFifo[calibrationHead], frame, submittedUs);
+            calibrationHead = (calibrationHead + 1) % LEGO_TX_CALIBRATION_DEPTH;
+            calibrationCount--;
+            break;
+        case LegoTxClass::DRIVE:
+            take(driveSlot, frame, submittedUs);
+            break;
+        default:
+            take(auxSlot, frame, submittedUs);
+            break;
+    }
+    return true;
+}
+
+void HOT_PATH LegoTxScheduler::recordSent(LegoTxClass cls, uint32_t submittedUs, uint32_t nowUs) {
+    if (cls >= LegoTxClass::COUNT) {
+        return;
+    }
+    int i = (int)cls;
+    uint32_t latencyUs = nowUs - submittedUs;
+
+    stats.sent[i]++;
+    stats.latencySumUs[i] += latencyUs;
+    if (latencyUs > stats.latencyMaxUs[i]) {
+        stats.latencyMaxUs[i] = latencyUs;
+    }
+}
+
+bool HOT_PATH LegoTxScheduler::hasPending() const {
+    LegoTxClass cls;
+    return peek(cls);
+}
+
+const LegoTxStats& LegoTxScheduler::getStats() const {
+    return stats;
+}
+
+void HOT_PATH LegoTxScheduler::storeLatest(Slot& slot, LegoTxClass cls, const LegoFrame& frame, uint32_t nowUs) {
+    if (slot.pending) {
+        // Latest wins, but keep the original timestamp so latency covers the wait
+        stats.replaced[(int)cls]++;
+    } else {
+        slot.submittedUs = nowUs;
+    }
+    slot.frame = frame;
+    slot.pending = true;
+}
+
+void HOT_PATH LegoTxScheduler::take(Slot& slot, LegoFrame& frame, uint32_t& submittedUs) {
+    frame = slot.frame;
+    submittedUs = slot.submittedUs;
+    slot.pending = false;
+}
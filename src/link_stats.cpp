@@ -0,0 +1,190 @@
+/**
+ * Link Statistics Implementation
+ */
+
+#include <Arduino.h>
+#include "config.h"
+#include "link_stats.h"
+
+static LinkStats g_linkStats[LINK_COUNT];
+
+const char* linkName(LinkId link) {
+    switch (link) {
+        case LinkId::XBOX: return "Xbox";
+        case LinkId::LEGO: return "Lego";
+        default:           return "?";
+    }
+}
+
+LinkStats& linkStats(LinkId link) {
+    return g_linkStats[(int)link];
+}
+
+// ============================================================================
+// Reset
+// ============================================================================
+
+void linkStatsReset(LinkId link) {
+    LinkStats& s = linkStats(link);
+
+    s.notifications.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < LINK_HIST_BUCKETS; i++) {
+        s.interArrival[i].store(0, std::memory_order_relaxed);
+    }
+    s.lastNotifyUs.store(0, std::memory_order_relaxed);
+
+    s.writesSubmitted.store(0, std::memory_order_relaxed);
+    s.writesCompleted.store(0, std::memory_order_relaxed);
+    s.writesFailed.store(0, std::memory_order_relaxed);
+    s.retries.store(0, std::memory_order_relaxed);
+
+    s.rssiMin.store(INT32_MAX, std::memory_order_relaxed);
+    s.rssiMax.store(INT32_MIN, std::memory_order_relaxed);
+    s.rssiSum.store(0, std::memory_order_relaxed);
+    s.rssiSamples.store(0, std::memory_order_relaxed);
+
+    // PHY is connection state, not a counter - keep it
+    s.connParamUpdates.store(0, std::memory_order_relaxed);
+    s.disconnects.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < LINK_DISCONNECT_HISTORY; i++) {
+        s.disconnectReasons[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void linkStatsResetAll() {
+    for (int i = 0; i < LINK_COUNT; i++) {
+        linkStatsReset((LinkId)i);
+    }
+}
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+void HOT_PATH linkStatsRecordNotification(LinkId link, uint32_t nowUs) {
+    LinkStats& s = linkStats(link);
+
+    s.notifications.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t lastUs = s.lastNotifyUs.exchange(nowUs, std::memory_order_relaxed);
+    if (lastUs == 0) {
+        return;  // First notification since reset has no interval
+    }
+
+    uint32_t deltaMs = (nowUs - lastUs) / 1000;
+    int bucket = 0;
+    while (bucket < LINK_HIST_BUCKETS - 1 && deltaMs > LINK_HIST_BOUNDS_MS[bucket]) {
+        bucket++;
+    }
+    s.interArrival[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void linkStatsRecordWriteSubmitted(LinkId link) {
+    linkStats(link).writesSubmitted.fetch_add(1, std::memory_order_relaxed);
+}
+
+void linkStatsRecordWriteResult(LinkId link, bool ok) {
+    LinkStats& s = linkStats(link);
+    if (ok) {
+        s.writesCompleted.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        s.writesFailed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void linkStatsRecordRetry(LinkId link) {
+    linkStats(link).retries.fetch_add(1, std::memory_order_relaxed);
+}
+
+void linkStatsRecordRssi(LinkId link, int rssi) {
+    LinkStats& s = linkStats(link);
+
+    int32_t current = s.rssiMin.load(std::memory_order_relaxed);
+    while (rssi < current &&
+           !s.rssiMin.compare_exchange_weak(current, rssi, std::memory_order_relaxed)) {
+    }
+    current = s.rssiMax.load(std::memory_order_relaxed);
+    while (rssi > current &&
+           !s.rssiMax.compare_exchange_weak(current, rssi, std::memory_order_relaxed)) {
+    }
+
+    s.rssiSum.fetch_add(rssi, std::memory_order_relaxed);
+    s.rssiSamples.fetch_add(1, std::memory_order_relaxed);
+}
+
+void linkStatsRecordConnParamUpdate(LinkId link) {
+    linkStats(link).connParamUpdates.fetch_add(1, std::memory_order_relaxed);
+}
+
+void linkStatsRecordPhy(LinkId link, uint8_t txPhy, uint8_t rxPhy) {
+    LinkStats& s = linkStats(link);
+    s.txPhy.store(txPhy, std::memory_order_relaxed);
+    s.rxPhy.store(rxPhy, std::memory_order_relaxed);
+}
+
+void linkStatsRecordDisconnect(LinkId link, int reason) {
+    LinkStats& s = linkStats(link);
+
+    s.disconnects.fetch_add(1, std::memory_order_relaxed);
+
+    // Disconnects come from a single task, so shifting the history is safe
+    for (int i = LINK_DISCONNECT_HISTORY - 1; i > 0; i--) {
+        s.disconnectReasons[i].store(s.disconnectReasons[i - 1].load(std::memory_order_relaxed),
+                                     std::memory_order_relaxed);
+    }
+    s.disconnectReasons[0].store(reason, std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+void linkStatsPrint(LinkId link) {
+    LinkStats& s = linkStats(link);
+
+    DEBUG_PRINTF("%s link:\n", linkName(link));
+    DEBUG_PRINTF("  Notifications: %lu  inter-arrival (ms):",
+                 (unsigned long)s.notifications.load(std::memory_order_relaxed));
+    for (int i = 0; i < LINK_HIST_BUCKETS; i++) {
+        if (i < LINK_HIST_BUCKETS - 1) {
+            DEBUG_PRINTF(" <=%u:%lu", LINK_HIST_BOUNDS_MS[i],
+                         (unsigned long)s.interArrival[i].load(std::memory_order_relaxed));
+        } else {
+            DEBUG_PRINTF(" >%u:%lu", LINK_HIST_BOUNDS_MS[i - 1],
+                         (unsigned long)s.interArrival[i].load(std::memory_order_relaxed));
+        }
+    }
+    DEBUG_PRINTLN();
+
+    DEBUG_PRINTF("  Writes: %lu submitted, %lu completed, %lu failed, %lu retries\n",
+                 (unsigned long)s.writesSubmitted.load(std::memory_order_relaxed),
+                 (unsigned long)s.writesCompleted.load(std::memory_order_relaxed),
+                 (unsigned long)s.writesFailed.load(std::memory_order_relaxed),
+                 (unsigned long)s.retries.load(std::memory_order_relaxed));
+
+    uint32_t samples = s.rssiSamples.load(std::memory_order_relaxed);
+    if (samples > 0) {
+        DEBUG_PRINTF("  RSSI: min %ld, avg %ld, max %ld dBm (%lu samples)\n",
+                     (long)s.rssiMin.load(std::memory_order_relaxed),
+                     (long)(s.rssiSum.load(std::memory_order_relaxed) / (int32_t)samples),
+                     (long)s.rssiMax.load(std::memory_order_relaxed),
+                     (unsigned long)samples);
+    } else {
+        DEBUG_PRINTLN("  RSSI: no samples");
+    }
+
+    DEBUG_PRINTF("  PHY tx/rx: %u/%u, conn param updates: %lu\n",
+                 s.txPhy.load(std::memory_order_relaxed),
+                 s.rxPhy.load(std::memory_order_relaxed),
+                 (unsigned long)s.connParamUpdates.load(std::memory_order_relaxed));
+
+    DEBUG_PRINTF("  Disconnects: %lu, recent reasons:",
+                 (unsigned long)s.disconnects.load(std::memory_order_relaxed));
+    for (int i = 0; i < LINK_DISCONNECT_HISTORY; i++) {
+        int32_t reason = s.disconnectReasons[i].load(std::memory_order_relaxed);
+        if (reason != 0) {
+            DEBUG_PRINTF(" 0x%03lx", (unsigned long)reason);
+        }
+    }
+    DEBUG_PRINTLN();
+}
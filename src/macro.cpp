@@ -0,0 +1,264 @@
+/**
+ * Macro Implementation
+ */
+
+#include <esp_heap_caps.h>
+#include "macro.h"
+
+// ============================================================================
+// MacroTrack Implementation
+// ============================================================================
+
+MacroTrack::MacroTrack()
+    : frames(nullptr)
+    , capacity(0)
+    , count(0)
+    , hash(MACRO_HASH_SEED)
+{
+}
+
+bool MacroTrack::init(uint32_t maxFrames) {
+    frames = (MacroFrame*)heap_caps_malloc(maxFrames * sizeof(MacroFrame), MALLOC_CAP_SPIRAM);
+    if (!frames) {
+        DEBUG_PRINTLN("[MACRO] ERROR: No PSRAM for the macro track");
+        return false;
+    }
+    capacity = maxFrames;
+    return true;
+}
+
+bool MacroTrack::isReady() const {
+    return frames != nullptr;
+}
+
+void MacroTrack::clear() {
+    count = 0;
+    hash = MACRO_HASH_SEED;
+}
+
+bool MacroTrack::append(const MacroFrame& frame) {
+    if (count >= capacity) {
+        return false;
+    }
+    frames[count++] = frame;
+    hash = macroHashFrame(hash, frame);
+    return true;
+}
+
+uint32_t MacroTrack::getCount() const {
+    return count;
+}
+
+uint32_t MacroTrack::getCapacity() const {
+    return capacity;
+}
+
+const MacroFrame& MacroTrack::getFrame(uint32_t index) const {
+    return frames[index];
+}
+
+uint32_t MacroTrack::getDurationUs() const {
+    return count ? frames[count - 1].offsetUs : 0;
+}
+
+uint32_t MacroTrack::getHash() const {
+    return hash;
+}
+
+// ============================================================================
+// MacroRecorder Implementation
+// ============================================================================
+
+MacroRecorder::MacroRecorder(MacroTrack& track)
+    : track(track)
+    , startUs(0)
+    , recording(false)
+{
+}
+
+bool MacroRecorder::start(uint32_t nowUs) {
+    if (!track.isReady()) {
+        return false;
+    }
+    track.clear();
+    startUs = nowUs;
+    recording = true;
+    return true;
+}
+
+bool MacroRecorder::record(const XboxControllerState& input, const MappedControls& controls, uint32_t nowUs) {
+    if (!recording) {
+        return false;
+    }
+
+    MacroFrame frame;
+    frame.offsetUs = nowUs - startUs;
+    frame.speed = controls.speed;
+    frame.steering = controls.steering;
+    frame.lights = controls.lights;
+    frame.stop = controls.emergencyStop ? 1 : 0;
+    xboxPackState(input, frame.input);
+
+    if (!track.append(frame)) {
+        recording = false;
+    }
+    return recording;
+}
+
+void MacroRecorder::stop() {
+    recording = false;
+}
+
+bool MacroRecorder::isRecording() const {
+    return recording;
+}
+
+// ============================================================================
+// MacroPlayer Implementation
+// ============================================================================
+
+MacroPlayer::MacroPlayer(MacroTrack& track)
+    : track(track)
+    , hub(nullptr)
+    , timer(nullptr)
+    , mux(portMUX_INITIALIZER_UNLOCKED)
+    , playing(false)
+    , next(0)
+    , startUs(0)
+    , hash(MACRO_HASH_SEED)
+    , writePending(false)
+    , pendingSubmitUs(0)
+    , pendingDueUs(0)
+{
+    resetStats();
+}
+
+bool MacroPlayer::init() {
+    esp_timer_create_args_t args = {};
+    args.callback = timerCB;
+    args.arg = this;
+    args.name = "macro";
+    if (esp_timer_create(&args, &timer) != ESP_OK) {
+        DEBUG_PRINTLN("[MACRO] ERROR: Failed to create playback timer");
+        timer = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool MacroPlayer::start(LegoHub* legoHub) {
+    if (!timer || playing || track.getCount() == 0) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&mux);
+    hub = legoHub;
+    next = 0;
+    hash = MACRO_HASH_SEED;
+    startUs = esp_timer_get_time() + MACRO_PLAY_LEAD_US - track.getFrame(0).offsetUs;
+    playing = true;
+    stats.plays++;
+    writePending = false;
+    esp_timer_start_once(timer, MACRO_PLAY_LEAD_US);
+    portEXIT_CRITICAL(&mux);
+    return true;
+}
+
+void MacroPlayer::stop() {
+    // playNext() checks and submits under the same mux, so once this
+    // returns no frame of the track reaches the hub any more
+    portENTER_CRITICAL(&mux);
+    playing = false;
+    esp_timer_stop(timer);
+    portEXIT_CRITICAL(&mux);
+}
+
+bool MacroPlayer::isPlaying() const {
+    return playing;
+}
+
+void MacroPlayer::recordTx() {
+    uint32_t txUs;
+    portENTER_CRITICAL(&mux);
+    if (writePending && hub->isControlSentSince(pendingSubmitUs, txUs)) {
+        uint32_t errorUs = txUs - pendingDueUs;
+        stats.writeErrorCount++;
+        stats.writeErrorSumUs += errorUs;
+        if (errorUs > stats.writeErrorMaxUs) {
+            stats.writeErrorMaxUs = errorUs;
+        }
+        writePending = false;
+    }
+    portEXIT_CRITICAL(&mux);
+}
+
+MacroPlaybackStats MacroPlayer::getStats() {
+    portENTER_CRITICAL(&mux);
+    MacroPlaybackStats copy = stats;
+    portEXIT_CRITICAL(&mux);
+    return copy;
+}
+
+void MacroPlayer::resetStats() {
+    portENTER_CRITICAL(&mux);
+    memset(&stats, 0, sizeof(stats));
+    portEXIT_CRITICAL(&mux);
+}
+
+void MacroPlayer::playNext() {
+    // Runs on the esp_timer task, racing stop() on the loop: the playing
+    // check, the submission and the re-arm all happen under the mux.
+    // Submitting only takes the hub's own spinlock, so this stays short.
+    portENTER_CRITICAL(&mux);
+    if (!playing) {
+        portEXIT_CRITICAL(&mux);
+        return;
+    }
+    if (!hub->isReady()) {
+        playing = false;
+        portEXIT_CRITICAL(&mux);
+        return;
+    }
+
+    const MacroFrame& frame = track.getFrame(next);
+    int64_t dueUs = startUs + frame.offsetUs;
+    int64_t nowUs = esp_timer_get_time();
+
+    if (frame.stop) {
+        hub->emergencyStop();
+    } else {
+        hub->sendDrive(frame.speed, frame.steering, frame.lights);
+    }
+    hash = macroHashFrame(hash, frame);
+
+    uint32_t timerErrorUs = nowUs > dueUs ? (uint32_t)(nowUs - dueUs) : 0;
+    bool finished = ++next >= track.getCount();
+
+    stats.frames++;
+    stats.timerErrorCount++;
+    stats.timerErrorSumUs += timerErrorUs;
+    if (timerErrorUs > stats.timerErrorMaxUs) {
+        stats.timerErrorMaxUs = timerErrorUs;
+    }
+    writePending = true;
+    pendingSubmitUs = (uint32_t)nowUs;
+    pendingDueUs = (uint32_t)dueUs;
+    if (finished) {
+        stats.completed++;
+        if (hash == track.getHash()) {
+            stats.hashMatches++;
+        }
+        playing = false;
+        portEXIT_CRITICAL(&mux);
+        return;
+    }
+
+    // Against the start time, so lateness does not accumulate
+    int64_t waitUs = startUs + track.getFrame(next).offsetUs - esp_timer_get_time();
+    esp_timer_start_once(timer, waitUs > 0 ? (uint64_t)waitUs : 0);
+    portEXIT_CRITICAL(&mux);
+}
+
+void MacroPlayer::timerCB(void* arg) {
+    static_cast<MacroPlayer*>(arg)->playNext();
+}
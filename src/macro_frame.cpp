@@ -0,0 +1,74 @@
+/**
+ * Macro Frame Implementation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "macro_frame.h"
+
+#define FNV_PRIME 16777619UL
+
+static inline uint32_t hashByte(uint32_t hash, uint8_t byte) {
+    return (hash ^ byte) * FNV_PRIME;
+}
+
+uint32_t macroHashFrame(uint32_t hash, const MacroFrame& frame) {
+    // Field by field, little-endian - independent of struct layout
+    for (int shift = 0; shift < 32; shift += 8) {
+        hash = hashByte(hash, (uint8_t)(frame.offsetUs >> shift));
+    }
+    hash = hashByte(hash, (uint8_t)frame.speed);
+    hash = hashByte(hash, (uint8_t)frame.steering);
+    hash = hashByte(hash, frame.lights);
+    return hashByte(hash, frame.stop);
+}
+
+int macroFormatFrame(char* buffer, size_t size, const MacroFrame& frame) {
+    const XboxPackedState& in = frame.input;
+    return snprintf(buffer, size, "%lu,%d,%d,%u,%u,%u,%d,%d,%d,%d,%u,%u",
+                    (unsigned long)frame.offsetUs,
+                    frame.speed, frame.steering, frame.lights, frame.stop,
+                    in.buttons, in.left_stick_x, in.left_stick_y,
+                    in.right_stick_x, in.right_stick_y, in.left_trigger, in.right_trigger);
+}
+
+int macroFormatTrailer(char* buffer, size_t size, uint32_t count, uint32_t hash) {
+    return snprintf(buffer, size, "# %lu frames, hash 0x%08lx",
+                    (unsigned long)count, (unsigned long)hash);
+}
+
+bool macroParseFrame(const char* line, MacroFrame& frame) {
+    unsigned long offsetUs;
+    int speed, steering, lx, ly, rx, ry;
+    unsigned lights, stop, buttons, lt, rt;
+    if (sscanf(line, "%lu,%d,%d,%u,%u,%u,%d,%d,%d,%d,%u,%u",
+               &offsetUs, &speed, &steering, &lights, &stop,
+               &buttons, &lx, &ly, &rx, &ry, &lt, &rt) != 12) {
+        return false;
+    }
+
+    memset(&frame, 0, sizeof(frame));
+    frame.offsetUs = (uint32_t)offsetUs;
+    frame.speed = (int8_t)speed;
+    frame.steering = (int8_t)steering;
+    frame.lights = (uint8_t)lights;
+    frame.stop = (uint8_t)stop;
+    frame.input.buttons = (uint16_t)buttons;
+    frame.input.left_stick_x = (int16_t)lx;
+    frame.input.left_stick_y = (int16_t)ly;
+    frame.input.right_stick_x = (int16_t)rx;
+    frame.input.right_stick_y = (int16_t)ry;
+    frame.input.left_trigger = (uint16_t)lt;
+    frame.input.right_trigger = (uint16_t)rt;
+    return true;
+}
+
+bool macroParseTrailer(const char* line, uint32_t& count, uint32_t& hash) {
+    unsigned long frames, value;
+    if (sscanf(line, "# %lu frames, hash 0x%lx", &frames, &value) != 2) {
+        return false;
+    }
+    count = (uint32_t)frames;
+    hash = (uint32_t)value;
+    return true;
+}
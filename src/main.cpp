@@ -10,18 +10,35 @@
 
 #include <Arduino.h>
 #include <NimBLEDevice.h>
+#include <Preferences.h>
 #include "config.h"
 #include "ble_manager.h"
+#include "lego_hub.h"
+#include "link_stats.h"
+#include "xbox_controller.h"
+#include "xbox_usb.h"
+#include "control_mapper.h"
+#include "hub_benchmark.h"
+#include "status_led.h"
+#include "display.h"
+#include "serial_input.h"
+#include "power_manager.h"
+#include "seqlock_bench.h"
+#include "hot_path_bench.h"
+#include "session_log.h"
+#include "stick_drift.h"
+#include "macro.h"
+#include "conn_planner.h"
 
 // ============================================================================
 // Global Variables
 // ============================================================================
 
 // Application state
+// Peers are connected and set up during SCANNING as soon as each is found
 enum class AppState {
     INIT,
     SCANNING,
-    CONNECTING,
     CONNECTED,
     ACTIVE,
     ERROR
@@ -29,11 +46,103 @@ enum class AppState {
 
 AppState currentState = AppState::INIT;
 unsigned long lastControlUpdate = 0;
+unsigned long controlPeriodMs = CONTROL_LOOP_PERIOD_MS;  // Follows the hub's drive-frame rate
 unsigned long lastDisplayUpdate = 0;
 
+// CPU clock / light-sleep policy, follows currentState
+PowerManager* powerManager = nullptr;
+
+// Status LED (timer-driven, patterns in status_led.h)
+StatusLed* statusLed = nullptr;
+
+// OLED status display (optional, rendered and pushed by its own task)
+Display* display = nullptr;
+
+// Session log on flash (staged in RAM, written by its own task)
+SessionLog* sessionLog = nullptr;
+
 // BLE Manager instance
 BLEManager* bleManager = nullptr;
 
+// Lego hub link (owns the hub's TX scheduler)
+LegoHub* legoHub = nullptr;
+
+// Xbox controller input (BLE or wired USB, see XBOX_INPUT_USB) and mapping
+#if XBOX_INPUT_USB
+XboxUsbController* xboxController = nullptr;
+#else
+XboxController* xboxController = nullptr;
+#endif
+ControlMapper* controlMapper = nullptr;
+MappedControls lastControls = {};  // Most recent output, for the display
+
+// Left-stick drift estimate, saved per controller while the stick rests
+StickDriftEstimator* stickDrift = nullptr;
+char stickDriftKey[16] = "";          // NVS key of the connected controller
+uint32_t stickDriftSavedSamples = 0;
+unsigned long lastStickDriftSaveMs = 0;
+bool stickDriftSaveDue = false;       // Set in the control frame, written after it
+
+// PC input: binary controller frames on the serial port, with their own mapper
+// (light toggles are edge-triggered per source)
+SerialInputParser* serialInput = nullptr;
+ControlMapper* pcMapper = nullptr;
+uint32_t pcFrameCount = 0;        // Last frame handed to the hub
+uint32_t pcFrameStartUs = 0;      // Its first byte, for serial -> hub write latency
+uint32_t pcSubmitUs = 0;
+bool pcLatencyPending = false;
+
+// Control macros (serial 'macro ...'): a playing macro owns the car
+MacroTrack* macroTrack = nullptr;
+MacroRecorder* macroRecorder = nullptr;
+MacroPlayer* macroPlayer = nullptr;
+
+// Connection intervals for the two links, replanned on collisions
+ConnPlanner* connPlanner = nullptr;
+unsigned long lastConnPlanCheckMs = 0;
+
+// Hub command-rate benchmark (serial 'bench hub'), suspends control while running
+HubBenchmark* hubBenchmark = nullptr;
+
+// Peer bring-up: connect, then discover/subscribe, each a queued GATT
+// operation polled from the loop
+enum class BringUpStage : uint8_t {
+    IDLE,
+    CONNECTING,
+    SETTING_UP
+};
+
+struct PeerBringUp {
+    BringUpStage stage;
+    GattFuture future;
+    PeerBringUp() : stage(BringUpStage::IDLE) {}
+};
+
+PeerBringUp xboxBringUp;
+PeerBringUp legoBringUp;
+GattFuture batteryRefresh;                // Periodic Xbox battery read
+unsigned long lastBatteryRefreshMs = 0;
+
+// Connect-as-found pipeline timing (millis(), 0 = not reached yet)
+struct PipelineTiming {
+    unsigned long scanStartMs;
+    unsigned long firstFoundMs;
+    unsigned long bothFoundMs;
+    unsigned long firstLinkUpMs;
+    unsigned long firstFrameMs;
+    unsigned long activeMs;
+};
+PipelineTiming pipelineTiming;
+
+// Stages of the last control frame, traced to the session log if it was slow
+struct FrameTrace {
+    uint32_t lateUs;      // Due -> loop picked it up
+    uint32_t startUs;
+    uint32_t submitUs;    // Mapped and handed to the hub
+    bool pending;
+};
+FrameTrace frameTrace = {};
+
 // ============================================================================
 // Function Prototypes
 // ============================================================================
@@ -42,9 +151,41 @@ void setup();
 void loop();
 void initBLE();
 void startScanning();
+#if !XBOX_INPUT_USB
+void updateXboxBringUp();
+bool setupXboxOp(void* context);
+bool refreshXboxBatteryOp(void* context);
+void updateConnPlan();
+void printConnPlan();
+#endif
+void updateLegoBringUp();
+bool setupLegoOp(void* context);
+bool isBringUpIdle();
+void printGattQueue(GattQueue& queue);
+void updatePipelineTiming();
+void printPipelineTiming();
 void updateControlLoop();
+void recordSerialInputLatency();
+void traceSlowFrame();
+void onGattTrace(const char* queue, const char* op, GattOpStatus status, uint32_t waitUs, uint32_t runUs);
+void loadStickDrift();
+void saveStickDrift();
+void forgetStickDrift();
+void startHubBenchmark();
+void runHubBenchmark();
+void printHubBenchmark();
+void onHubFeedback(const uint8_t* data, size_t length);
+void runSeqlockBenchmark();
+void runHotPathBenchmark();
+void runMacroCommand(const char* command);
+void printMacroStatus();
+PowerMode powerModeFor(AppState state);
+const char* appStateName(AppState state);
+void logSessionSnapshot();
 void updateDisplay();
 void updateSerial();
+void handleSerialCommands();
+void runSerialCommand(const char* command);
 void handleError(ErrorCode error);
 
 // ============================================================================
@@ -65,9 +206,42 @@ void setup() {
     DEBUG_PRINTLN("Board: " BOARD_NAME);
     DEBUG_PRINTLN("========================================");
 
+    // Power management first - setup runs at full clock with the locks held
+    powerManager = new PowerManager();
+    powerManager->init();
+
     // Initialize built-in LED
-    pinMode(LED_BUILTIN, OUTPUT);
-    digitalWrite(LED_BUILTIN, LOW);
+    statusLed = new StatusLed();
+    statusLed->init(LED_BUILTIN);
+
+    // Initialize display (optional - runs without one)
+    display = new Display();
+    display->init();
+
+    // Session log (optional - runs without flash)
+    sessionLog = new SessionLog();
+    if (SESSION_LOG_ENABLED && sessionLog->init()) {
+        sessionLog->log("boot %s %s", PROJECT_NAME, PROJECT_VERSION);
+    }
+
+    stickDrift = new StickDriftEstimator();
+    connPlanner = new ConnPlanner();
+
+    // Macro track in PSRAM (optional - commands refuse without one)
+    macroTrack = new MacroTrack();
+    if (MACRO_ENABLED) {
+        macroTrack->init(MACRO_MAX_FRAMES);
+    }
+    macroRecorder = new MacroRecorder(*macroTrack);
+    macroPlayer = new MacroPlayer(*macroTrack);
+    macroPlayer->init();
+
+    // PC input parser (fed from handleSerialCommands)
+    serialInput = new SerialInputParser();
+    pcMapper = new ControlMapper();
+
+    // Start link statistics from a clean slate (sets RSSI min/max sentinels)
+    linkStatsResetAll();
 
     // Initialize BLE
     DEBUG_PRINTLN("\n[INIT] Initializing BLE...");
@@ -106,6 +280,17 @@ void loop() {
         lastSerialUpdate = currentMillis;
     }
 
+    handleSerialCommands();
+
+    static unsigned long lastSnapshot = 0;
+    if (currentMillis - lastSnapshot >= SESSION_LOG_SNAPSHOT_MS) {
+        logSessionSnapshot();
+        lastSnapshot = currentMillis;
+    }
+
+    // Full clock while a link is up or coming up, scaled down otherwise
+    powerManager->setMode(powerModeFor(currentState));
+
     // State machine
     switch (currentState) {
         case AppState::INIT:
@@ -114,85 +299,66 @@ void loop() {
 
         case AppState::SCANNING:
             // Scanning is handled by BLE callbacks
-            // Just blink LED to show we're alive
-            static unsigned long lastBlink = 0;
-            if (currentMillis - lastBlink > 500) {
-                digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
-                lastBlink = currentMillis;
-            }
-
-            // Check if scan is complete and devices found
-            if (bleManager && !bleManager->isScanning()) {
-                if (bleManager->foundBothDevices()) {
-                    DEBUG_PRINTLN("\n[SCAN] Both devices found! Attempting connections...");
-                    currentState = AppState::CONNECTING;
-                } else {
-                    // Scan complete but devices not found
-                    DEBUG_PRINTLN("\n[SCAN] Scan complete - devices missing:");
-                    if (!bleManager->foundXbox()) {
-                        DEBUG_PRINTLN("[SCAN]   - Xbox controller NOT FOUND");
-                    }
-                    if (!bleManager->foundLego()) {
-                        DEBUG_PRINTLN("[SCAN]   - Lego hub NOT FOUND");
-                    }
-                    DEBUG_PRINTLN("[SCAN] Restarting scan in 3 seconds...");
-                    delay(3000);
-                    startScanning();
-                }
+            if (!bleManager) {
+                statusLed->setPattern(LED_PATTERN_SCANNING);
+                break;
             }
-            break;
 
-        case AppState::CONNECTING: {
-            // Solid LED during connection
-            digitalWrite(LED_BUILTIN, HIGH);
+            // Connect, discover and subscribe to each peer the moment it is
+            // identified - scanning resumes for the other one afterwards.
+            // Each step runs on the peer's GATT queue; the loop only polls.
+            // Failed attempts are retried with backoff by the BLE manager.
+            updatePipelineTiming();
+#if !XBOX_INPUT_USB
+            updateXboxBringUp();
+#endif
+            updateLegoBringUp();
 
-            // Attempt to connect to both devices
-            static bool connectingStarted = false;
-            if (!connectingStarted) {
-                connectingStarted = true;
+            // One pattern per pass, from the bring-up stage
+            statusLed->setPattern(isBringUpIdle() ? LED_PATTERN_SCANNING : LED_PATTERN_CONNECTING);
 
-                DEBUG_PRINTLN("\n[CONN] Connecting to Xbox controller...");
-                bool xboxConnected = bleManager->connectToXbox();
-
-                if (xboxConnected) {
-                    DEBUG_PRINTLN("[CONN] Xbox controller connected!");
-                    // Give BLE stack time to stabilize before second connection
-                    DEBUG_PRINTLN("[CONN] Waiting for BLE stack to stabilize...");
-                    delay(1000);  // 1 second delay
-                } else {
-                    DEBUG_PRINTLN("[CONN] ERROR: Failed to connect to Xbox controller");
-                    handleError(ERR_XBOX_CONNECT_FAILED);
-                    connectingStarted = false;
-                    break;
-                }
+            if (bleManager->areBothConnected() && isBringUpIdle()) {
+                bleManager->stopScan();
+                sessionLog->log("scan stop");
+                currentState = AppState::CONNECTED;
+                break;
+            }
 
-                DEBUG_PRINTLN("\n[CONN] Connecting to Lego hub...");
-                bool legoConnected = bleManager->connectToLego();
-
-                if (legoConnected) {
-                    DEBUG_PRINTLN("[CONN] Lego hub connected!");
-                    currentState = AppState::CONNECTED;
-                } else {
-                    DEBUG_PRINTLN("[CONN] ERROR: Failed to connect to Lego hub");
-                    handleError(ERR_LEGO_CONNECT_FAILED);
+            // Check if scan is complete with devices still missing (a device
+            // whose retries are exhausted counts as missing again). A scan
+            // paused for a connect, or any bring-up still running, is not.
+            if (!bleManager->isScanning() && isBringUpIdle() &&
+                !bleManager->foundBothDevices()) {
+                DEBUG_PRINTLN("\n[SCAN] Scan complete - devices missing:");
+                sessionLog->log("scan stop");
+                if (!bleManager->foundXbox()) {
+                    DEBUG_PRINTLN("[SCAN]   - Xbox controller NOT FOUND");
                 }
-
-                connectingStarted = false;
+                if (!bleManager->foundLego()) {
+                    DEBUG_PRINTLN("[SCAN]   - Lego hub NOT FOUND");
+                }
+                DEBUG_PRINTLN("[SCAN] Restarting scan in 3 seconds...");
+                delay(3000);
+                startScanning();
             }
             break;
-        }
 
         case AppState::CONNECTED:
-            // Devices connected, ready to start control loop
+            // Devices connected and set up, ready to start control loop
             DEBUG_PRINTLN("[STATE] Devices connected! Starting control loop...");
             currentState = AppState::ACTIVE;
-            digitalWrite(LED_BUILTIN, HIGH);
+            statusLed->setPattern(LED_PATTERN_ACTIVE);
+            loadStickDrift();
+            connPlanner->reset();
+            lastConnPlanCheckMs = 0;
+            pipelineTiming.activeMs = millis();
+            printPipelineTiming();
             break;
 
         case AppState::ACTIVE:
-            // Check for disconnections
+            // Check for disconnections (an unplugged USB pad just reads neutral)
             if (bleManager) {
-                if (!bleManager->isXboxConnected()) {
+                if (!XBOX_INPUT_USB && !bleManager->isXboxConnected()) {
                     DEBUG_PRINTLN("\n[ERROR] Xbox controller disconnected!");
                     handleError(ERR_XBOX_DISCONNECTED);
                     break;
@@ -204,12 +370,43 @@ void loop() {
                 }
             }
 
-            // Main control loop
-            if (currentMillis - lastControlUpdate >= CONTROL_LOOP_PERIOD_MS) {
+            // Main control loop, at the hub's adaptive drive-frame rate
+            // (the benchmark owns the hub while it runs)
+            controlPeriodMs = legoHub->getDriveIntervalMs();
+            if (hubBenchmark->isRunning()) {
+                lastControlUpdate = currentMillis;
+            } else if (currentMillis - lastControlUpdate >= controlPeriodMs) {
+                // Anything beyond one period is lateness - back off standby scanning
+                unsigned long lateMs = currentMillis - lastControlUpdate - controlPeriodMs;
+                bleManager->reportControlLateness(lateMs);
+                frameTrace.lateUs = lateMs * 1000;
                 updateControlLoop();
                 lastControlUpdate = currentMillis;
             }
 
+            // Sample per-link RSSI
+            bleManager->updateLinkStats();
+
+            // Keep the advert cache fresh for instant failover
+            bleManager->updateStandbyScan();
+
+#if !XBOX_INPUT_USB
+            // Re-read the battery on the controller's GATT queue, behind
+            // anything more urgent
+            if (currentMillis - lastBatteryRefreshMs >= XBOX_BATTERY_REFRESH_MS) {
+                lastBatteryRefreshMs = currentMillis;
+                GattOp op = { "battery", refreshXboxBatteryOp, nullptr, GattPriority::BACKGROUND,
+                              GATT_HOUSEKEEPING_WAIT_MS, &batteryRefresh, nullptr };
+                bleManager->getXboxQueue().submit(op);
+            }
+
+            // Keep the two links' connection events apart
+            if (CONN_PLAN_ENABLED && currentMillis - lastConnPlanCheckMs >= CONN_PLAN_CHECK_MS) {
+                lastConnPlanCheckMs = currentMillis;
+                updateConnPlan();
+            }
+#endif
+
             // Display update (less frequent)
             if (currentMillis - lastDisplayUpdate >= DISPLAY_UPDATE_PERIOD_MS) {
                 lastDisplayUpdate = currentMillis;
@@ -217,17 +414,63 @@ void loop() {
             break;
 
         case AppState::ERROR:
-            // Error state - blink LED rapidly
-            static unsigned long lastErrorBlink = 0;
-            if (currentMillis - lastErrorBlink > 100) {
-                digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
-                lastErrorBlink = currentMillis;
-            }
+            // Error state - the LED blinks the error code (set in handleError)
             break;
     }
 
-    // Small delay to prevent watchdog issues
-    delay(1);
+    static AppState loggedState = AppState::INIT;
+    if (currentState != loggedState) {
+        sessionLog->log("state %s -> %s", appStateName(loggedState), appStateName(currentState));
+        if (loggedState == AppState::ACTIVE) {
+            saveStickDrift();
+        }
+        loggedState = currentState;
+    }
+
+    // Transmit the highest-priority pending hub frame (the hub link can be
+    // up while still scanning for the controller)
+    if (hubBenchmark && hubBenchmark->isRunning()) {
+        runHubBenchmark();
+    } else if (legoHub) {
+        legoHub->service();
+        recordSerialInputLatency();
+        traceSlowFrame();
+        if (stickDriftSaveDue && !frameTrace.pending) {
+            saveStickDrift();
+        }
+        if (macroPlayer->isPlaying()) {
+            macroPlayer->recordTx();
+        }
+    }
+
+    // Small delay to prevent watchdog issues (longer when idle, so the
+    // chip can light-sleep)
+    powerManager->loopDelay();
+}
+
+const char* appStateName(AppState state) {
+    switch (state) {
+        case AppState::INIT:      return "INIT";
+        case AppState::SCANNING:  return "SCANNING";
+        case AppState::CONNECTED: return "CONNECTED";
+        case AppState::ACTIVE:    return "ACTIVE";
+        default:                  return "ERROR";
+    }
+}
+
+PowerMode powerModeFor(AppState state) {
+    // A connect in progress or a live link needs the full clock in any
+    // state; only pure discovery and the error state may scale down
+    if (bleManager && (!isBringUpIdle() ||
+                       bleManager->isXboxConnected() || bleManager->isLegoConnected())) {
+        return PowerMode::DRIVE;
+    }
+
+    switch (state) {
+        case AppState::SCANNING: return PowerMode::SCAN;
+        case AppState::ERROR:    return PowerMode::IDLE;
+        default:                 return PowerMode::DRIVE;
+    }
 }
 
 // ============================================================================
@@ -249,6 +492,19 @@ void initBLE() {
     // Initialize BLE manager
     bleManager->init();
 
+    // Peer modules are initialized as each device connects
+    legoHub = new LegoHub(bleManager->getLegoQueue());
+#if XBOX_INPUT_USB
+    xboxController = new XboxUsbController();
+    xboxController->init();
+#else
+    xboxController = new XboxController();
+#endif
+    controlMapper = new ControlMapper();
+    hubBenchmark = new HubBenchmark();
+    legoHub->setFeedbackHandler(onHubFeedback);
+    GattQueue::setTraceHandler(onGattTrace);
+
     DEBUG_PRINTLN("[BLE] BLE Manager initialized successfully");
 }
 
@@ -264,45 +520,739 @@ void startScanning() {
     }
 
     DEBUG_PRINTLN("[SCAN] Starting device scan...");
+    sessionLog->log("scan start");
+    if (!bleManager->isXboxConnected() && !bleManager->isLegoConnected()) {
+        // Fresh session - restart the pipeline timing
+        memset(&pipelineTiming, 0, sizeof(pipelineTiming));
+        pipelineTiming.scanStartMs = millis();
+    }
     bleManager->startScan(BLE_SCAN_DURATION);
 }
 
+// ============================================================================
+// Peer Bring-up (connect, discover, subscribe)
+// ============================================================================
+
+#if !XBOX_INPUT_USB
+void updateXboxBringUp() {
+    PeerBringUp& bringUp = xboxBringUp;
+
+    switch (bringUp.stage) {
+        case BringUpStage::IDLE:
+            if (!bleManager->isXboxConnected() && bleManager->isXboxRetryDue()
+                && bleManager->startXboxConnect(&bringUp.future)) {
+                DEBUG_PRINTLN("\n[CONN] Connecting to Xbox controller...");
+                bringUp.stage = BringUpStage::CONNECTING;
+            }
+            break;
+
+        case BringUpStage::CONNECTING: {
+            if (!bringUp.future.isDone()) {
+                break;
+            }
+            bringUp.stage = BringUpStage::IDLE;
+            if (bringUp.future.get() == GattOpStatus::CANCELLED) {
+                break;  // Links were reset underneath us
+            }
+            if (!bleManager->finishXboxConnect(bringUp.future)) {
+                DEBUG_PRINTLN("[CONN] Failed to connect to Xbox controller");
+                break;
+            }
+
+            GattOp setup = { "setup", setupXboxOp, nullptr, GattPriority::NORMAL,
+                             GATT_SETUP_WAIT_MS, &bringUp.future, nullptr };
+            if (!bleManager->getXboxQueue().submit(setup)) {
+                bleManager->abortXboxConnection();
+                break;
+            }
+            bringUp.stage = BringUpStage::SETTING_UP;
+            break;
+        }
+
+        case BringUpStage::SETTING_UP:
+            if (!bringUp.future.isDone()) {
+                break;
+            }
+            bringUp.stage = BringUpStage::IDLE;
+            if (bringUp.future.get() != GattOpStatus::OK) {
+                DEBUG_PRINTF("[CONN] ERROR: Xbox controller setup %s\n",
+                            gattOpStatusName(bringUp.future.get()));
+                if (bringUp.future.get() != GattOpStatus::CANCELLED) {
+                    bleManager->abortXboxConnection();
+                }
+                break;
+            }
+
+            DEBUG_PRINTF("[CONN] Xbox controller ready! (setup %lu ms)\n",
+                        (unsigned long)(bringUp.future.runUs / 1000));
+            sessionLog->log("xbox ready, setup %lu ms", (unsigned long)(bringUp.future.runUs / 1000));
+            if (pipelineTiming.firstLinkUpMs == 0) {
+                pipelineTiming.firstLinkUpMs = millis();
+            }
+            break;
+    }
+}
+
+bool setupXboxOp(void* context) {
+    return xboxController->init(bleManager->getXboxClient());
+}
+
+void updateConnPlan() {
+    xboxController->refreshConnInterval();
+    ConnEventPhase xbox = xboxController->getConnEventPhase();
+    ConnEventPhase lego = legoHub->getConnEventPhase();
+    if (!connPlanner->check(xbox, lego, millis())) {
+        return;
+    }
+
+    ConnPlan plan = connPlanner->getPlan();
+    DEBUG_PRINTF("[BLE] Connection plan %u: Xbox %u.%02u ms, hub %u.%02u ms\n",
+                connPlanner->getPlanIndex(),
+                plan.xboxInterval * 125 / 100, plan.xboxInterval * 125 % 100,
+                plan.legoInterval * 125 / 100, plan.legoInterval * 125 % 100);
+    sessionLog->log("plan %u xbox=%u lego=%u sep=%lu", connPlanner->getPlanIndex(),
+                    plan.xboxInterval, plan.legoInterval,
+                    (unsigned long)connPlanner->getStats().separationUs);
+    bleManager->requestConnIntervals(plan.xboxInterval, plan.legoInterval);
+    connPlanner->planRequested(millis());
+}
+
+void printConnPlan() {
+    ConnPlan plan = connPlanner->getPlan();
+    const ConnPlanStats& s = connPlanner->getStats();
+    DEBUG_PRINTF("Plan %u (Xbox %u.%02u ms, hub %u.%02u ms): %s\n",
+                connPlanner->getPlanIndex(),
+                plan.xboxInterval * 125 / 100, plan.xboxInterval * 125 % 100,
+                plan.legoInterval * 125 / 100, plan.legoInterval * 125 % 100,
+                connPlanVerdictName(connPlanner->getVerdict()));
+    if (s.checks != 0) {
+        DEBUG_PRINTF("Event separation: last %lu us, min %lu us (guard %d us)\n",
+                    (unsigned long)s.separationUs,
+                    (unsigned long)s.minSeparationUs,
+                    CONN_PLAN_GUARD_US);
+    }
+    DEBUG_PRINTF("%lu checks, %lu overlaps, %lu skip bursts, %lu off-plan, %lu replans\n",
+                (unsigned long)s.checks,
+                (unsigned long)s.overlaps,
+                (unsigned long)s.skipBursts,
+                (unsigned long)s.mismatches,
+                (unsigned long)s.replans);
+
+    ConnEventStats xbox = xboxController->getConnEventStats();
+    ConnEventStats lego = legoHub->getConnEventStats();
+    DEBUG_PRINTF("Skipped events: Xbox %lu (jitter %lu us), hub %lu (jitter %lu us)\n",
+                (unsigned long)xbox.skipped,
+                (unsigned long)xbox.jitterUs,
+                (unsigned long)lego.skipped,
+                (unsigned long)lego.jitterUs);
+}
+
+bool refreshXboxBatteryOp(void* context) {
+    return xboxController->refreshBatteryLevel();
+}
+#endif
+
+void updateLegoBringUp() {
+    PeerBringUp& bringUp = legoBringUp;
+
+    switch (bringUp.stage) {
+        case BringUpStage::IDLE:
+            // A hub that dropped while scanning (no ERR_LEGO_DISCONNECTED
+            // outside ACTIVE) lets go of its link here, before the next
+            // connect rediscovers the characteristic
+            if (!bleManager->isLegoConnected() && legoHub->hasLink()) {
+                DEBUG_PRINTLN("[CONN] Lego hub link lost");
+                legoHub->reset();
+            }
+            if (!bleManager->isLegoConnected() && bleManager->isLegoRetryDue()
+                && bleManager->startLegoConnect(&bringUp.future)) {
+                DEBUG_PRINTLN("\n[CONN] Connecting to Lego hub...");
+                bringUp.stage = BringUpStage::CONNECTING;
+            }
+            break;
+
+        case BringUpStage::CONNECTING: {
+            if (!bringUp.future.isDone()) {
+                break;
+            }
+            bringUp.stage = BringUpStage::IDLE;
+            if (bringUp.future.get() == GattOpStatus::CANCELLED) {
+                break;
+            }
+            if (!bleManager->finishLegoConnect(bringUp.future)) {
+                DEBUG_PRINTLN("[CONN] Failed to connect to Lego hub");
+                break;
+            }
+
+            GattOp setup = { "setup", setupLegoOp, nullptr, GattPriority::NORMAL,
+                             GATT_SETUP_WAIT_MS, &bringUp.future, nullptr };
+            if (!bleManager->getLegoQueue().submit(setup)) {
+                bleManager->abortLegoConnection();
+                break;
+            }
+            bringUp.stage = BringUpStage::SETTING_UP;
+            break;
+        }
+
+        case BringUpStage::SETTING_UP:
+            if (!bringUp.future.isDone()) {
+                break;
+            }
+            bringUp.stage = BringUpStage::IDLE;
+            if (bringUp.future.get() != GattOpStatus::OK) {
+                DEBUG_PRINTF("[CONN] ERROR: Lego hub setup %s\n",
+                            gattOpStatusName(bringUp.future.get()));
+                if (bringUp.future.get() != GattOpStatus::CANCELLED) {
+                    bleManager->abortLegoConnection();
+                }
+                break;
+            }
+
+            // Calibration goes out now, while the controller may still be missing
+            legoHub->calibrateSteering();
+
+            DEBUG_PRINTF("[CONN] Lego hub ready! (setup %lu ms)\n",
+                        (unsigned long)(bringUp.future.runUs / 1000));
+            sessionLog->log("lego ready, setup %lu ms", (unsigned long)(bringUp.future.runUs / 1000));
+            if (pipelineTiming.firstLinkUpMs == 0) {
+                pipelineTiming.firstLinkUpMs = millis();
+            }
+            break;
+    }
+}
+
+bool setupLegoOp(void* context) {
+    return legoHub->init(bleManager->getLegoClient());
+}
+
+bool isBringUpIdle() {
+    return xboxBringUp.stage == BringUpStage::IDLE && legoBringUp.stage == BringUpStage::IDLE;
+}
+
+void updatePipelineTiming() {
+    bool xbox = XBOX_INPUT_USB || bleManager->foundXbox();
+    bool lego = bleManager->foundLego();
+
+    if (pipelineTiming.firstFoundMs == 0 && (xbox || lego)) {
+        pipelineTiming.firstFoundMs = millis();
+    }
+    if (pipelineTiming.bothFoundMs == 0 && xbox && lego) {
+        pipelineTiming.bothFoundMs = millis();
+    }
+    if (pipelineTiming.firstFrameMs == 0) {
+        pipelineTiming.firstFrameMs = legoHub->getFirstTxMs();
+    }
+}
+
+void printPipelineTiming() {
+    const PipelineTiming& t = pipelineTiming;
+    if (t.scanStartMs == 0 || t.activeMs == 0) {
+        return;
+    }
+
+    DEBUG_PRINTF("First found: +%lu ms, both found: +%lu ms\n",
+                 t.firstFoundMs ? t.firstFoundMs - t.scanStartMs : 0,
+                 t.bothFoundMs ? t.bothFoundMs - t.scanStartMs : 0);
+    DEBUG_PRINTF("First link up: +%lu ms, first hub frame: +%lu ms, active: +%lu ms\n",
+                 t.firstLinkUpMs ? t.firstLinkUpMs - t.scanStartMs : 0,
+                 t.firstFrameMs ? t.firstFrameMs - t.scanStartMs : 0,
+                 t.activeMs - t.scanStartMs);
+
+    // Connecting only after both were found could not have sent anything before bothFoundMs
+    if (t.firstFrameMs != 0 && t.bothFoundMs != 0 && t.firstFrameMs < t.bothFoundMs) {
+        DEBUG_PRINTF("First hub frame went out %lu ms before both devices were found\n",
+                     t.bothFoundMs - t.firstFrameMs);
+    }
+}
+
 // ============================================================================
 // Control Loop Update
 // ============================================================================
 
 void updateControlLoop() {
-    // TODO: Read Xbox controller state
-    // TODO: Map inputs to Lego controls
-    // TODO: Send commands to Lego hub
+    // Read the latest controller state and map it to car controls
+    frameTrace.startUs = micros();
+    XboxControllerState input = xboxController->getState();
+    if (STICK_DRIFT_ENABLED) {
+        stickDrift->update(input);
+        controlMapper->setStickCalibration(stickDrift->getCalibration());
+
+        // NVS writes stall flash access for a few ms - only with the car
+        // stopped, and never inside the frame (loop() writes it once the
+        // frame is out)
+        if (stickDrift->isResting() && millis() - lastStickDriftSaveMs >= STICK_DRIFT_SAVE_MS) {
+            stickDriftSaveDue = true;
+        }
+    }
+    MappedControls controls = controlMapper->map(input);
+
+    // PC frames take over while they keep arriving - the controller's
+    // emergency stop still applies
+    uint32_t nowUs = micros();
+    if (SERIAL_INPUT_ENABLED && serialInput->isFresh(nowUs, SERIAL_INPUT_TIMEOUT_MS * 1000UL)) {
+        bool controllerStop = controls.emergencyStop;
+        input = serialInput->getState();
+        controls = pcMapper->map(input);
+        controls.emergencyStop = controls.emergencyStop || controllerStop;
+
+        if (serialInput->getFrameCount() != pcFrameCount) {
+            pcFrameCount = serialInput->getFrameCount();
+            pcFrameStartUs = serialInput->getFrameStartUs();
+            pcSubmitUs = nowUs;
+            pcLatencyPending = true;
+        }
+    }
 
-    // Placeholder
+    // A playing macro submits its own frames - the controller's emergency
+    // stop still cancels it
+    if (macroPlayer->isPlaying()) {
+        if (!controls.emergencyStop) {
+            return;
+        }
+        macroPlayer->stop();
+        DEBUG_PRINTLN("[MACRO] Playback cancelled by emergency stop");
+    }
+    if (macroRecorder->isRecording() && !macroRecorder->record(input, controls, nowUs)) {
+        DEBUG_PRINTLN("[MACRO] Track full - recording stopped");
+    }
+    lastControls = controls;
+
+    // Send commands to Lego hub
+    if (controls.emergencyStop) {
+        legoHub->emergencyStop();
+    } else {
+        legoHub->sendDrive(controls.speed, controls.steering, controls.lights);
+    }
+    frameTrace.submitUs = micros();
+    frameTrace.pending = true;
+
+#if DEBUG_CONTROLS
     static int counter = 0;
-    if (++counter % 20 == 0) {  // Print every 20 updates (1 second at 20Hz)
-        DEBUG_PRINTF("[CTRL] Control loop running... (%d updates)\n", counter);
+    if (++counter % legoHub->getDriveRateHz() == 0) {  // Print about once per second
+        DEBUG_PRINTF("[CTRL] Speed: %d%%  Steering: %d%%  Lights: 0x%02x%s\n",
+                     controls.speed, controls.steering, controls.lights,
+                     controls.emergencyStop ? "  STOP" : "");
+    }
+#endif
+}
+
+void recordSerialInputLatency() {
+    if (!pcLatencyPending) {
+        return;
+    }
+
+    uint32_t txUs;
+    if (legoHub->isControlSentSince(pcSubmitUs, txUs)) {
+        serialInput->recordLatency(txUs - pcFrameStartUs);
+        pcLatencyPending = false;
     }
 }
 
+void traceSlowFrame() {
+    if (!frameTrace.pending) {
+        return;
+    }
+
+    uint32_t txUs;
+    if (!legoHub->isControlSentSince(frameTrace.submitUs, txUs)) {
+        return;
+    }
+    frameTrace.pending = false;
+
+    uint32_t mapUs = frameTrace.submitUs - frameTrace.startUs;
+    uint32_t writeUs = txUs - frameTrace.submitUs;
+    if (frameTrace.lateUs + mapUs + writeUs >= SESSION_LOG_SLOW_FRAME_US) {
+        sessionLog->log("frame late=%lu map=%lu write=%lu",
+                        (unsigned long)frameTrace.lateUs,
+                        (unsigned long)mapUs,
+                        (unsigned long)writeUs);
+    }
+}
+
+void onGattTrace(const char* queue, const char* op, GattOpStatus status, uint32_t waitUs, uint32_t runUs) {
+    // A held emergency stop sends one stop per control frame
+    if (status == GattOpStatus::OK && strcmp(op, "stop") == 0) {
+        return;
+    }
+    sessionLog->log("gatt %s %s wait=%lu run=%lu %s", queue, op,
+                    (unsigned long)waitUs, (unsigned long)runUs, gattOpStatusName(status));
+}
+
+// ============================================================================
+// Stick Drift Persistence
+// ============================================================================
+
+void loadStickDrift() {
+    if (!STICK_DRIFT_ENABLED) {
+        return;
+    }
+
+#if XBOX_INPUT_USB
+    snprintf(stickDriftKey, sizeof(stickDriftKey), "%susb", NVS_KEY_DRIFT_PREFIX);
+#else
+    const uint8_t* address = bleManager->getXboxInfo().address.getNative();
+    snprintf(stickDriftKey, sizeof(stickDriftKey), "%s%02x%02x%02x%02x%02x%02x", NVS_KEY_DRIFT_PREFIX,
+             address[5], address[4], address[3], address[2], address[1], address[0]);
+#endif
+
+    // Same controller as before (a Lego reconnect) - keep learning
+    static char loadedKey[16] = "";
+    if (strcmp(stickDriftKey, loadedKey) == 0) {
+        return;
+    }
+    strcpy(loadedKey, stickDriftKey);
+
+    stickDrift->reset();
+    StickDriftRecord record;
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, true)) {
+        if (prefs.getBytes(stickDriftKey, &record, sizeof(record)) == sizeof(record)
+            && stickDrift->load(record)) {
+            const StickCalibration& cal = stickDrift->getCalibration();
+            DEBUG_PRINTF("[DRIFT] Loaded %s: center %d/%d, deadzone %u/%u\n", stickDriftKey,
+                         cal.center[STICK_AXIS_X], cal.center[STICK_AXIS_Y],
+                         cal.deadzone[STICK_AXIS_X], cal.deadzone[STICK_AXIS_Y]);
+        }
+        prefs.end();
+    }
+    stickDriftSavedSamples = stickDrift->getSamples();
+    lastStickDriftSaveMs = millis();
+}
+
+void saveStickDrift() {
+    stickDriftSaveDue = false;
+    lastStickDriftSaveMs = millis();
+    if (!STICK_DRIFT_ENABLED || stickDriftKey[0] == '\0'
+        || stickDrift->getSamples() - stickDriftSavedSamples < STICK_DRIFT_MIN_SAMPLES) {
+        return;
+    }
+
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        if (prefs.putBytes(stickDriftKey, &stickDrift->getRecord(), sizeof(StickDriftRecord))) {
+            stickDriftSavedSamples = stickDrift->getSamples();
+        }
+        prefs.end();
+    }
+}
+
+void forgetStickDrift() {
+    stickDrift->reset();
+    stickDriftSavedSamples = 0;
+    if (stickDriftKey[0] == '\0') {
+        return;
+    }
+
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.remove(stickDriftKey);
+        prefs.end();
+    }
+}
+
+// ============================================================================
+// Hub Benchmark
+// ============================================================================
+
+void startHubBenchmark() {
+    if (!legoHub || !legoHub->isReady()) {
+        DEBUG_PRINTLN("[BENCH] Hub not connected");
+        return;
+    }
+    if (hubBenchmark->isRunning()) {
+        DEBUG_PRINTLN("[BENCH] Already running ('bench stop' to abort)");
+        return;
+    }
+
+    DEBUG_PRINTF("[BENCH] Probing hub: %d rates x 2 write types, %d ms each (car held at neutral)\n",
+                HUB_BENCH_RATE_COUNT, HUB_BENCH_STEP_MS);
+    hubBenchmark->start(micros());
+}
+
+void runHubBenchmark() {
+    if (!legoHub->isReady()) {
+        DEBUG_PRINTLN("[BENCH] Hub link down - benchmark aborted");
+        hubBenchmark->abort();
+        return;
+    }
+
+    LegoFrame frame;
+    bool withResponse;
+    uint32_t startUs = micros();
+    if (hubBenchmark->nextFrame(startUs, frame, withResponse)) {
+        bool ok = legoHub->writeDirect(frame, withResponse);
+        hubBenchmark->recordWrite(ok, micros() - startUs);
+    }
+
+    if (hubBenchmark->hasNewResults()) {
+        hubBenchmark->acknowledgeResults();
+        printHubBenchmark();
+    }
+}
+
+void printHubBenchmark() {
+    DEBUG_PRINTLN("\n========== Hub Benchmark ==========");
+    DEBUG_PRINTLN("Write     Target  Sent/s  Accept  Fail  Skip  Lat avg  Lat max  Notif  Errors");
+    for (int i = 0; i < hubBenchmark->getRowCount(); i++) {
+        const HubBenchRow& row = hubBenchmark->getRow(i);
+        uint32_t acceptedX10 = row.elapsedUs ? (uint32_t)((uint64_t)row.accepted * 10000000ULL / row.elapsedUs) : 0;
+        uint32_t avgUs = row.accepted ? (uint32_t)(row.latencySumUs / row.accepted) : 0;
+        DEBUG_PRINTF("%-8s  %4u Hz  %4lu.%lu  %6lu  %4lu  %4lu  %5lu us  %5lu us  %5lu  %6lu\n",
+                    row.withResponse ? "response" : "no-resp",
+                    row.targetHz,
+                    (unsigned long)(acceptedX10 / 10),
+                    (unsigned long)(acceptedX10 % 10),
+                    (unsigned long)row.accepted,
+                    (unsigned long)row.failed,
+                    (unsigned long)row.skipped,
+                    (unsigned long)avgUs,
+                    (unsigned long)row.latencyMaxUs,
+                    (unsigned long)row.notifications,
+                    (unsigned long)row.hubErrors);
+    }
+    DEBUG_PRINTLN("===================================\n");
+}
+
+// ============================================================================
+// Seqlock Benchmark
+// ============================================================================
+
+void runSeqlockBenchmark() {
+    // Blocks the loop for every phase - never while driving
+    if (currentState == AppState::ACTIVE) {
+        DEBUG_PRINTLN("[BENCH] Not while driving");
+        return;
+    }
+
+    DEBUG_PRINTF("[BENCH] State publication: writer on the other core, %d ms per method\n",
+                SEQLOCK_BENCH_PHASE_MS);
+    SeqlockBenchResult results[SYNC_METHOD_COUNT];
+    if (!seqlockBenchRun(SEQLOCK_BENCH_PHASE_MS, results)) {
+        DEBUG_PRINTLN("[BENCH] ERROR: Failed to start the writer task");
+        return;
+    }
+
+    DEBUG_PRINTLN("\n======== Seqlock Benchmark ========");
+    DEBUG_PRINTLN("Method     Reads/s   ns/read  Writes/s  Retries  Torn");
+    for (int i = 0; i < SYNC_METHOD_COUNT; i++) {
+        const SeqlockBenchResult& r = results[i];
+        uint32_t elapsedUs = r.elapsedUs ? r.elapsedUs : 1;
+        DEBUG_PRINTF("%-8s  %8lu  %8lu  %8lu  %7lu  %4lu\n",
+                    r.name,
+                    (unsigned long)((uint64_t)r.reads * 1000000ULL / elapsedUs),
+                    (unsigned long)(r.reads ? (uint64_t)elapsedUs * 1000ULL / r.reads : 0),
+                    (unsigned long)((uint64_t)r.writes * 1000000ULL / elapsedUs),
+                    (unsigned long)r.retries,
+                    (unsigned long)r.tornReads);
+    }
+    DEBUG_PRINTLN("===================================\n");
+}
+
+void runHotPathBenchmark() {
+    // Blocks the loop for every phase - never while driving
+    if (currentState == AppState::ACTIVE) {
+        DEBUG_PRINTLN("[BENCH] Not while driving");
+        return;
+    }
+
+    // Cycle counts only compare at a fixed clock
+    powerManager->setMode(PowerMode::DRIVE);
+    uint32_t mhz = getCpuFrequencyMhz();
+
+    DEBUG_PRINTF("[BENCH] Control path (%s): %d passes per phase at %lu MHz\n",
+                HOT_PATH_IRAM ? "IRAM" : "flash", HOT_PATH_BENCH_ITERATIONS, (unsigned long)mhz);
+    HotPathBenchResult results[HOT_PATH_LOAD_COUNT];
+    if (!hotPathBenchRun(HOT_PATH_BENCH_ITERATIONS, results)) {
+        DEBUG_PRINTLN("[BENCH] ERROR: Failed to start the NVS load task");
+        return;
+    }
+
+    DEBUG_PRINTLN("\n======== Hot Path Benchmark ========");
+    DEBUG_PRINTLN("Load          Min us   Avg us   Max us  NVS writes");
+    for (int i = 0; i < HOT_PATH_LOAD_COUNT; i++) {
+        const HotPathBenchResult& r = results[i];
+        uint32_t avgCycles = r.passes ? (uint32_t)(r.sumCycles / r.passes) : 0;
+        DEBUG_PRINTF("%-11s  %4lu.%02lu  %4lu.%02lu  %4lu.%02lu  %10lu\n",
+                    r.name,
+                    (unsigned long)(r.minCycles / mhz), (unsigned long)(r.minCycles % mhz * 100 / mhz),
+                    (unsigned long)(avgCycles / mhz), (unsigned long)(avgCycles % mhz * 100 / mhz),
+                    (unsigned long)(r.maxCycles / mhz), (unsigned long)(r.maxCycles % mhz * 100 / mhz),
+                    (unsigned long)r.nvsWrites);
+    }
+    DEBUG_PRINTLN("====================================\n");
+}
+
+void onHubFeedback(const uint8_t* data, size_t length) {
+    if (hubBenchmark && hubBenchmark->isRunning()) {
+        hubBenchmark->recordNotification(data, length);
+    }
+}
+
+// ============================================================================
+// Macros
+// ============================================================================
+
+void runMacroCommand(const char* command) {
+    if (!macroTrack->isReady()) {
+        DEBUG_PRINTLN("[MACRO] No macro track (PSRAM missing or MACRO_ENABLED 0)");
+        return;
+    }
+
+    if (strcmp(command, "stop") == 0) {
+        if (macroRecorder->isRecording()) {
+            macroRecorder->stop();
+            DEBUG_PRINTF("[MACRO] Recorded %lu frames, %lu ms, hash 0x%08lx\n",
+                        (unsigned long)macroTrack->getCount(),
+                        (unsigned long)(macroTrack->getDurationUs() / 1000),
+                        (unsigned long)macroTrack->getHash());
+            sessionLog->log("macro recorded %lu frames", (unsigned long)macroTrack->getCount());
+        } else if (macroPlayer->isPlaying()) {
+            macroPlayer->stop();
+            DEBUG_PRINTLN("[MACRO] Playback stopped");
+        }
+        return;
+    }
+
+    if (strcmp(command, "dump") == 0) {
+        // Prints the whole track on the loop - never while driving
+        if (currentState == AppState::ACTIVE) {
+            DEBUG_PRINTLN("[MACRO] Not while driving");
+            return;
+        }
+        char line[96];
+        DEBUG_PRINTLN(MACRO_DUMP_HEADER);
+        for (uint32_t i = 0; i < macroTrack->getCount(); i++) {
+            macroFormatFrame(line, sizeof(line), macroTrack->getFrame(i));
+            DEBUG_PRINTLN(line);
+        }
+        macroFormatTrailer(line, sizeof(line), macroTrack->getCount(), macroTrack->getHash());
+        DEBUG_PRINTLN(line);
+        return;
+    }
+
+    bool record = strcmp(command, "rec") == 0;
+    if (!record && strcmp(command, "play") != 0) {
+        DEBUG_PRINTF("[MACRO] Unknown macro command: %s\n", command);
+        return;
+    }
+    if (currentState != AppState::ACTIVE || hubBenchmark->isRunning()) {
+        DEBUG_PRINTLN("[MACRO] Only while driving");
+        return;
+    }
+    if (macroRecorder->isRecording() || macroPlayer->isPlaying()) {
+        DEBUG_PRINTLN("[MACRO] Busy ('macro stop' first)");
+        return;
+    }
+
+    if (record) {
+        macroRecorder->start(micros());
+        DEBUG_PRINTF("[MACRO] Recording (up to %lu frames)\n", (unsigned long)macroTrack->getCapacity());
+    } else if (macroPlayer->start(legoHub)) {
+        DEBUG_PRINTF("[MACRO] Playing %lu frames, %lu ms\n",
+                    (unsigned long)macroTrack->getCount(),
+                    (unsigned long)(macroTrack->getDurationUs() / 1000));
+        sessionLog->log("macro play %lu frames", (unsigned long)macroTrack->getCount());
+    } else {
+        DEBUG_PRINTLN("[MACRO] Nothing recorded");
+    }
+}
+
+void printMacroStatus() {
+    if (!macroTrack->isReady()) {
+        return;
+    }
+
+    DEBUG_PRINTLN("--- Macro ---");
+    DEBUG_PRINTF("Track: %lu frames, %lu ms, hash 0x%08lx%s\n",
+                (unsigned long)macroTrack->getCount(),
+                (unsigned long)(macroTrack->getDurationUs() / 1000),
+                (unsigned long)macroTrack->getHash(),
+                macroRecorder->isRecording() ? " [recording]" : macroPlayer->isPlaying() ? " [playing]" : "");
+
+    MacroPlaybackStats play = macroPlayer->getStats();
+    if (play.plays == 0) {
+        return;
+    }
+    DEBUG_PRINTF("Plays %lu (%lu completed, %lu hash matches), %lu frames\n",
+                (unsigned long)play.plays,
+                (unsigned long)play.completed,
+                (unsigned long)play.hashMatches,
+                (unsigned long)play.frames);
+    DEBUG_PRINTF("Timer error avg %lu us, max %lu us; write error avg %lu us, max %lu us\n",
+                (unsigned long)(play.timerErrorCount ? play.timerErrorSumUs / play.timerErrorCount : 0),
+                (unsigned long)play.timerErrorMaxUs,
+                (unsigned long)(play.writeErrorCount ? play.writeErrorSumUs / play.writeErrorCount : 0),
+                (unsigned long)play.writeErrorMaxUs);
+}
+
 // ============================================================================
 // Display Update
 // ============================================================================
 
 void updateDisplay() {
-    // TODO: Update OLED display (if present)
+    if (!display || !display->isPresent()) {
+        return;
+    }
+
+    // Snapshot only - rendering and I2C happen in the display task
+    DisplayStatus status = {};
+    status.state = appStateName(currentState);
+    if (bleManager) {
+        status.xboxConnected = XBOX_INPUT_USB ? xboxController->isReady() : bleManager->isXboxConnected();
+        status.legoConnected = bleManager->isLegoConnected();
+    }
+    if (status.xboxConnected) {
+        status.xboxBattery = xboxController->getBatteryLevel();
+    }
+    if (status.legoConnected) {
+        status.driveRateHz = legoHub->getDriveRateHz();
+    }
+    if (currentState == AppState::ACTIVE) {
+        status.speed = lastControls.speed;
+        status.steering = lastControls.steering;
+        status.lights = lastControls.lights;
+        status.emergencyStop = lastControls.emergencyStop;
+    }
+    display->update(status);
+}
+
+void logSessionSnapshot() {
+    if (!sessionLog->isReady()) {
+        return;
+    }
+
+    bool xbox = bleManager && (XBOX_INPUT_USB ? xboxController->isReady() : bleManager->isXboxConnected());
+    bool lego = bleManager && bleManager->isLegoConnected();
+    if (currentState != AppState::ACTIVE) {
+        sessionLog->log("snap %s xbox=%d lego=%d", appStateName(currentState), xbox, lego);
+        return;
+    }
+
+    LegoTxStats tx = legoHub->getTxStats();
+    sessionLog->log("snap ACTIVE spd=%d str=%d lights=%02x stop=%d rate=%u bat=%u sent=%lu fail=%lu",
+                    lastControls.speed,
+                    lastControls.steering,
+                    lastControls.lights,
+                    lastControls.emergencyStop,
+                    legoHub->getDriveRateHz(),
+                    xboxController->getBatteryLevel(),
+                    (unsigned long)tx.sent[(int)LegoTxClass::DRIVE],
+                    (unsigned long)legoHub->getWriteFailures());
 }
 
 void updateSerial() {
     DEBUG_PRINTLN("\n========== Status ==========");
-    DEBUG_PRINTF("State: %s\n",
-        currentState == AppState::INIT ? "INIT" :
-        currentState == AppState::SCANNING ? "SCANNING" :
-        currentState == AppState::CONNECTING ? "CONNECTING" :
-        currentState == AppState::CONNECTED ? "CONNECTED" :
-        currentState == AppState::ACTIVE ? "ACTIVE" : "ERROR");
+    DEBUG_PRINTF("State: %s\n", appStateName(currentState));
     DEBUG_PRINTF("Uptime: %lu seconds\n", millis() / 1000);
 
     if (bleManager) {
         DEBUG_PRINTLN("--- BLE Status ---");
+#if XBOX_INPUT_USB
+        DEBUG_PRINTF("Xbox: wired USB [%s], %lu reports, %lu read retries\n",
+                    xboxController->isReady() ? "CONNECTED" : "unplugged",
+                    (unsigned long)xboxController->getReportCount(),
+                    (unsigned long)xboxController->getReadRetries());
+#else
         if (bleManager->foundXbox()) {
             DeviceInfo xbox = bleManager->getXboxInfo();
             const char* xboxStatus = bleManager->isXboxConnected() ? "CONNECTED" : "disconnected";
@@ -310,9 +1260,13 @@ void updateSerial() {
             DEBUG_PRINTF("  Address: %s, RSSI: %d\n",
                         xbox.address.toString().c_str(),
                         xbox.rssi);
+            DEBUG_PRINTF("  Reports: %lu, read retries: %lu\n",
+                        (unsigned long)xboxController->getReportCount(),
+                        (unsigned long)xboxController->getReadRetries());
         } else {
             DEBUG_PRINTLN("Xbox: Not found");
         }
+#endif
 
         if (bleManager->foundLego()) {
             DeviceInfo lego = bleManager->getLegoInfo();
@@ -324,10 +1278,343 @@ void updateSerial() {
         } else {
             DEBUG_PRINTLN("Lego: Not found");
         }
+
+        DEBUG_PRINTF("Standby scan: %s (paused %lu times)\n",
+                    bleManager->isStandbyScanning() ? "running" : "stopped",
+                    (unsigned long)bleManager->getStandbyPauseCount());
+    }
+
+    if (bleManager) {
+        DEBUG_PRINTLN("--- Connect Retries ---");
+        const ConnectRetry* retries[] = { &bleManager->getXboxRetry(), &bleManager->getLegoRetry() };
+        for (int i = 0; i < LINK_COUNT; i++) {
+            const RetryStats& stats = retries[i]->getStats();
+            uint32_t perSuccess = retries[i]->getAttemptsPerSuccessX100();
+            DEBUG_PRINTF("%s: %lu attempts, %lu connects (%lu.%02lu attempts/connect, worst %u), %lu exhausted\n",
+                        linkName((LinkId)i),
+                        (unsigned long)stats.attempts,
+                        (unsigned long)stats.successes,
+                        (unsigned long)(perSuccess / 100),
+                        (unsigned long)(perSuccess % 100),
+                        stats.maxAttemptsUsed,
+                        (unsigned long)stats.exhausted);
+        }
+    }
+
+    if (pipelineTiming.activeMs != 0) {
+        DEBUG_PRINTLN("--- Connect Pipeline ---");
+        printPipelineTiming();
+    }
+
+#if !XBOX_INPUT_USB
+    if (CONN_PLAN_ENABLED && currentState == AppState::ACTIVE) {
+        DEBUG_PRINTLN("--- Connection Plan ---");
+        printConnPlan();
+    }
+#endif
+
+    if (legoHub && legoHub->isReady()) {
+        DEBUG_PRINTLN("--- Hub TX ---");
+        LegoTxStats tx = legoHub->getTxStats();
+        for (int i = 0; i < LEGO_TX_CLASS_COUNT; i++) {
+            uint32_t avgUs = tx.sent[i] ? (uint32_t)(tx.latencySumUs[i] / tx.sent[i]) : 0;
+            DEBUG_PRINTF("%-6s sent %lu, replaced %lu, wait avg %lu us, max %lu us\n",
+                        legoTxClassName((LegoTxClass)i),
+                        (unsigned long)tx.sent[i],
+                        (unsigned long)tx.replaced[i],
+                        (unsigned long)avgUs,
+                        (unsigned long)tx.latencyMaxUs[i]);
+        }
+        DEBUG_PRINTF("Preempted by stop: drive %lu, aux %lu, write failures: %lu\n",
+                    (unsigned long)tx.drivePreempted,
+                    (unsigned long)tx.auxPreempted,
+                    (unsigned long)legoHub->getWriteFailures());
+
+        AimdStats rate = legoHub->getRateStats();
+        DEBUG_PRINTF("Drive rate: %u Hz (range %u-%u), %lu increases, %lu failure cuts, %lu latency cuts, last: %s\n",
+                    legoHub->getDriveRateHz(),
+                    rate.lowestRateHz,
+                    rate.highestRateHz,
+                    (unsigned long)rate.increases,
+                    (unsigned long)rate.failureCuts,
+                    (unsigned long)rate.latencyCuts,
+                    aimdDecisionName(rate.lastDecision));
+
+        ConnEventStats events = legoHub->getConnEventStats();
+        uint32_t intervalUs = legoHub->getConnIntervalUs();
+        DEBUG_PRINTF("Event phase: %s, interval %lu.%02lu ms, jitter %lu us, %lu observed, %lu outliers, %lu restarts (align %s)\n",
+                    legoHub->isConnEventLocked() ? "locked" : "unknown",
+                    (unsigned long)(intervalUs / 1000),
+                    (unsigned long)(intervalUs % 1000 / 10),
+                    (unsigned long)events.jitterUs,
+                    (unsigned long)events.observations,
+                    (unsigned long)events.outliers,
+                    (unsigned long)events.restarts,
+                    legoHub->isTxAlignEnabled() ? "on" : "off");
+        LegoTxAlignStats align = legoHub->getAlignStats();
+        for (int i = 0; i < LEGO_TX_TIMING_COUNT; i++) {
+            if (align.frames[i] == 0) {
+                continue;
+            }
+            DEBUG_PRINTF("Ready -> air (%s): %lu frames, avg %lu us, max %lu us\n",
+                        legoTxTimingName((LegoTxTiming)i),
+                        (unsigned long)align.frames[i],
+                        (unsigned long)(align.airWaitSumUs[i] / align.frames[i]),
+                        (unsigned long)align.airWaitMaxUs[i]);
+        }
+        DEBUG_PRINTF("Sent with unknown phase: %lu\n", (unsigned long)align.untimed);
+    }
+
+    DEBUG_PRINTF("--- Power (%s, %lu MHz%s) ---\n",
+                powerModeName(powerManager->getMode()),
+                (unsigned long)getCpuFrequencyMhz(),
+                powerManager->isScalingActive() ? ", scaling" : ", fixed clock");
+    for (int i = 0; i < POWER_MODE_COUNT; i++) {
+        PowerModeStats power = powerManager->getStats((PowerMode)i);
+        if (power.loops == 0) {
+            continue;
+        }
+        DEBUG_PRINTF("%-5s %6lu s, loop %2lu ms, wake-up late avg %lu us, max %lu us\n",
+                    powerModeName((PowerMode)i),
+                    (unsigned long)(power.timeMs / 1000),
+                    (unsigned long)powerModeLoopDelayMs((PowerMode)i),
+                    (unsigned long)(power.oversleepSumUs / power.loops),
+                    (unsigned long)power.oversleepMaxUs);
+    }
+
+    if (display && display->isPresent()) {
+        DisplayStats disp = display->getStats();
+        uint32_t pushed = disp.framesPushed ? disp.framesPushed : 1;
+        DEBUG_PRINTLN("--- Display ---");
+        DEBUG_PRINTF("Frames %lu (%lu pushed, %lu pages), %lu bytes (%lu/frame), last %lu us, max %lu us, I2C errors %lu\n",
+                    (unsigned long)disp.framesRendered,
+                    (unsigned long)disp.framesPushed,
+                    (unsigned long)disp.pagesPushed,
+                    (unsigned long)disp.bytesTransferred,
+                    (unsigned long)(disp.bytesTransferred / pushed),
+                    (unsigned long)disp.lastFrameUs,
+                    (unsigned long)disp.maxFrameUs,
+                    (unsigned long)disp.i2cErrors);
+    }
+
+    if (serialInput && serialInput->getFrameCount() > 0) {
+        const SerialInputStats& pc = serialInput->getStats();
+        DEBUG_PRINTLN("--- PC Input ---");
+        DEBUG_PRINTF("Frames %lu%s, lost %lu, duplicates %lu, checksum errors %lu, sync errors %lu, discarded %lu bytes\n",
+                    (unsigned long)pc.frames,
+                    serialInput->isFresh(micros(), SERIAL_INPUT_TIMEOUT_MS * 1000UL) ? " (in control)" : "",
+                    (unsigned long)pc.lostFrames,
+                    (unsigned long)pc.duplicates,
+                    (unsigned long)pc.checksumErrors,
+                    (unsigned long)pc.syncErrors,
+                    (unsigned long)pc.discarded);
+        if (pc.latencyCount > 0) {
+            DEBUG_PRINTF("Serial -> hub write: avg %lu us, min %lu us, max %lu us (%lu frames)\n",
+                        (unsigned long)(pc.latencySumUs / pc.latencyCount),
+                        (unsigned long)pc.latencyMinUs,
+                        (unsigned long)pc.latencyMaxUs,
+                        (unsigned long)pc.latencyCount);
+        }
+    }
+
+    printMacroStatus();
+
+    if (STICK_DRIFT_ENABLED) {
+        const StickCalibration& cal = stickDrift->getCalibration();
+        DEBUG_PRINTLN("--- Stick Drift ---");
+        DEBUG_PRINTF("%s, %lu rest frames%s\n",
+                    cal.valid ? "Calibrated" : "Learning (percent deadzone in use)",
+                    (unsigned long)stickDrift->getSamples(),
+                    stickDrift->isResting() ? ", resting" : "");
+        for (uint8_t axis = 0; axis < STICK_AXIS_COUNT; axis++) {
+            DEBUG_PRINTF("%c: center %d, noise %u, deadzone %u (%lu.%lu%%)\n",
+                        axis == STICK_AXIS_X ? 'X' : 'Y',
+                        cal.center[axis],
+                        stickDrift->getNoise((StickAxis)axis),
+                        cal.deadzone[axis],
+                        (unsigned long)(cal.deadzone[axis] * 100UL / XBOX_STICK_MAX),
+                        (unsigned long)(cal.deadzone[axis] * 1000UL / XBOX_STICK_MAX % 10));
+        }
+    }
+
+    if (sessionLog->isReady()) {
+        SessionLogStats log = sessionLog->getStats();
+        uint32_t flushes = log.fullFlushes + log.partialFlushes;
+        DEBUG_PRINTLN("--- Session Log ---");
+        DEBUG_PRINTF("Lines %lu (%lu dropped), %lu KB written, %lu rotations, %lu write errors\n",
+                    (unsigned long)log.lines,
+                    (unsigned long)log.droppedLines,
+                    (unsigned long)(log.bytesWritten / 1024),
+                    (unsigned long)log.rotations,
+                    (unsigned long)log.writeErrors);
+        DEBUG_PRINTF("Flushes %lu full / %lu partial, avg %lu us, last %lu us, max %lu us\n",
+                    (unsigned long)log.fullFlushes,
+                    (unsigned long)log.partialFlushes,
+                    (unsigned long)(flushes ? log.flushSumUs / flushes : 0),
+                    (unsigned long)log.lastFlushUs,
+                    (unsigned long)log.maxFlushUs);
+    }
+
+    if (bleManager) {
+        DEBUG_PRINTLN("--- GATT Queues ---");
+        printGattQueue(bleManager->getXboxQueue());
+        printGattQueue(bleManager->getLegoQueue());
+    }
+
+    if (bleManager && (bleManager->isXboxConnected() || bleManager->isLegoConnected())) {
+        DEBUG_PRINTLN("--- Link Stats ---");
+        for (int i = 0; i < LINK_COUNT; i++) {
+            linkStatsPrint((LinkId)i);
+        }
     }
     DEBUG_PRINTLN("============================\n");
 }
 
+void printGattQueue(GattQueue& queue) {
+    GattQueueStats q = queue.getStats();
+    if (q.submitted == 0) {
+        return;
+    }
+    DEBUG_PRINTF("%s: %lu ops (%lu ok, %lu failed, %lu timed out, %lu cancelled, %lu rejected), max depth %u\n",
+                queue.getName(),
+                (unsigned long)q.submitted,
+                (unsigned long)q.completed,
+                (unsigned long)q.failed,
+                (unsigned long)q.timedOut,
+                (unsigned long)q.cancelled,
+                (unsigned long)q.rejected,
+                q.maxDepth);
+    DEBUG_PRINTF("  Queue wait avg %lu us, max %lu us; longest op %lu ms\n",
+                (unsigned long)(q.started ? q.waitSumUs / q.started : 0),
+                (unsigned long)q.waitMaxUs,
+                (unsigned long)(q.runMaxUs / 1000));
+}
+
+// ============================================================================
+// Serial Commands
+// ============================================================================
+
+void handleSerialCommands() {
+    static char line[SERIAL_CMD_MAX_LEN];
+    static size_t length = 0;
+
+    while (Serial.available() > 0) {
+        uint8_t byte = (uint8_t)Serial.read();
+
+        // Binary PC frames are interleaved with text - 0xA5 never occurs in a command
+        if (SERIAL_INPUT_ENABLED) {
+            SerialInputResult result = serialInput->feed(byte, micros());
+            if (result == SerialInputResult::DISCARDED) {
+                length = 0;
+            }
+            if (result != SerialInputResult::NOT_FRAME) {
+                continue;
+            }
+        }
+
+        char c = (char)byte;
+        if (c == '\r') {
+            continue;
+        }
+        if (c != '\n') {
+            if (length < sizeof(line) - 1) {
+                line[length++] = c;
+            }
+            continue;
+        }
+
+        line[length] = '\0';
+        length = 0;
+        runSerialCommand(line);
+    }
+}
+
+void runSerialCommand(const char* command) {
+    if (strcmp(command, "status") == 0) {
+        updateSerial();
+    } else if (strcmp(command, "stats reset") == 0) {
+        linkStatsResetAll();
+        if (legoHub) {
+            legoHub->resetStats();
+        }
+        if (bleManager) {
+            bleManager->resetRetryStats();
+        }
+        if (display) {
+            display->resetStats();
+        }
+        if (serialInput) {
+            serialInput->resetStats();
+        }
+        if (powerManager) {
+            powerManager->resetStats();
+        }
+        if (bleManager) {
+            bleManager->getXboxQueue().resetStats();
+            bleManager->getLegoQueue().resetStats();
+        }
+        sessionLog->resetStats();
+        macroPlayer->resetStats();
+        connPlanner->resetStats();
+#if !XBOX_INPUT_USB
+        if (xboxController) {
+            xboxController->resetConnEventStats();
+        }
+#endif
+        DEBUG_PRINTLN("[CMD] Statistics reset");
+    } else if (strcmp(command, "bench hub") == 0) {
+        startHubBenchmark();
+    } else if (strcmp(command, "log dump") == 0 || strcmp(command, "log clear") == 0) {
+        // Reads and erases flash on the loop - never while driving
+        if (currentState == AppState::ACTIVE) {
+            DEBUG_PRINTLN("[LOG] Not while driving");
+        } else if (command[4] == 'd') {
+            sessionLog->dump();
+        } else {
+            sessionLog->clear();
+            DEBUG_PRINTLN("[LOG] Session logs deleted");
+        }
+    } else if (strncmp(command, "macro ", 6) == 0) {
+        runMacroCommand(command + 6);
+    } else if (strcmp(command, "txalign on") == 0 || strcmp(command, "txalign off") == 0) {
+        bool enabled = strcmp(command, "txalign on") == 0;
+        if (legoHub) {
+            legoHub->setTxAlign(enabled);
+        }
+        DEBUG_PRINTF("[LEGO] Connection-event alignment %s\n", enabled ? "on" : "off");
+    } else if (strcmp(command, "drift reset") == 0) {
+        forgetStickDrift();
+        DEBUG_PRINTLN("[DRIFT] Stick calibration cleared - relearning");
+    } else if (strcmp(command, "bench seqlock") == 0) {
+        runSeqlockBenchmark();
+    } else if (strcmp(command, "bench hotpath") == 0) {
+        runHotPathBenchmark();
+    } else if (strcmp(command, "bench stop") == 0) {
+        if (hubBenchmark && hubBenchmark->isRunning()) {
+            hubBenchmark->abort();
+            DEBUG_PRINTLN("[BENCH] Aborted");
+        }
+    } else if (strcmp(command, "help") == 0) {
+        DEBUG_PRINTLN("[CMD] Commands:");
+        DEBUG_PRINTLN("[CMD]   status       - print status now");
+        DEBUG_PRINTLN("[CMD]   stats reset  - clear link and TX statistics");
+        DEBUG_PRINTLN("[CMD]   bench hub    - probe hub command-rate capacity");
+        DEBUG_PRINTLN("[CMD]   bench stop   - abort the hub benchmark");
+        DEBUG_PRINTLN("[CMD]   bench seqlock - state publication stress test (not while driving)");
+        DEBUG_PRINTLN("[CMD]   bench hotpath - control-path worst case under NVS writes (not while driving)");
+        DEBUG_PRINTLN("[CMD]   macro rec    - record the controls sent to the car (while driving)");
+        DEBUG_PRINTLN("[CMD]   macro play   - replay the recording on a timer (while driving)");
+        DEBUG_PRINTLN("[CMD]   macro stop   - stop recording or playback");
+        DEBUG_PRINTLN("[CMD]   macro dump   - print the recorded frames (not while driving)");
+        DEBUG_PRINTLN("[CMD]   txalign on|off - time hub frames to its connection events");
+        DEBUG_PRINTLN("[CMD]   drift reset  - forget this controller's stick calibration");
+        DEBUG_PRINTLN("[CMD]   log dump     - print the session logs, oldest first (not while driving)");
+        DEBUG_PRINTLN("[CMD]   log clear    - delete the session logs (not while driving)");
+    } else if (command[0] != '\0') {
+        DEBUG_PRINTF("[CMD] Unknown command: %s (try 'help')\n", command);
+    }
+}
+
 // ============================================================================
 // Error Handling
 // ============================================================================
@@ -335,6 +1622,11 @@ void updateSerial() {
 void handleError(ErrorCode error) {
     DEBUG_PRINTLN("\n!!!!!!!!!!!!!!!!!!!!!!!!!!!!");
     DEBUG_PRINTF("ERROR: Code %d\n", error);
+    sessionLog->log("error %d in %s", error, appStateName(currentState));
+
+    // Macros only run against a live link
+    macroPlayer->stop();
+    macroRecorder->stop();
 
     switch (error) {
         case ERR_BLE_INIT_FAILED:
@@ -360,20 +1652,41 @@ void handleError(ErrorCode error) {
         case ERR_XBOX_DISCONNECTED:
             DEBUG_PRINTLN("Xbox controller disconnected");
             DEBUG_PRINTLN("Will attempt reconnection...");
+            if (legoHub) {
+                // Stop the car before the hub link is torn down
+                legoHub->emergencyStop();
+                legoHub->flushStop(LEGO_STOP_FLUSH_MS);
+                legoHub->reset();
+            }
+            // Links down first, so no report is decoded while the state is cleared
             if (bleManager) {
                 bleManager->resetForReconnection();
             }
-            delay(2000);  // Wait 2 seconds before rescanning
+            if (xboxController) {
+                xboxController->reset();
+            }
+            // The hub link was ours to end, so the hub reconnects at once
+            if (!bleManager || !bleManager->hasCachedPeer()) {
+                delay(2000);  // Wait 2 seconds before rescanning
+            }
             currentState = AppState::SCANNING;
             startScanning();
             break;
         case ERR_LEGO_DISCONNECTED:
             DEBUG_PRINTLN("Lego hub disconnected");
             DEBUG_PRINTLN("Will attempt reconnection...");
+            if (legoHub) {
+                legoHub->reset();
+            }
             if (bleManager) {
                 bleManager->resetForReconnection();
             }
-            delay(2000);  // Wait 2 seconds before rescanning
+            if (xboxController) {
+                xboxController->reset();
+            }
+            if (!bleManager || !bleManager->hasCachedPeer()) {
+                delay(2000);  // Wait 2 seconds before rescanning
+            }
             currentState = AppState::SCANNING;
             startScanning();
             break;
@@ -383,5 +1696,9 @@ void handleError(ErrorCode error) {
             break;
     }
 
+    if (currentState == AppState::ERROR && statusLed) {
+        statusLed->setPattern(ledErrorPattern(error));
+    }
+
     DEBUG_PRINTLN("!!!!!!!!!!!!!!!!!!!!!!!!!!!!\n");
 }
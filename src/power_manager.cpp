@@ -0,0 +1,150 @@
+/**
+ * Power Manager Implementation
+ */
+
+#include "power_manager.h"
+
+#if CONFIG_PM_ENABLE
+#include <esp_idf_version.h>
+#endif
+
+static const uint32_t LOOP_DELAY_MS[POWER_MODE_COUNT] = {
+    1,                          // DRIVE
+    POWER_SCAN_LOOP_DELAY_MS,   // SCAN
+    POWER_IDLE_LOOP_DELAY_MS    // IDLE
+};
+
+const char* powerModeName(PowerMode mode) {
+    switch (mode) {
+        case PowerMode::DRIVE: return "drive";
+        case PowerMode::SCAN:  return "scan";
+        case PowerMode::IDLE:  return "idle";
+        default:               return "?";
+    }
+}
+
+uint32_t powerModeLoopDelayMs(PowerMode mode) {
+    return LOOP_DELAY_MS[(int)mode];
+}
+
+// ============================================================================
+// PowerManager Implementation
+// ============================================================================
+
+PowerManager::PowerManager()
+    : mode(PowerMode::DRIVE)
+    , scalingActive(false)
+    , modeStartMs(0)
+#if CONFIG_PM_ENABLE
+    , cpuLock(nullptr)
+    , sleepLock(nullptr)
+#endif
+{
+    memset(stats, 0, sizeof(stats));
+}
+
+bool PowerManager::init() {
+    modeStartMs = millis();
+
+#if CONFIG_PM_ENABLE && POWER_MANAGEMENT_ENABLED
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_pm_config_t config = {};
+#else
+    esp_pm_config_esp32s3_t config = {};
+#endif
+    config.max_freq_mhz = POWER_MAX_FREQ_MHZ;
+    config.min_freq_mhz = POWER_MIN_FREQ_MHZ;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    config.light_sleep_enable = POWER_LIGHT_SLEEP;
+#endif
+
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "drive_cpu", &cpuLock) != ESP_OK
+        || esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "drive_sleep", &sleepLock) != ESP_OK) {
+        DEBUG_PRINTLN("[POWER] ERROR: Failed to create PM locks");
+        return false;
+    }
+
+    // Start in DRIVE (locks held) so setup and bring-up run at full speed
+    esp_pm_lock_acquire(cpuLock);
+    esp_pm_lock_acquire(sleepLock);
+
+    if (esp_pm_configure(&config) != ESP_OK) {
+        DEBUG_PRINTLN("[POWER] ERROR: esp_pm_configure failed - clock stays fixed");
+        return false;
+    }
+
+    scalingActive = true;
+    DEBUG_PRINTF("[POWER] Frequency scaling %d-%d MHz, light sleep %s\n",
+                POWER_MIN_FREQ_MHZ, POWER_MAX_FREQ_MHZ,
+                config.light_sleep_enable ? "on" : "off (needs tickless idle)");
+    return true;
+#elif POWER_MANAGEMENT_ENABLED
+    DEBUG_PRINTLN("[POWER] CONFIG_PM_ENABLE not set in the SDK - clock stays fixed");
+    return false;
+#else
+    return false;
+#endif
+}
+
+bool PowerManager::isScalingActive() {
+    return scalingActive;
+}
+
+void PowerManager::setMode(PowerMode newMode) {
+    if (newMode == mode) {
+        return;
+    }
+
+    closeResidency(millis());
+
+#if CONFIG_PM_ENABLE
+    if (scalingActive) {
+        bool wasDrive = (mode == PowerMode::DRIVE);
+        bool isDrive = (newMode == PowerMode::DRIVE);
+        if (isDrive && !wasDrive) {
+            esp_pm_lock_acquire(cpuLock);
+            esp_pm_lock_acquire(sleepLock);
+        } else if (wasDrive && !isDrive) {
+            esp_pm_lock_release(sleepLock);
+            esp_pm_lock_release(cpuLock);
+        }
+    }
+#endif
+
+    DEBUG_PRINTF("[POWER] Mode %s -> %s\n", powerModeName(mode), powerModeName(newMode));
+    mode = newMode;
+}
+
+PowerMode PowerManager::getMode() {
+    return mode;
+}
+
+void PowerManager::loopDelay() {
+    uint32_t delayMs = powerModeLoopDelayMs(mode);
+    uint32_t startUs = micros();
+    delay(delayMs);
+    uint32_t elapsedUs = micros() - startUs;
+
+    PowerModeStats& s = stats[(int)mode];
+    uint32_t oversleepUs = elapsedUs > delayMs * 1000 ? elapsedUs - delayMs * 1000 : 0;
+    s.loops++;
+    s.oversleepSumUs += oversleepUs;
+    if (oversleepUs > s.oversleepMaxUs) {
+        s.oversleepMaxUs = oversleepUs;
+    }
+}
+
+PowerModeStats PowerManager::getStats(PowerMode statsMode) {
+    closeResidency(millis());
+    return stats[(int)statsMode];
+}
+
+void PowerManager::resetStats() {
+    memset(stats, 0, sizeof(stats));
+    modeStartMs = millis();
+}
+
+void PowerManager::closeResidency(unsigned long nowMs) {
+    stats[(int)mode].timeMs += nowMs - modeStartMs;
+    modeStartMs = nowMs;
+}
@@ -0,0 +1,146 @@
+/**
+ * Seqlock Benchmark Implementation
+ */
+
+#include "seqlock_bench.h"
+#include "seqlock.h"
+#include "xbox_report.h"
+
+static const char* const METHOD_NAMES[SYNC_METHOD_COUNT] = { "seqlock", "spinlock", "mutex" };
+
+static Seqlock<XboxPackedState> benchSeqlock;
+static XboxPackedState benchPlain;
+static portMUX_TYPE benchMux = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t benchMutex = nullptr;
+
+static SyncMethod writerMethod;
+static volatile bool writerStop = false;
+static volatile uint32_t writerCount = 0;
+static TaskHandle_t readerTask = nullptr;
+
+// ============================================================================
+// Value Pattern
+// ============================================================================
+
+static void fillPattern(XboxPackedState& value, uint16_t n) {
+    value.buttons       = n;
+    value.left_stick_x  = (int16_t)n;
+    value.left_stick_y  = (int16_t)~n;
+    value.right_stick_x = (int16_t)(n ^ 0x5555);
+    value.right_stick_y = (int16_t)(n ^ 0xAAAA);
+    value.left_trigger  = (uint16_t)(n + 1);
+    value.right_trigger = (uint16_t)(n - 1);
+    value.battery_level = (uint8_t)n;
+    value.reserved      = (uint8_t)(n >> 8);
+}
+
+static bool isConsistent(const XboxPackedState& value) {
+    XboxPackedState expected;
+    fillPattern(expected, value.buttons);
+    return memcmp(&expected, &value, sizeof(value)) == 0;
+}
+
+// ============================================================================
+// Writer and Reader
+// ============================================================================
+
+static void writerTaskFn(void* arg) {
+    uint32_t count = 0;
+    uint16_t n = 0;
+    XboxPackedState value;
+
+    while (!writerStop) {
+        fillPattern(value, ++n);
+        switch (writerMethod) {
+            case SyncMethod::SEQLOCK:
+                benchSeqlock.write(value);
+                break;
+            case SyncMethod::SPINLOCK:
+                portENTER_CRITICAL(&benchMux);
+                benchPlain = value;
+                portEXIT_CRITICAL(&benchMux);
+                break;
+            default:
+                xSemaphoreTake(benchMutex, portMAX_DELAY);
+                benchPlain = value;
+                xSemaphoreGive(benchMutex);
+                break;
+        }
+        count++;
+    }
+
+    writerCount = count;
+    xTaskNotifyGive(readerTask);
+    vTaskDelete(nullptr);
+}
+
+static void readOnce(SyncMethod method, XboxPackedState& value) {
+    switch (method) {
+        case SyncMethod::SEQLOCK:
+            benchSeqlock.read(value);
+            break;
+        case SyncMethod::SPINLOCK:
+            portENTER_CRITICAL(&benchMux);
+            value = benchPlain;
+            portEXIT_CRITICAL(&benchMux);
+            break;
+        default:
+            xSemaphoreTake(benchMutex, portMAX_DELAY);
+            value = benchPlain;
+            xSemaphoreGive(benchMutex);
+            break;
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool seqlockBenchRun(uint32_t phaseMs, SeqlockBenchResult results[SYNC_METHOD_COUNT]) {
+    if (!benchMutex) {
+        benchMutex = xSemaphoreCreateMutex();
+    }
+    readerTask = xTaskGetCurrentTaskHandle();
+    int writerCore = xPortGetCoreID() ^ 1;
+
+    for (int m = 0; m < SYNC_METHOD_COUNT; m++) {
+        SyncMethod method = (SyncMethod)m;
+        SeqlockBenchResult& result = results[m];
+        memset(&result, 0, sizeof(result));
+        result.name = METHOD_NAMES[m];
+
+        // Start from a consistent value
+        XboxPackedState value;
+        fillPattern(value, 0);
+        benchSeqlock.write(value);
+        benchPlain = value;
+        uint32_t retriesBefore = benchSeqlock.getRetryCount();
+
+        writerMethod = method;
+        writerStop = false;
+        if (xTaskCreatePinnedToCore(writerTaskFn, "seqlock_w", 2048, nullptr,
+                                    1, nullptr, writerCore) != pdPASS) {
+            return false;
+        }
+
+        uint32_t startUs = micros();
+        uint32_t phaseUs = phaseMs * 1000;
+        while (micros() - startUs < phaseUs) {
+            // Batch reads between clock checks to keep micros() out of the timing
+            for (int i = 0; i < 64; i++) {
+                readOnce(method, value);
+                if (!isConsistent(value)) {
+                    result.tornReads++;
+                }
+            }
+            result.reads += 64;
+        }
+        result.elapsedUs = micros() - startUs;
+
+        writerStop = true;
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        result.writes = writerCount;
+        result.retries = benchSeqlock.getRetryCount() - retriesBefore;
+    }
+    return true;
+}
@@ -0,0 +1,234 @@
+/**
+ * Serial Input Implementation
+ */
+
+#include <string.h>
+#include "serial_input.h"
+#include "config.h"
+
+#define CHECKSUM_OFFSET (SERIAL_INPUT_FRAME_SIZE - 2)
+
+// ============================================================================
+// SerialInputParser Implementation
+// ============================================================================
+
+SerialInputParser::SerialInputParser()
+    : current(0)
+    , position(0)
+    , sum1(0)
+    , sum2(0)
+    , lowByte(0)
+    , sequence(0)
+    , receivedSum1(0)
+    , startUs(0)
+    , haveSequence(false)
+    , lastSequence(0)
+    , lastFrameStartUs(0)
+    , lastFrameEndUs(0)
+    , binary(false)
+    , resyncing(false)
+    , lineClean(true)
+    , lastByteUs(0)
+{
+    states[0].battery_level = 0;
+    states[1].battery_level = 0;
+    xboxResetState(states[0]);
+    xboxResetState(states[1]);
+
+    // resetStats() keeps the frame count, so start it from zero here
+    memset(&stats, 0, sizeof(stats));
+    resetStats();
+}
+
+SerialInputResult HOT_PATH SerialInputParser::feed(uint8_t byte, uint32_t nowUs) {
+    // The sender has stopped - whatever comes next is typed
+    if (binary && nowUs - lastByteUs >= SERIAL_INPUT_TIMEOUT_MS * 1000UL) {
+        binary = false;
+        resyncing = false;
+        lineClean = true;
+        position = 0;
+    }
+    lastByteUs = nowUs;
+
+    switch (position) {
+        case 0:
+            if (byte != SERIAL_INPUT_SYNC1) {
+                return binary ? filterText(byte) : SerialInputResult::NOT_FRAME;
+            }
+            startUs = nowUs;
+            position = 1;
+            return SerialInputResult::CONSUMED;
+
+        case 1:
+            if (byte != SERIAL_INPUT_SYNC2) {
+                stats.syncErrors++;
+                position = 0;
+                return dropFrame();
+            }
+            resyncing = false;
+            lineClean = true;
+            position = 2;
+            return SerialInputResult::CONSUMED;
+
+        case CHECKSUM_OFFSET:
+            receivedSum1 = byte;
+            position++;
+            return SerialInputResult::CONSUMED;
+
+        case CHECKSUM_OFFSET + 1:
+            position = 0;
+            return finishFrame(byte, nowUs);
+
+        default:
+            break;
+    }
+
+    // Checksummed body: type, sequence, payload
+    sum1 = (position == 2) ? byte : (uint8_t)((sum1 + byte) % 255);
+    sum2 = (position == 2) ? byte : (uint8_t)((sum2 + sum1) % 255);
+
+    if (position == 2) {
+        if (byte != SERIAL_INPUT_TYPE_CONTROLS) {
+            stats.syncErrors++;
+            position = 0;
+            return dropFrame();
+        }
+    } else if (position == 3) {
+        sequence = byte;
+    } else if (position & 1) {
+        decodeField(states[current ^ 1], position - 1, (uint16_t)(lowByte | (byte << 8)));
+    } else {
+        lowByte = byte;
+    }
+
+    position++;
+    return SerialInputResult::CONSUMED;
+}
+
+bool SerialInputParser::inFrame() const {
+    return position != 0;
+}
+
+const XboxControllerState& SerialInputParser::getState() const {
+    return states[current];
+}
+
+uint32_t SerialInputParser::getFrameCount() const {
+    return stats.frames;
+}
+
+uint32_t SerialInputParser::getFrameStartUs() const {
+    return lastFrameStartUs;
+}
+
+bool HOT_PATH SerialInputParser::isFresh(uint32_t nowUs, uint32_t timeoutUs) const {
+    return stats.frames > 0 && nowUs - lastFrameEndUs < timeoutUs;
+}
+
+void SerialInputParser::recordLatency(uint32_t latencyUs) {
+    stats.latencyCount++;
+    stats.latencySumUs += latencyUs;
+    if (latencyUs < stats.latencyMinUs) {
+        stats.latencyMinUs = latencyUs;
+    }
+    if (latencyUs > stats.latencyMaxUs) {
+        stats.latencyMaxUs = latencyUs;
+    }
+}
+
+const SerialInputStats& SerialInputParser::getStats() const {
+    return stats;
+}
+
+void SerialInputParser::resetStats() {
+    uint32_t frames = stats.frames;
+    memset(&stats, 0, sizeof(stats));
+    stats.latencyMinUs = UINT32_MAX;
+
+    // The frame count doubles as the change counter - keep it monotonic
+    stats.frames = frames;
+}
+
+void HOT_PATH SerialInputParser::decodeField(XboxControllerState& state, uint8_t offset, uint16_t value) {
+    switch (offset) {
+        case 4:
+            state.btn_a      = value & 0x0001;
+            state.btn_b      = value & 0x0002;
+            state.btn_x      = value & 0x0004;
+            state.btn_y      = value & 0x0008;
+            state.btn_lb     = value & 0x0010;
+            state.btn_rb     = value & 0x0020;
+            state.btn_ls     = value & 0x0040;
+            state.btn_rs     = value & 0x0080;
+            state.btn_view   = value & 0x0100;
+            state.btn_menu   = value & 0x0200;
+            state.btn_xbox   = value & 0x0400;
+            state.btn_share  = value & 0x0800;
+            state.dpad_up    = value & 0x1000;
+            state.dpad_down  = value & 0x2000;
+            state.dpad_left  = value & 0x4000;
+            state.dpad_right = value & 0x8000;
+            break;
+        case 6:  state.left_stick_x  = (int16_t)value; break;
+        case 8:  state.left_stick_y  = (int16_t)value; break;
+        case 10: state.right_stick_x = (int16_t)value; break;
+        case 12: state.right_stick_y = (int16_t)value; break;
+        case 14: state.left_trigger  = value & 0x03FF; break;
+        case 16: state.right_trigger = value & 0x03FF; break;
+        default: break;
+    }
+}
+
+SerialInputResult HOT_PATH SerialInputParser::finishFrame(uint8_t receivedSum2, uint32_t nowUs) {
+    if (receivedSum1 != sum1 || receivedSum2 != sum2) {
+        stats.checksumErrors++;
+        dropFrame();
+        return SerialInputResult::FRAME_DROPPED;
+    }
+
+    if (haveSequence) {
+        uint8_t gap = (uint8_t)(sequence - lastSequence);
+        if (gap == 0) {
+            stats.duplicates++;
+            return SerialInputResult::FRAME_DROPPED;
+        }
+        // A large jump is the sender restarting, not loss
+        if (gap < 128) {
+            stats.lostFrames += gap - 1;
+        }
+    }
+    haveSequence = true;
+    lastSequence = sequence;
+
+    current ^= 1;
+    stats.frames++;
+    lastFrameStartUs = startUs;
+    lastFrameEndUs = nowUs;
+    binary = true;
+    return SerialInputResult::FRAME_OK;
+}
+
+SerialInputResult HOT_PATH SerialInputParser::dropFrame() {
+    // The rest of the real frame is still on its way and may hold any byte
+    if (binary) {
+        resyncing = true;
+        lineClean = false;
+    }
+    return SerialInputResult::CONSUMED;
+}
+
+SerialInputResult HOT_PATH SerialInputParser::filterText(uint8_t byte) {
+    bool printable = byte >= 0x20 && byte < 0x7F;
+    if (!resyncing && lineClean && (printable || byte == '\r' || byte == '\n')) {
+        return SerialInputResult::NOT_FRAME;
+    }
+
+    // A newline ends a discarded line; the next one may be text again
+    if (!resyncing && byte == '\n') {
+        lineClean = true;
+    } else {
+        lineClean = false;
+    }
+    stats.discarded++;
+    return SerialInputResult::DISCARDED;
+}
@@ -0,0 +1,252 @@
+/**
+ * Session Log Implementation
+ */
+
+#include <LittleFS.h>
+#include <stdarg.h>
+#include "session_log.h"
+
+#define SESSION_LOG_LINE_MAX 160
+
+static void filePath(char* path, size_t size, int index) {
+    snprintf(path, size, "/session%d.log", index);
+}
+
+// ============================================================================
+// SessionLog Implementation
+// ============================================================================
+
+SessionLog::SessionLog()
+    : active(0)
+    , sealed(false)
+    , lastSealMs(0)
+    , ready(false)
+    , mux(portMUX_INITIALIZER_UNLOCKED)
+    , task(nullptr)
+{
+    fill[0] = 0;
+    fill[1] = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool SessionLog::init() {
+    if (!LittleFS.begin(true)) {
+        DEBUG_PRINTLN("[LOG] ERROR: LittleFS mount failed - session log disabled");
+        return false;
+    }
+
+    // A new file per session
+    rotate();
+    lastSealMs = millis();
+
+    if (xTaskCreatePinnedToCore(taskMain, "session_log", SESSION_LOG_TASK_STACK, this,
+                                SESSION_LOG_TASK_PRIORITY, &task, SESSION_LOG_TASK_CORE) != pdPASS) {
+        DEBUG_PRINTLN("[LOG] ERROR: Failed to start the session log task");
+        return false;
+    }
+
+    ready = true;
+    DEBUG_PRINTF("[LOG] Session log on LittleFS (%lu / %lu KB used)\n",
+                (unsigned long)(LittleFS.usedBytes() / 1024),
+                (unsigned long)(LittleFS.totalBytes() / 1024));
+    return true;
+}
+
+bool SessionLog::isReady() {
+    return ready;
+}
+
+void SessionLog::log(const char* format, ...) {
+    if (!ready) {
+        return;
+    }
+
+    char line[SESSION_LOG_LINE_MAX];
+    unsigned long ms = millis();
+    int length = snprintf(line, sizeof(line), "%lu.%03lu ", ms / 1000, ms % 1000);
+
+    va_list args;
+    va_start(args, format);
+    int text = vsnprintf(line + length, sizeof(line) - length - 1, format, args);
+    va_end(args);
+
+    if (text < 0) {
+        return;
+    }
+    length += text;
+    if (length > (int)sizeof(line) - 2) {
+        length = sizeof(line) - 2;  // Truncated
+    }
+    line[length++] = '\n';
+    append(line, length);
+}
+
+// ============================================================================
+// Staging
+// ============================================================================
+
+void SessionLog::append(const char* line, size_t length) {
+    bool wake = false;
+
+    portENTER_CRITICAL(&mux);
+    if (fill[active] + length > SESSION_LOG_BLOCK_SIZE) {
+        if (sealed) {
+            // Both blocks full - the flash is a block behind
+            stats.droppedLines++;
+            portEXIT_CRITICAL(&mux);
+            return;
+        }
+        wake = sealActive(false);
+    }
+    memcpy(&blocks[active][fill[active]], line, length);
+    fill[active] += length;
+    stats.lines++;
+    portEXIT_CRITICAL(&mux);
+
+    if (wake) {
+        xTaskNotifyGive(task);
+    }
+}
+
+// Call with mux held. Hands the active block to the task.
+bool SessionLog::sealActive(bool partialOnly) {
+    if (sealed || fill[active] == 0) {
+        return false;
+    }
+    if (partialOnly) {
+        stats.partialFlushes++;
+    } else {
+        stats.fullFlushes++;
+    }
+    sealed = true;
+    active ^= 1;
+    fill[active] = 0;
+    lastSealMs = millis();
+    return true;
+}
+
+// ============================================================================
+// Flash (session log task only)
+// ============================================================================
+
+void SessionLog::writeSealed() {
+    uint8_t index = active ^ 1;
+    size_t length = fill[index];
+
+    uint32_t startUs = micros();
+    File file = LittleFS.open("/session0.log", FILE_APPEND);
+    bool ok = file && file.write((const uint8_t*)blocks[index], length) == length;
+    size_t fileSize = file ? file.size() : 0;
+    if (file) {
+        file.close();
+    }
+    uint32_t elapsedUs = micros() - startUs;
+
+    portENTER_CRITICAL(&mux);
+    sealed = false;
+    if (ok) {
+        stats.bytesWritten += length;
+    } else {
+        stats.writeErrors++;
+    }
+    stats.lastFlushUs = elapsedUs;
+    stats.flushSumUs += elapsedUs;
+    if (elapsedUs > stats.maxFlushUs) {
+        stats.maxFlushUs = elapsedUs;
+    }
+    portEXIT_CRITICAL(&mux);
+
+    // Into the next block, for timelines (see tools/trace_export.cpp)
+    log("flush bytes=%lu run=%lu", (unsigned long)length, (unsigned long)elapsedUs);
+
+    if (fileSize + SESSION_LOG_BLOCK_SIZE > SESSION_LOG_FILE_MAX) {
+        rotate();
+    }
+}
+
+void SessionLog::rotate() {
+    char from[24];
+    char to[24];
+
+    filePath(to, sizeof(to), SESSION_LOG_FILES - 1);
+    if (LittleFS.exists(to)) {
+        LittleFS.remove(to);
+    }
+    for (int i = SESSION_LOG_FILES - 2; i >= 0; i--) {
+        filePath(from, sizeof(from), i);
+        filePath(to, sizeof(to), i + 1);
+        if (LittleFS.exists(from)) {
+            LittleFS.rename(from, to);
+        }
+    }
+
+    portENTER_CRITICAL(&mux);
+    stats.rotations++;
+    portEXIT_CRITICAL(&mux);
+}
+
+void SessionLog::taskMain(void* arg) {
+    SessionLog* log = static_cast<SessionLog*>(arg);
+    TickType_t period = pdMS_TO_TICKS(SESSION_LOG_FLUSH_MS);
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, period);
+
+        // Nothing full arrived in time - write what there is
+        portENTER_CRITICAL(&log->mux);
+        if (!log->sealed && millis() - log->lastSealMs >= SESSION_LOG_FLUSH_MS) {
+            log->sealActive(true);
+        }
+        bool pending = log->sealed;
+        portEXIT_CRITICAL(&log->mux);
+
+        if (pending) {
+            log->writeSealed();
+        }
+    }
+}
+
+// ============================================================================
+// File Access
+// ============================================================================
+
+void SessionLog::dump() {
+    char path[24];
+    for (int i = SESSION_LOG_FILES - 1; i >= 0; i--) {
+        filePath(path, sizeof(path), i);
+        File file = LittleFS.open(path, FILE_READ);
+        if (!file) {
+            continue;
+        }
+        DEBUG_PRINTF("----- %s (%lu bytes) -----\n", path, (unsigned long)file.size());
+        uint8_t buffer[256];
+        size_t n;
+        while ((n = file.read(buffer, sizeof(buffer))) > 0) {
+            Serial.write(buffer, n);
+        }
+        file.close();
+    }
+}
+
+void SessionLog::clear() {
+    char path[24];
+    for (int i = 0; i < SESSION_LOG_FILES; i++) {
+        filePath(path, sizeof(path), i);
+        if (LittleFS.exists(path)) {
+            LittleFS.remove(path);
+        }
+    }
+}
+
+SessionLogStats SessionLog::getStats() {
+    portENTER_CRITICAL(&mux);
+    SessionLogStats copy = stats;
+    portEXIT_CRITICAL(&mux);
+    return copy;
+}
+
+void SessionLog::resetStats() {
+    portENTER_CRITICAL(&mux);
+    memset(&stats, 0, sizeof(stats));
+    portEXIT_CRITICAL(&mux);
+}
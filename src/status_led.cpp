@@ -0,0 +1,107 @@
+/**
+ * Status LED Implementation
+ */
+
+#include "status_led.h"
+
+// ============================================================================
+// StatusLed Implementation
+// ============================================================================
+
+StatusLed::StatusLed()
+    : pin(LED_BUILTIN)
+    , timer(nullptr)
+    , mux(portMUX_INITIALIZER_UNLOCKED)
+    , pattern(LED_PATTERN_OFF)
+    , step(0)
+    , repeat(0)
+    , pausing(false)
+{
+}
+
+void StatusLed::init(uint8_t ledPin) {
+    pin = ledPin;
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+
+    esp_timer_create_args_t args = {};
+    args.callback = timerCB;
+    args.arg = this;
+    args.name = "status_led";
+    if (esp_timer_create(&args, &timer) != ESP_OK) {
+        DEBUG_PRINTLN("[LED] ERROR: Failed to create LED timer");
+        timer = nullptr;
+    }
+}
+
+void StatusLed::setPattern(const LedPattern& newPattern) {
+    if (!timer) {
+        return;
+    }
+
+    portENTER_CRITICAL(&mux);
+    bool same = pattern.steps == newPattern.steps
+        && pattern.repeats == newPattern.repeats
+        && pattern.pauseMs == newPattern.pauseMs;
+    portEXIT_CRITICAL(&mux);
+    if (same) {
+        return;
+    }
+
+    esp_timer_stop(timer);
+
+    portENTER_CRITICAL(&mux);
+    pattern = newPattern;
+    step = 0;
+    repeat = 0;
+    pausing = false;
+    uint32_t durationMs = apply();
+    portEXIT_CRITICAL(&mux);
+
+    if (durationMs > 0) {
+        esp_timer_start_once(timer, (uint64_t)durationMs * 1000);
+    }
+}
+
+uint32_t StatusLed::apply() {
+    if (pausing) {
+        digitalWrite(pin, LOW);
+        return pattern.pauseMs;
+    }
+
+    const LedStep& current = pattern.steps[step];
+    digitalWrite(pin, current.on ? HIGH : LOW);
+    return current.durationMs;
+}
+
+void StatusLed::advance() {
+    if (pausing) {
+        pausing = false;
+        step = 0;
+        repeat = 0;
+        return;
+    }
+
+    if (++step < pattern.stepCount) {
+        return;
+    }
+
+    step = 0;
+    if (++repeat >= pattern.repeats) {
+        repeat = 0;
+        pausing = pattern.pauseMs > 0;
+    }
+}
+
+void StatusLed::timerCB(void* arg) {
+    StatusLed* led = static_cast<StatusLed*>(arg);
+
+    portENTER_CRITICAL(&led->mux);
+    led->advance();
+    uint32_t durationMs = led->apply();
+    portEXIT_CRITICAL(&led->mux);
+
+    if (durationMs > 0) {
+        esp_timer_start_once(led->timer, (uint64_t)durationMs * 1000);
+    }
+}
@@ -0,0 +1,142 @@
+/**
+ * Stick Drift Implementation
+ */
+
+#include <string.h>
+#include "stick_drift.h"
+
+#define TRIGGER_REST  (XBOX_TRIGGER_MAX / 32)
+
+static inline int32_t HOT_PATH absValue(int32_t value) {
+    return value < 0 ? -value : value;
+}
+
+// ============================================================================
+// StickDriftEstimator Implementation
+// ============================================================================
+
+StickDriftEstimator::StickDriftEstimator() {
+    reset();
+}
+
+void HOT_PATH StickDriftEstimator::update(const XboxControllerState& state) {
+    int32_t x = state.left_stick_x;
+    int32_t y = state.left_stick_y;
+
+    bool still = nearRest(x, previous[STICK_AXIS_X], STICK_AXIS_X)
+              && nearRest(y, previous[STICK_AXIS_Y], STICK_AXIS_Y)
+              && state.left_trigger < TRIGGER_REST
+              && state.right_trigger < TRIGGER_REST;
+    previous[STICK_AXIS_X] = (int16_t)x;
+    previous[STICK_AXIS_Y] = (int16_t)y;
+
+    if (!still) {
+        restFrames = 0;
+        return;
+    }
+    if (restFrames < STICK_DRIFT_SETTLE_FRAMES) {
+        restFrames++;
+        return;
+    }
+
+    // Seed from the first rest frame rather than converging from zero
+    if (record.samples == 0) {
+        record.axes[STICK_AXIS_X].centerQ8 = x * 256;
+        record.axes[STICK_AXIS_Y].centerQ8 = y * 256;
+    }
+    learn(x, record.axes[STICK_AXIS_X]);
+    learn(y, record.axes[STICK_AXIS_Y]);
+    record.samples++;
+
+    updateCalibration();
+}
+
+const StickCalibration& StickDriftEstimator::getCalibration() const {
+    return calibration;
+}
+
+bool StickDriftEstimator::isResting() const {
+    return restFrames >= STICK_DRIFT_SETTLE_FRAMES;
+}
+
+uint32_t StickDriftEstimator::getSamples() const {
+    return record.samples;
+}
+
+uint16_t StickDriftEstimator::getNoise(StickAxis axis) const {
+    return (uint16_t)(record.axes[axis].noiseQ8 >> 8);
+}
+
+const StickDriftRecord& StickDriftEstimator::getRecord() const {
+    return record;
+}
+
+bool StickDriftEstimator::load(const StickDriftRecord& saved) {
+    if (saved.version != STICK_DRIFT_RECORD_VERSION) {
+        return false;
+    }
+    record = saved;
+    restFrames = 0;
+    updateCalibration();
+    return true;
+}
+
+void StickDriftEstimator::reset() {
+    memset(&record, 0, sizeof(record));
+    record.version = STICK_DRIFT_RECORD_VERSION;
+    memset(&calibration, 0, sizeof(calibration));
+    previous[STICK_AXIS_X] = 0;
+    previous[STICK_AXIS_Y] = 0;
+    restFrames = 0;
+}
+
+bool HOT_PATH StickDriftEstimator::nearRest(int32_t value, int32_t last, StickAxis axis) const {
+    // Until calibrated, accept anything a worn stick could plausibly rest at;
+    // afterwards only what the learned deadzone would hide anyway
+    int32_t gate = calibration.valid ? 2 * calibration.deadzone[axis] : STICK_DRIFT_REST_GATE;
+    int32_t center = record.axes[axis].centerQ8 >> 8;
+
+    return absValue(value - center) <= gate
+        && absValue(value - last) <= STICK_DRIFT_MOTION_GATE;
+}
+
+void HOT_PATH StickDriftEstimator::learn(int32_t value, StickDriftAxis& axis) {
+    int32_t valueQ8 = value * 256;
+    axis.centerQ8 += (valueQ8 - axis.centerQ8) >> STICK_DRIFT_CENTER_SHIFT;
+
+    uint32_t deviationQ8 = (uint32_t)absValue(valueQ8 - axis.centerQ8);
+    axis.noiseQ8 = (uint32_t)((int32_t)axis.noiseQ8
+                   + (((int32_t)deviationQ8 - (int32_t)axis.noiseQ8) >> STICK_DRIFT_NOISE_SHIFT));
+
+    if (deviationQ8 > axis.peakQ8) {
+        axis.peakQ8 = deviationQ8;
+    } else {
+        axis.peakQ8 -= axis.peakQ8 >> STICK_DRIFT_PEAK_DECAY_SHIFT;
+    }
+}
+
+void HOT_PATH StickDriftEstimator::updateCalibration() {
+    for (uint8_t i = 0; i < STICK_AXIS_COUNT; i++) {
+        const StickDriftAxis& axis = record.axes[i];
+
+        int32_t center = axis.centerQ8 >> 8;
+        if (center > STICK_DRIFT_MAX_CENTER) {
+            center = STICK_DRIFT_MAX_CENTER;
+        } else if (center < -STICK_DRIFT_MAX_CENTER) {
+            center = -STICK_DRIFT_MAX_CENTER;
+        }
+
+        uint32_t noise = (axis.noiseQ8 * STICK_DRIFT_NOISE_MULT) >> 8;
+        uint32_t peak = axis.peakQ8 >> 8;
+        uint32_t deadzone = (noise > peak ? noise : peak) + STICK_DRIFT_MARGIN;
+        if (deadzone < STICK_DRIFT_MIN_DEADZONE) {
+            deadzone = STICK_DRIFT_MIN_DEADZONE;
+        } else if (deadzone > STICK_DRIFT_MAX_DEADZONE) {
+            deadzone = STICK_DRIFT_MAX_DEADZONE;
+        }
+
+        calibration.center[i] = (int16_t)center;
+        calibration.deadzone[i] = (uint16_t)deadzone;
+    }
+    calibration.valid = record.samples >= STICK_DRIFT_MIN_SAMPLES;
+}
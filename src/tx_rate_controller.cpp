@@ -0,0 +1,111 @@
+/**
+ * TX Rate Controller Implementation
+ */
+
+#include <string.h>
+#include "tx_rate_controller.h"
+
+const char* aimdDecisionName(AimdDecision decision) {
+    switch (decision) {
+        case AimdDecision::INCREASE:    return "increase";
+        case AimdDecision::CUT_FAILURE: return "cut (failure)";
+        case AimdDecision::CUT_LATENCY: return "cut (latency)";
+        default:                        return "none";
+    }
+}
+
+// ============================================================================
+// TxRateController Implementation
+// ============================================================================
+
+TxRateController::TxRateController(const AimdPolicy& policy)
+    : policy(policy)
+{
+    reset();
+    resetStats();
+}
+
+void TxRateController::reset() {
+    rateHz = policy.startRateHz;
+    healthyWrites = 0;
+    writesSinceCut = policy.windowWrites;
+}
+
+void TxRateController::recordWrite(bool ok, uint32_t latencyUs) {
+    stats.writes++;
+    if (writesSinceCut < policy.windowWrites) {
+        writesSinceCut++;
+    }
+
+    if (!ok) {
+        stats.failures++;
+        cut(AimdDecision::CUT_FAILURE);
+        return;
+    }
+    if (latencyUs > policy.latencyLimitUs) {
+        stats.slowWrites++;
+        cut(AimdDecision::CUT_LATENCY);
+        return;
+    }
+
+    if (++healthyWrites >= policy.windowWrites) {
+        healthyWrites = 0;
+        if (rateHz < policy.maxRateHz) {
+            rateHz += policy.increaseHz;
+            if (rateHz > policy.maxRateHz) {
+                rateHz = policy.maxRateHz;
+            }
+            stats.increases++;
+            stats.lastDecision = AimdDecision::INCREASE;
+            noteRate();
+        }
+    }
+}
+
+uint16_t TxRateController::getRateHz() const {
+    return rateHz;
+}
+
+uint32_t TxRateController::getIntervalMs() const {
+    return 1000 / rateHz;
+}
+
+const AimdStats& TxRateController::getStats() const {
+    return stats;
+}
+
+void TxRateController::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+    stats.lowestRateHz = rateHz;
+    stats.highestRateHz = rateHz;
+}
+
+void TxRateController::cut(AimdDecision reason) {
+    healthyWrites = 0;
+
+    // The writes that triggered the last cut are still draining
+    if (writesSinceCut < policy.windowWrites) {
+        return;
+    }
+    writesSinceCut = 0;
+
+    uint32_t cutHz = (uint32_t)rateHz * policy.decreasePercent / 100;
+    rateHz = cutHz < policy.minRateHz ? policy.minRateHz : (uint16_t)cutHz;
+
+    if (reason == AimdDecision::CUT_FAILURE) {
+        stats.failureCuts++;
+    } else {
+        stats.latencyCuts++;
+    }
+    stats.lastDecision = reason;
+    noteRate();
+}
+
+void TxRateController::noteRate() {
+    if (rateHz < stats.lowestRateHz) {
+        stats.lowestRateHz = rateHz;
+    }
+    if (rateHz > stats.highestRateHz) {
+        stats.highestRateHz = rateHz;
+    }
+}
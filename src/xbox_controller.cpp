@@ -0,0 +1,202 @@
+/**
+ * Xbox Controller Implementation
+ */
+
+#include "xbox_controller.h"
+#include "link_stats.h"
+
+// Global pointer for notification callbacks (NimBLE limitation)
+static XboxController* g_xboxController = nullptr;
+
+// ============================================================================
+// XboxController Implementation
+// ============================================================================
+
+XboxController::XboxController()
+    : bleClient(nullptr)
+    , subscribed(false)
+    , batteryLevel(0)
+    , reportCount(0)
+    , accepting(false)
+    , reportsInFlight(0)
+    , eventMux(portMUX_INITIALIZER_UNLOCKED)
+{
+    g_xboxController = this;
+    state.battery_level = 0;
+    xboxResetState(state);
+    publish();
+}
+
+bool XboxController::init(NimBLEClient* client) {
+    reset();
+    bleClient = client;
+
+    if (!bleClient || !bleClient->isConnected()) {
+        DEBUG_PRINTLN("[XBOX] ERROR: Controller is not connected");
+        return false;
+    }
+
+    NimBLERemoteService* hidService = bleClient->getService(XBOX_HID_SERVICE_UUID);
+    if (!hidService) {
+        DEBUG_PRINTLN("[XBOX] ERROR: HID service not found");
+        return false;
+    }
+
+    // The HID service has several report characteristics; inputs are the notifying ones
+    accepting.store(true);
+    std::vector<NimBLERemoteCharacteristic*>* characteristics = hidService->getCharacteristics(true);
+    for (NimBLERemoteCharacteristic* characteristic : *characteristics) {
+        if (characteristic->getUUID() == NimBLEUUID(XBOX_REPORT_CHARACTERISTIC_UUID) &&
+            characteristic->canNotify()) {
+            if (characteristic->subscribe(true, reportCB)) {
+                subscribed = true;
+            }
+        }
+    }
+
+    if (!subscribed) {
+        DEBUG_PRINTLN("[XBOX] ERROR: Failed to subscribe to input reports");
+        return false;
+    }
+
+    readBatteryLevel();
+    DEBUG_PRINTF("[XBOX] Controller ready (battery %u%%)\n", getBatteryLevel());
+    return true;
+}
+
+void XboxController::reset() {
+    // The link may still deliver a report while it closes. Close the gate,
+    // then wait out one already past it - the seqlock takes one writer.
+    accepting.store(false);
+    while (reportsInFlight.load() != 0) {
+    }
+
+    xboxResetState(state);
+    publish();
+
+    bleClient = nullptr;
+    subscribed = false;
+
+    portENTER_CRITICAL(&eventMux);
+    eventTracker.setInterval(0);
+    portEXIT_CRITICAL(&eventMux);
+}
+
+bool XboxController::isReady() {
+    return subscribed && bleClient && bleClient->isConnected();
+}
+
+XboxControllerState HOT_PATH XboxController::getState() {
+    XboxPackedState packed;
+    published.read(packed);
+
+    XboxControllerState copy;
+    xboxUnpackState(packed, copy);
+    copy.battery_level = batteryLevel.load(std::memory_order_relaxed);
+    return copy;
+}
+
+uint8_t XboxController::getBatteryLevel() {
+    return batteryLevel.load(std::memory_order_relaxed);
+}
+
+uint32_t XboxController::getReportCount() {
+    return reportCount;
+}
+
+uint32_t XboxController::getReadRetries() {
+    return published.getRetryCount();
+}
+
+void HOT_PATH XboxController::handleReport(const uint8_t* data, size_t length) {
+    // Checked after the count goes up, so reset() either sees the count or
+    // this call sees the gate closed (both sequentially consistent)
+    reportsInFlight.fetch_add(1);
+    if (accepting.load()) {
+        decodeReport(data, length);
+    }
+    reportsInFlight.fetch_sub(1);
+}
+
+void HOT_PATH XboxController::decodeReport(const uint8_t* data, size_t length) {
+    uint32_t nowUs = micros();
+    linkStatsRecordNotification(LinkId::XBOX, nowUs);
+
+    // Reports only arrive in connection events
+    portENTER_CRITICAL(&eventMux);
+    eventTracker.observe(nowUs);
+    portEXIT_CRITICAL(&eventMux);
+
+    if (!xboxParseBleReport(data, length, state)) {
+        return;
+    }
+    publish();
+    reportCount++;
+}
+
+void HOT_PATH XboxController::publish() {
+    XboxPackedState packed;
+    xboxPackState(state, packed);
+    published.write(packed);
+}
+
+bool XboxController::refreshBatteryLevel() {
+    if (!isReady()) {
+        return false;
+    }
+    readBatteryLevel();
+    return true;
+}
+
+void XboxController::refreshConnInterval() {
+    if (!isReady()) {
+        return;
+    }
+
+    uint32_t intervalUs = (uint32_t)bleClient->getConnInfo().getConnInterval() * 1250;
+    portENTER_CRITICAL(&eventMux);
+    eventTracker.setInterval(intervalUs);
+    portEXIT_CRITICAL(&eventMux);
+}
+
+ConnEventPhase XboxController::getConnEventPhase() {
+    uint32_t nowUs = micros();
+    portENTER_CRITICAL(&eventMux);
+    ConnEventPhase phase = eventTracker.getPhase(nowUs);
+    portEXIT_CRITICAL(&eventMux);
+    return phase;
+}
+
+ConnEventStats XboxController::getConnEventStats() {
+    portENTER_CRITICAL(&eventMux);
+    ConnEventStats stats = eventTracker.getStats();
+    portEXIT_CRITICAL(&eventMux);
+    return stats;
+}
+
+void XboxController::resetConnEventStats() {
+    portENTER_CRITICAL(&eventMux);
+    eventTracker.resetStats();
+    portEXIT_CRITICAL(&eventMux);
+}
+
+void XboxController::readBatteryLevel() {
+    NimBLERemoteService* batteryService = bleClient->getService(XBOX_BATTERY_SERVICE_UUID);
+    if (!batteryService) {
+        return;
+    }
+
+    NimBLERemoteCharacteristic* level = batteryService->getCharacteristic(XBOX_BATTERY_LEVEL_UUID);
+    if (level && level->canRead()) {
+        std::string value = level->readValue();
+        if (!value.empty()) {
+            batteryLevel.store((uint8_t)value[0], std::memory_order_relaxed);
+        }
+    }
+}
+
+void HOT_PATH XboxController::reportCB(NimBLERemoteCharacteristic* pChar, uint8_t* data, size_t length, bool isNotify) {
+    if (g_xboxController) {
+        g_xboxController->handleReport(data, length);
+    }
+}
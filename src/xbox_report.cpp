@@ -0,0 +1,169 @@
+/**
+ * Xbox Report Implementation
+ */
+
+#include "xbox_report.h"
+#include "config.h"
+
+static inline uint16_t HOT_PATH readU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline int16_t HOT_PATH readS16(const uint8_t* p) {
+    return (int16_t)readU16(p);
+}
+
+// Unsigned 0..65535 axis to signed -32768..32767
+static inline int16_t HOT_PATH axisToSigned(uint16_t raw) {
+    return (int16_t)((int32_t)raw - 32768);
+}
+
+// Unsigned axis where 0 is up, to signed with up positive
+static inline int16_t HOT_PATH axisToSignedInverted(uint16_t raw) {
+    int32_t value = 32767 - (int32_t)raw;
+    return (int16_t)(value < -32768 ? -32768 : value);
+}
+
+void xboxResetState(XboxControllerState& state) {
+    uint8_t battery = state.battery_level;
+    state = XboxControllerState();
+    state.battery_level = battery;
+}
+
+void HOT_PATH xboxPackState(const XboxControllerState& state, XboxPackedState& packed) {
+    packed.buttons = (uint16_t)(
+        (state.btn_a      ? 0x0001 : 0) | (state.btn_b     ? 0x0002 : 0) |
+        (state.btn_x      ? 0x0004 : 0) | (state.btn_y     ? 0x0008 : 0) |
+        (state.btn_lb     ? 0x0010 : 0) | (state.btn_rb    ? 0x0020 : 0) |
+        (state.btn_ls     ? 0x0040 : 0) | (state.btn_rs    ? 0x0080 : 0) |
+        (state.btn_view   ? 0x0100 : 0) | (state.btn_menu  ? 0x0200 : 0) |
+        (state.btn_xbox   ? 0x0400 : 0) | (state.btn_share ? 0x0800 : 0) |
+        (state.dpad_up    ? 0x1000 : 0) | (state.dpad_down ? 0x2000 : 0) |
+        (state.dpad_left  ? 0x4000 : 0) | (state.dpad_right ? 0x8000 : 0));
+    packed.left_stick_x  = state.left_stick_x;
+    packed.left_stick_y  = state.left_stick_y;
+    packed.right_stick_x = state.right_stick_x;
+    packed.right_stick_y = state.right_stick_y;
+    packed.left_trigger  = state.left_trigger;
+    packed.right_trigger = state.right_trigger;
+    packed.battery_level = state.battery_level;
+    packed.reserved      = 0;
+}
+
+void HOT_PATH xboxUnpackState(const XboxPackedState& packed, XboxControllerState& state) {
+    uint16_t b = packed.buttons;
+    state.btn_a      = b & 0x0001;
+    state.btn_b      = b & 0x0002;
+    state.btn_x      = b & 0x0004;
+    state.btn_y      = b & 0x0008;
+    state.btn_lb     = b & 0x0010;
+    state.btn_rb     = b & 0x0020;
+    state.btn_ls     = b & 0x0040;
+    state.btn_rs     = b & 0x0080;
+    state.btn_view   = b & 0x0100;
+    state.btn_menu   = b & 0x0200;
+    state.btn_xbox   = b & 0x0400;
+    state.btn_share  = b & 0x0800;
+    state.dpad_up    = b & 0x1000;
+    state.dpad_down  = b & 0x2000;
+    state.dpad_left  = b & 0x4000;
+    state.dpad_right = b & 0x8000;
+    state.left_stick_x  = packed.left_stick_x;
+    state.left_stick_y  = packed.left_stick_y;
+    state.right_stick_x = packed.right_stick_x;
+    state.right_stick_y = packed.right_stick_y;
+    state.left_trigger  = packed.left_trigger;
+    state.right_trigger = packed.right_trigger;
+    state.battery_level = packed.battery_level;
+}
+
+bool HOT_PATH xboxParseBleReport(const uint8_t* data, size_t length, XboxControllerState& state) {
+    if (!data || length < XBOX_BLE_REPORT_SIZE - 1) {
+        return false;
+    }
+
+    state.left_stick_x  = axisToSigned(readU16(&data[0]));
+    state.left_stick_y  = axisToSignedInverted(readU16(&data[2]));
+    state.right_stick_x = axisToSigned(readU16(&data[4]));
+    state.right_stick_y = axisToSignedInverted(readU16(&data[6]));
+
+    state.left_trigger  = readU16(&data[8]) & 0x03FF;
+    state.right_trigger = readU16(&data[10]) & 0x03FF;
+
+    // Hat: 1 = N, 2 = NE, 3 = E ... 8 = NW
+    uint8_t hat = data[12];
+    state.dpad_up    = (hat == 1 || hat == 2 || hat == 8);
+    state.dpad_right = (hat == 2 || hat == 3 || hat == 4);
+    state.dpad_down  = (hat == 4 || hat == 5 || hat == 6);
+    state.dpad_left  = (hat == 6 || hat == 7 || hat == 8);
+
+    uint8_t buttons = data[13];
+    state.btn_a  = buttons & 0x01;
+    state.btn_b  = buttons & 0x02;
+    state.btn_x  = buttons & 0x08;
+    state.btn_y  = buttons & 0x10;
+    state.btn_lb = buttons & 0x40;
+    state.btn_rb = buttons & 0x80;
+
+    uint8_t system = data[14];
+    state.btn_view = system & 0x04;
+    state.btn_menu = system & 0x08;
+    state.btn_xbox = system & 0x10;
+    state.btn_ls   = system & 0x20;
+    state.btn_rs   = system & 0x40;
+
+    state.btn_share = (length >= XBOX_BLE_REPORT_SIZE) ? (data[15] & 0x01) : false;
+
+    return true;
+}
+
+bool HOT_PATH xboxParseGipReport(const uint8_t* data, size_t length, XboxControllerState& state) {
+    if (!data || length < GIP_HEADER_SIZE) {
+        return false;
+    }
+
+    switch (data[0]) {
+        case GIP_CMD_INPUT:
+            if (length < GIP_INPUT_REPORT_SIZE) {
+                return false;
+            }
+            break;
+        case GIP_CMD_VIRTUAL_KEY:
+            if (length < GIP_HEADER_SIZE + 1) {
+                return false;
+            }
+            state.btn_xbox = data[4] & 0x01;
+            return true;
+        default:
+            return false;
+    }
+
+    uint8_t buttons = data[4];
+    state.btn_menu = buttons & 0x04;
+    state.btn_view = buttons & 0x08;
+    state.btn_a    = buttons & 0x10;
+    state.btn_b    = buttons & 0x20;
+    state.btn_x    = buttons & 0x40;
+    state.btn_y    = buttons & 0x80;
+
+    uint8_t dpadShoulders = data[5];
+    state.dpad_up    = dpadShoulders & 0x01;
+    state.dpad_down  = dpadShoulders & 0x02;
+    state.dpad_left  = dpadShoulders & 0x04;
+    state.dpad_right = dpadShoulders & 0x08;
+    state.btn_lb     = dpadShoulders & 0x10;
+    state.btn_rb     = dpadShoulders & 0x20;
+    state.btn_ls     = dpadShoulders & 0x40;
+    state.btn_rs     = dpadShoulders & 0x80;
+
+    state.left_trigger  = readU16(&data[6]) & 0x03FF;
+    state.right_trigger = readU16(&data[8]) & 0x03FF;
+
+    // Already signed with Y up, the same convention as XboxControllerState
+    state.left_stick_x  = readS16(&data[10]);
+    state.left_stick_y  = readS16(&data[12]);
+    state.right_stick_x = readS16(&data[14]);
+    state.right_stick_y = readS16(&data[16]);
+
+    return true;
+}
@@ -0,0 +1,281 @@
+/**
+ * Xbox USB Implementation
+ */
+
+#include "xbox_usb.h"
+
+#if XBOX_INPUT_USB
+
+#include "link_stats.h"
+
+// GIP vendor interface of Xbox One / Series pads
+#define GIP_INTERFACE_CLASS     0xFF
+#define GIP_INTERFACE_SUBCLASS  0x47
+#define GIP_INTERFACE_PROTOCOL  0xD0
+#define XBOX_USB_TRANSFER_SIZE  64
+
+// Without this the pad enumerates but never reports input
+static const uint8_t GIP_POWER_ON[] = { 0x05, 0x20, 0x00, 0x01, 0x00 };
+
+// ============================================================================
+// XboxUsbController Implementation
+// ============================================================================
+
+XboxUsbController::XboxUsbController()
+    : clientHandle(nullptr)
+    , deviceHandle(nullptr)
+    , inTransfer(nullptr)
+    , outTransfer(nullptr)
+    , interfaceNumber(0)
+    , inEndpoint(0)
+    , outEndpoint(0)
+    , inPacketSize(0)
+    , sequence(0)
+    , ready(false)
+    , reportCount(0)
+{
+    // A wired pad is bus powered
+    state.battery_level = 100;
+    xboxResetState(state);
+    publish();
+}
+
+bool XboxUsbController::init() {
+    usb_host_config_t hostConfig = {};
+    hostConfig.intr_flags = ESP_INTR_FLAG_LEVEL1;
+    if (usb_host_install(&hostConfig) != ESP_OK) {
+        DEBUG_PRINTLN("[XBOX] ERROR: USB host install failed");
+        return false;
+    }
+    xTaskCreatePinnedToCore(hostTask, "usb_host", XBOX_USB_TASK_STACK, this,
+                            XBOX_USB_TASK_PRIORITY, nullptr, XBOX_USB_TASK_CORE);
+
+    usb_host_client_config_t clientConfig = {};
+    clientConfig.is_synchronous = false;
+    clientConfig.max_num_event_msg = 5;
+    clientConfig.async.client_event_callback = clientEventCB;
+    clientConfig.async.callback_arg = this;
+    if (usb_host_client_register(&clientConfig, &clientHandle) != ESP_OK) {
+        DEBUG_PRINTLN("[XBOX] ERROR: USB client register failed");
+        return false;
+    }
+    xTaskCreatePinnedToCore(clientTask, "xbox_usb", XBOX_USB_TASK_STACK, this,
+                            XBOX_USB_TASK_PRIORITY, nullptr, XBOX_USB_TASK_CORE);
+
+    DEBUG_PRINTLN("[XBOX] USB host ready - waiting for a wired controller");
+    return true;
+}
+
+void XboxUsbController::reset() {
+    // The USB link does not depend on BLE - keep the pad and its last input
+}
+
+bool XboxUsbController::isReady() {
+    return ready;
+}
+
+XboxControllerState HOT_PATH XboxUsbController::getState() {
+    XboxPackedState packed;
+    published.read(packed);
+
+    XboxControllerState copy;
+    xboxUnpackState(packed, copy);
+    return copy;
+}
+
+uint8_t XboxUsbController::getBatteryLevel() {
+    return 100;
+}
+
+uint32_t XboxUsbController::getReportCount() {
+    return reportCount;
+}
+
+uint32_t XboxUsbController::getReadRetries() {
+    return published.getRetryCount();
+}
+
+void HOT_PATH XboxUsbController::handleReport(const uint8_t* data, size_t length) {
+    linkStatsRecordNotification(LinkId::XBOX, micros());
+
+    if (xboxParseGipReport(data, length, state)) {
+        publish();
+        reportCount++;
+    }
+}
+
+void HOT_PATH XboxUsbController::publish() {
+    XboxPackedState packed;
+    xboxPackState(state, packed);
+    published.write(packed);
+}
+
+// ============================================================================
+// Device Handling (USB client task)
+// ============================================================================
+
+void XboxUsbController::openDevice(uint8_t address) {
+    if (deviceHandle) {
+        return;  // One pad at a time
+    }
+    if (usb_host_device_open(clientHandle, address, &deviceHandle) != ESP_OK) {
+        deviceHandle = nullptr;
+        return;
+    }
+
+    const usb_device_desc_t* device;
+    const usb_config_desc_t* config;
+    if (usb_host_get_device_descriptor(deviceHandle, &device) != ESP_OK
+        || device->idVendor != XBOX_USB_VENDOR_ID
+        || usb_host_get_active_config_descriptor(deviceHandle, &config) != ESP_OK
+        || !findGipInterface(config)) {
+        DEBUG_PRINTLN("[XBOX] USB device is not an Xbox controller - ignored");
+        usb_host_device_close(clientHandle, deviceHandle);
+        deviceHandle = nullptr;
+        return;
+    }
+
+    if (usb_host_interface_claim(clientHandle, deviceHandle, interfaceNumber, 0) != ESP_OK) {
+        DEBUG_PRINTLN("[XBOX] ERROR: Failed to claim the GIP interface");
+        usb_host_device_close(clientHandle, deviceHandle);
+        deviceHandle = nullptr;
+        return;
+    }
+
+    if (!inTransfer) {
+        usb_host_transfer_alloc(XBOX_USB_TRANSFER_SIZE, 0, &inTransfer);
+    }
+    if (!outTransfer) {
+        usb_host_transfer_alloc(XBOX_USB_TRANSFER_SIZE, 0, &outTransfer);
+    }
+
+    inTransfer->device_handle = deviceHandle;
+    inTransfer->bEndpointAddress = inEndpoint;
+    inTransfer->callback = inTransferCB;
+    inTransfer->context = this;
+    inTransfer->num_bytes = inPacketSize;
+
+    outTransfer->device_handle = deviceHandle;
+    outTransfer->bEndpointAddress = outEndpoint;
+    outTransfer->callback = outTransferCB;
+    outTransfer->context = this;
+
+    if (!sendPowerOn()) {
+        DEBUG_PRINTLN("[XBOX] WARNING: Failed to send GIP power-on");
+    }
+
+    ready = true;
+    usb_host_transfer_submit(inTransfer);
+    DEBUG_PRINTF("[XBOX] Wired controller connected (PID 0x%04x)\n", device->idProduct);
+}
+
+void XboxUsbController::closeDevice() {
+    ready = false;
+
+    xboxResetState(state);
+    publish();
+
+    if (!deviceHandle) {
+        return;
+    }
+
+    // A pending IN transfer completes with an error and is not resubmitted
+    usb_host_endpoint_halt(deviceHandle, inEndpoint);
+    usb_host_endpoint_flush(deviceHandle, inEndpoint);
+    usb_host_interface_release(clientHandle, deviceHandle, interfaceNumber);
+    usb_host_device_close(clientHandle, deviceHandle);
+    deviceHandle = nullptr;
+
+    DEBUG_PRINTLN("[XBOX] Wired controller disconnected");
+}
+
+bool XboxUsbController::findGipInterface(const usb_config_desc_t* config) {
+    int offset = 0;
+    const usb_standard_desc_t* desc = (const usb_standard_desc_t*)config;
+
+    while ((desc = usb_parse_next_descriptor_of_type(desc, config->wTotalLength,
+                                                     USB_B_DESCRIPTOR_TYPE_INTERFACE, &offset))) {
+        const usb_intf_desc_t* intf = (const usb_intf_desc_t*)desc;
+        if (intf->bInterfaceClass != GIP_INTERFACE_CLASS
+            || intf->bInterfaceSubClass != GIP_INTERFACE_SUBCLASS
+            || intf->bInterfaceProtocol != GIP_INTERFACE_PROTOCOL
+            || intf->bAlternateSetting != 0) {
+            continue;
+        }
+
+        inEndpoint = 0;
+        outEndpoint = 0;
+        for (int i = 0; i < intf->bNumEndpoints; i++) {
+            int endpointOffset = offset;
+            const usb_ep_desc_t* ep = usb_parse_endpoint_descriptor_by_index(
+                intf, i, config->wTotalLength, &endpointOffset);
+            if (!ep || (ep->bmAttributes & USB_BM_ATTRIBUTES_XFERTYPE_MASK) != USB_BM_ATTRIBUTES_XFER_INT) {
+                continue;
+            }
+            if (ep->bEndpointAddress & USB_B_ENDPOINT_ADDRESS_EP_DIR_MASK) {
+                inEndpoint = ep->bEndpointAddress;
+                inPacketSize = ep->wMaxPacketSize;
+            } else {
+                outEndpoint = ep->bEndpointAddress;
+            }
+        }
+
+        if (inEndpoint && outEndpoint) {
+            interfaceNumber = intf->bInterfaceNumber;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool XboxUsbController::sendPowerOn() {
+    memcpy(outTransfer->data_buffer, GIP_POWER_ON, sizeof(GIP_POWER_ON));
+    outTransfer->data_buffer[2] = sequence++;
+    outTransfer->num_bytes = sizeof(GIP_POWER_ON);
+    return usb_host_transfer_submit(outTransfer) == ESP_OK;
+}
+
+// ============================================================================
+// Tasks and Callbacks
+// ============================================================================
+
+void XboxUsbController::hostTask(void* arg) {
+    while (true) {
+        uint32_t eventFlags;
+        usb_host_lib_handle_events(portMAX_DELAY, &eventFlags);
+    }
+}
+
+void XboxUsbController::clientTask(void* arg) {
+    XboxUsbController* controller = static_cast<XboxUsbController*>(arg);
+    while (true) {
+        usb_host_client_handle_events(controller->clientHandle, portMAX_DELAY);
+    }
+}
+
+void XboxUsbController::clientEventCB(const usb_host_client_event_msg_t* msg, void* arg) {
+    XboxUsbController* controller = static_cast<XboxUsbController*>(arg);
+
+    if (msg->event == USB_HOST_CLIENT_EVENT_NEW_DEV) {
+        controller->openDevice(msg->new_dev.address);
+    } else if (msg->event == USB_HOST_CLIENT_EVENT_DEV_GONE) {
+        controller->closeDevice();
+    }
+}
+
+void HOT_PATH XboxUsbController::inTransferCB(usb_transfer_t* transfer) {
+    XboxUsbController* controller = static_cast<XboxUsbController*>(transfer->context);
+    if (transfer->status == USB_TRANSFER_STATUS_COMPLETED) {
+        controller->handleReport(transfer->data_buffer, transfer->actual_num_bytes);
+    }
+
+    if (controller->ready) {
+        usb_host_transfer_submit(transfer);
+    }
+}
+
+void XboxUsbController::outTransferCB(usb_transfer_t* transfer) {
+    // Fire-and-forget
+}
+
+#endif // XBOX_INPUT_USB
@@ -0,0 +1,160 @@
+/**
+ * Connect Retry Tests - Backoff, jitter and exhaustion
+ *
+ * Run on the host: pio test -e native
+ *
+ * Uses the firmware's policy from config.h: 250 ms doubling per retry,
+ * capped at 2000 ms, +/- 25% jitter. The random value passed to
+ * recordFailure() picks the jitter, so the extremes can be asked for.
+ */
+
+#include <unity.h>
+#include <stdint.h>
+#include "config.h"
+#include "connect_retry.h"
+
+#define JITTER_SPAN  (2 * BLE_RETRY_JITTER_PERCENT + 1)
+#define JITTER_LOW   0                               // -25%
+#define JITTER_NONE  BLE_RETRY_JITTER_PERCENT        // +0%
+#define JITTER_HIGH  (2 * BLE_RETRY_JITTER_PERCENT)  // +25%
+
+static const RetryPolicy FIRMWARE_POLICY = {
+    1 + BLE_MAX_RETRIES,
+    BLE_RETRY_BASE_MS,
+    BLE_RETRY_MAX_MS,
+    BLE_RETRY_JITTER_PERCENT
+};
+
+// Same delays, enough attempts to reach the cap
+static const RetryPolicy LONG_POLICY = {
+    8,
+    BLE_RETRY_BASE_MS,
+    BLE_RETRY_MAX_MS,
+    BLE_RETRY_JITTER_PERCENT
+};
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+static void test_policy_values() {
+    TEST_ASSERT_EQUAL_UINT32(250, BLE_RETRY_BASE_MS);
+    TEST_ASSERT_EQUAL_UINT32(2000, BLE_RETRY_MAX_MS);
+    TEST_ASSERT_EQUAL_UINT32(25, BLE_RETRY_JITTER_PERCENT);
+}
+
+static void test_first_attempt_immediate() {
+    ConnectRetry retry(FIRMWARE_POLICY);
+    TEST_ASSERT_TRUE(retry.isDue(0));
+    TEST_ASSERT_TRUE(retry.isDue(123456));
+    TEST_ASSERT_FALSE(retry.isExhausted());
+    TEST_ASSERT_EQUAL_UINT8(0, retry.getAttempt());
+}
+
+static void test_backoff_doubles_to_cap() {
+    ConnectRetry retry(LONG_POLICY);
+    static const uint32_t EXPECTED_MS[] = { 250, 500, 1000, 2000, 2000, 2000, 2000 };
+
+    uint32_t nowMs = 10000;
+    for (int i = 0; i < 7; i++) {
+        retry.recordFailure(nowMs, JITTER_NONE);
+        TEST_ASSERT_EQUAL_UINT32(EXPECTED_MS[i], retry.getNextDelayMs());
+        TEST_ASSERT_FALSE(retry.isDue(nowMs + EXPECTED_MS[i] - 1));
+        TEST_ASSERT_TRUE(retry.isDue(nowMs + EXPECTED_MS[i]));
+        nowMs += EXPECTED_MS[i];
+    }
+}
+
+static void test_jitter_bounds() {
+    static const uint32_t NOMINAL_MS[] = { 250, 500, 1000, 2000, 2000 };
+
+    // Every random value, including ones far beyond the span
+    static const uint32_t RANDOM[] = {
+        JITTER_LOW, JITTER_NONE, JITTER_HIGH, JITTER_SPAN, 12345, 0xffffffff
+    };
+    for (size_t r = 0; r < sizeof(RANDOM) / sizeof(RANDOM[0]); r++) {
+        ConnectRetry retry(LONG_POLICY);
+        for (int i = 0; i < 5; i++) {
+            retry.recordFailure(0, RANDOM[r]);
+            uint32_t delayMs = retry.getNextDelayMs();
+            TEST_ASSERT_TRUE(delayMs >= NOMINAL_MS[i] * 75 / 100);
+            TEST_ASSERT_TRUE(delayMs <= NOMINAL_MS[i] * 125 / 100);
+        }
+    }
+
+    // The extremes are reached
+    ConnectRetry low(LONG_POLICY);
+    ConnectRetry high(LONG_POLICY);
+    low.recordFailure(0, JITTER_LOW);
+    high.recordFailure(0, JITTER_HIGH);
+    TEST_ASSERT_EQUAL_UINT32(187, low.getNextDelayMs());
+    TEST_ASSERT_EQUAL_UINT32(312, high.getNextDelayMs());
+    for (int i = 0; i < 4; i++) {
+        low.recordFailure(0, JITTER_LOW);
+        high.recordFailure(0, JITTER_HIGH);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1500, low.getNextDelayMs());
+    TEST_ASSERT_EQUAL_UINT32(2500, high.getNextDelayMs());
+}
+
+static void test_exhausted_after_max_attempts() {
+    ConnectRetry retry(FIRMWARE_POLICY);
+    for (int i = 0; i < BLE_MAX_RETRIES; i++) {
+        retry.recordFailure(0, JITTER_NONE);
+        TEST_ASSERT_FALSE(retry.isExhausted());
+    }
+    retry.recordFailure(0, JITTER_NONE);
+    TEST_ASSERT_TRUE(retry.isExhausted());
+    TEST_ASSERT_FALSE(retry.isDue(1000000));
+    TEST_ASSERT_EQUAL_UINT8(1 + BLE_MAX_RETRIES, retry.getAttempt());
+    TEST_ASSERT_EQUAL_UINT32(1, retry.getStats().exhausted);
+    TEST_ASSERT_EQUAL_UINT32(1 + BLE_MAX_RETRIES, retry.getStats().attempts);
+
+    // A rescan starts over from the base delay
+    retry.reset();
+    TEST_ASSERT_TRUE(retry.isDue(0));
+    retry.recordFailure(0, JITTER_NONE);
+    TEST_ASSERT_EQUAL_UINT32(250, retry.getNextDelayMs());
+}
+
+static void test_success_resets_backoff() {
+    ConnectRetry retry(FIRMWARE_POLICY);
+    retry.recordFailure(0, JITTER_NONE);
+    retry.recordFailure(250, JITTER_NONE);
+    retry.recordSuccess();
+
+    TEST_ASSERT_EQUAL_UINT8(0, retry.getAttempt());
+    TEST_ASSERT_TRUE(retry.isDue(750));
+    TEST_ASSERT_EQUAL_UINT32(1, retry.getStats().successes);
+    TEST_ASSERT_EQUAL_UINT8(3, retry.getStats().maxAttemptsUsed);
+    TEST_ASSERT_EQUAL_UINT32(300, retry.getAttemptsPerSuccessX100());
+
+    retry.recordFailure(1000, JITTER_NONE);
+    TEST_ASSERT_EQUAL_UINT32(250, retry.getNextDelayMs());
+}
+
+static void test_due_across_millis_wrap() {
+    ConnectRetry retry(FIRMWARE_POLICY);
+    uint32_t nowMs = 0xffffff00;
+    retry.recordFailure(nowMs, JITTER_NONE);
+    TEST_ASSERT_FALSE(retry.isDue(nowMs + 249));
+    TEST_ASSERT_TRUE(retry.isDue(nowMs + 250));   // Wrapped past zero
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_policy_values);
+    RUN_TEST(test_first_attempt_immediate);
+    RUN_TEST(test_backoff_doubles_to_cap);
+    RUN_TEST(test_jitter_bounds);
+    RUN_TEST(test_exhausted_after_max_attempts);
+    RUN_TEST(test_success_resets_backoff);
+    RUN_TEST(test_due_across_millis_wrap);
+    return UNITY_END();
+}
@@ -0,0 +1,154 @@
+/**
+ * Lego TX Scheduler Tests - Priority, replacement and preemption
+ *
+ * Run on the host: pio test -e native
+ *
+ * Each frame carries its own speed byte, so what comes out of pop() shows
+ * which submission survived.
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "lego_tx_scheduler.h"
+
+static LegoTxScheduler scheduler;
+
+void setUp() {
+    scheduler.clear();
+    scheduler.resetStats();
+}
+
+void tearDown() {
+}
+
+static LegoFrame driveFrame(int8_t speed) {
+    LegoFrame frame;
+    legoEncodeDrive(frame, speed, 0, 0);
+    return frame;
+}
+
+static void assertPop(LegoTxClass expectedCls, int8_t expectedSpeed, uint32_t expectedSubmittedUs) {
+    LegoFrame frame;
+    LegoTxClass cls;
+    uint32_t submittedUs;
+    TEST_ASSERT_TRUE(scheduler.pop(frame, cls, submittedUs));
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)expectedCls, (uint8_t)cls);
+    TEST_ASSERT_EQUAL_INT8(expectedSpeed, (int8_t)frame.data[LEGO_FRAME_SPEED_OFFSET]);
+    TEST_ASSERT_EQUAL_UINT32(expectedSubmittedUs, submittedUs);
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+static void test_strict_priority() {
+    // Submitted lowest first, popped highest first
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::AUX, driveFrame(4), 100));
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::DRIVE, driveFrame(3), 200));
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::CALIBRATION, driveFrame(2), 300));
+
+    LegoTxClass cls;
+    TEST_ASSERT_TRUE(scheduler.peek(cls));
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)LegoTxClass::CALIBRATION, (uint8_t)cls);
+    assertPop(LegoTxClass::CALIBRATION, 2, 300);
+    assertPop(LegoTxClass::DRIVE, 3, 200);
+    assertPop(LegoTxClass::AUX, 4, 100);
+
+    TEST_ASSERT_FALSE(scheduler.hasPending());
+    TEST_ASSERT_FALSE(scheduler.peek(cls));
+}
+
+static void test_stop_goes_first() {
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::CALIBRATION, driveFrame(2), 100));
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::STOP, driveFrame(0), 200));
+
+    assertPop(LegoTxClass::STOP, 0, 200);
+    assertPop(LegoTxClass::CALIBRATION, 2, 100);
+    TEST_ASSERT_FALSE(scheduler.hasPending());
+}
+
+static void test_drive_and_aux_latest_wins() {
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::DRIVE, driveFrame(10), 100));
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::DRIVE, driveFrame(20), 200));
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::DRIVE, driveFrame(30), 300));
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::AUX, driveFrame(40), 400));
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::AUX, driveFrame(50), 500));
+
+    // Newest frame, oldest timestamp - the wait counts from the first submit
+    assertPop(LegoTxClass::DRIVE, 30, 100);
+    assertPop(LegoTxClass::AUX, 50, 400);
+    TEST_ASSERT_FALSE(scheduler.hasPending());
+
+    const LegoTxStats& stats = scheduler.getStats();
+    TEST_ASSERT_EQUAL_UINT32(3, stats.submitted[(int)LegoTxClass::DRIVE]);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.replaced[(int)LegoTxClass::DRIVE]);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.submitted[(int)LegoTxClass::AUX]);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.replaced[(int)LegoTxClass::AUX]);
+
+    // A popped slot starts over
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::DRIVE, driveFrame(60), 600));
+    assertPop(LegoTxClass::DRIVE, 60, 600);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.replaced[(int)LegoTxClass::DRIVE]);
+}
+
+static void test_calibration_fifo() {
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::CALIBRATION, driveFrame(1), 100));
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::CALIBRATION, driveFrame(2), 200));
+
+    // Third frame does not fit and does not displace the others
+    TEST_ASSERT_FALSE(scheduler.submit(LegoTxClass::CALIBRATION, driveFrame(3), 300));
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.getStats().calibrationDropped);
+
+    assertPop(LegoTxClass::CALIBRATION, 1, 100);
+
+    // Wraps around the ring
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::CALIBRATION, driveFrame(4), 400));
+    assertPop(LegoTxClass::CALIBRATION, 2, 200);
+    assertPop(LegoTxClass::CALIBRATION, 4, 400);
+    TEST_ASSERT_FALSE(scheduler.hasPending());
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.getStats().replaced[(int)LegoTxClass::CALIBRATION]);
+}
+
+static void test_stop_discards_drive_and_aux() {
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::DRIVE, driveFrame(80), 100));
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::AUX, driveFrame(80), 150));
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::CALIBRATION, driveFrame(1), 175));
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::STOP, driveFrame(0), 200));
+
+    const LegoTxStats& stats = scheduler.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.drivePreempted);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.auxPreempted);
+
+    // Calibration survives - it carries no speed
+    assertPop(LegoTxClass::STOP, 0, 200);
+    assertPop(LegoTxClass::CALIBRATION, 1, 175);
+    TEST_ASSERT_FALSE(scheduler.hasPending());
+
+    // Drive frames submitted after the stop are sent normally
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::DRIVE, driveFrame(20), 300));
+    assertPop(LegoTxClass::DRIVE, 20, 300);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.drivePreempted);
+}
+
+static void test_sent_latency_stats() {
+    TEST_ASSERT_TRUE(scheduler.submit(LegoTxClass::DRIVE, driveFrame(10), 1000));
+    scheduler.recordSent(LegoTxClass::DRIVE, 1000, 4000);
+    scheduler.recordSent(LegoTxClass::DRIVE, 5000, 6000);
+
+    const LegoTxStats& stats = scheduler.getStats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.sent[(int)LegoTxClass::DRIVE]);
+    TEST_ASSERT_EQUAL_UINT32(3000, stats.latencyMaxUs[(int)LegoTxClass::DRIVE]);
+    TEST_ASSERT_EQUAL_UINT32(4000, (uint32_t)stats.latencySumUs[(int)LegoTxClass::DRIVE]);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.sent[(int)LegoTxClass::STOP]);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_strict_priority);
+    RUN_TEST(test_stop_goes_first);
+    RUN_TEST(test_drive_and_aux_latest_wins);
+    RUN_TEST(test_calibration_fifo);
+    RUN_TEST(test_stop_discards_drive_and_aux);
+    RUN_TEST(test_sent_latency_stats);
+    return UNITY_END();
+}
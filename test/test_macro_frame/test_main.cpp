@@ -0,0 +1,166 @@
+/**
+ * Macro Frame Tests - Track hash and 'macro dump' round trip
+ *
+ * Run on the host: pio test -e native
+ *
+ * A session is recorded the way MacroRecorder does it (controller input
+ * through the control mapper), printed as 'macro dump' lines, read back
+ * and replayed through a fresh mapper. Both must reproduce the recorded
+ * track hash bit for bit.
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "control_mapper.h"
+#include "macro_frame.h"
+
+#define SESSION_FRAMES   400
+#define SESSION_PERIOD_US 20000
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+static MacroFrame makeFrame(uint32_t offsetUs, int8_t speed, int8_t steering, uint8_t lights, uint8_t stop) {
+    MacroFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.offsetUs = offsetUs;
+    frame.speed = speed;
+    frame.steering = steering;
+    frame.lights = lights;
+    frame.stop = stop;
+    return frame;
+}
+
+// Synthetic driving: throttle ramps, steering sweeps, a light toggle and
+// an emergency stop (B + X) near the end
+static void sessionInput(int i, XboxControllerState& input) {
+    memset(&input, 0, sizeof(input));
+    input.right_trigger = (uint16_t)((i * 7) % 1024);
+    input.left_trigger = (uint16_t)(i > 300 ? (i - 300) * 10 : 0);
+    input.left_stick_x = (int16_t)((i % 100) * 655 - 32750);
+    input.left_stick_y = (int16_t)(i * 80 - 16000);
+    input.btn_a = (i >= 50 && i < 55);
+    input.btn_b = input.btn_x = (i >= 380 && i < 390);
+    input.battery_level = 90;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+static void test_hash_golden_values() {
+    // FNV-1a over offset (little-endian), speed, steering, lights, stop
+    MacroFrame f1 = makeFrame(0, 0, 0, 0, 0);
+    MacroFrame f2 = makeFrame(20000, -100, 37, 0x12, 0);
+    MacroFrame f3 = makeFrame(40123, 0, -5, 0x80, 1);
+
+    uint32_t hash = macroHashFrame(MACRO_HASH_SEED, f1);
+    TEST_ASSERT_EQUAL_UINT32(0x9be17165, hash);
+    hash = macroHashFrame(macroHashFrame(hash, f2), f3);
+    TEST_ASSERT_EQUAL_UINT32(0x1c9cfed7, hash);
+
+    // Order matters
+    hash = macroHashFrame(MACRO_HASH_SEED, f1);
+    hash = macroHashFrame(macroHashFrame(hash, f3), f2);
+    TEST_ASSERT_EQUAL_UINT32(0x3c13e573, hash);
+}
+
+static void test_parse_rejects_other_lines() {
+    MacroFrame frame;
+    uint32_t count, hash;
+
+    TEST_ASSERT_FALSE(macroParseFrame(MACRO_DUMP_HEADER, frame));
+    TEST_ASSERT_FALSE(macroParseFrame("[MACRO] Playback stopped", frame));
+    TEST_ASSERT_FALSE(macroParseFrame("100,1,2,3", frame));
+    TEST_ASSERT_FALSE(macroParseFrame("# 3 frames, hash 0x1c9cfed7", frame));
+
+    TEST_ASSERT_TRUE(macroParseTrailer("# 3 frames, hash 0x1c9cfed7", count, hash));
+    TEST_ASSERT_EQUAL_UINT32(3, count);
+    TEST_ASSERT_EQUAL_UINT32(0x1c9cfed7, hash);
+    TEST_ASSERT_FALSE(macroParseTrailer("0,0,0,0,0,0,0,0,0,0,0,0", count, hash));
+}
+
+static void test_dump_replays_bit_for_bit() {
+    // Record
+    ControlMapper recorder;
+    std::vector<MacroFrame> track;
+    uint32_t trackHash = MACRO_HASH_SEED;
+    for (int i = 0; i < SESSION_FRAMES; i++) {
+        XboxControllerState input;
+        sessionInput(i, input);
+        MappedControls controls = recorder.map(input);
+
+        MacroFrame frame = makeFrame((uint32_t)i * SESSION_PERIOD_US, controls.speed,
+                                     controls.steering, controls.lights,
+                                     controls.emergencyStop ? 1 : 0);
+        xboxPackState(input, frame.input);
+        track.push_back(frame);
+        trackHash = macroHashFrame(trackHash, frame);
+    }
+
+    // Dump
+    std::string dump = MACRO_DUMP_HEADER "\n";
+    char line[96];
+    for (size_t i = 0; i < track.size(); i++) {
+        macroFormatFrame(line, sizeof(line), track[i]);
+        dump += line;
+        dump += "\n";
+    }
+    macroFormatTrailer(line, sizeof(line), (uint32_t)track.size(), trackHash);
+    dump += line;
+    dump += "\n";
+
+    // Read back and replay
+    ControlMapper player;
+    uint32_t parsedHash = MACRO_HASH_SEED;
+    uint32_t replayHash = MACRO_HASH_SEED;
+    uint32_t parsed = 0;
+    uint32_t trailerCount = 0;
+    uint32_t trailerHash = 0;
+    size_t start = 0;
+    while (start < dump.size()) {
+        size_t end = dump.find('\n', start);
+        std::string text = dump.substr(start, end - start);
+        start = end + 1;
+
+        MacroFrame frame;
+        if (macroParseFrame(text.c_str(), frame)) {
+            TEST_ASSERT_EQUAL_UINT32(track[parsed].offsetUs, frame.offsetUs);
+            TEST_ASSERT_EQUAL_INT8(track[parsed].speed, frame.speed);
+            TEST_ASSERT_EQUAL_INT8(track[parsed].steering, frame.steering);
+            TEST_ASSERT_EQUAL_UINT8(track[parsed].lights, frame.lights);
+            TEST_ASSERT_EQUAL_UINT8(track[parsed].stop, frame.stop);
+            parsedHash = macroHashFrame(parsedHash, frame);
+
+            XboxControllerState input;
+            memset(&input, 0, sizeof(input));
+            xboxUnpackState(frame.input, input);
+            MappedControls controls = player.map(input);
+            MacroFrame replayed = makeFrame(frame.offsetUs, controls.speed, controls.steering,
+                                            controls.lights, controls.emergencyStop ? 1 : 0);
+            replayHash = macroHashFrame(replayHash, replayed);
+            parsed++;
+        } else {
+            macroParseTrailer(text.c_str(), trailerCount, trailerHash);
+        }
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(SESSION_FRAMES, parsed);
+    TEST_ASSERT_EQUAL_UINT32(SESSION_FRAMES, trailerCount);
+    TEST_ASSERT_EQUAL_UINT32(trackHash, trailerHash);
+    TEST_ASSERT_EQUAL_UINT32(trackHash, parsedHash);
+    TEST_ASSERT_EQUAL_UINT32(trackHash, replayHash);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_hash_golden_values);
+    RUN_TEST(test_parse_rejects_other_lines);
+    RUN_TEST(test_dump_replays_bit_for_bit);
+    return UNITY_END();
+}
@@ -0,0 +1,136 @@
+/**
+ * Seqlock Tests - Concurrent publication of XboxPackedState
+ *
+ * Run on the host: pio test -e native
+ *
+ * One writer thread publishes values derived from a counter while several
+ * reader threads read them back; a torn read shows up as fields that
+ * disagree. The same file also builds standalone under ThreadSanitizer
+ * (with a Unity checkout on the include path):
+ *   g++ -std=c++11 -O1 -g -fsanitize=thread -pthread -Iinclude -I<unity>/src \
+ *       test/test_seqlock/test_main.cpp <unity>/src/unity.c
+ * TSan checks the word accesses but does not model the fences (-Wtsan), so
+ * the torn-read check is what covers the ordering.
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "seqlock.h"
+#include "xbox_report.h"
+
+#define STRESS_READERS 4
+#define STRESS_WRITES  60000   // Below 65536, so the counter never wraps
+
+// ============================================================================
+// Value Pattern
+// ============================================================================
+
+static void fillPattern(XboxPackedState& value, uint16_t n) {
+    value.buttons       = n;
+    value.left_stick_x  = (int16_t)n;
+    value.left_stick_y  = (int16_t)~n;
+    value.right_stick_x = (int16_t)(n ^ 0x5555);
+    value.right_stick_y = (int16_t)(n ^ 0xAAAA);
+    value.left_trigger  = (uint16_t)(n + 1);
+    value.right_trigger = (uint16_t)(n - 1);
+    value.battery_level = (uint8_t)n;
+    value.reserved      = (uint8_t)(n >> 8);
+}
+
+static bool isConsistent(const XboxPackedState& value) {
+    XboxPackedState expected;
+    fillPattern(expected, value.buttons);
+    return memcmp(&expected, &value, sizeof(value)) == 0;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+static void test_single_thread_round_trip() {
+    Seqlock<XboxPackedState> lock;
+    XboxPackedState in;
+    XboxPackedState out;
+
+    fillPattern(in, 1234);
+    lock.write(in);
+    lock.read(out);
+
+    TEST_ASSERT_EQUAL_MEMORY(&in, &out, sizeof(in));
+    TEST_ASSERT_EQUAL_UINT32(1, lock.getWriteCount());
+    TEST_ASSERT_EQUAL_UINT32(0, lock.getRetryCount());
+}
+
+static void test_concurrent_readers_never_see_torn_values() {
+    Seqlock<XboxPackedState> lock;
+    std::atomic<bool> writerDone(false);
+    std::atomic<uint32_t> tornReads(0);
+    std::atomic<uint32_t> backwardReads(0);
+    std::atomic<uint32_t> reads(0);
+
+    XboxPackedState initial;
+    fillPattern(initial, 0);
+    lock.write(initial);
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < STRESS_READERS; r++) {
+        readers.push_back(std::thread([&]() {
+            uint16_t last = 0;
+            uint32_t count = 0;
+            XboxPackedState value;
+            while (!writerDone.load(std::memory_order_acquire)) {
+                lock.read(value);
+                if (!isConsistent(value)) {
+                    tornReads.fetch_add(1, std::memory_order_relaxed);
+                }
+                // A single writer publishes in order, so no reader goes back
+                if (value.buttons < last) {
+                    backwardReads.fetch_add(1, std::memory_order_relaxed);
+                }
+                last = value.buttons;
+                count++;
+            }
+            reads.fetch_add(count, std::memory_order_relaxed);
+        }));
+    }
+
+    std::thread writer([&]() {
+        XboxPackedState value;
+        for (uint16_t n = 1; n <= STRESS_WRITES; n++) {
+            fillPattern(value, n);
+            lock.write(value);
+        }
+        writerDone.store(true, std::memory_order_release);
+    });
+
+    writer.join();
+    for (size_t r = 0; r < readers.size(); r++) {
+        readers[r].join();
+    }
+
+    XboxPackedState latest;
+    lock.read(latest);
+
+    TEST_ASSERT_EQUAL_UINT32(0, tornReads.load());
+    TEST_ASSERT_EQUAL_UINT32(0, backwardReads.load());
+    TEST_ASSERT_EQUAL_UINT32(STRESS_WRITES + 1, lock.getWriteCount());
+    TEST_ASSERT_EQUAL_UINT16(STRESS_WRITES, latest.buttons);
+    TEST_ASSERT_TRUE(isConsistent(latest));
+    TEST_ASSERT_TRUE(reads.load() > 0);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_single_thread_round_trip);
+    RUN_TEST(test_concurrent_readers_never_see_torn_values);
+    return UNITY_END();
+}
@@ -0,0 +1,281 @@
+/**
+ * Serial Input Tests - PC controller frames and text on one port
+ *
+ * Run on the host: pio test -e native
+ *
+ * Frames are built the way tools/pc_drive.py's build_frame() does; the
+ * captured frame below is its output. The resync test breaks a frame by
+ * dropping one byte and checks that the rest of the stream - payload
+ * bytes that look like text, newlines included - never reaches the
+ * command line.
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include "config.h"
+#include "serial_input.h"
+
+#define BYTE_US 10   // Byte spacing on the USB serial port
+
+// pc_drive.build_frame(3, buttons=("a", "lb"), lx=32767, ly=-32768,
+//                      rx=0x1234, ry=-256, lt=1023, rt=512)
+static const uint8_t PC_DRIVE_FRAME[SERIAL_INPUT_FRAME_SIZE] = {
+    0xa5, 0x5a, 0x01, 0x03, 0x11, 0x00,
+    0xff, 0x7f, 0x00, 0x80, 0x34, 0x12, 0x00, 0xff,
+    0xff, 0x03, 0x00, 0x02,
+    0x60, 0x56
+};
+
+// Payload bytes that read as text: 'A', '\n', ' ', ' ', ... '\n'
+#define TEXTLIKE_LX 0x0a41
+#define TEXTLIKE_LY 0x2020
+#define TEXTLIKE_LT 0x020a
+
+struct Fed {
+    int text;
+    int consumed;
+    int ok;
+    int dropped;
+    int discarded;
+    std::string textBytes;
+};
+
+static SerialInputParser* parser;
+static uint32_t nowUs;
+
+void setUp() {
+    parser = new SerialInputParser();
+    nowUs = 1000000;
+}
+
+void tearDown() {
+    delete parser;
+}
+
+static void buildFrame(uint8_t* out, uint8_t seq, uint16_t buttons, int16_t lx, int16_t ly,
+                       int16_t rx, int16_t ry, uint16_t lt, uint16_t rt) {
+    uint16_t fields[] = { buttons, (uint16_t)lx, (uint16_t)ly, (uint16_t)rx, (uint16_t)ry, lt, rt };
+    out[0] = SERIAL_INPUT_SYNC1;
+    out[1] = SERIAL_INPUT_SYNC2;
+    out[2] = SERIAL_INPUT_TYPE_CONTROLS;
+    out[3] = seq;
+    for (int i = 0; i < 7; i++) {
+        out[4 + 2 * i] = (uint8_t)fields[i];
+        out[5 + 2 * i] = (uint8_t)(fields[i] >> 8);
+    }
+
+    // Fletcher-16 of bytes 2-17
+    uint8_t sum1 = 0;
+    uint8_t sum2 = 0;
+    for (int i = 2; i < SERIAL_INPUT_FRAME_SIZE - 2; i++) {
+        sum1 = (uint8_t)((sum1 + out[i]) % 255);
+        sum2 = (uint8_t)((sum2 + sum1) % 255);
+    }
+    out[18] = sum1;
+    out[19] = sum2;
+}
+
+static void buildDriveFrame(uint8_t* out, uint8_t seq) {
+    buildFrame(out, seq, 0, 0, 16000, 0, 0, 0, 600);
+}
+
+static Fed feed(const uint8_t* data, size_t length) {
+    Fed fed = Fed();
+    for (size_t i = 0; i < length; i++) {
+        nowUs += BYTE_US;
+        switch (parser->feed(data[i], nowUs)) {
+            case SerialInputResult::NOT_FRAME:
+                fed.text++;
+                fed.textBytes += (char)data[i];
+                break;
+            case SerialInputResult::CONSUMED:      fed.consumed++; break;
+            case SerialInputResult::FRAME_OK:      fed.ok++; break;
+            case SerialInputResult::FRAME_DROPPED: fed.dropped++; break;
+            case SerialInputResult::DISCARDED:     fed.discarded++; break;
+        }
+    }
+    return fed;
+}
+
+static Fed feedText(const char* text) {
+    return feed((const uint8_t*)text, strlen(text));
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+static void test_builder_matches_pc_drive() {
+    uint8_t frame[SERIAL_INPUT_FRAME_SIZE];
+    buildFrame(frame, 3, 0x0011, 32767, -32768, 0x1234, -256, 1023, 512);
+    TEST_ASSERT_EQUAL_MEMORY(PC_DRIVE_FRAME, frame, sizeof(frame));
+}
+
+static void test_valid_frame_decodes() {
+    Fed fed = feed(PC_DRIVE_FRAME, sizeof(PC_DRIVE_FRAME));
+    TEST_ASSERT_EQUAL_INT(1, fed.ok);
+    TEST_ASSERT_EQUAL_INT(SERIAL_INPUT_FRAME_SIZE - 1, fed.consumed);
+    TEST_ASSERT_EQUAL_INT(0, fed.text);
+
+    const XboxControllerState& state = parser->getState();
+    TEST_ASSERT_TRUE(state.btn_a);
+    TEST_ASSERT_TRUE(state.btn_lb);
+    TEST_ASSERT_FALSE(state.btn_b);
+    TEST_ASSERT_EQUAL_INT16(32767, state.left_stick_x);
+    TEST_ASSERT_EQUAL_INT16(-32768, state.left_stick_y);
+    TEST_ASSERT_EQUAL_INT16(0x1234, state.right_stick_x);
+    TEST_ASSERT_EQUAL_INT16(-256, state.right_stick_y);
+    TEST_ASSERT_EQUAL_UINT16(1023, state.left_trigger);
+    TEST_ASSERT_EQUAL_UINT16(512, state.right_trigger);
+
+    TEST_ASSERT_EQUAL_UINT32(1, parser->getFrameCount());
+    TEST_ASSERT_EQUAL_UINT32(1000000 + BYTE_US, parser->getFrameStartUs());
+    TEST_ASSERT_TRUE(parser->isFresh(nowUs, SERIAL_INPUT_TIMEOUT_MS * 1000UL));
+    TEST_ASSERT_FALSE(parser->isFresh(nowUs + SERIAL_INPUT_TIMEOUT_MS * 1000UL, SERIAL_INPUT_TIMEOUT_MS * 1000UL));
+}
+
+static void test_checksum_error_keeps_state() {
+    feed(PC_DRIVE_FRAME, sizeof(PC_DRIVE_FRAME));
+
+    uint8_t frame[SERIAL_INPUT_FRAME_SIZE];
+    buildFrame(frame, 4, 0x0002, -100, 0, 0, 0, 0, 0);
+    frame[6] ^= 0x01;
+    Fed fed = feed(frame, sizeof(frame));
+
+    TEST_ASSERT_EQUAL_INT(1, fed.dropped);
+    TEST_ASSERT_EQUAL_INT(0, fed.ok);
+    TEST_ASSERT_EQUAL_UINT32(1, parser->getStats().checksumErrors);
+    TEST_ASSERT_EQUAL_UINT32(1, parser->getFrameCount());
+    TEST_ASSERT_TRUE(parser->getState().btn_a);
+    TEST_ASSERT_EQUAL_INT16(32767, parser->getState().left_stick_x);
+}
+
+static void test_sequence_gaps_count_lost_frames() {
+    static const uint8_t SEQUENCES[] = { 1, 2, 5, 6, 255, 0, 1 };
+    uint8_t frame[SERIAL_INPUT_FRAME_SIZE];
+    for (size_t i = 0; i < sizeof(SEQUENCES); i++) {
+        buildDriveFrame(frame, SEQUENCES[i]);
+        TEST_ASSERT_EQUAL_INT(1, feed(frame, sizeof(frame)).ok);
+    }
+
+    // 3 and 4 missing, 7..254 is a sender restart, 255 -> 0 wraps
+    TEST_ASSERT_EQUAL_UINT32(2, parser->getStats().lostFrames);
+    TEST_ASSERT_EQUAL_UINT32(7, parser->getFrameCount());
+}
+
+static void test_duplicate_dropped() {
+    uint8_t first[SERIAL_INPUT_FRAME_SIZE];
+    uint8_t repeat[SERIAL_INPUT_FRAME_SIZE];
+    buildFrame(first, 9, 0x0001, 1000, 0, 0, 0, 0, 0);
+    buildFrame(repeat, 9, 0x0002, -1000, 0, 0, 0, 0, 0);
+
+    TEST_ASSERT_EQUAL_INT(1, feed(first, sizeof(first)).ok);
+    TEST_ASSERT_EQUAL_INT(1, feed(repeat, sizeof(repeat)).dropped);
+
+    TEST_ASSERT_EQUAL_UINT32(1, parser->getStats().duplicates);
+    TEST_ASSERT_EQUAL_UINT32(1, parser->getFrameCount());
+    TEST_ASSERT_TRUE(parser->getState().btn_a);
+    TEST_ASSERT_EQUAL_INT16(1000, parser->getState().left_stick_x);
+
+    // Framing was intact, so text right after it still passes
+    TEST_ASSERT_EQUAL_INT(7, feedText("status\n").text);
+}
+
+static void test_resync_after_dropped_byte() {
+    uint8_t frames[5][SERIAL_INPUT_FRAME_SIZE];
+    for (int i = 0; i < 5; i++) {
+        buildFrame(frames[i], (uint8_t)(2 + i), 0, TEXTLIKE_LX, TEXTLIKE_LY, 0, 0, TEXTLIKE_LT, TEXTLIKE_LT);
+    }
+
+    TEST_ASSERT_EQUAL_INT(1, feed(frames[0], SERIAL_INPUT_FRAME_SIZE).ok);
+
+    // Frame 2 loses its buttons high byte: it completes on frame 3's sync
+    // byte and fails its checksum, leaving frame 3's payload to resync on
+    feed(frames[1], 5);
+    feed(frames[1] + 6, SERIAL_INPUT_FRAME_SIZE - 6);
+    Fed rest = feed(frames[2], SERIAL_INPUT_FRAME_SIZE);
+
+    TEST_ASSERT_EQUAL_INT(1, rest.dropped);
+    TEST_ASSERT_EQUAL_INT(0, rest.text);
+    TEST_ASSERT_EQUAL_INT(SERIAL_INPUT_FRAME_SIZE - 1, rest.discarded);
+    TEST_ASSERT_EQUAL_UINT32(SERIAL_INPUT_FRAME_SIZE - 1, parser->getStats().discarded);
+
+    // Back in step at frame 4's sync pair
+    TEST_ASSERT_EQUAL_INT(1, feed(frames[3], SERIAL_INPUT_FRAME_SIZE).ok);
+    TEST_ASSERT_EQUAL_INT(1, feed(frames[4], SERIAL_INPUT_FRAME_SIZE).ok);
+
+    const SerialInputStats& stats = parser->getStats();
+    TEST_ASSERT_EQUAL_UINT32(3, parser->getFrameCount());
+    TEST_ASSERT_EQUAL_UINT32(1, stats.checksumErrors);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.lostFrames);
+    TEST_ASSERT_EQUAL_INT16(TEXTLIKE_LX, parser->getState().left_stick_x);
+
+    // Text typed between frames still works
+    Fed text = feedText("status\n");
+    TEST_ASSERT_EQUAL_INT(7, text.text);
+    TEST_ASSERT_EQUAL_STRING("status\n", text.textBytes.c_str());
+}
+
+static void test_text_alongside_frames() {
+    // Before any frame the port is a plain text console
+    TEST_ASSERT_EQUAL_INT(5, feedText("help\n").text);
+    static const uint8_t NOISE[] = { 0x01, 0x0a };
+    TEST_ASSERT_EQUAL_INT(2, feed(NOISE, sizeof(NOISE)).text);
+
+    // A command split around a frame
+    uint8_t frame[SERIAL_INPUT_FRAME_SIZE];
+    buildDriveFrame(frame, 1);
+    Fed first = feedText("sta");
+    TEST_ASSERT_EQUAL_INT(1, feed(frame, sizeof(frame)).ok);
+    Fed second = feedText("tus\r\n");
+    TEST_ASSERT_EQUAL_STRING("status\r\n", (first.textBytes + second.textBytes).c_str());
+}
+
+static void test_binary_link_drops_unprintable_lines() {
+    uint8_t frame[SERIAL_INPUT_FRAME_SIZE];
+    buildDriveFrame(frame, 1);
+    feed(frame, sizeof(frame));
+
+    // One unprintable byte discards the line through its newline
+    static const uint8_t LINE[] = { 'a', 'b', 0x01, 'c', '\n' };
+    Fed fed = feed(LINE, sizeof(LINE));
+    TEST_ASSERT_EQUAL_INT(2, fed.text);
+    TEST_ASSERT_EQUAL_INT(3, fed.discarded);
+
+    TEST_ASSERT_EQUAL_STRING("status\n", feedText("status\n").textBytes.c_str());
+}
+
+static void test_quiet_link_is_text_again() {
+    uint8_t frame[SERIAL_INPUT_FRAME_SIZE];
+    buildDriveFrame(frame, 1);
+    feed(frame, sizeof(frame));
+
+    // A broken frame, then the sender stops mid-resync
+    buildDriveFrame(frame, 2);
+    feed(frame, 10);
+    nowUs += 5000;
+    TEST_ASSERT_EQUAL_INT(0, feedText("x\n").text);
+
+    nowUs += SERIAL_INPUT_TIMEOUT_MS * 1000UL;
+    Fed fed = feedText("status\n");
+    TEST_ASSERT_EQUAL_STRING("status\n", fed.textBytes.c_str());
+
+    // And frames are picked up again
+    buildDriveFrame(frame, 3);
+    TEST_ASSERT_EQUAL_INT(1, feed(frame, sizeof(frame)).ok);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_builder_matches_pc_drive);
+    RUN_TEST(test_valid_frame_decodes);
+    RUN_TEST(test_checksum_error_keeps_state);
+    RUN_TEST(test_sequence_gaps_count_lost_frames);
+    RUN_TEST(test_duplicate_dropped);
+    RUN_TEST(test_resync_after_dropped_byte);
+    RUN_TEST(test_text_alongside_frames);
+    RUN_TEST(test_binary_link_drops_unprintable_lines);
+    RUN_TEST(test_quiet_link_is_text_again);
+    return UNITY_END();
+}
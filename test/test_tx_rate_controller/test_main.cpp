@@ -0,0 +1,187 @@
+/**
+ * TX Rate Controller Tests - AIMD increase, cuts and bounds
+ *
+ * Run on the host: pio test -e native
+ *
+ * Uses the firmware's policy from config.h: 10-50 Hz starting at 20 Hz,
+ * +2 Hz per window of 20 healthy writes, halved on a failed or slow
+ * (> 8 ms) write, at most one cut per window.
+ */
+
+#include <unity.h>
+#include <stdint.h>
+#include "config.h"
+#include "tx_rate_controller.h"
+
+#define FAST_WRITE_US 50
+#define SLOW_WRITE_US (LEGO_AIMD_LATENCY_LIMIT_US + 1)
+
+static const AimdPolicy FIRMWARE_POLICY = {
+    LEGO_AIMD_MIN_RATE_HZ,
+    LEGO_AIMD_MAX_RATE_HZ,
+    LEGO_AIMD_START_RATE_HZ,
+    LEGO_AIMD_INCREASE_HZ,
+    LEGO_AIMD_DECREASE_PERCENT,
+    LEGO_AIMD_WINDOW_WRITES,
+    LEGO_AIMD_LATENCY_LIMIT_US
+};
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+static void healthyWrites(TxRateController& controller, int count) {
+    for (int i = 0; i < count; i++) {
+        controller.recordWrite(true, FAST_WRITE_US);
+    }
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+static void test_policy_values() {
+    TEST_ASSERT_EQUAL_UINT16(10, LEGO_AIMD_MIN_RATE_HZ);
+    TEST_ASSERT_EQUAL_UINT16(50, LEGO_AIMD_MAX_RATE_HZ);
+    TEST_ASSERT_EQUAL_UINT16(20, LEGO_AIMD_START_RATE_HZ);
+}
+
+static void test_additive_increase_to_max() {
+    TxRateController controller(FIRMWARE_POLICY);
+    TEST_ASSERT_EQUAL_UINT16(20, controller.getRateHz());
+    TEST_ASSERT_EQUAL_UINT32(50, controller.getIntervalMs());
+
+    healthyWrites(controller, LEGO_AIMD_WINDOW_WRITES - 1);
+    TEST_ASSERT_EQUAL_UINT16(20, controller.getRateHz());
+    healthyWrites(controller, 1);
+    TEST_ASSERT_EQUAL_UINT16(22, controller.getRateHz());
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AimdDecision::INCREASE, (uint8_t)controller.getStats().lastDecision);
+
+    // 14 more windows reach the max, and it holds there
+    healthyWrites(controller, 14 * LEGO_AIMD_WINDOW_WRITES);
+    TEST_ASSERT_EQUAL_UINT16(50, controller.getRateHz());
+    TEST_ASSERT_EQUAL_UINT32(20, controller.getIntervalMs());
+    healthyWrites(controller, 10 * LEGO_AIMD_WINDOW_WRITES);
+    TEST_ASSERT_EQUAL_UINT16(50, controller.getRateHz());
+    TEST_ASSERT_EQUAL_UINT32(15, controller.getStats().increases);
+    TEST_ASSERT_EQUAL_UINT16(50, controller.getStats().highestRateHz);
+}
+
+static void test_failure_halves_rate() {
+    TxRateController controller(FIRMWARE_POLICY);
+    healthyWrites(controller, 15 * LEGO_AIMD_WINDOW_WRITES);
+    TEST_ASSERT_EQUAL_UINT16(50, controller.getRateHz());
+
+    controller.recordWrite(false, FAST_WRITE_US);
+    TEST_ASSERT_EQUAL_UINT16(25, controller.getRateHz());
+
+    const AimdStats& stats = controller.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.failures);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.failureCuts);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AimdDecision::CUT_FAILURE, (uint8_t)stats.lastDecision);
+}
+
+static void test_slow_write_halves_rate() {
+    TxRateController controller(FIRMWARE_POLICY);
+    controller.recordWrite(true, LEGO_AIMD_LATENCY_LIMIT_US);   // At the limit is fine
+    TEST_ASSERT_EQUAL_UINT16(20, controller.getRateHz());
+
+    controller.recordWrite(true, SLOW_WRITE_US);
+    TEST_ASSERT_EQUAL_UINT16(10, controller.getRateHz());
+
+    const AimdStats& stats = controller.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.slowWrites);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.latencyCuts);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)AimdDecision::CUT_LATENCY, (uint8_t)stats.lastDecision);
+}
+
+static void test_one_cut_per_window() {
+    TxRateController controller(FIRMWARE_POLICY);
+    healthyWrites(controller, 15 * LEGO_AIMD_WINDOW_WRITES);
+
+    // A burst of trouble costs one cut, not five
+    for (int i = 0; i < 5; i++) {
+        controller.recordWrite(false, FAST_WRITE_US);
+    }
+    TEST_ASSERT_EQUAL_UINT16(25, controller.getRateHz());
+    TEST_ASSERT_EQUAL_UINT32(5, controller.getStats().failures);
+    TEST_ASSERT_EQUAL_UINT32(1, controller.getStats().failureCuts);
+
+    // A window after the cut, trouble cuts again
+    healthyWrites(controller, LEGO_AIMD_WINDOW_WRITES - 5);
+    controller.recordWrite(true, SLOW_WRITE_US);
+    TEST_ASSERT_EQUAL_UINT16(12, controller.getRateHz());
+    TEST_ASSERT_EQUAL_UINT32(1, controller.getStats().latencyCuts);
+}
+
+static void test_never_below_min() {
+    TxRateController controller(FIRMWARE_POLICY);
+    for (int i = 0; i < 10; i++) {
+        controller.recordWrite(false, FAST_WRITE_US);
+        healthyWrites(controller, LEGO_AIMD_WINDOW_WRITES - 1);   // Never a full healthy window
+        TEST_ASSERT_TRUE(controller.getRateHz() >= LEGO_AIMD_MIN_RATE_HZ);
+    }
+    TEST_ASSERT_EQUAL_UINT16(LEGO_AIMD_MIN_RATE_HZ, controller.getRateHz());
+    TEST_ASSERT_EQUAL_UINT32(100, controller.getIntervalMs());
+    TEST_ASSERT_EQUAL_UINT16(LEGO_AIMD_MIN_RATE_HZ, controller.getStats().lowestRateHz);
+}
+
+static void test_recovers_after_congestion() {
+    TxRateController controller(FIRMWARE_POLICY);
+    for (int i = 0; i < 4; i++) {
+        controller.recordWrite(true, SLOW_WRITE_US);
+        healthyWrites(controller, LEGO_AIMD_WINDOW_WRITES - 1);
+    }
+    TEST_ASSERT_EQUAL_UINT16(LEGO_AIMD_MIN_RATE_HZ, controller.getRateHz());
+
+    // Back to the max by additive increase alone: 20 windows from 10 Hz
+    for (int window = 1; window <= 20; window++) {
+        healthyWrites(controller, LEGO_AIMD_WINDOW_WRITES);
+        TEST_ASSERT_EQUAL_UINT16(LEGO_AIMD_MIN_RATE_HZ + window * LEGO_AIMD_INCREASE_HZ, controller.getRateHz());
+    }
+    TEST_ASSERT_EQUAL_UINT16(LEGO_AIMD_MAX_RATE_HZ, controller.getRateHz());
+    TEST_ASSERT_EQUAL_UINT16(LEGO_AIMD_MIN_RATE_HZ, controller.getStats().lowestRateHz);
+    TEST_ASSERT_EQUAL_UINT16(LEGO_AIMD_MAX_RATE_HZ, controller.getStats().highestRateHz);
+}
+
+static void test_trouble_restarts_increase_window() {
+    TxRateController controller(FIRMWARE_POLICY);
+    controller.recordWrite(false, FAST_WRITE_US);
+    TEST_ASSERT_EQUAL_UINT16(10, controller.getRateHz());
+
+    // A failure inside the cut window is not cut for, but the healthy count starts over
+    healthyWrites(controller, LEGO_AIMD_WINDOW_WRITES - 2);
+    controller.recordWrite(false, FAST_WRITE_US);
+    healthyWrites(controller, LEGO_AIMD_WINDOW_WRITES - 1);
+    TEST_ASSERT_EQUAL_UINT16(10, controller.getRateHz());
+    TEST_ASSERT_EQUAL_UINT32(1, controller.getStats().failureCuts);
+    healthyWrites(controller, 1);
+    TEST_ASSERT_EQUAL_UINT16(12, controller.getRateHz());
+}
+
+static void test_reset_returns_to_start() {
+    TxRateController controller(FIRMWARE_POLICY);
+    healthyWrites(controller, 15 * LEGO_AIMD_WINDOW_WRITES);
+    controller.reset();
+    TEST_ASSERT_EQUAL_UINT16(LEGO_AIMD_START_RATE_HZ, controller.getRateHz());
+
+    // A fresh connection may be cut at once
+    controller.recordWrite(false, FAST_WRITE_US);
+    TEST_ASSERT_EQUAL_UINT16(10, controller.getRateHz());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_policy_values);
+    RUN_TEST(test_additive_increase_to_max);
+    RUN_TEST(test_failure_halves_rate);
+    RUN_TEST(test_slow_write_halves_rate);
+    RUN_TEST(test_one_cut_per_window);
+    RUN_TEST(test_never_below_min);
+    RUN_TEST(test_recovers_after_congestion);
+    RUN_TEST(test_trouble_restarts_increase_window);
+    RUN_TEST(test_reset_returns_to_start);
+    return UNITY_END();
+}
@@ -0,0 +1,169 @@
+/**
+ * Xbox Report Tests - GIP (USB) report decoding
+ *
+ * Run on the host: pio test -e native
+ *
+ * The reports below are GIP messages as a wired Xbox Series controller
+ * sends them over USB, decoded into XboxControllerState.
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "xbox_report.h"
+
+// ============================================================================
+// Captured Reports
+// ============================================================================
+
+// Input, nothing touched
+static const uint8_t GIP_INPUT_IDLE[] = {
+    0x20, 0x00, 0x01, 0x0e,
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+// Input: A + LB, left trigger full, right trigger half, left stick
+// full right and full down, right stick slightly right and down
+static const uint8_t GIP_INPUT_A_LB[] = {
+    0x20, 0x00, 0x02, 0x0e,
+    0x10, 0x10,
+    0xff, 0x03, 0x00, 0x02,
+    0xff, 0x7f, 0x00, 0x80, 0x34, 0x12, 0x00, 0xff
+};
+
+// Input: Menu + View + Y, D-pad up-right, right stick click
+static const uint8_t GIP_INPUT_MENU_VIEW_Y[] = {
+    0x20, 0x00, 0x03, 0x0e,
+    0x8c, 0x89,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+// Virtual key (Xbox button) press and release
+static const uint8_t GIP_XBOX_PRESSED[]  = { 0x07, 0x20, 0x04, 0x02, 0x01, 0x5b };
+static const uint8_t GIP_XBOX_RELEASED[] = { 0x07, 0x20, 0x05, 0x02, 0x00, 0x5b };
+
+// Status (battery) message - not an input report
+static const uint8_t GIP_STATUS[] = { 0x03, 0x20, 0x06, 0x04, 0x83, 0x00, 0x00, 0x00 };
+
+static XboxControllerState state;
+
+// Compare through the packed form, which has no padding
+static void assertSameState(const XboxControllerState& expected, const XboxControllerState& actual) {
+    XboxPackedState a;
+    XboxPackedState b;
+    xboxPackState(expected, a);
+    xboxPackState(actual, b);
+    TEST_ASSERT_EQUAL_MEMORY(&a, &b, sizeof(a));
+}
+
+void setUp() {
+    memset(&state, 0, sizeof(state));
+    state.battery_level = 80;
+    xboxResetState(state);
+}
+
+void tearDown() {
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+static void test_input_idle() {
+    state.btn_a = true;
+    state.left_stick_x = 1000;
+
+    TEST_ASSERT_TRUE(xboxParseGipReport(GIP_INPUT_IDLE, sizeof(GIP_INPUT_IDLE), state));
+    TEST_ASSERT_FALSE(state.btn_a);
+    TEST_ASSERT_EQUAL_INT16(0, state.left_stick_x);
+    TEST_ASSERT_EQUAL_INT16(0, state.left_stick_y);
+    TEST_ASSERT_EQUAL_UINT16(0, state.left_trigger);
+    TEST_ASSERT_EQUAL_UINT8(80, state.battery_level);
+}
+
+static void test_input_buttons_axes_triggers() {
+    TEST_ASSERT_TRUE(xboxParseGipReport(GIP_INPUT_A_LB, sizeof(GIP_INPUT_A_LB), state));
+
+    TEST_ASSERT_TRUE(state.btn_a);
+    TEST_ASSERT_TRUE(state.btn_lb);
+    TEST_ASSERT_FALSE(state.btn_b);
+    TEST_ASSERT_FALSE(state.btn_rb);
+    TEST_ASSERT_FALSE(state.dpad_up);
+
+    TEST_ASSERT_EQUAL_UINT16(1023, state.left_trigger);
+    TEST_ASSERT_EQUAL_UINT16(512, state.right_trigger);
+
+    TEST_ASSERT_EQUAL_INT16(32767, state.left_stick_x);
+    TEST_ASSERT_EQUAL_INT16(-32768, state.left_stick_y);
+    TEST_ASSERT_EQUAL_INT16(0x1234, state.right_stick_x);
+    TEST_ASSERT_EQUAL_INT16(-256, state.right_stick_y);
+}
+
+static void test_input_system_buttons_dpad() {
+    TEST_ASSERT_TRUE(xboxParseGipReport(GIP_INPUT_MENU_VIEW_Y, sizeof(GIP_INPUT_MENU_VIEW_Y), state));
+
+    TEST_ASSERT_TRUE(state.btn_menu);
+    TEST_ASSERT_TRUE(state.btn_view);
+    TEST_ASSERT_TRUE(state.btn_y);
+    TEST_ASSERT_FALSE(state.btn_a);
+    TEST_ASSERT_FALSE(state.btn_x);
+
+    TEST_ASSERT_TRUE(state.dpad_up);
+    TEST_ASSERT_TRUE(state.dpad_right);
+    TEST_ASSERT_FALSE(state.dpad_down);
+    TEST_ASSERT_FALSE(state.dpad_left);
+    TEST_ASSERT_TRUE(state.btn_rs);
+    TEST_ASSERT_FALSE(state.btn_ls);
+}
+
+static void test_virtual_key_only_touches_xbox_button() {
+    TEST_ASSERT_TRUE(xboxParseGipReport(GIP_INPUT_A_LB, sizeof(GIP_INPUT_A_LB), state));
+
+    TEST_ASSERT_TRUE(xboxParseGipReport(GIP_XBOX_PRESSED, sizeof(GIP_XBOX_PRESSED), state));
+    TEST_ASSERT_TRUE(state.btn_xbox);
+    TEST_ASSERT_TRUE(state.btn_a);
+    TEST_ASSERT_EQUAL_INT16(32767, state.left_stick_x);
+
+    TEST_ASSERT_TRUE(xboxParseGipReport(GIP_XBOX_RELEASED, sizeof(GIP_XBOX_RELEASED), state));
+    TEST_ASSERT_FALSE(state.btn_xbox);
+    TEST_ASSERT_TRUE(state.btn_a);
+}
+
+static void test_packed_round_trip() {
+    TEST_ASSERT_TRUE(xboxParseGipReport(GIP_INPUT_A_LB, sizeof(GIP_INPUT_A_LB), state));
+    TEST_ASSERT_TRUE(xboxParseGipReport(GIP_XBOX_PRESSED, sizeof(GIP_XBOX_PRESSED), state));
+
+    XboxPackedState packed;
+    XboxControllerState unpacked;
+    xboxPackState(state, packed);
+    xboxUnpackState(packed, unpacked);
+
+    TEST_ASSERT_TRUE(unpacked.btn_xbox);
+    TEST_ASSERT_EQUAL_INT16(-256, unpacked.right_stick_y);
+    assertSameState(state, unpacked);
+}
+
+static void test_rejects_other_and_malformed_messages() {
+    XboxControllerState before = state;
+
+    TEST_ASSERT_FALSE(xboxParseGipReport(GIP_STATUS, sizeof(GIP_STATUS), state));
+    TEST_ASSERT_FALSE(xboxParseGipReport(GIP_INPUT_A_LB, GIP_INPUT_REPORT_SIZE - 1, state));
+    TEST_ASSERT_FALSE(xboxParseGipReport(GIP_XBOX_PRESSED, GIP_HEADER_SIZE, state));
+    TEST_ASSERT_FALSE(xboxParseGipReport(GIP_INPUT_A_LB, 2, state));
+    TEST_ASSERT_FALSE(xboxParseGipReport(nullptr, sizeof(GIP_INPUT_A_LB), state));
+
+    assertSameState(before, state);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_input_idle);
+    RUN_TEST(test_input_buttons_axes_triggers);
+    RUN_TEST(test_input_system_buttons_dpad);
+    RUN_TEST(test_virtual_key_only_touches_xbox_button);
+    RUN_TEST(test_packed_round_trip);
+    RUN_TEST(test_rejects_other_and_malformed_messages);
+    return UNITY_END();
+}
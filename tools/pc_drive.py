@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""Drive the car from a PC over the USB serial port.
+
+Sends binary controller frames (see include/serial_input.h) at a fixed
+rate. The firmware hands control back to the Xbox controller once frames
+stop for SERIAL_INPUT_TIMEOUT_MS.
+
+Works on any tty, including a pseudo-terminal, so the framing can be
+checked on Linux without hardware:
+
+    socat -d -d pty,raw,echo=0 pty,raw,echo=0     # prints two /dev/pts paths
+    python3 tools/pc_drive.py /dev/pts/3 --speed 40 &
+    xxd -c 20 /dev/pts/4
+
+Usage:
+    python3 tools/pc_drive.py /dev/ttyACM0 --speed 50 --steer -30 --duration 5
+"""
+
+import argparse
+import os
+import struct
+import sys
+import termios
+import time
+import tty
+
+SYNC = b"\xa5\x5a"
+TYPE_CONTROLS = 0x01
+
+BUTTONS = ["a", "b", "x", "y", "lb", "rb", "ls", "rs",
+           "view", "menu", "xbox", "share", "up", "down", "left", "right"]
+
+
+def fletcher16(data):
+    sum1 = sum2 = 0
+    for byte in data:
+        sum1 = (sum1 + byte) % 255
+        sum2 = (sum2 + sum1) % 255
+    return bytes([sum1, sum2])
+
+
+def build_frame(seq, buttons=(), lx=0, ly=0, rx=0, ry=0, lt=0, rt=0):
+    mask = 0
+    for name in buttons:
+        mask |= 1 << BUTTONS.index(name)
+    body = struct.pack("<BBHhhhhHH", TYPE_CONTROLS, seq & 0xFF, mask, lx, ly, rx, ry, lt, rt)
+    return SYNC + body + fletcher16(body)
+
+
+def percent_to_axis(percent):
+    return max(-32768, min(32767, int(percent * 32767 / 100)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port", help="serial device or pty, e.g. /dev/ttyACM0")
+    parser.add_argument("--rate", type=float, default=50, help="frames per second (default 50)")
+    parser.add_argument("--speed", type=float, default=0, help="-100..100, sent on the triggers and left stick Y")
+    parser.add_argument("--steer", type=float, default=0, help="-100..100, left stick X")
+    parser.add_argument("--buttons", default="", help="comma-separated, e.g. b,x (emergency stop)")
+    parser.add_argument("--duration", type=float, default=0, help="seconds, 0 = until Ctrl-C")
+    args = parser.parse_args()
+
+    fd = os.open(args.port, os.O_RDWR | os.O_NOCTTY)
+    if os.isatty(fd):
+        tty.setraw(fd)
+        termios.tcflush(fd, termios.TCIOFLUSH)
+
+    trigger = int(min(abs(args.speed), 100) * 1023 / 100)
+    lt, rt = (trigger, 0) if args.speed < 0 else (0, trigger)
+    buttons = [b for b in args.buttons.split(",") if b]
+    period = 1.0 / args.rate
+    end = time.monotonic() + args.duration if args.duration else None
+
+    seq = 0
+    next_send = time.monotonic()
+    try:
+        while end is None or time.monotonic() < end:
+            os.write(fd, build_frame(seq, buttons, lx=percent_to_axis(args.steer),
+                                       ly=percent_to_axis(args.speed), lt=lt, rt=rt))
+            seq += 1
+            next_send += period
+            time.sleep(max(0, next_send - time.monotonic()))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        # Neutral frame so the car stops now rather than at the timeout
+        os.write(fd, build_frame(seq))
+        os.close(fd)
+    print(f"sent {seq + 1} frames", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,446 @@
+/**
+ * Replay A/B - One recorded session through two mapper configurations
+ *
+ * Host tool (C++11), built from the firmware's own mapping code:
+ *
+ *     g++ -std=c++11 -O2 -Iinclude -o replay_ab tools/replay_ab.cpp \
+ *         src/control_mapper.cpp src/stick_drift.cpp src/xbox_report.cpp \
+ *         src/macro_frame.cpp
+ *     ./replay_ab macro_dump.csv "deadzone=3" "deadzone=8 max_speed=60"
+ *
+ * Input is the serial output of 'macro dump' (other serial text is
+ * ignored). The frames must hash to the value in the dump's trailer, so a
+ * truncated or garbled capture is rejected (exit code 1). Each recorded
+ * frame's controller input is then mapped again with configuration A and
+ * with configuration B, at the recorded times.
+ * Configurations are space- or comma-separated key=value pairs, or the name
+ * of a file holding them (one per line, # comments). Unset keys keep the
+ * firmware defaults from config.h:
+ *
+ *     max_speed        0-100   (DEFAULT_MAX_SPEED_PERCENT)
+ *     deadzone         0-50    (DEFAULT_DEADZONE_PERCENT)
+ *     trigger_accel    0/1     (DEFAULT_TRIGGER_MODE)
+ *     invert_steering  0/1     (DEFAULT_INVERT_STEERING)
+ *     stick_drift      0/1     (STICK_DRIFT_ENABLED) - learning starts from
+ *                              scratch, not from the controller's saved estimate
+ *
+ * Metrics, per configuration:
+ * - frames: sent (one per recorded frame), changed (output differs from the
+ *   previous frame), same as recorded (matches what the car got)
+ * - replay hash: the track hash of the replayed frames - equal to the
+ *   recording's when the configuration reproduces it bit for bit
+ * - jerk: RMS third derivative of speed and steering, in %/s^3 - lower is
+ *   smoother
+ * - steering reversals: direction changes; peak and total swing between them
+ * - response delay: from the input leaving rest (RESPONSE_INPUT_PERCENT of
+ *   full scale) to the output leaving zero, mean and max over all onsets
+ * - CPU: host nanoseconds per frame for mapping (and drift estimation);
+ *   compare A against B, not against the ESP32
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "control_mapper.h"
+#include "macro_frame.h"
+#include "stick_drift.h"
+#include "xbox_report.h"
+
+#define RESPONSE_INPUT_PERCENT 2       // Input onset threshold
+#define CPU_MIN_REPLAYS        5       // Replays timed per configuration, at least
+#define CPU_MIN_TIME_NS        50000000LL
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+struct RecordedFrame {
+    uint32_t offsetUs;
+    MappedControls recorded;
+    XboxControllerState input;
+};
+
+static void toRecordedFrame(const MacroFrame& frame, RecordedFrame& recorded) {
+    recorded.offsetUs = frame.offsetUs;
+    recorded.recorded.speed = frame.speed;
+    recorded.recorded.steering = frame.steering;
+    recorded.recorded.lights = frame.lights;
+    recorded.recorded.emergencyStop = frame.stop != 0;
+    xboxUnpackState(frame.input, recorded.input);
+}
+
+// Track hash of a frame sequence, as MacroTrack computes it
+static uint32_t trackHash(const std::vector<RecordedFrame>& frames, const std::vector<MappedControls>& controls) {
+    uint32_t hash = MACRO_HASH_SEED;
+    MacroFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    for (size_t i = 0; i < frames.size(); i++) {
+        frame.offsetUs = frames[i].offsetUs;
+        frame.speed = controls[i].speed;
+        frame.steering = controls[i].steering;
+        frame.lights = controls[i].lights;
+        frame.stop = controls[i].emergencyStop ? 1 : 0;
+        hash = macroHashFrame(hash, frame);
+    }
+    return hash;
+}
+
+static bool loadRecording(const char* path, std::vector<RecordedFrame>& frames, uint32_t& hash) {
+    std::ifstream in(path);
+    if (!in) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+
+    std::string line;
+    MacroFrame frame;
+    RecordedFrame recorded;
+    uint32_t computed = MACRO_HASH_SEED;
+    uint32_t trailerCount = 0;
+    uint32_t trailerHash = 0;
+    bool trailer = false;
+    while (std::getline(in, line)) {
+        if (macroParseFrame(line.c_str(), frame)) {
+            toRecordedFrame(frame, recorded);
+            frames.push_back(recorded);
+            computed = macroHashFrame(computed, frame);
+        } else if (macroParseTrailer(line.c_str(), trailerCount, trailerHash)) {
+            trailer = true;
+        }
+    }
+    if (frames.size() < 4) {
+        fprintf(stderr, "%s: no 'macro dump' frames with input columns found\n", path);
+        return false;
+    }
+
+    // The same frames, in the same order, or the replay means nothing
+    if (!trailer) {
+        fprintf(stderr, "%s: no '# N frames, hash 0x...' trailer - incomplete dump?\n", path);
+        return false;
+    }
+    if (trailerCount != frames.size() || trailerHash != computed) {
+        fprintf(stderr, "%s: %zu frames hash to 0x%08lx, the board printed %lu frames, hash 0x%08lx\n",
+                path, frames.size(), (unsigned long)computed,
+                (unsigned long)trailerCount, (unsigned long)trailerHash);
+        return false;
+    }
+    hash = computed;
+    return true;
+}
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+struct ReplayConfig {
+    std::string label;
+    ControlSettings settings;
+    bool stickDrift = STICK_DRIFT_ENABLED;
+};
+
+static bool applySetting(ReplayConfig& config, const std::string& pair) {
+    size_t eq = pair.find('=');
+    if (eq == std::string::npos) {
+        return false;
+    }
+    std::string key = pair.substr(0, eq);
+    long value = strtol(pair.c_str() + eq + 1, nullptr, 10);
+
+    if (key == "max_speed" && value >= 0 && value <= 100) {
+        config.settings.maxSpeedPercent = (uint8_t)value;
+    } else if (key == "deadzone" && value >= 0 && value <= 50) {
+        config.settings.deadzonePercent = (uint8_t)value;
+    } else if (key == "trigger_accel") {
+        config.settings.triggerAcceleration = value != 0;
+    } else if (key == "invert_steering") {
+        config.settings.invertSteering = value != 0;
+    } else if (key == "stick_drift") {
+        config.stickDrift = value != 0;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parseConfig(const char* arg, ReplayConfig& config) {
+    std::string text = arg;
+    config.label = arg;
+
+    // A file if there is one by that name
+    std::ifstream file(arg);
+    if (file) {
+        std::ostringstream contents;
+        std::string line;
+        while (std::getline(file, line)) {
+            contents << line.substr(0, line.find('#')) << ' ';
+        }
+        text = contents.str();
+    }
+
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == ',' || text[i] == '\t' || text[i] == '\r') {
+            text[i] = ' ';
+        }
+    }
+    std::istringstream words(text);
+    std::string pair;
+    while (words >> pair) {
+        if (!applySetting(config, pair)) {
+            fprintf(stderr, "Unknown or out-of-range setting: %s\n", pair.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Replay
+// ============================================================================
+
+static void replay(const ReplayConfig& config, const std::vector<RecordedFrame>& frames,
+                   std::vector<MappedControls>& out) {
+    ControlMapper mapper(config.settings);
+    StickDriftEstimator drift;
+
+    out.resize(frames.size());
+    for (size_t i = 0; i < frames.size(); i++) {
+        if (config.stickDrift) {
+            drift.update(frames[i].input);
+            mapper.setStickCalibration(drift.getCalibration());
+        }
+        out[i] = mapper.map(frames[i].input);
+    }
+}
+
+static double cpuNsPerFrame(const ReplayConfig& config, const std::vector<RecordedFrame>& frames) {
+    std::vector<MappedControls> out;
+    long long elapsedNs = 0;
+    int replays = 0;
+    while (replays < CPU_MIN_REPLAYS || elapsedNs < CPU_MIN_TIME_NS) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        replay(config, frames, out);
+        elapsedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        replays++;
+    }
+    return (double)elapsedNs / ((double)replays * frames.size());
+}
+
+// ============================================================================
+// Metrics
+// ============================================================================
+
+struct Metrics {
+    uint32_t frames;
+    uint32_t changed;
+    uint32_t sameAsRecorded;
+    double speedJerk;
+    double steeringJerk;
+    uint32_t reversals;
+    int peakSwing;
+    long totalSwing;
+    uint32_t onsets;
+    double delayMeanMs;
+    double delayMaxMs;
+    double cpuNs;
+    uint32_t replayHash;
+};
+
+static bool sameControls(const MappedControls& a, const MappedControls& b) {
+    return a.speed == b.speed && a.steering == b.steering
+        && a.lights == b.lights && a.emergencyStop == b.emergencyStop;
+}
+
+// RMS third derivative (%/s^3) of one output channel
+static double rmsJerk(const std::vector<RecordedFrame>& frames, const std::vector<double>& x) {
+    double sumSquares = 0;
+    size_t count = 0;
+    double v1 = 0, a1 = 0;
+    for (size_t i = 1; i < x.size(); i++) {
+        double dt = (frames[i].offsetUs - frames[i - 1].offsetUs) / 1e6;
+        if (dt <= 0) {
+            continue;
+        }
+        double v = (x[i] - x[i - 1]) / dt;
+        double a = (v - v1) / dt;
+        if (i >= 3) {
+            double j = (a - a1) / dt;
+            sumSquares += j * j;
+            count++;
+        }
+        v1 = v;
+        a1 = a;
+    }
+    return count ? std::sqrt(sumSquares / count) : 0;
+}
+
+// Raw speed input as a percentage, the way the mapper reads it
+static double speedInputPercent(const ReplayConfig& config, const XboxControllerState& input) {
+    if (config.settings.triggerAcceleration) {
+        return 100.0 * ((int32_t)input.right_trigger - (int32_t)input.left_trigger) / XBOX_TRIGGER_MAX;
+    }
+    return 100.0 * input.left_stick_y / XBOX_STICK_MAX;
+}
+
+// Input leaves rest -> output leaves zero, for one channel
+static void responseDelays(const std::vector<RecordedFrame>& frames, const std::vector<double>& inputPercent,
+                           const std::vector<double>& output, std::vector<double>& delaysMs) {
+    bool waiting = false;
+    uint32_t onsetUs = 0;
+    for (size_t i = 0; i < frames.size(); i++) {
+        bool inputActive = std::fabs(inputPercent[i]) >= RESPONSE_INPUT_PERCENT;
+        if (!inputActive) {
+            waiting = false;
+            continue;
+        }
+        if (!waiting && (i == 0 || std::fabs(inputPercent[i - 1]) < RESPONSE_INPUT_PERCENT)) {
+            waiting = true;
+            onsetUs = frames[i].offsetUs;
+        }
+        if (waiting && output[i] != 0) {
+            delaysMs.push_back((frames[i].offsetUs - onsetUs) / 1000.0);
+            waiting = false;
+        }
+    }
+}
+
+static Metrics measure(const ReplayConfig& config, const std::vector<RecordedFrame>& frames) {
+    std::vector<MappedControls> out;
+    replay(config, frames, out);
+
+    Metrics m;
+    memset(&m, 0, sizeof(m));
+    m.frames = (uint32_t)out.size();
+
+    std::vector<double> speed(out.size()), steering(out.size());
+    std::vector<double> speedIn(out.size()), steeringIn(out.size());
+    for (size_t i = 0; i < out.size(); i++) {
+        if (i > 0 && !sameControls(out[i], out[i - 1])) {
+            m.changed++;
+        }
+        if (sameControls(out[i], frames[i].recorded)) {
+            m.sameAsRecorded++;
+        }
+        speed[i] = out[i].emergencyStop ? 0 : out[i].speed;
+        steering[i] = out[i].steering;
+        speedIn[i] = speedInputPercent(config, frames[i].input);
+        steeringIn[i] = 100.0 * frames[i].input.left_stick_x / XBOX_STICK_MAX;
+    }
+    m.speedJerk = rmsJerk(frames, speed);
+    m.steeringJerk = rmsJerk(frames, steering);
+
+    // Steering reversals: swing between consecutive turning points
+    int direction = 0;
+    int extreme = out.empty() ? 0 : out[0].steering;
+    for (size_t i = 1; i < out.size(); i++) {
+        int delta = out[i].steering - out[i - 1].steering;
+        if (delta == 0) {
+            continue;
+        }
+        int newDirection = delta > 0 ? 1 : -1;
+        if (direction != 0 && newDirection != direction) {
+            int swing = std::abs(out[i - 1].steering - extreme);
+            m.reversals++;
+            m.totalSwing += swing;
+            if (swing > m.peakSwing) {
+                m.peakSwing = swing;
+            }
+            extreme = out[i - 1].steering;
+        }
+        direction = newDirection;
+    }
+
+    std::vector<double> delaysMs;
+    responseDelays(frames, speedIn, speed, delaysMs);
+    responseDelays(frames, steeringIn, steering, delaysMs);
+    m.onsets = (uint32_t)delaysMs.size();
+    for (size_t i = 0; i < delaysMs.size(); i++) {
+        m.delayMeanMs += delaysMs[i];
+        if (delaysMs[i] > m.delayMaxMs) {
+            m.delayMaxMs = delaysMs[i];
+        }
+    }
+    if (m.onsets) {
+        m.delayMeanMs /= m.onsets;
+    }
+
+    m.replayHash = trackHash(frames, out);
+    m.cpuNs = cpuNsPerFrame(config, frames);
+    return m;
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+
+static void row(const char* name, double a, double b, const char* format) {
+    char left[32], right[32], diff[32];
+    snprintf(left, sizeof(left), format, a);
+    snprintf(right, sizeof(right), format, b);
+    snprintf(diff, sizeof(diff), format, b - a);
+    std::string signedDiff = b - a > 0 ? std::string("+") + diff : std::string(diff);
+    printf("%-26s %14s %14s %14s\n", name, left, right, signedDiff.c_str());
+}
+
+int main(int argc, char** argv) {
+    if (argc != 4) {
+        fprintf(stderr, "Usage: %s macro_dump.csv <config A> <config B>\n", argv[0]);
+        fprintf(stderr, "  config: \"key=value ...\" or a file (keys: max_speed, deadzone,\n");
+        fprintf(stderr, "          trigger_accel, invert_steering, stick_drift)\n");
+        return 2;
+    }
+
+    std::vector<RecordedFrame> frames;
+    uint32_t recordedHash;
+    if (!loadRecording(argv[1], frames, recordedHash)) {
+        return 1;
+    }
+
+    ReplayConfig configs[2];
+    for (int i = 0; i < 2; i++) {
+        if (!parseConfig(argv[2 + i], configs[i])) {
+            return 2;
+        }
+    }
+
+    Metrics a = measure(configs[0], frames);
+    Metrics b = measure(configs[1], frames);
+
+    double seconds = (frames.back().offsetUs - frames.front().offsetUs) / 1e6;
+    printf("Session: %zu frames, %.1f s, hash 0x%08lx (matches the dump)\n",
+           frames.size(), seconds, (unsigned long)recordedHash);
+    printf("A: %s\nB: %s\n\n", configs[0].label.c_str(), configs[1].label.c_str());
+    printf("%-26s %14s %14s %14s\n", "", "A", "B", "B - A");
+    row("frames sent", a.frames, b.frames, "%.0f");
+    row("frames changed", a.changed, b.changed, "%.0f");
+    row("same as recorded", a.sameAsRecorded, b.sameAsRecorded, "%.0f");
+    row("speed jerk RMS (%/s^3)", a.speedJerk, b.speedJerk, "%.3g");
+    row("steering jerk RMS (%/s^3)", a.steeringJerk, b.steeringJerk, "%.3g");
+    row("steering reversals", a.reversals, b.reversals, "%.0f");
+    row("peak reversal swing (%)", a.peakSwing, b.peakSwing, "%.0f");
+    row("total reversal swing (%)", a.totalSwing, b.totalSwing, "%.0f");
+    row("input onsets", a.onsets, b.onsets, "%.0f");
+    row("response delay avg (ms)", a.delayMeanMs, b.delayMeanMs, "%.1f");
+    row("response delay max (ms)", a.delayMaxMs, b.delayMaxMs, "%.1f");
+    row("CPU per frame (ns, host)", a.cpuNs, b.cpuNs, "%.1f");
+
+    char hashA[16], hashB[16];
+    snprintf(hashA, sizeof(hashA), "0x%08lx", (unsigned long)a.replayHash);
+    snprintf(hashB, sizeof(hashB), "0x%08lx", (unsigned long)b.replayHash);
+    printf("%-26s %14s %14s\n", "replay hash", hashA, hashB);
+    for (int i = 0; i < 2; i++) {
+        const Metrics& m = i == 0 ? a : b;
+        if (m.replayHash == recordedHash) {
+            printf("%c reproduces the recording bit for bit\n", 'A' + i);
+        }
+    }
+    return 0;
+}
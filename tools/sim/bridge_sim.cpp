@@ -0,0 +1,1028 @@
+/**
+ * Bridge Simulator Implementation
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "bridge_sim.h"
+
+#define SIM_SCAN_RESTART_MS   3000    // main.cpp: scan ended with a peer missing
+#define SIM_RECONNECT_WAIT_MS 2000    // handleError(): no peer to reconnect from the cache
+#define SIM_CONNECT_TIMEOUT_MS 2000   // BLE_CONN_TIMEOUT, rounded up by NimBLE
+#define SIM_ADV_DELAY_US      10000   // Random advDelay added to each advert
+#define SIM_UPDATE_INSTANT    6       // Events until a parameter update applies
+
+static const RetryPolicy SIM_RETRY_POLICY = {
+    1 + BLE_MAX_RETRIES,
+    BLE_RETRY_BASE_MS,
+    BLE_RETRY_MAX_MS,
+    BLE_RETRY_JITTER_PERCENT
+};
+
+// Connect + GATT setup (encryption, discovery, subscription)
+static const uint32_t SETUP_US[SIM_PEER_COUNT] = { 600000, 300000 };
+
+static AimdPolicy aimdPolicy(const SimConfig& config) {
+    AimdPolicy policy = {
+        config.minRateHz,
+        config.maxRateHz,
+        std::min(std::max(config.startRateHz, config.minRateHz), config.maxRateHz),
+        LEGO_AIMD_INCREASE_HZ,
+        LEGO_AIMD_DECREASE_PERCENT,
+        LEGO_AIMD_WINDOW_WRITES,
+        config.latencyLimitUs
+    };
+    return policy;
+}
+
+static ControlSettings controlSettings(const SimConfig& config) {
+    ControlSettings settings;
+    settings.deadzonePercent = config.deadzonePercent;
+    settings.maxSpeedPercent = config.maxSpeedPercent;
+    return settings;
+}
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+static bool parseValue(const std::string& text, uint32_t maxValue, uint32_t& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    unsigned long parsed = strtoul(text.c_str(), &end, 10);
+    if (*end != '\0' || parsed > maxValue) {
+        return false;
+    }
+    value = (uint32_t)parsed;
+    return true;
+}
+
+bool simConfigSet(SimConfig& config, const std::string& key, const std::string& value) {
+    uint32_t v;
+    if (key == "seed") {
+        if (!parseValue(value, UINT32_MAX, v)) return false;
+        config.seed = v;
+    } else if (key == "xbox_interval") {
+        if (!parseValue(value, 3200, v) || v < 6) return false;
+        config.xboxInterval = v;
+    } else if (key == "lego_interval") {
+        if (!parseValue(value, 3200, v) || v < 6) return false;
+        config.legoInterval = v;
+    } else if (key == "conn_plan") {
+        if (!parseValue(value, 1, v)) return false;
+        config.connPlan = v != 0;
+    } else if (key == "supervision_ms") {
+        if (!parseValue(value, 32000, v) || v < 100) return false;
+        config.supervisionMs = v;
+    } else if (key == "min_rate") {
+        if (!parseValue(value, 1000, v) || v == 0) return false;
+        config.minRateHz = v;
+    } else if (key == "max_rate") {
+        if (!parseValue(value, 1000, v) || v == 0) return false;
+        config.maxRateHz = v;
+    } else if (key == "start_rate") {
+        if (!parseValue(value, 1000, v) || v == 0) return false;
+        config.startRateHz = v;
+    } else if (key == "latency_limit_us") {
+        if (!parseValue(value, UINT32_MAX, v)) return false;
+        config.latencyLimitUs = v;
+    } else if (key == "tx_min_interval_ms") {
+        if (!parseValue(value, 1000, v)) return false;
+        config.txMinIntervalMs = v;
+    } else if (key == "tx_align") {
+        if (!parseValue(value, 1, v)) return false;
+        config.txAlign = v != 0;
+    } else if (key == "align_lead_us") {
+        if (!parseValue(value, 1000000, v)) return false;
+        config.alignLeadUs = v;
+    } else if (key == "standby_scan") {
+        if (!parseValue(value, 1, v)) return false;
+        config.standbyScan = v != 0;
+    } else if (key == "reconnect_cache") {
+        if (!parseValue(value, 1, v)) return false;
+        config.reconnectCache = v != 0;
+    } else if (key == "deadzone") {
+        if (!parseValue(value, 50, v)) return false;
+        config.deadzonePercent = v;
+    } else if (key == "max_speed") {
+        if (!parseValue(value, 100, v)) return false;
+        config.maxSpeedPercent = v;
+    } else if (key == "hub_notify_ms") {
+        if (!parseValue(value, 60000, v) || v == 0) return false;
+        config.hubNotifyMs = v;
+    } else if (key == "hub_failsafe_ms") {
+        if (!parseValue(value, 60000, v) || v == 0) return false;
+        config.hubFailsafeMs = v;
+    } else if (key == "host_delay_us") {
+        if (!parseValue(value, 100000, v)) return false;
+        config.hostDelayUs = v;
+    } else if (key == "stack_us") {
+        if (!parseValue(value, 100000, v)) return false;
+        config.stackUs = v;
+    } else if (key == "stack_depth") {
+        if (!parseValue(value, 64, v) || v == 0) return false;
+        config.stackDepth = v;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool simConfigValid(const SimConfig& config) {
+    return config.minRateHz <= config.maxRateHz;
+}
+
+std::string simConfigDescribe(const SimConfig& config) {
+    char text[512];
+    snprintf(text, sizeof(text),
+             "seed=%u xbox_interval=%u lego_interval=%u conn_plan=%d supervision_ms=%u "
+             "min_rate=%u max_rate=%u start_rate=%u latency_limit_us=%u tx_min_interval_ms=%u "
+             "tx_align=%d align_lead_us=%u standby_scan=%d reconnect_cache=%d deadzone=%u "
+             "max_speed=%u hub_notify_ms=%u "
+             "hub_failsafe_ms=%u host_delay_us=%u stack_us=%u stack_depth=%u",
+             config.seed, config.xboxInterval, config.legoInterval, config.connPlan ? 1 : 0,
+             config.supervisionMs, config.minRateHz, config.maxRateHz, config.startRateHz,
+             config.latencyLimitUs, config.txMinIntervalMs, config.txAlign ? 1 : 0,
+             config.alignLeadUs, config.standbyScan ? 1 : 0, config.reconnectCache ? 1 : 0,
+             config.deadzonePercent, config.maxSpeedPercent,
+             config.hubNotifyMs, config.hubFailsafeMs, config.hostDelayUs, config.stackUs,
+             config.stackDepth);
+    return text;
+}
+
+// ============================================================================
+// Names and Helpers
+// ============================================================================
+
+const char* simPeerName(SimPeer peer) {
+    switch (peer) {
+        case SimPeer::XBOX: return "xbox";
+        case SimPeer::LEGO: return "lego";
+        default:            return "?";
+    }
+}
+
+const char* simStateName(SimState state) {
+    switch (state) {
+        case SimState::SCANNING:  return "scanning";
+        case SimState::CONNECTED: return "connected";
+        case SimState::ACTIVE:    return "active";
+        default:                  return "?";
+    }
+}
+
+bool simProfile(const std::string& name, SimImpairment& impairment) {
+    SimImpairment profile;
+    if (name == "clean") {
+        // Defaults
+    } else if (name == "lossy") {
+        profile.lossPercent = 10;
+        profile.jitterUs = 1000;
+    } else if (name == "congested") {
+        profile.lossPercent = 5;
+        profile.latencyUs = 4000;
+        profile.jitterUs = 4000;
+    } else if (name == "bad") {
+        profile.lossPercent = 30;
+        profile.latencyUs = 10000;
+        profile.jitterUs = 10000;
+    } else {
+        return false;
+    }
+    impairment = profile;
+    return true;
+}
+
+uint32_t simPercentile(const std::vector<uint32_t>& samples, uint8_t percent) {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::vector<uint32_t> sorted(samples);
+    std::sort(sorted.begin(), sorted.end());
+
+    // Nearest rank
+    size_t rank = (sorted.size() * percent + 99) / 100;
+    return sorted[rank == 0 ? 0 : rank - 1];
+}
+
+// ============================================================================
+// BridgeSim Implementation
+// ============================================================================
+
+BridgeSim::BridgeSim(const SimConfig& simConfig)
+    : config(simConfig)
+    , nowUs(0)
+    , rng(((uint64_t)simConfig.seed << 1) | 1)
+    , crowd(0)
+    , state(SimState::SCANNING)
+    , scanning(false)
+    , scanPending(true)
+    , scanEndUs(0)
+    , blockedUntilUs(0)
+    , connecting(-1)
+    , connectDoneUs(0)
+    , connectWillSucceed(false)
+    , retry{ ConnectRetry(SIM_RETRY_POLICY), ConnectRetry(SIM_RETRY_POLICY) }
+    , mapper(controlSettings(simConfig))
+    , rateController(aimdPolicy(simConfig))
+    , lastControlUs(0)
+    , lastTxUs(0)
+    , lastPlanCheckUs(0)
+    , activeSinceUs(0)
+    , inputStampUs(0)
+    , rampStartUs(0)
+    , rampUs(0)
+    , hostStampUs(0)
+    , hubNextNotifyUs(0)
+    , hubLastRxUs(0)
+    , hubWatchdogArmed(false)
+    , hubDeliveredStampUs(0)
+    , stopPressUs(0)
+    , hubSpeed(0)
+{
+    stats = SimStats();
+    noteRate();
+
+    for (int i = 0; i < SIM_PEER_COUNT; i++) {
+        Peer& peer = peers[i];
+        peer.present = false;
+        peer.rssi = -60;
+        peer.advIntervalUs = 100000;
+        peer.nextAdvUs = 0;
+        peer.refusals = 0;
+        peer.found = false;
+        peer.cachedAdvUs = 0;
+        peer.releasedUs = 0;
+        peer.everConnected = false;
+        memset(&peer.link, 0, sizeof(peer.link));
+    }
+
+    memset(&input, 0, sizeof(input));
+    memset(&hostInput, 0, sizeof(hostInput));
+    memset(rampFrom, 0, sizeof(rampFrom));
+    memset(rampTo, 0, sizeof(rampTo));
+    memset(slotStampUs, 0, sizeof(slotStampUs));
+    memset(slotControls, 0, sizeof(slotControls));
+
+    // Stir the seed so neighbouring seeds diverge at once
+    for (int i = 0; i < 8; i++) {
+        random();
+    }
+}
+
+uint32_t BridgeSim::random() {
+    // xorshift64*
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return (uint32_t)((rng * 2685821657736338717ULL) >> 32);
+}
+
+bool BridgeSim::chance(uint32_t perMillion) {
+    return random() % 1000000 < perMillion;
+}
+
+uint32_t BridgeSim::lossPerMillion(SimPeer which) const {
+    const Peer& peer = peers[(int)which];
+
+    // Impairment, weak signal (2.5% per dB below -80 dBm) and a crowded band
+    double impaired = peer.impairment.lossPercent / 100.0;
+    double weak = std::min(std::max((-80 - peer.rssi) * 0.025, 0.0), 0.5);
+    double crowded = std::min(crowd * 0.001, 0.2);
+    double delivered = (1 - impaired) * (1 - weak) * (1 - crowded);
+    return (uint32_t)((1 - delivered) * 1000000);
+}
+
+uint32_t BridgeSim::deliveryDelayUs(SimPeer which) {
+    const SimImpairment& impairment = peers[(int)which].impairment;
+    uint32_t jitter = impairment.jitterUs ? random() % (impairment.jitterUs + 1) : 0;
+    return impairment.latencyUs + jitter;
+}
+
+// ============================================================================
+// Scenario Inputs
+// ============================================================================
+
+void BridgeSim::appear(SimPeer which, int8_t rssi, uint32_t advIntervalMs) {
+    Peer& peer = peers[(int)which];
+    peer.present = true;
+    peer.rssi = rssi;
+    peer.advIntervalUs = advIntervalMs * 1000;
+    peer.nextAdvUs = nowUs + random() % (peer.advIntervalUs + 1);
+}
+
+void BridgeSim::vanish(SimPeer which) {
+    // The link (if any) stays until supervision times it out
+    peers[(int)which].present = false;
+}
+
+void BridgeSim::setRssi(SimPeer which, int8_t rssi) {
+    peers[(int)which].rssi = rssi;
+}
+
+void BridgeSim::disconnect(SimPeer which) {
+    if (peers[(int)which].link.up) {
+        dropLink(which);
+    }
+}
+
+void BridgeSim::refuse(SimPeer which, uint32_t attempts) {
+    peers[(int)which].refusals = attempts;
+}
+
+void BridgeSim::setImpairment(SimPeer which, const SimImpairment& impairment) {
+    peers[(int)which].impairment = impairment;
+}
+
+void BridgeSim::setCrowd(uint16_t advertisers) {
+    crowd = advertisers;
+}
+
+void BridgeSim::setDrive(int8_t speed, int8_t steering, uint32_t newRampUs) {
+    updateInput();
+    rampFrom[0] = rampTo[0];
+    rampFrom[1] = rampTo[1];
+    if (rampUs != 0 && nowUs < rampStartUs + rampUs) {
+        // Start from where a running ramp has got to
+        uint64_t elapsed = nowUs - rampStartUs;
+        for (int i = 0; i < 2; i++) {
+            rampFrom[i] = rampFrom[i] + (int32_t)(rampTo[i] - rampFrom[i]) * (int64_t)elapsed / rampUs;
+        }
+    }
+    rampTo[0] = speed;
+    rampTo[1] = steering;
+    rampStartUs = nowUs;
+    rampUs = newRampUs;
+    updateInput();
+}
+
+void BridgeSim::setButtons(uint16_t buttons) {
+    // ControlMapper's emergency stop: B + X (bits 1 and 2)
+    const uint16_t stopButtons = 0x0006;
+    bool pressed = (buttons & stopButtons) == stopButtons && (input.buttons & stopButtons) != stopButtons;
+    if (pressed && state == SimState::ACTIVE) {
+        stopPressUs = nowUs;
+    } else if ((buttons & stopButtons) != stopButtons) {
+        stopPressUs = 0;
+    }
+    if (input.buttons != buttons) {
+        input.buttons = buttons;
+        inputStampUs = nowUs;
+    }
+}
+
+void BridgeSim::updateInput() {
+    int32_t value[2];
+    for (int i = 0; i < 2; i++) {
+        if (rampUs == 0 || nowUs >= rampStartUs + rampUs) {
+            value[i] = rampTo[i];
+        } else {
+            value[i] = rampFrom[i] + (int32_t)(rampTo[i] - rampFrom[i]) * (int64_t)(nowUs - rampStartUs) / rampUs;
+        }
+    }
+
+    XboxPackedState next = input;
+    next.right_trigger = value[0] > 0 ? value[0] * 1023 / 100 : 0;
+    next.left_trigger = value[0] < 0 ? -value[0] * 1023 / 100 : 0;
+    next.left_stick_y = value[0] * 32767 / 100;
+    next.left_stick_x = value[1] * 32767 / 100;
+    if (memcmp(&next, &input, sizeof(next)) != 0) {
+        input = next;
+        inputStampUs = nowUs;
+    }
+}
+
+// ============================================================================
+// Time
+// ============================================================================
+
+void BridgeSim::runUntil(uint64_t timeUs) {
+    while (nowUs + SIM_LOOP_US <= timeUs) {
+        step();
+    }
+}
+
+uint64_t BridgeSim::getTimeUs() const {
+    return nowUs;
+}
+
+SimState BridgeSim::getState() const {
+    return state;
+}
+
+bool BridgeSim::isConnected(SimPeer which) const {
+    return peers[(int)which].link.up;
+}
+
+int8_t BridgeSim::getHubSpeed() const {
+    return hubSpeed;
+}
+
+const SimStats& BridgeSim::getStats() const {
+    return stats;
+}
+
+const SimConfig& BridgeSim::getConfig() const {
+    return config;
+}
+
+void BridgeSim::step() {
+    uint64_t endUs = nowUs + SIM_LOOP_US;
+
+    updateInput();
+
+    // Deliveries that have reached the host and the hub by now
+    while (!reportsInFlight.empty() && reportsInFlight.front().arriveUs <= nowUs) {
+        const Report& report = reportsInFlight.front();
+        if (peers[(int)SimPeer::XBOX].link.up) {
+            hostInput = report.state;
+            hostStampUs = report.stampUs;
+            tracker[(int)SimPeer::XBOX].observe((uint32_t)report.arriveUs);
+        }
+        reportsInFlight.pop_front();
+    }
+    while (!hubObservations.empty() && hubObservations.front() <= nowUs) {
+        if (peers[(int)SimPeer::LEGO].link.up) {
+            tracker[(int)SimPeer::LEGO].observe((uint32_t)hubObservations.front());
+        }
+        hubObservations.pop_front();
+    }
+    while (!hubInFlight.empty() && hubInFlight.front().first <= nowUs) {
+        hubReceive(hubInFlight.front().second, hubInFlight.front().first);
+        hubInFlight.pop_front();
+    }
+
+    // Hub watchdog
+    if (hubWatchdogArmed && nowUs - hubLastRxUs > config.hubFailsafeMs * 1000ULL) {
+        stats.failsafes++;
+        hubWatchdogArmed = false;
+        hubSpeed = 0;
+    }
+
+    checkSupervision();
+    updateDiscovery();
+    if (nowUs >= blockedUntilUs) {
+        updateBridge();
+    }
+    if (state == SimState::ACTIVE) {
+        stats.activeMs++;
+    }
+
+    processEvents(endUs);
+    nowUs = endUs;
+}
+
+// ============================================================================
+// Discovery and Bring-up
+// ============================================================================
+
+void BridgeSim::updateDiscovery() {
+    // Discovery scan (paused while connecting), or standby scan while active
+    bool discovery = state == SimState::SCANNING && scanning && connecting < 0 && nowUs >= blockedUntilUs;
+    bool standby = state == SimState::ACTIVE && config.standbyScan;
+    double duty = discovery ? (double)BLE_SCAN_WINDOW / BLE_SCAN_INTERVAL
+                : standby ? (double)BLE_STANDBY_SCAN_WINDOW / BLE_STANDBY_SCAN_INTERVAL
+                : 0;
+
+    for (int i = 0; i < SIM_PEER_COUNT; i++) {
+        Peer& peer = peers[i];
+        if (!peer.present || peer.link.up) {
+            continue;
+        }
+        if (nowUs < peer.nextAdvUs) {
+            continue;
+        }
+        peer.nextAdvUs += peer.advIntervalUs + random() % SIM_ADV_DELAY_US;
+
+        // Heard: in a scan window, strong enough, and not collided in the crowd
+        double heard = duty
+                     * std::min(std::max((peer.rssi + 95) / 15.0, 0.0), 1.0)
+                     * pow(0.992, crowd);
+        if (!chance((uint32_t)(heard * 1000000))) {
+            continue;
+        }
+        peer.cachedAdvUs = nowUs;
+        if (discovery) {
+            peer.found = true;
+        }
+    }
+}
+
+void BridgeSim::startScan() {
+    scanPending = false;
+
+    // Peers not up are found again, from the cache if possible
+    for (int i = 0; i < SIM_PEER_COUNT; i++) {
+        Peer& peer = peers[i];
+        if (peer.link.up) {
+            continue;
+        }
+        peer.found = isSeedable(peer);
+        retry[i].reset();
+    }
+
+    scanning = !(peers[0].found && peers[1].found);
+    scanEndUs = nowUs + BLE_SCAN_DURATION * 1000000ULL;
+}
+
+bool BridgeSim::isSeedable(const Peer& peer) const {
+    // BLEManager::seedFromAdvertCache(): only a peer connected before (one
+    // device per peer here), released by us or heard recently
+    if (!config.reconnectCache || !peer.everConnected) {
+        return false;
+    }
+    uint64_t maxAgeUs = BLE_ADVERT_MAX_AGE_MS * 1000ULL;
+    return (peer.releasedUs != 0 && nowUs - peer.releasedUs <= maxAgeUs)
+        || (peer.cachedAdvUs != 0 && nowUs - peer.cachedAdvUs <= maxAgeUs);
+}
+
+bool BridgeSim::inStandbyWindow(uint64_t timeUs) const {
+    if (state != SimState::ACTIVE || !config.standbyScan || timeUs < activeSinceUs) {
+        return false;
+    }
+    return (timeUs - activeSinceUs) % (BLE_STANDBY_SCAN_INTERVAL * 625ULL) < BLE_STANDBY_SCAN_WINDOW * 625ULL;
+}
+
+void BridgeSim::updateBringUp() {
+    uint32_t nowMs = (uint32_t)(nowUs / 1000);
+
+    if (connecting >= 0) {
+        if (nowUs < connectDoneUs) {
+            return;
+        }
+        int i = connecting;
+        connecting = -1;
+        if (connectWillSucceed && peers[i].present) {
+            retry[i].recordSuccess();
+            connectLink((SimPeer)i);
+        } else {
+            stats.connectFailures[i]++;
+            retry[i].recordFailure(nowMs, random());
+            if (retry[i].isExhausted()) {
+                // Forgotten - found again by the scan
+                stats.rescans[i]++;
+                peers[i].found = false;
+                retry[i].reset();
+            } else {
+                uint32_t delayMs = retry[i].getNextDelayMs();
+                if (stats.backoffMaxMs[i] == 0 || delayMs < stats.backoffMinMs[i]) {
+                    stats.backoffMinMs[i] = delayMs;
+                }
+                stats.backoffMaxMs[i] = std::max(stats.backoffMaxMs[i], delayMs);
+            }
+        }
+        return;
+    }
+
+    // One connection at a time, Xbox first
+    for (int i = 0; i < SIM_PEER_COUNT; i++) {
+        Peer& peer = peers[i];
+        if (!peer.found || peer.link.up || !retry[i].isDue(nowMs)) {
+            continue;
+        }
+
+        connecting = i;
+        if (peer.present) {
+            // A handful of packets must get through for connect and setup
+            double delivered = 1 - lossPerMillion((SimPeer)i) / 1000000.0;
+            connectWillSucceed = chance((uint32_t)(pow(delivered, 4) * 1000000));
+            if (peer.refusals > 0) {
+                // Connects, then setup fails (e.g. discovery times out)
+                peer.refusals--;
+                connectWillSucceed = false;
+            }
+            uint32_t setupUs = SETUP_US[i] * (80 + random() % 41) / 100;
+            connectDoneUs = nowUs + (connectWillSucceed ? setupUs : setupUs / 2);
+        } else {
+            connectWillSucceed = false;
+            connectDoneUs = nowUs + SIM_CONNECT_TIMEOUT_MS * 1000ULL;
+        }
+        return;
+    }
+}
+
+void BridgeSim::connectLink(SimPeer which) {
+    Peer& peer = peers[(int)which];
+    Link& link = peer.link;
+    uint16_t interval = which == SimPeer::XBOX ? config.xboxInterval : config.legoInterval;
+
+    link.up = true;
+    link.intervalUs = interval * 1250;
+    link.nextEventUs = nowUs + random() % link.intervalUs;
+    link.lastGoodUs = nowUs;
+    link.skippedLast = false;
+    link.pendingIntervalUs = 0;
+    link.updateAtUs = 0;
+
+    tracker[(int)which].reset();
+    tracker[(int)which].setInterval(link.intervalUs);
+    stats.connects[(int)which]++;
+    peer.everConnected = true;
+    peer.releasedUs = 0;
+
+    if (which == SimPeer::LEGO) {
+        hubNextNotifyUs = nowUs + config.hubNotifyMs * 1000ULL;
+        hubWatchdogArmed = false;
+        hubSpeed = 0;
+    }
+}
+
+void BridgeSim::dropLink(SimPeer which) {
+    Peer& peer = peers[(int)which];
+    peer.link.up = false;
+    peer.found = false;
+    peer.nextAdvUs = nowUs + random() % (peer.advIntervalUs + 1);
+    stats.disconnects[(int)which]++;
+
+    if (which == SimPeer::LEGO) {
+        // The hub stops the motors when the link goes
+        if (hubSpeed != 0) {
+            stats.failsafes++;
+        }
+        hubSpeed = 0;
+        hubWatchdogArmed = false;
+        stackQueue.clear();
+        hubInFlight.clear();
+        hubObservations.clear();
+    } else {
+        reportsInFlight.clear();
+    }
+}
+
+void BridgeSim::checkSupervision() {
+    for (int i = 0; i < SIM_PEER_COUNT; i++) {
+        Link& link = peers[i].link;
+        // Events run ahead within a loop tick, so lastGoodUs may be after nowUs
+        if (link.up && nowUs > link.lastGoodUs + config.supervisionMs * 1000ULL) {
+            dropLink((SimPeer)i);
+        }
+    }
+}
+
+// ============================================================================
+// Bridge State Machine (main.cpp loop())
+// ============================================================================
+
+void BridgeSim::updateBridge() {
+    switch (state) {
+        case SimState::SCANNING:
+            if (scanPending) {
+                startScan();
+            }
+            updateBringUp();
+
+            if (peers[0].link.up && peers[1].link.up && connecting < 0) {
+                scanning = false;
+                state = SimState::CONNECTED;
+                break;
+            }
+
+            if (scanning && nowUs >= scanEndUs) {
+                scanning = false;
+            }
+            if (!scanning && !(peers[0].found && peers[1].found)) {
+                blockedUntilUs = nowUs + SIM_SCAN_RESTART_MS * 1000ULL;
+                scanPending = true;
+            }
+            break;
+
+        case SimState::CONNECTED:
+            state = SimState::ACTIVE;
+            planner.reset();
+            lastPlanCheckUs = 0;
+            lastControlUs = nowUs;
+            activeSinceUs = nowUs;
+            hubDeliveredStampUs = std::max(hubDeliveredStampUs, nowUs);
+            rateController.reset();
+            noteRate();
+            scheduler.clear();
+            if (!stats.everActive) {
+                stats.everActive = true;
+                stats.firstActiveMs = (uint32_t)(nowUs / 1000);
+            }
+            break;
+
+        case SimState::ACTIVE:
+            if (!peers[(int)SimPeer::XBOX].link.up) {
+                teardown(SimPeer::XBOX);
+                break;
+            }
+            if (!peers[(int)SimPeer::LEGO].link.up) {
+                teardown(SimPeer::LEGO);
+                break;
+            }
+
+            if (nowUs - lastControlUs >= rateController.getIntervalMs() * 1000ULL) {
+                updateControl();
+                lastControlUs = nowUs;
+            }
+            service();
+
+            if (config.connPlan && nowUs - lastPlanCheckUs >= CONN_PLAN_CHECK_MS * 1000ULL) {
+                lastPlanCheckUs = nowUs;
+                updateConnPlan();
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void BridgeSim::teardown(SimPeer lost) {
+    // handleError(): stop the car first if the hub is still there (the
+    // acknowledged write completes before the links are torn down)
+    if (lost == SimPeer::XBOX && peers[(int)SimPeer::LEGO].link.up) {
+        Packet stop;
+        memset(&stop, 0, sizeof(stop));
+        stop.controls = slotControls[(int)LegoTxClass::DRIVE];
+        stop.controls.speed = 0;
+        stop.stop = true;
+        hubReceive(stop, peers[(int)SimPeer::LEGO].link.nextEventUs + deliveryDelayUs(SimPeer::LEGO));
+        stats.framesWritten++;
+    }
+
+    // resetForReconnection(): both links go, the advert cache stays
+    for (int i = 0; i < SIM_PEER_COUNT; i++) {
+        Peer& peer = peers[i];
+        if (peer.link.up) {
+            peer.link.up = false;
+            peer.releasedUs = nowUs;
+            peer.nextAdvUs = nowUs + random() % (peer.advIntervalUs + 1);
+        }
+        peer.found = false;
+        retry[i].reset();
+    }
+    hubWatchdogArmed = false;
+    stackQueue.clear();
+    hubInFlight.clear();
+    hubObservations.clear();
+    reportsInFlight.clear();
+    scheduler.clear();
+    memset(&hostInput, 0, sizeof(hostInput));
+
+    bool cached = false;
+    for (int i = 0; i < SIM_PEER_COUNT; i++) {
+        cached = cached || isSeedable(peers[i]);
+    }
+    if (!cached) {
+        blockedUntilUs = nowUs + SIM_RECONNECT_WAIT_MS * 1000ULL;
+    }
+    state = SimState::SCANNING;
+    scanPending = true;
+}
+
+// ============================================================================
+// Control Path (updateControlLoop() and LegoHub::service())
+// ============================================================================
+
+void BridgeSim::updateControl() {
+    XboxControllerState pad;
+    xboxUnpackState(hostInput, pad);
+    MappedControls controls = mapper.map(pad);
+
+    LegoFrame frame;
+    LegoTxClass cls;
+    if (controls.emergencyStop) {
+        controls.speed = 0;
+        controls.lights = LEGO_LIGHTS_BRAKE;
+        cls = LegoTxClass::STOP;
+    } else {
+        cls = LegoTxClass::DRIVE;
+    }
+    legoEncodeDrive(frame, controls.speed, controls.steering, controls.lights);
+    if (scheduler.submit(cls, frame, (uint32_t)nowUs)) {
+        slotStampUs[(int)cls] = hostStampUs;
+        slotControls[(int)cls] = controls;
+        stats.framesSubmitted++;
+    }
+}
+
+void BridgeSim::service() {
+    uint32_t now32 = (uint32_t)nowUs;
+
+    LegoTxClass cls;
+    if (!scheduler.peek(cls)) {
+        return;
+    }
+    if (cls != LegoTxClass::STOP && nowUs - lastTxUs < config.txMinIntervalMs * 1000ULL) {
+        return;
+    }
+
+    ConnEventTracker& hubTracker = tracker[(int)SimPeer::LEGO];
+    bool timed = hubTracker.isLocked(now32);
+    uint32_t eventUs = hubTracker.nextEventUs(now32);
+    bool align = timed && config.txAlign && cls != LegoTxClass::STOP;
+    if (align && eventUs - now32 > config.alignLeadUs) {
+        return;
+    }
+
+    LegoFrame frame;
+    uint32_t submittedUs;
+    if (!scheduler.pop(frame, cls, submittedUs)) {
+        return;
+    }
+
+    Packet packet;
+    packet.controls = slotControls[(int)cls];
+    packet.stampUs = slotStampUs[(int)cls];
+    packet.stop = cls == LegoTxClass::STOP;
+    packet.readyUs = nowUs + config.stackUs;
+
+    // A full stack buffer blocks the write until the next event drains it
+    if (stackQueue.size() >= config.stackDepth) {
+        const Link& link = peers[(int)SimPeer::LEGO].link;
+        uint32_t blockedUs = (uint32_t)(link.nextEventUs - nowUs) + config.stackUs;
+        packet.readyUs = nowUs + blockedUs;
+        stats.slowWrites++;
+        if (!packet.stop) {
+            rateController.recordWrite(true, blockedUs);
+        }
+    } else if (!packet.stop) {
+        rateController.recordWrite(true, 50);
+    }
+    noteRate();
+
+    scheduler.recordSent(cls, submittedUs, now32);
+    stackQueue.push_back(packet);
+    stats.framesWritten++;
+    lastTxUs = nowUs;
+}
+
+void BridgeSim::noteRate() {
+    const AimdStats& aimd = rateController.getStats();
+    stats.rateHz = rateController.getRateHz();
+    stats.rateMinHz = aimd.lowestRateHz;
+    stats.rateMaxHz = aimd.highestRateHz;
+    stats.rateCuts = aimd.failureCuts + aimd.latencyCuts;
+    stats.rateIncreases = aimd.increases;
+}
+
+void BridgeSim::updateConnPlan() {
+    uint32_t now32 = (uint32_t)nowUs;
+    ConnEventPhase xbox = tracker[(int)SimPeer::XBOX].getPhase(now32);
+    ConnEventPhase lego = tracker[(int)SimPeer::LEGO].getPhase(now32);
+    if (!planner.check(xbox, lego, (uint32_t)(nowUs / 1000))) {
+        return;
+    }
+
+    // BLEManager::requestConnIntervals() - applied a few events later
+    ConnPlan plan = planner.getPlan();
+    uint16_t intervals[SIM_PEER_COUNT] = { plan.xboxInterval, plan.legoInterval };
+    for (int i = 0; i < SIM_PEER_COUNT; i++) {
+        Link& link = peers[i].link;
+        if (link.intervalUs != intervals[i] * 1250U) {
+            link.pendingIntervalUs = intervals[i] * 1250U;
+            link.updateAtUs = link.nextEventUs + SIM_UPDATE_INSTANT * link.intervalUs;
+        }
+    }
+    planner.planRequested((uint32_t)(nowUs / 1000));
+    stats.replans = planner.getStats().replans;
+}
+
+// ============================================================================
+// Radio
+// ============================================================================
+
+void BridgeSim::processEvents(uint64_t endUs) {
+    Link& xbox = peers[(int)SimPeer::XBOX].link;
+    Link& lego = peers[(int)SimPeer::LEGO].link;
+
+    for (;;) {
+        // Parameter updates take effect at their instant, with a new anchor
+        for (int i = 0; i < SIM_PEER_COUNT; i++) {
+            Link& link = peers[i].link;
+            if (link.up && link.pendingIntervalUs && link.nextEventUs >= link.updateAtUs) {
+                link.intervalUs = link.pendingIntervalUs;
+                link.nextEventUs = link.updateAtUs + random() % link.intervalUs;
+                link.pendingIntervalUs = 0;
+                tracker[i].setInterval(link.intervalUs);
+            }
+        }
+
+        bool xboxDue = xbox.up && xbox.nextEventUs < endUs;
+        bool legoDue = lego.up && lego.nextEventUs < endUs;
+        if (!xboxDue && !legoDue) {
+            return;
+        }
+        SimPeer first = !legoDue || (xboxDue && xbox.nextEventUs <= lego.nextEventUs)
+                      ? SimPeer::XBOX : SimPeer::LEGO;
+        SimPeer second = first == SimPeer::XBOX ? SimPeer::LEGO : SimPeer::XBOX;
+        Link& a = peers[(int)first].link;
+        Link& b = peers[(int)second].link;
+
+        if (inStandbyWindow(a.nextEventUs)) {
+            a.nextEventUs += a.intervalUs;
+            stats.scanSkips++;
+            continue;
+        }
+
+        // Too close together - the link skipped last time gets the radio
+        if (b.up && b.nextEventUs < a.nextEventUs + SIM_EVENT_RESERVE_US) {
+            bool secondWins = b.skippedLast && !a.skippedLast;
+            SimPeer winner = secondWins ? second : first;
+            SimPeer loser = secondWins ? first : second;
+            Link& lost = peers[(int)loser].link;
+            lost.nextEventUs += lost.intervalUs;
+            lost.skippedLast = true;
+            stats.skippedEvents[(int)loser]++;
+            runEvent(winner);
+            continue;
+        }
+        runEvent(first);
+    }
+}
+
+void BridgeSim::runEvent(SimPeer which) {
+    Peer& peer = peers[(int)which];
+    Link& link = peer.link;
+    uint64_t eventUs = link.nextEventUs;
+    link.nextEventUs += link.intervalUs;
+    link.skippedLast = false;
+    stats.airtimeUs += SIM_EVENT_BASE_US;
+
+    bool ok = peer.present && !chance(lossPerMillion(which));
+
+    if (which == SimPeer::XBOX) {
+        // A report in every event; the central retries a lost one
+        stats.airtimeUs += SIM_PACKET_US;
+        if (!ok) {
+            return;
+        }
+        link.lastGoodUs = eventUs;
+        Report report;
+        report.state = input;
+        report.stampUs = inputStampUs;
+        report.arriveUs = eventUs + config.hostDelayUs + deliveryDelayUs(which);
+        if (!reportsInFlight.empty() && report.arriveUs < reportsInFlight.back().arriveUs) {
+            report.arriveUs = reportsInFlight.back().arriveUs;   // In order
+        }
+        reportsInFlight.push_back(report);
+        return;
+    }
+
+    // Hub: queued frames (lost ones are retransmitted next event), then
+    // a port notification when one is due
+    int packets = 0;
+    while (packets < SIM_EVENT_PACKETS && packets < (int)stackQueue.size()
+           && stackQueue[packets].readyUs <= eventUs) {
+        packets++;
+    }
+    bool notify = eventUs >= hubNextNotifyUs;
+    stats.airtimeUs += (uint64_t)(packets + (notify ? 1 : 0)) * SIM_PACKET_US;
+
+    if (!ok) {
+        stats.retransmissions += packets;
+        return;
+    }
+    link.lastGoodUs = eventUs;
+
+    uint64_t arriveUs = eventUs + deliveryDelayUs(which);
+    if (!hubInFlight.empty() && arriveUs < hubInFlight.back().first) {
+        arriveUs = hubInFlight.back().first;
+    }
+    for (int i = 0; i < packets; i++) {
+        const Packet& packet = stackQueue.front();
+        hubInFlight.push_back(std::make_pair(arriveUs, packet));
+        if (packet.stop) {
+            // The write response comes back to the host
+            hubObservations.push_back(arriveUs + config.hostDelayUs);
+        }
+        stackQueue.pop_front();
+    }
+
+    if (notify) {
+        while (hubNextNotifyUs <= eventUs) {
+            hubNextNotifyUs += config.hubNotifyMs * 1000ULL;
+        }
+        uint64_t observedUs = eventUs + config.hostDelayUs + deliveryDelayUs(which);
+        if (!hubObservations.empty() && observedUs < hubObservations.back()) {
+            observedUs = hubObservations.back();
+        }
+        hubObservations.push_back(observedUs);
+    }
+}
+
+void BridgeSim::hubReceive(const Packet& packet, uint64_t atUs) {
+    stats.framesDelivered++;
+    hubLastRxUs = atUs;
+    hubWatchdogArmed = true;
+    hubSpeed = packet.stop ? 0 : packet.controls.speed;
+
+    // First frame carrying an input (or a newer one)
+    if (packet.stampUs > hubDeliveredStampUs) {
+        hubDeliveredStampUs = packet.stampUs;
+        stats.latencyUs.push_back((uint32_t)(atUs - packet.stampUs));
+    }
+
+    // A held stop repeats every control frame - only the first one counts
+    if (packet.stop && stopPressUs != 0 && atUs >= stopPressUs) {
+        stats.stopLatencyUs.push_back((uint32_t)(atUs - stopPressUs));
+        stopPressUs = 0;
+    }
+}
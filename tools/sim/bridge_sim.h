@@ -0,0 +1,336 @@
+/**
+ * Bridge Simulator - The bridge, its two peers and the radio in virtual time
+ *
+ * Host only (C++11). The bridge side runs the firmware's own pure modules:
+ * ConnectRetry, TxRateController, LegoTxScheduler, ControlMapper,
+ * ConnEventTracker and ConnPlanner. The parts that need a radio are modeled
+ * after main.cpp, BLEManager and LegoHub:
+ *
+ * - Discovery: each advertising peer is heard with a probability set by the
+ *   scan duty cycle, its RSSI and the number of other advertisers ("crowd").
+ *   Peers are connected one at a time as they are found, failed attempts go
+ *   through ConnectRetry (a peer whose retries run out is forgotten until
+ *   the scan hears it again), and a scan that ends with a peer missing
+ *   restarts after 3 s. A disconnect while active tears both links down, waiting 2 s
+ *   unless a peer can be reconnected without a scan: one whose link the
+ *   bridge ended itself, or one with a fresh cached advert.
+ * - Standby scan: while active, a passive window (BLE_STANDBY_SCAN_WINDOW
+ *   every BLE_STANDBY_SCAN_INTERVAL) caches adverts of peers not connected.
+ *   As a worst case, connection events that start inside a window are
+ *   skipped (NimBLE's controller gives connections priority instead).
+ * - Links: connection events at each link's interval, from a random anchor.
+ *   Events of the two links that start within SIM_EVENT_RESERVE_US collide
+ *   and one is skipped (the link skipped last time wins). Each event is lost
+ *   with the link's loss probability; lost packets are retransmitted at the
+ *   next event. A link without a good event for the supervision timeout
+ *   drops.
+ * - Xbox: one report per connection event with the current input.
+ * - Hub: a port notification every hubNotifyMs (feeds the event tracker),
+ *   and a watchdog that counts a failsafe when no frame arrives for
+ *   hubFailsafeMs, or when the link drops while the car moves.
+ * - Control: the loop runs every 1 ms; the control update at the AIMD rate,
+ *   service() with LegoHub's pacing and event alignment, and writes queue in
+ *   a stack buffer of stackDepth frames (a full buffer makes the write slow,
+ *   which the AIMD controller sees as congestion).
+ *
+ * Latency is measured from an input change at the controller to the first
+ * frame at the hub that was mapped from it (or from a newer input), for
+ * inputs changed while active. Stop latency is the same for the first stop
+ * frame of each emergency stop.
+ * Everything is driven by one seeded generator, so a seed and a sequence of
+ * calls always give the same run.
+ */
+
+#ifndef BRIDGE_SIM_H
+#define BRIDGE_SIM_H
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "conn_event_tracker.h"
+#include "conn_planner.h"
+#include "connect_retry.h"
+#include "control_mapper.h"
+#include "lego_tx_scheduler.h"
+#include "tx_rate_controller.h"
+#include "xbox_report.h"
+
+#define SIM_LOOP_US          1000   // Firmware loop period while active
+#define SIM_EVENT_RESERVE_US 1250   // Radio time kept for one connection event
+#define SIM_EVENT_BASE_US    300    // Empty packet exchange (two PDUs + IFS)
+#define SIM_PACKET_US        250    // Added per data packet
+#define SIM_EVENT_PACKETS    4      // Data packets per connection event, at most
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+struct SimConfig {
+    uint32_t seed = 1;
+
+    // Connection intervals the peers start with (units of 1.25 ms)
+    uint16_t xboxInterval = 6;
+    uint16_t legoInterval = 24;
+    bool connPlan = CONN_PLAN_ENABLED;
+    uint32_t supervisionMs = CONN_PLAN_TIMEOUT * 10;
+
+    // Drive frame rate (TxRateController policy) and LegoHub pacing
+    uint16_t minRateHz = LEGO_AIMD_MIN_RATE_HZ;
+    uint16_t maxRateHz = LEGO_AIMD_MAX_RATE_HZ;
+    uint16_t startRateHz = LEGO_AIMD_START_RATE_HZ;
+    uint32_t latencyLimitUs = LEGO_AIMD_LATENCY_LIMIT_US;
+    uint32_t txMinIntervalMs = LEGO_TX_MIN_INTERVAL_MS;
+    bool txAlign = LEGO_TX_ALIGN_ENABLED;
+    uint32_t alignLeadUs = LEGO_TX_ALIGN_LEAD_US;
+
+    // Standby scan while active, and reconnecting from the advert cache
+    bool standbyScan = BLE_STANDBY_SCAN_ENABLED;
+    bool reconnectCache = true;
+
+    // Mapping
+    uint8_t deadzonePercent = DEFAULT_DEADZONE_PERCENT;
+    uint8_t maxSpeedPercent = DEFAULT_MAX_SPEED_PERCENT;
+
+    // Peer and host behavior
+    uint32_t hubNotifyMs = 100;
+    uint32_t hubFailsafeMs = 500;
+    uint32_t hostDelayUs = 300;     // Controller -> host, per received packet
+    uint32_t stackUs = 200;         // Write -> packet ready in the controller
+    uint8_t stackDepth = 4;         // Frames the stack buffers
+};
+
+// key=value; returns false for an unknown key or a bad value
+bool simConfigSet(SimConfig& config, const std::string& key, const std::string& value);
+
+// Settings that only make sense together (min_rate <= max_rate)
+bool simConfigValid(const SimConfig& config);
+std::string simConfigDescribe(const SimConfig& config);
+
+// ============================================================================
+// Peers and Impairments
+// ============================================================================
+
+enum class SimPeer : uint8_t {
+    XBOX = 0,
+    LEGO,
+    COUNT
+};
+
+#define SIM_PEER_COUNT ((int)SimPeer::COUNT)
+
+const char* simPeerName(SimPeer peer);
+
+struct SimImpairment {
+    uint8_t lossPercent = 0;    // Per connection event
+    uint32_t latencyUs = 0;     // Added to every delivery
+    uint32_t jitterUs = 0;      // Random 0..jitter on top
+};
+
+// Named profiles: clean, lossy, congested, bad
+bool simProfile(const std::string& name, SimImpairment& impairment);
+
+enum class SimState : uint8_t {
+    SCANNING = 0,
+    CONNECTED,
+    ACTIVE,
+    COUNT
+};
+
+const char* simStateName(SimState state);
+
+// ============================================================================
+// Results
+// ============================================================================
+
+struct SimStats {
+    bool everActive;
+    uint32_t firstActiveMs;
+    uint32_t activeMs;                          // Total time in ACTIVE
+
+    uint32_t connects[SIM_PEER_COUNT];
+    uint32_t connectFailures[SIM_PEER_COUNT];
+    uint32_t rescans[SIM_PEER_COUNT];           // Retries used up, peer left to the scan
+    uint32_t backoffMinMs[SIM_PEER_COUNT];      // Retry delays ConnectRetry chose
+    uint32_t backoffMaxMs[SIM_PEER_COUNT];      // (both 0 = no retry yet)
+    uint32_t disconnects[SIM_PEER_COUNT];       // Link lost (either side)
+    uint32_t skippedEvents[SIM_PEER_COUNT];     // Lost to the other link
+    uint32_t scanSkips;                         // Lost to a standby scan window
+
+    uint32_t framesSubmitted;                   // To the scheduler
+    uint32_t framesWritten;                     // To the stack
+    uint32_t framesDelivered;                   // At the hub
+    uint32_t retransmissions;
+    uint32_t slowWrites;                        // Stack buffer was full
+
+    // Drive frame rate (TxRateController)
+    uint16_t rateHz;                            // Now
+    uint16_t rateMinHz;                         // Lowest and highest so far
+    uint16_t rateMaxHz;
+    uint32_t rateCuts;                          // Failure and latency cuts
+    uint32_t rateIncreases;
+
+    uint32_t failsafes;
+    uint32_t replans;
+    uint64_t airtimeUs;                         // Both links
+
+    std::vector<uint32_t> latencyUs;            // Input change -> hub
+    std::vector<uint32_t> stopLatencyUs;        // Stop input -> first stop frame at the hub
+};
+
+// Percentile (0-100) of a sample set, 0 when empty
+uint32_t simPercentile(const std::vector<uint32_t>& samples, uint8_t percent);
+
+// ============================================================================
+// Simulator
+// ============================================================================
+
+class BridgeSim {
+public:
+    BridgeSim(const SimConfig& config);
+
+    // Peers (both start absent)
+    void appear(SimPeer peer, int8_t rssi, uint32_t advIntervalMs);
+    void vanish(SimPeer peer);          // Out of range: links time out
+    void setRssi(SimPeer peer, int8_t rssi);
+    void disconnect(SimPeer peer);      // Peer ends the link, keeps advertising
+    void refuse(SimPeer peer, uint32_t attempts);  // Next connects fail in setup
+    void setImpairment(SimPeer peer, const SimImpairment& impairment);
+    void setCrowd(uint16_t advertisers);
+
+    // Controller input: speed and steering -100..100, reached over rampUs
+    void setDrive(int8_t speed, int8_t steering, uint32_t rampUs);
+    void setButtons(uint16_t buttons);  // XboxPackedState bit layout
+
+    // Advance virtual time
+    void runUntil(uint64_t timeUs);
+    uint64_t getTimeUs() const;
+
+    SimState getState() const;
+    bool isConnected(SimPeer peer) const;
+    int8_t getHubSpeed() const;         // Last frame the hub received
+    const SimStats& getStats() const;
+    const SimConfig& getConfig() const;
+
+private:
+    struct Packet {
+        MappedControls controls;
+        uint64_t stampUs;               // Input the frame was mapped from
+        uint64_t readyUs;               // In the controller from then on
+        bool stop;
+    };
+
+    struct Link {
+        bool up;
+        uint32_t intervalUs;
+        uint64_t nextEventUs;
+        uint64_t lastGoodUs;
+        bool skippedLast;
+        uint32_t pendingIntervalUs;     // Parameter update, applied at updateAtUs
+        uint64_t updateAtUs;
+    };
+
+    struct Peer {
+        bool present;
+        int8_t rssi;
+        uint32_t advIntervalUs;
+        uint64_t nextAdvUs;
+        SimImpairment impairment;
+        uint32_t refusals;              // Connects still to fail in setup
+
+        // Bridge view
+        bool found;
+        uint64_t cachedAdvUs;           // Advert cache entry (0 = none)
+        uint64_t releasedUs;            // Bridge ended a working link (0 = no)
+        bool everConnected;
+        Link link;
+    };
+
+    SimConfig config;
+    uint64_t nowUs;
+    uint64_t rng;
+    SimStats stats;
+
+    Peer peers[SIM_PEER_COUNT];
+    uint16_t crowd;
+
+    // Bridge
+    SimState state;
+    bool scanning;
+    bool scanPending;                   // startScan() once not blocked
+    uint64_t scanEndUs;
+    uint64_t blockedUntilUs;            // delay() in the firmware loop
+    int connecting;                     // Peer being brought up, -1 = none
+    uint64_t connectDoneUs;
+    bool connectWillSucceed;
+    ConnectRetry retry[SIM_PEER_COUNT];
+
+    ControlMapper mapper;
+    LegoTxScheduler scheduler;
+    TxRateController rateController;
+    ConnEventTracker tracker[SIM_PEER_COUNT];
+    ConnPlanner planner;
+    uint64_t lastControlUs;
+    uint64_t lastTxUs;
+    uint64_t lastPlanCheckUs;
+    uint64_t activeSinceUs;
+    uint64_t slotStampUs[LEGO_TX_CLASS_COUNT];
+    MappedControls slotControls[LEGO_TX_CLASS_COUNT];
+    std::deque<Packet> stackQueue;
+
+    // Controller input, and what the bridge has received of it
+    XboxPackedState input;
+    uint64_t inputStampUs;
+    int16_t rampFrom[2];
+    int16_t rampTo[2];
+    uint64_t rampStartUs;
+    uint32_t rampUs;
+    struct Report {
+        XboxPackedState state;
+        uint64_t stampUs;
+        uint64_t arriveUs;
+    };
+    std::deque<Report> reportsInFlight;
+    XboxPackedState hostInput;
+    uint64_t hostStampUs;
+
+    // Hub
+    std::deque<std::pair<uint64_t, Packet> > hubInFlight;
+    std::deque<uint64_t> hubObservations;   // Host sees a hub event
+    uint64_t hubNextNotifyUs;
+    uint64_t hubLastRxUs;
+    bool hubWatchdogArmed;
+    uint64_t hubDeliveredStampUs;
+    uint64_t stopPressUs;               // B + X pressed, no stop at the hub yet (0 = none)
+    int8_t hubSpeed;
+
+    uint32_t random();
+    bool chance(uint32_t perMillion);
+    uint32_t lossPerMillion(SimPeer peer) const;
+    uint32_t deliveryDelayUs(SimPeer peer);
+
+    void step();
+    void updateInput();
+    void updateDiscovery();
+    void updateBringUp();
+    void updateBridge();
+    void updateControl();
+    void service();
+    void noteRate();
+    void updateConnPlan();
+    void processEvents(uint64_t endUs);
+    void runEvent(SimPeer peer);
+    void hubReceive(const Packet& packet, uint64_t atUs);
+    void checkSupervision();
+
+    void startScan();
+    bool isSeedable(const Peer& peer) const;
+    bool inStandbyWindow(uint64_t timeUs) const;
+    void connectLink(SimPeer peer);
+    void dropLink(SimPeer peer);
+    void teardown(SimPeer lost);
+};
+
+#endif // BRIDGE_SIM_H
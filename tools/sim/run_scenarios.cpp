@@ -0,0 +1,138 @@
+/**
+ * Run Scenarios - Execute scenario files against the bridge simulator
+ *
+ * Host tool (C++11), built from the firmware's pure modules:
+ *
+ *     g++ -std=c++11 -O2 -Iinclude -o run_scenarios \
+ *         tools/sim/run_scenarios.cpp tools/sim/scenario.cpp tools/sim/bridge_sim.cpp \
+ *         src/connect_retry.cpp src/tx_rate_controller.cpp src/lego_tx_scheduler.cpp \
+ *         src/control_mapper.cpp src/stick_drift.cpp src/xbox_report.cpp \
+ *         src/conn_event_tracker.cpp src/conn_planner.cpp
+ *     (cd tools/sim/scenarios && ../../../run_scenarios *.scn)
+ *
+ * Options (before the files):
+ *
+ *     -v           print actions and state changes as they happen
+ *     -s <seed>    run with this seed instead of each scenario's own
+ *     key=value    override a simulator setting (see simConfigSet())
+ *
+ * Each expectation prints PASS or FAIL with the value it saw, followed by
+ * a summary of the run. The exit status is 0 when every expectation
+ * passed, 1 when one failed and 2 when a file could not be loaded. See
+ * scenario.h for the file format.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "scenario.h"
+
+static void printSummary(const ScenarioResult& result) {
+    const SimStats& stats = result.stats;
+
+    printf("  ----\n");
+    if (stats.everActive) {
+        printf("  active at %.3fs, %.1fs of %.1fs\n",
+               stats.firstActiveMs / 1000.0, stats.activeMs / 1000.0, result.durationUs / 1e6);
+    } else {
+        printf("  never active in %.1fs\n", result.durationUs / 1e6);
+    }
+    printf("  latency   p50 %.1f  p95 %.1f  p99 %.1f  max %.1f ms (%u samples)\n",
+           simPercentile(stats.latencyUs, 50) / 1000.0, simPercentile(stats.latencyUs, 95) / 1000.0,
+           simPercentile(stats.latencyUs, 99) / 1000.0, simPercentile(stats.latencyUs, 100) / 1000.0,
+           (unsigned)stats.latencyUs.size());
+    if (!stats.stopLatencyUs.empty()) {
+        printf("  stops     p50 %.1f  p95 %.1f  p99 %.1f  max %.1f ms (%u samples)\n",
+               simPercentile(stats.stopLatencyUs, 50) / 1000.0, simPercentile(stats.stopLatencyUs, 95) / 1000.0,
+               simPercentile(stats.stopLatencyUs, 99) / 1000.0, simPercentile(stats.stopLatencyUs, 100) / 1000.0,
+               (unsigned)stats.stopLatencyUs.size());
+    }
+    printf("  frames    %u submitted, %u written, %u at the hub, %u retransmitted, %u slow writes\n",
+           stats.framesSubmitted, stats.framesWritten, stats.framesDelivered,
+           stats.retransmissions, stats.slowWrites);
+    for (int i = 0; i < SIM_PEER_COUNT; i++) {
+        printf("  %-9s %u connects, %u failures, %u disconnects, %u skipped events\n",
+               simPeerName((SimPeer)i), stats.connects[i], stats.connectFailures[i],
+               stats.disconnects[i], stats.skippedEvents[i]);
+        if (stats.backoffMaxMs[i] != 0) {
+            printf("  %-9s backoff %u-%u ms, %u rescans\n", "", stats.backoffMinMs[i],
+                   stats.backoffMaxMs[i], stats.rescans[i]);
+        }
+    }
+    printf("  rate      %u Hz (%u-%u), %u cuts, %u increases\n", stats.rateHz, stats.rateMinHz,
+           stats.rateMaxHz, stats.rateCuts, stats.rateIncreases);
+    printf("  failsafes %u, replans %u, scan skips %u, airtime %.2f%%\n",
+           stats.failsafes, stats.replans, stats.scanSkips, stats.airtimeUs * 100.0 / result.durationUs);
+}
+
+int main(int argc, char** argv) {
+    bool verbose = false;
+    bool seedSet = false;
+    uint32_t seed = 0;
+    std::vector<std::pair<std::string, std::string> > overrides;
+
+    int arg = 1;
+    for (; arg < argc; arg++) {
+        const char* option = argv[arg];
+        if (strcmp(option, "-v") == 0) {
+            verbose = true;
+        } else if (strcmp(option, "-s") == 0 && arg + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++arg], nullptr, 10);
+            seedSet = true;
+        } else if (strchr(option, '=') != nullptr) {
+            const char* equals = strchr(option, '=');
+            overrides.push_back(std::make_pair(std::string(option, equals - option), std::string(equals + 1)));
+        } else {
+            break;
+        }
+    }
+    if (arg >= argc) {
+        fprintf(stderr, "usage: %s [-v] [-s seed] [key=value...] scenario.scn...\n", argv[0]);
+        return 2;
+    }
+
+    int failed = 0;
+    int total = 0;
+    for (; arg < argc; arg++) {
+        Scenario scenario;
+        std::string error;
+        if (!scenario.load(argv[arg], error)) {
+            fprintf(stderr, "%s\n", error.c_str());
+            return 2;
+        }
+
+        SimConfig config = scenario.getConfig();
+        if (seedSet) {
+            config.seed = seed;
+        }
+        for (size_t i = 0; i < overrides.size(); i++) {
+            if (!simConfigSet(config, overrides[i].first, overrides[i].second)) {
+                fprintf(stderr, "bad setting: %s=%s\n", overrides[i].first.c_str(), overrides[i].second.c_str());
+                return 2;
+            }
+        }
+        if (!simConfigValid(config)) {
+            fprintf(stderr, "bad settings: min_rate above max_rate\n");
+            return 2;
+        }
+
+        printf("%s: %s (seed %u)\n", argv[arg], scenario.getName().c_str(), config.seed);
+        ScenarioResult result = scenario.run(config, verbose);
+        for (size_t i = 0; i < result.lines.size(); i++) {
+            printf("  %s\n", result.lines[i].c_str());
+        }
+        printSummary(result);
+        printf("  %s\n\n", result.passed ? "passed" : "FAILED");
+
+        total++;
+        if (!result.passed) {
+            failed++;
+        }
+    }
+
+    printf("%d of %d scenarios passed\n", total - failed, total);
+    return failed ? 1 : 0;
+}
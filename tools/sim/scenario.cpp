@@ -0,0 +1,666 @@
+/**
+ * Scenario Implementation
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "scenario.h"
+
+#define PEER_MASK_ALL ((1 << SIM_PEER_COUNT) - 1)
+
+static const char* const BUTTON_NAMES[] = {
+    "a", "b", "x", "y", "lb", "rb", "ls", "rs",
+    "view", "menu", "xbox", "share", "up", "down", "left", "right"
+};
+
+// ============================================================================
+// Parsing Helpers
+// ============================================================================
+
+static bool parseNumber(const std::string& text, double& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    value = strtod(text.c_str(), &end);
+    return *end == '\0';
+}
+
+static bool parseInt(const std::string& text, int32_t minValue, int32_t maxValue, int32_t& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    long parsed = strtol(text.c_str(), &end, 10);
+    if (*end != '\0' || parsed < minValue || parsed > maxValue) {
+        return false;
+    }
+    value = (int32_t)parsed;
+    return true;
+}
+
+// 800us, 250ms, 1.5s
+static bool parseTime(const std::string& text, uint64_t& us) {
+    static const struct { const char* suffix; double scale; } UNITS[] = {
+        { "us", 1 }, { "ms", 1000 }, { "s", 1000000 }
+    };
+    for (size_t i = 0; i < sizeof(UNITS) / sizeof(UNITS[0]); i++) {
+        size_t length = strlen(UNITS[i].suffix);
+        if (text.size() <= length || text.compare(text.size() - length, length, UNITS[i].suffix) != 0) {
+            continue;
+        }
+        double value;
+        if (!parseNumber(text.substr(0, text.size() - length), value) || value < 0) {
+            return false;
+        }
+        us = (uint64_t)llround(value * UNITS[i].scale);
+        return true;
+    }
+    return false;
+}
+
+static bool parsePeers(const std::string& text, uint8_t& mask) {
+    if (text == "all") {
+        mask = PEER_MASK_ALL;
+        return true;
+    }
+    for (int i = 0; i < SIM_PEER_COUNT; i++) {
+        if (text == simPeerName((SimPeer)i)) {
+            mask = 1 << i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parseButtons(const std::string& text, int32_t& mask) {
+    mask = 0;
+    if (text == "none") {
+        return true;
+    }
+    std::stringstream list(text);
+    std::string name;
+    while (std::getline(list, name, ',')) {
+        bool known = false;
+        for (int bit = 0; bit < 16; bit++) {
+            if (name == BUTTON_NAMES[bit]) {
+                mask |= 1 << bit;
+                known = true;
+            }
+        }
+        if (!known) {
+            return false;
+        }
+    }
+    return mask != 0;
+}
+
+static bool isTimeMetric(const std::string& metric) {
+    return metric.compare(0, 8, "latency ") == 0 || metric.compare(0, 13, "stop_latency ") == 0
+        || metric == "first_active" || metric == "backoff_min" || metric == "backoff_max";
+}
+
+static bool isPeerMetric(const std::string& metric) {
+    return metric == "connects" || metric == "failures" || metric == "disconnects" || metric == "skipped"
+        || metric == "rescans" || metric == "backoff_min" || metric == "backoff_max";
+}
+
+static bool isMetric(const std::string& metric) {
+    static const char* const NAMES[] = {
+        "latency p50", "latency p90", "latency p95", "latency p99", "latency max",
+        "stop_latency p50", "stop_latency p90", "stop_latency p95", "stop_latency p99",
+        "stop_latency max", "stop_samples", "samples", "first_active", "airtime", "frames",
+        "failsafes", "replans", "retransmissions", "slow_writes", "scan_skips",
+        "rate", "rate_min", "rate_max", "rate_cuts", "rate_increases"
+    };
+    for (size_t i = 0; i < sizeof(NAMES) / sizeof(NAMES[0]); i++) {
+        if (metric == NAMES[i]) {
+            return true;
+        }
+    }
+    return isPeerMetric(metric);
+}
+
+// ============================================================================
+// Scenario Implementation
+// ============================================================================
+
+Scenario::Scenario()
+    : durationUs(30000000)
+{
+}
+
+bool Scenario::load(const std::string& filePath, std::string& error) {
+    path = filePath;
+    name = filePath;
+    statements.clear();
+
+    std::ifstream file(filePath.c_str());
+    if (!file) {
+        error = filePath + ": cannot open";
+        return false;
+    }
+
+    std::string text;
+    int line = 0;
+    while (std::getline(file, text)) {
+        line++;
+        size_t comment = text.find('#');
+        if (comment != std::string::npos) {
+            text.erase(comment);
+        }
+        std::string message;
+        if (!parseLine(text, line, message)) {
+            char prefix[32];
+            snprintf(prefix, sizeof(prefix), ":%d: ", line);
+            error = filePath + prefix + message;
+            return false;
+        }
+    }
+
+    if (!simConfigValid(config)) {
+        error = filePath + ": min_rate above max_rate";
+        return false;
+    }
+    for (size_t i = 0; i < statements.size(); i++) {
+        if (!statements[i].atEnd && statements[i].atUs > durationUs) {
+            char message[64];
+            snprintf(message, sizeof(message), ":%d: after the end of the run", statements[i].line);
+            error = filePath + message;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Scenario::parseLine(const std::string& text, int line, std::string& error) {
+    std::vector<std::string> words;
+    std::stringstream stream(text);
+    std::string word;
+    while (stream >> word) {
+        words.push_back(word);
+    }
+    if (words.empty()) {
+        return true;
+    }
+
+    // Run-wide settings
+    if (words[0] == "name") {
+        if (words.size() < 2) {
+            error = "name <text>";
+            return false;
+        }
+        size_t start = text.find("name") + 4;
+        size_t first = text.find_first_not_of(" \t", start);
+        size_t last = text.find_last_not_of(" \t\r");
+        name = text.substr(first, last - first + 1);
+        return true;
+    }
+    if (words[0] == "seed" || words[0] == "set") {
+        std::string key = words[0] == "seed" ? "seed" : (words.size() > 1 ? words[1] : "");
+        size_t valueIndex = words[0] == "seed" ? 1 : 2;
+        if (words.size() != valueIndex + 1 || !simConfigSet(config, key, words[valueIndex])) {
+            error = "bad setting";
+            return false;
+        }
+        return true;
+    }
+    if (words[0] == "duration") {
+        if (words.size() != 2 || !parseTime(words[1], durationUs) || durationUs < SIM_LOOP_US) {
+            error = "bad duration";
+            return false;
+        }
+        return true;
+    }
+
+    Statement st;
+    st.line = line;
+    st.atEnd = false;
+    st.atUs = 0;
+    st.peerMask = 0;
+    memset(st.values, 0, sizeof(st.values));
+    st.rampUs = 0;
+    st.check = Check::METRIC;
+    st.state = SimState::SCANNING;
+    st.compare = Compare::EQ;
+    st.threshold = 0;
+    st.withinUs = 0;
+
+    size_t w = 0;
+    bool timed = false;
+    if (words[0] == "at") {
+        if (words.size() < 3 || !parseTime(words[1], st.atUs)) {
+            error = "bad time";
+            return false;
+        }
+        timed = true;
+        w = 2;
+    }
+
+    // Canonical text for reports
+    for (size_t i = 0; i < words.size(); i++) {
+        st.text += (i ? " " : "") + words[i];
+    }
+
+    const std::string& command = words[w++];
+    size_t left = words.size() - w;
+
+    if (command == "appear") {
+        st.op = Op::APPEAR;
+        st.values[0] = -60;
+        st.values[1] = 100;
+        if (left < 1 || !parsePeers(words[w++], st.peerMask)) {
+            error = "appear <peer> [rssi <dBm>] [adv <time>]";
+            return false;
+        }
+        while (w + 1 < words.size()) {
+            uint64_t advUs;
+            if (words[w] == "rssi" && parseInt(words[w + 1], -127, 20, st.values[0])) {
+                w += 2;
+            } else if (words[w] == "adv" && parseTime(words[w + 1], advUs) && advUs >= 20000) {
+                st.values[1] = (int32_t)(advUs / 1000);
+                w += 2;
+            } else {
+                break;
+            }
+        }
+        if (w != words.size()) {
+            error = "appear <peer> [rssi <dBm>] [adv <time>] (adv >= 20ms)";
+            return false;
+        }
+    } else if (command == "vanish" || command == "disconnect") {
+        st.op = command == "vanish" ? Op::VANISH : Op::DISCONNECT;
+        if (left != 1 || !parsePeers(words[w], st.peerMask)) {
+            error = command + " <peer>";
+            return false;
+        }
+    } else if (command == "refuse") {
+        st.op = Op::REFUSE;
+        if (left != 2 || !parsePeers(words[w], st.peerMask) || !parseInt(words[w + 1], 0, 1000, st.values[0])) {
+            error = "refuse <peer> <attempts>";
+            return false;
+        }
+    } else if (command == "rssi") {
+        st.op = Op::RSSI;
+        if (left != 2 || !parsePeers(words[w], st.peerMask) || !parseInt(words[w + 1], -127, 20, st.values[0])) {
+            error = "rssi <peer> <dBm>";
+            return false;
+        }
+    } else if (command == "impair") {
+        st.op = Op::IMPAIR;
+        if (left < 1 || !parsePeers(words[w++], st.peerMask)) {
+            error = "impair <peer> [loss <percent>] [latency <time>] [jitter <time>]";
+            return false;
+        }
+        while (w + 1 < words.size()) {
+            int32_t loss;
+            uint64_t us;
+            std::string value = words[w + 1];
+            if (!value.empty() && value[value.size() - 1] == '%') {
+                value.erase(value.size() - 1);
+            }
+            if (words[w] == "loss" && parseInt(value, 0, 100, loss)) {
+                st.impairment.lossPercent = loss;
+            } else if (words[w] == "latency" && parseTime(words[w + 1], us) && us <= 1000000) {
+                st.impairment.latencyUs = (uint32_t)us;
+            } else if (words[w] == "jitter" && parseTime(words[w + 1], us) && us <= 1000000) {
+                st.impairment.jitterUs = (uint32_t)us;
+            } else {
+                break;
+            }
+            w += 2;
+        }
+        if (w != words.size()) {
+            error = "impair <peer> [loss <percent>] [latency <time>] [jitter <time>]";
+            return false;
+        }
+    } else if (command == "profile") {
+        st.op = Op::IMPAIR;
+        if (left != 2 || !parsePeers(words[w], st.peerMask) || !simProfile(words[w + 1], st.impairment)) {
+            error = "profile <peer> clean|lossy|congested|bad";
+            return false;
+        }
+    } else if (command == "crowd") {
+        st.op = Op::CROWD;
+        if (left != 1 || !parseInt(words[w], 0, 10000, st.values[0])) {
+            error = "crowd <advertisers>";
+            return false;
+        }
+    } else if (command == "drive") {
+        st.op = Op::DRIVE;
+        uint64_t rampUs = 0;
+        bool ok = (left == 2 || (left == 4 && words[w + 2] == "ramp" && parseTime(words[w + 3], rampUs)))
+               && parseInt(words[w], -100, 100, st.values[0])
+               && parseInt(words[w + 1], -100, 100, st.values[1])
+               && rampUs <= 60000000;
+        if (!ok) {
+            error = "drive <speed> <steering> [ramp <time>]";
+            return false;
+        }
+        st.rampUs = (uint32_t)rampUs;
+    } else if (command == "buttons") {
+        st.op = Op::BUTTONS;
+        if (left != 1 || !parseButtons(words[w], st.values[0])) {
+            error = "buttons <name,name...>|none";
+            return false;
+        }
+    } else if (command == "expect") {
+        st.op = Op::EXPECT;
+        st.atEnd = !timed;
+
+        // Optional trailing window
+        size_t end = words.size();
+        if (end >= w + 2 && words[end - 2] == "within") {
+            if (!timed || !parseTime(words[end - 1], st.withinUs)) {
+                error = "within needs an 'at' time and a duration";
+                return false;
+            }
+            end -= 2;
+        }
+
+        if (w < end && words[w] == "state") {
+            st.check = Check::STATE;
+            bool known = false;
+            for (int i = 0; i < (int)SimState::COUNT && end == w + 2; i++) {
+                if (words[w + 1] == simStateName((SimState)i)) {
+                    st.state = (SimState)i;
+                    known = true;
+                }
+            }
+            if (!known) {
+                error = "expect state scanning|connected|active";
+                return false;
+            }
+            st.compare = Compare::EQ;
+        } else {
+            // [speed|metric] [peer] <op> <value>
+            if (w < end && words[w] == "speed") {
+                st.check = Check::SPEED;
+                st.metric = "speed";
+                w++;
+            } else if (w < end && (words[w] == "latency" || words[w] == "stop_latency") && w + 1 < end) {
+                st.metric = words[w] + " " + words[w + 1];
+                w += 2;
+            } else if (w < end) {
+                st.metric = words[w++];
+            }
+            if (st.check == Check::METRIC && !isMetric(st.metric)) {
+                error = "unknown metric '" + st.metric + "'";
+                return false;
+            }
+            if (isPeerMetric(st.metric)) {
+                if (w >= end || !parsePeers(words[w], st.peerMask) || st.peerMask == PEER_MASK_ALL) {
+                    error = st.metric + " needs a peer (xbox or lego)";
+                    return false;
+                }
+                w++;
+            }
+            if (end != w + 2) {
+                error = "expect " + st.metric + " <op> <value>";
+                return false;
+            }
+
+            static const char* const OPS[] = { "<", "<=", ">", ">=", "==", "!=" };
+            bool known = false;
+            for (int i = 0; i < 6; i++) {
+                if (words[w] == OPS[i]) {
+                    st.compare = (Compare)i;
+                    known = true;
+                }
+            }
+            std::string value = words[w + 1];
+            if (st.metric == "airtime" && !value.empty() && value[value.size() - 1] == '%') {
+                value.erase(value.size() - 1);
+            }
+            bool parsed;
+            if (isTimeMetric(st.metric)) {
+                uint64_t us = 0;
+                parsed = parseTime(value, us);
+                st.threshold = (double)us;
+            } else {
+                parsed = parseNumber(value, st.threshold);
+            }
+            if (!known || !parsed) {
+                error = "bad comparison (use < <= > >= == != and a value"
+                        + std::string(isTimeMetric(st.metric) ? " with a time unit)" : ")");
+                return false;
+            }
+        }
+    } else {
+        error = "unknown statement '" + command + "'";
+        return false;
+    }
+
+    statements.push_back(st);
+    return true;
+}
+
+const std::string& Scenario::getName() const {
+    return name;
+}
+
+uint64_t Scenario::getDurationUs() const {
+    return durationUs;
+}
+
+SimConfig Scenario::getConfig() const {
+    return config;
+}
+
+// ============================================================================
+// Execution
+// ============================================================================
+
+void Scenario::apply(BridgeSim& sim, const Statement& st) {
+    for (int i = 0; i < SIM_PEER_COUNT; i++) {
+        if (!(st.peerMask & (1 << i))) {
+            continue;
+        }
+        SimPeer peer = (SimPeer)i;
+        switch (st.op) {
+            case Op::APPEAR:     sim.appear(peer, st.values[0], st.values[1]); break;
+            case Op::VANISH:     sim.vanish(peer); break;
+            case Op::RSSI:       sim.setRssi(peer, st.values[0]); break;
+            case Op::DISCONNECT: sim.disconnect(peer); break;
+            case Op::REFUSE:     sim.refuse(peer, st.values[0]); break;
+            case Op::IMPAIR:     sim.setImpairment(peer, st.impairment); break;
+            default:             break;
+        }
+    }
+
+    switch (st.op) {
+        case Op::CROWD:   sim.setCrowd(st.values[0]); break;
+        case Op::DRIVE:   sim.setDrive(st.values[0], st.values[1], st.rampUs); break;
+        case Op::BUTTONS: sim.setButtons((uint16_t)st.values[0]); break;
+        default:          break;
+    }
+}
+
+bool Scenario::evaluate(const BridgeSim& sim, const Statement& st, double& value) {
+    const SimStats& stats = sim.getStats();
+    int peer = 0;
+    while (st.peerMask && !(st.peerMask & (1 << peer))) {
+        peer++;
+    }
+
+    if (st.check == Check::STATE) {
+        value = (double)sim.getState();
+        return sim.getState() == st.state;
+    }
+
+    if (st.check == Check::SPEED) {
+        value = sim.getHubSpeed();
+    } else if (st.metric.compare(0, 8, "latency ") == 0) {
+        std::string which = st.metric.substr(8);
+        uint8_t percent = which == "max" ? 100 : (uint8_t)atoi(which.c_str() + 1);
+        value = stats.latencyUs.empty() ? INFINITY : simPercentile(stats.latencyUs, percent);
+    } else if (st.metric.compare(0, 13, "stop_latency ") == 0) {
+        std::string which = st.metric.substr(13);
+        uint8_t percent = which == "max" ? 100 : (uint8_t)atoi(which.c_str() + 1);
+        value = stats.stopLatencyUs.empty() ? INFINITY : simPercentile(stats.stopLatencyUs, percent);
+    } else if (st.metric == "samples") {
+        value = stats.latencyUs.size();
+    } else if (st.metric == "stop_samples") {
+        value = stats.stopLatencyUs.size();
+    } else if (st.metric == "first_active") {
+        value = stats.everActive ? stats.firstActiveMs * 1000.0 : INFINITY;
+    } else if (st.metric == "airtime") {
+        value = sim.getTimeUs() ? stats.airtimeUs * 100.0 / sim.getTimeUs() : 0;
+    } else if (st.metric == "frames") {
+        value = stats.framesDelivered;
+    } else if (st.metric == "failsafes") {
+        value = stats.failsafes;
+    } else if (st.metric == "replans") {
+        value = stats.replans;
+    } else if (st.metric == "retransmissions") {
+        value = stats.retransmissions;
+    } else if (st.metric == "scan_skips") {
+        value = stats.scanSkips;
+    } else if (st.metric == "slow_writes") {
+        value = stats.slowWrites;
+    } else if (st.metric == "rate") {
+        value = stats.rateHz;
+    } else if (st.metric == "rate_min") {
+        value = stats.rateMinHz;
+    } else if (st.metric == "rate_max") {
+        value = stats.rateMaxHz;
+    } else if (st.metric == "rate_cuts") {
+        value = stats.rateCuts;
+    } else if (st.metric == "rate_increases") {
+        value = stats.rateIncreases;
+    } else if (st.metric == "connects") {
+        value = stats.connects[peer];
+    } else if (st.metric == "failures") {
+        value = stats.connectFailures[peer];
+    } else if (st.metric == "disconnects") {
+        value = stats.disconnects[peer];
+    } else if (st.metric == "skipped") {
+        value = stats.skippedEvents[peer];
+    } else if (st.metric == "rescans") {
+        value = stats.rescans[peer];
+    } else if (st.metric == "backoff_min" || st.metric == "backoff_max") {
+        uint32_t ms = st.metric == "backoff_min" ? stats.backoffMinMs[peer] : stats.backoffMaxMs[peer];
+        value = stats.backoffMaxMs[peer] ? ms * 1000.0 : INFINITY;
+    } else {
+        value = NAN;
+        return false;
+    }
+
+    switch (st.compare) {
+        case Compare::LT: return value < st.threshold;
+        case Compare::LE: return value <= st.threshold;
+        case Compare::GT: return value > st.threshold;
+        case Compare::GE: return value >= st.threshold;
+        case Compare::EQ: return value == st.threshold;
+        case Compare::NE: return value != st.threshold;
+        default:          return false;
+    }
+}
+
+std::string Scenario::format(const Statement& st, double value) {
+    char got[48];
+    if (st.check == Check::STATE) {
+        snprintf(got, sizeof(got), "%s", simStateName((SimState)(int)value));
+    } else if (isinf(value)) {
+        snprintf(got, sizeof(got), "none");
+    } else if (isTimeMetric(st.metric)) {
+        snprintf(got, sizeof(got), "%.1fms", value / 1000);
+    } else if (st.metric == "airtime") {
+        snprintf(got, sizeof(got), "%.2f%%", value);
+    } else {
+        snprintf(got, sizeof(got), "%.0f", value);
+    }
+
+    char text[512];
+    snprintf(text, sizeof(text), "line %d: %s (got %s)", st.line, st.text.c_str(), got);
+    return text;
+}
+
+ScenarioResult Scenario::run(const SimConfig& runConfig, bool verbose) const {
+    BridgeSim sim(runConfig);
+    ScenarioResult result;
+    result.passed = true;
+    result.durationUs = durationUs;
+
+    // Actions in time order (file order within the same time)
+    std::vector<const Statement*> actions;
+    std::vector<const Statement*> watches;
+    std::vector<const Statement*> endChecks;
+    for (size_t i = 0; i < statements.size(); i++) {
+        const Statement& st = statements[i];
+        if (st.op != Op::EXPECT) {
+            actions.push_back(&st);
+        } else if (st.atEnd) {
+            endChecks.push_back(&st);
+        } else {
+            watches.push_back(&st);
+        }
+    }
+    std::stable_sort(actions.begin(), actions.end(),
+                     [](const Statement* a, const Statement* b) { return a->atUs < b->atUs; });
+    std::vector<bool> settled(watches.size(), false);
+    std::vector<std::pair<int, std::string> > lines;
+
+    size_t next = 0;
+    SimState lastState = sim.getState();
+    for (uint64_t t = 0; ; t += SIM_LOOP_US) {
+        while (next < actions.size() && actions[next]->atUs <= t) {
+            if (verbose) {
+                printf("  %9.3fs  line %d: %s\n", t / 1e6, actions[next]->line, actions[next]->text.c_str());
+            }
+            apply(sim, *actions[next++]);
+        }
+
+        bool last = t >= durationUs;
+        for (size_t i = 0; i < watches.size(); i++) {
+            const Statement& st = *watches[i];
+            if (settled[i] || st.atUs > t) {
+                continue;
+            }
+            double value;
+            if (evaluate(sim, st, value)) {
+                char when[32];
+                snprintf(when, sizeof(when), " at %.3fs", t / 1e6);
+                lines.push_back(std::make_pair(st.line, "PASS  " + format(st, value) + when));
+                settled[i] = true;
+            } else if (t >= st.atUs + st.withinUs || last) {
+                lines.push_back(std::make_pair(st.line, "FAIL  " + format(st, value)));
+                result.passed = false;
+                settled[i] = true;
+            }
+        }
+        if (last) {
+            break;
+        }
+
+        sim.runUntil(t + SIM_LOOP_US);
+        if (verbose && sim.getState() != lastState) {
+            printf("  %9.3fs  state %s -> %s\n", sim.getTimeUs() / 1e6,
+                   simStateName(lastState), simStateName(sim.getState()));
+        }
+        lastState = sim.getState();
+    }
+
+    for (size_t i = 0; i < endChecks.size(); i++) {
+        const Statement& st = *endChecks[i];
+        double value;
+        bool ok = evaluate(sim, st, value);
+        lines.push_back(std::make_pair(st.line, (ok ? "PASS  " : "FAIL  ") + format(st, value)));
+        result.passed = result.passed && ok;
+    }
+
+    std::stable_sort(lines.begin(), lines.end(),
+                     [](const std::pair<int, std::string>& a, const std::pair<int, std::string>& b) {
+                         return a.first < b.first;
+                     });
+    for (size_t i = 0; i < lines.size(); i++) {
+        result.lines.push_back(lines[i].second);
+    }
+    result.stats = sim.getStats();
+    return result;
+}
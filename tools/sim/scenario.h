@@ -0,0 +1,152 @@
+/**
+ * Scenario - Scripted runs of the bridge simulator
+ *
+ * Host only (C++11). A scenario is a text file, one statement per line,
+ * # starts a comment. Times take a unit: 800us, 250ms, 1.5s.
+ *
+ *     name Xbox drops out while driving
+ *     seed 7
+ *     duration 30s
+ *     set lego_interval 12              # Any simConfigSet() key
+ *
+ *     appear xbox rssi -60 adv 50ms     # Peer starts advertising
+ *     appear lego
+ *     at 3s  expect state active within 5s
+ *     at 4s  drive 100 0 ramp 500ms     # Speed, steering (-100..100)
+ *     at 10s disconnect xbox
+ *     at 10s expect speed == 0 within 200ms
+ *     expect latency p95 < 60ms         # No 'at': checked at the end
+ *
+ * Statements without 'at' run at 0 s, except expectations, which are
+ * checked at the end of the run. Peers are xbox, lego, or all:
+ *
+ *     appear <peer> [rssi <dBm>] [adv <time>]
+ *     vanish <peer>                     # Out of range, links time out
+ *     rssi <peer> <dBm>
+ *     disconnect <peer>                 # Peer ends the link, advertises again
+ *     refuse <peer> <attempts>          # Next connects fail in setup
+ *     impair <peer> [loss <percent>] [latency <time>] [jitter <time>]
+ *     profile <peer> clean|lossy|congested|bad
+ *     crowd <advertisers>               # Other BLE devices around
+ *     drive <speed> <steering> [ramp <time>]
+ *     buttons a,b,x,y,lb,rb,ls,rs,view,menu,xbox,share,up,down,left,right|none
+ *
+ * impair and profile replace the peer's whole impairment (unset = none).
+ *
+ *     expect state scanning|connected|active
+ *     expect speed <op> <value>         # Last frame the hub received
+ *     expect <metric> [<peer>] <op> <value>
+ *     ... [within <time>]               # Passes once true in the window
+ *
+ * Operators: < <= > >= == !=. Metrics (peer-specific ones need the peer):
+ *
+ *     latency p50|p90|p95|p99|max  <time>     input change -> hub
+ *     samples                      count      latency samples
+ *     stop_latency p50|...|max     <time>     stop input -> first stop frame at the hub
+ *     stop_samples                 count      stop latency samples
+ *     first_active                 <time>
+ *     airtime                      percent    both links, of elapsed time
+ *     frames                       count      delivered to the hub
+ *     failsafes, replans, retransmissions, slow_writes
+ *     scan_skips                   count      events lost to standby scans
+ *     rate                         Hz         drive frame rate now
+ *     rate_min, rate_max           Hz         lowest and highest so far
+ *     rate_cuts, rate_increases    count      AIMD decisions
+ *     connects|failures|disconnects|skipped <peer>
+ *     rescans <peer>               count      retries used up, peer left to the scan
+ *     backoff_min|backoff_max <peer> <time>   retry delays chosen
+ */
+
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "bridge_sim.h"
+
+struct ScenarioResult {
+    bool passed;
+    std::vector<std::string> lines;     // One per expectation, PASS/FAIL first
+    SimStats stats;
+    uint64_t durationUs;
+};
+
+class Scenario {
+public:
+    Scenario();
+
+    // Returns false with a "file:line: message" error
+    bool load(const std::string& path, std::string& error);
+
+    const std::string& getName() const;
+    uint64_t getDurationUs() const;
+
+    // The scenario's own seed and settings on top of the defaults
+    SimConfig getConfig() const;
+
+    // Run against any configuration (e.g. a parameter sweep's)
+    ScenarioResult run(const SimConfig& config, bool verbose) const;
+
+private:
+    enum class Op : uint8_t {
+        APPEAR = 0,
+        VANISH,
+        RSSI,
+        DISCONNECT,
+        REFUSE,
+        IMPAIR,
+        CROWD,
+        DRIVE,
+        BUTTONS,
+        EXPECT
+    };
+
+    enum class Check : uint8_t {
+        STATE = 0,
+        SPEED,
+        METRIC
+    };
+
+    enum class Compare : uint8_t {
+        LT = 0,
+        LE,
+        GT,
+        GE,
+        EQ,
+        NE
+    };
+
+    struct Statement {
+        int line;
+        std::string text;
+        Op op;
+        bool atEnd;
+        uint64_t atUs;
+        uint8_t peerMask;           // Bit per SimPeer
+
+        int32_t values[3];          // rssi/adv, speed/steering, crowd, buttons
+        uint32_t rampUs;
+        SimImpairment impairment;
+
+        Check check;
+        SimState state;
+        std::string metric;
+        Compare compare;
+        double threshold;
+        uint64_t withinUs;
+    };
+
+    std::string name;
+    std::string path;
+    uint64_t durationUs;
+    SimConfig config;
+    std::vector<Statement> statements;
+
+    bool parseLine(const std::string& text, int line, std::string& error);
+    static void apply(BridgeSim& sim, const Statement& statement);
+    static bool evaluate(const BridgeSim& sim, const Statement& statement, double& value);
+    static std::string format(const Statement& statement, double value);
+};
+
+#endif // SCENARIO_H
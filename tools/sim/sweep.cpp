@@ -0,0 +1,480 @@
+/**
+ * Sweep - Monte Carlo parameter sweep over simulated sessions
+ *
+ * Host tool (C++11), built on the bridge simulator:
+ *
+ *     g++ -std=c++11 -O2 -pthread -Iinclude -o sweep \
+ *         tools/sim/sweep.cpp tools/sim/scenario.cpp tools/sim/bridge_sim.cpp \
+ *         src/connect_retry.cpp src/tx_rate_controller.cpp src/lego_tx_scheduler.cpp \
+ *         src/control_mapper.cpp src/stick_drift.cpp src/xbox_report.cpp \
+ *         src/conn_event_tracker.cpp src/conn_planner.cpp
+ *     ./sweep -r 16 tools/sim/scenarios/session.scn \
+ *         conn_plan=0 lego_interval=12,24,36 max_rate=20:50:10 tx_align=0,1
+ *
+ * Each axis is a simConfigSet() key with a list of values (a,b,c) or a
+ * range (lo:hi or lo:hi:step). The configurations are the full grid, or
+ * -n random points of it. Every configuration runs the scenario once per
+ * seed, on top of the scenario's own settings. All configurations use the
+ * same seeds, so they are compared on the same sessions. The connection
+ * planner moves both links to CONN_PLANS, so interval axes need conn_plan=0.
+ *
+ * Options (before the scenario):
+ *
+ *     -j <threads>  worker threads (default: all cores)
+ *     -r <runs>     seeds per configuration (default 8)
+ *     -s <seed>     base seed (default 1); runs and samples derive from it
+ *     -n <points>   random configurations instead of the full grid
+ *     -c            CSV instead of the table
+ *
+ * Per configuration: scenario expectations passed, latency percentiles
+ * (input change -> hub) over all runs' samples, mean airtime, failsafe
+ * events and link drops in total. The Pareto front is the set of
+ * configurations that no other beats on p95 latency, airtime and
+ * failsafes at once.
+ *
+ * Runs are spread over a work-stealing pool: each worker starts with a
+ * contiguous share of the runs and steals from the others' far ends once
+ * its own share is done. Each run writes only its own result slot, so the
+ * output for a seed is the same at any thread count.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "scenario.h"
+
+#define DEFAULT_RUNS 8
+
+// ============================================================================
+// Work-Stealing Pool
+// ============================================================================
+
+class WorkStealingPool {
+public:
+    WorkStealingPool(unsigned threads)
+        : workers(threads ? threads : 1)
+        , steals(0)
+    {
+        for (unsigned i = 0; i < workers; i++) {
+            queues.push_back(std::unique_ptr<Queue>(new Queue()));
+        }
+    }
+
+    // Runs work(0..tasks-1) and returns when all are done
+    void run(size_t tasks, const std::function<void(size_t)>& work) {
+        for (unsigned w = 0; w < workers; w++) {
+            size_t first = tasks * w / workers;
+            size_t last = tasks * (w + 1) / workers;
+            for (size_t task = first; task < last; task++) {
+                queues[w]->tasks.push_back(task);
+            }
+        }
+
+        std::vector<std::thread> threads;
+        for (unsigned w = 0; w < workers; w++) {
+            threads.push_back(std::thread([this, w, &work]() {
+                size_t task;
+                while (take(w, task) || steal(w, task)) {
+                    work(task);
+                }
+            }));
+        }
+        for (size_t i = 0; i < threads.size(); i++) {
+            threads[i].join();
+        }
+    }
+
+    unsigned getWorkers() const {
+        return workers;
+    }
+
+    uint64_t getSteals() const {
+        return steals.load();
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    unsigned workers;
+    std::vector<std::unique_ptr<Queue> > queues;
+    std::atomic<uint64_t> steals;
+
+    // Own work from the near end
+    bool take(unsigned self, size_t& task) {
+        Queue& queue = *queues[self];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        task = queue.tasks.front();
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    // Someone else's from the far end (no task adds more, so one empty
+    // pass over all queues means the work is done)
+    bool steal(unsigned self, size_t& task) {
+        for (unsigned i = 1; i < workers; i++) {
+            Queue& queue = *queues[(self + i) % workers];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = queue.tasks.back();
+                queue.tasks.pop_back();
+                steals++;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// ============================================================================
+// Parameter Space
+// ============================================================================
+
+struct Axis {
+    std::string key;
+    std::vector<std::string> values;
+};
+
+static uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// key=a,b,c or key=lo:hi[:step]
+static bool parseAxis(const std::string& text, Axis& axis) {
+    size_t equals = text.find('=');
+    if (equals == std::string::npos || equals == 0) {
+        return false;
+    }
+    axis.key = text.substr(0, equals);
+    std::string spec = text.substr(equals + 1);
+
+    if (spec.find(':') != std::string::npos) {
+        unsigned long lo, hi, step = 1;
+        int fields = sscanf(spec.c_str(), "%lu:%lu:%lu", &lo, &hi, &step);
+        if (fields < 2 || step == 0 || lo > hi) {
+            return false;
+        }
+        for (unsigned long v = lo; v <= hi; v += step) {
+            axis.values.push_back(std::to_string(v));
+        }
+    } else {
+        size_t start = 0;
+        while (start <= spec.size()) {
+            size_t comma = spec.find(',', start);
+            size_t end = comma == std::string::npos ? spec.size() : comma;
+            axis.values.push_back(spec.substr(start, end - start));
+            start = end + 1;
+        }
+    }
+
+    // Every value must be a valid setting on its own
+    for (size_t i = 0; i < axis.values.size(); i++) {
+        SimConfig scratch;
+        if (!simConfigSet(scratch, axis.key, axis.values[i])) {
+            return false;
+        }
+    }
+    return !axis.values.empty();
+}
+
+// ============================================================================
+// Results
+// ============================================================================
+
+struct RunResult {
+    bool passed;
+    bool active;
+    std::vector<uint32_t> latencyUs;
+    double airtimePercent;
+    uint32_t failsafes;
+    uint32_t drops;
+};
+
+struct Summary {
+    std::string label;          // Swept settings only
+    uint32_t passed;
+    uint32_t neverActive;
+    uint32_t samples;
+    double p50, p95, p99, max;  // ms, INFINITY without samples
+    double airtimePercent;      // Mean over runs
+    uint32_t failsafes;         // Total over runs
+    uint32_t drops;
+    bool pareto;
+};
+
+static bool dominates(const Summary& a, const Summary& b) {
+    bool noWorse = a.p95 <= b.p95 && a.airtimePercent <= b.airtimePercent && a.failsafes <= b.failsafes;
+    bool better = a.p95 < b.p95 || a.airtimePercent < b.airtimePercent || a.failsafes < b.failsafes;
+    return noWorse && better;
+}
+
+static void printTable(const std::vector<Summary>& summaries, const std::vector<size_t>& order, uint32_t runs) {
+    size_t width = 6;
+    for (size_t i = 0; i < summaries.size(); i++) {
+        width = std::max(width, summaries[i].label.size());
+    }
+
+    printf("  %-*s  pass    p50    p95    p99    max  airtime  failsafes  drops\n", (int)width, "config");
+    for (size_t i = 0; i < order.size(); i++) {
+        const Summary& s = summaries[order[i]];
+        printf("%c %-*s  %2u/%-2u %6.1f %6.1f %6.1f %6.1f  %6.2f%%  %9u  %5u\n",
+               s.pareto ? '*' : ' ', (int)width, s.label.c_str(), s.passed, runs,
+               s.p50, s.p95, s.p99, s.max, s.airtimePercent, s.failsafes, s.drops);
+    }
+}
+
+static void printCsv(const std::vector<Summary>& summaries, const std::vector<size_t>& order, uint32_t runs) {
+    printf("config,runs,passed,never_active,samples,p50_ms,p95_ms,p99_ms,max_ms,airtime_percent,failsafes,drops,pareto\n");
+    for (size_t i = 0; i < order.size(); i++) {
+        const Summary& s = summaries[order[i]];
+        printf("\"%s\",%u,%u,%u,%u,%.2f,%.2f,%.2f,%.2f,%.3f,%u,%u,%d\n",
+               s.label.c_str(), runs, s.passed, s.neverActive, s.samples,
+               s.p50, s.p95, s.p99, s.max, s.airtimePercent, s.failsafes, s.drops, s.pareto ? 1 : 0);
+    }
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static int usage(const char* name) {
+    fprintf(stderr, "usage: %s [-j threads] [-r runs] [-s seed] [-n points] [-c] scenario.scn key=values...\n", name);
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    unsigned threads = std::thread::hardware_concurrency();
+    uint32_t runs = DEFAULT_RUNS;
+    uint64_t baseSeed = 1;
+    uint32_t points = 0;
+    bool csv = false;
+
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        const char* option = argv[arg];
+        if (strcmp(option, "-c") == 0) {
+            csv = true;
+            continue;
+        }
+        if (arg + 1 >= argc) {
+            return usage(argv[0]);
+        }
+        unsigned long value = strtoul(argv[++arg], nullptr, 10);
+        if (strcmp(option, "-j") == 0) {
+            threads = (unsigned)value;
+        } else if (strcmp(option, "-r") == 0 && value > 0) {
+            runs = (uint32_t)value;
+        } else if (strcmp(option, "-s") == 0) {
+            baseSeed = value;
+        } else if (strcmp(option, "-n") == 0 && value > 0) {
+            points = (uint32_t)value;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (arg >= argc) {
+        return usage(argv[0]);
+    }
+
+    const char* scenarioPath = argv[arg++];
+    Scenario scenario;
+    std::string error;
+    if (!scenario.load(scenarioPath, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 2;
+    }
+
+    std::vector<Axis> axes;
+    for (; arg < argc; arg++) {
+        Axis axis;
+        if (!parseAxis(argv[arg], axis)) {
+            fprintf(stderr, "bad axis: %s\n", argv[arg]);
+            return 2;
+        }
+        axes.push_back(axis);
+    }
+    for (size_t a = 0; a < axes.size(); a++) {
+        bool interval = axes[a].key == "xbox_interval" || axes[a].key == "lego_interval";
+        bool planned = scenario.getConfig().connPlan;
+        for (size_t b = 0; b < axes.size(); b++) {
+            if (axes[b].key == "conn_plan") {
+                planned = std::find(axes[b].values.begin(), axes[b].values.end(), "1") != axes[b].values.end();
+            }
+        }
+        if (interval && planned) {
+            fprintf(stderr, "warning: %s is replaced by the connection planner's intervals unless conn_plan=0\n",
+                    axes[a].key.c_str());
+        }
+    }
+
+    // Configurations: the full grid, or random points of it (drawn again
+    // when a point is not a valid combination)
+    std::vector<SimConfig> configs;
+    std::vector<std::string> labels;
+    auto addConfig = [&](const std::vector<size_t>& pick, bool report) {
+        SimConfig config = scenario.getConfig();
+        std::string label;
+        for (size_t a = 0; a < axes.size(); a++) {
+            const std::string& value = axes[a].values[pick[a]];
+            simConfigSet(config, axes[a].key, value);
+            label += (a ? " " : "") + axes[a].key + "=" + value;
+        }
+        if (!simConfigValid(config)) {
+            if (report) {
+                fprintf(stderr, "skipped (min_rate above max_rate): %s\n", label.c_str());
+            }
+            return;
+        }
+        configs.push_back(config);
+        labels.push_back(label.empty() ? "(scenario settings)" : label);
+    };
+
+    if (points == 0) {
+        size_t total = 1;
+        for (size_t a = 0; a < axes.size(); a++) {
+            total *= axes[a].values.size();
+        }
+        for (size_t n = 0; n < total; n++) {
+            std::vector<size_t> pick(axes.size());
+            size_t rest = n;
+            for (size_t a = axes.size(); a-- > 0;) {
+                pick[a] = rest % axes[a].values.size();
+                rest /= axes[a].values.size();
+            }
+            addConfig(pick, true);
+        }
+    } else {
+        uint64_t state = baseSeed ^ 0x5DEECE66DULL;
+        for (uint64_t draws = 0; configs.size() < points && draws < points * 100ULL; draws++) {
+            std::vector<size_t> pick(axes.size());
+            for (size_t a = 0; a < axes.size(); a++) {
+                pick[a] = splitmix64(state) % axes[a].values.size();
+            }
+            addConfig(pick, false);
+        }
+    }
+    if (configs.empty()) {
+        fprintf(stderr, "no valid configurations\n");
+        return 2;
+    }
+
+    // Same seeds for every configuration
+    std::vector<uint32_t> seeds(runs);
+    uint64_t seedState = baseSeed;
+    for (uint32_t r = 0; r < runs; r++) {
+        seeds[r] = (uint32_t)splitmix64(seedState);
+    }
+
+    size_t tasks = configs.size() * runs;
+    std::vector<RunResult> results(tasks);
+    WorkStealingPool pool(threads);
+    auto started = std::chrono::steady_clock::now();
+
+    pool.run(tasks, [&](size_t task) {
+        SimConfig config = configs[task / runs];
+        config.seed = seeds[task % runs];
+        ScenarioResult run = scenario.run(config, false);
+
+        RunResult& result = results[task];
+        const SimStats& stats = run.stats;
+        result.passed = run.passed;
+        result.active = stats.everActive;
+        result.latencyUs.swap(run.stats.latencyUs);
+        result.airtimePercent = stats.airtimeUs * 100.0 / run.durationUs;
+        result.failsafes = stats.failsafes;
+        result.drops = 0;
+        for (int i = 0; i < SIM_PEER_COUNT; i++) {
+            result.drops += stats.disconnects[i];
+        }
+    });
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    fprintf(stderr, "%zu runs (%zu configurations x %u seeds) of %.0fs sessions on %u threads in %.2fs, %llu steals\n",
+            tasks, configs.size(), runs, scenario.getDurationUs() / 1e6, pool.getWorkers(), seconds,
+            (unsigned long long)pool.getSteals());
+
+    // Aggregate in configuration order
+    std::vector<Summary> summaries(configs.size());
+    for (size_t n = 0; n < configs.size(); n++) {
+        Summary& s = summaries[n];
+        s.label = labels[n];
+        s.passed = 0;
+        s.neverActive = 0;
+        s.airtimePercent = 0;
+        s.failsafes = 0;
+        s.drops = 0;
+        s.pareto = false;
+
+        std::vector<uint32_t> latency;
+        for (uint32_t r = 0; r < runs; r++) {
+            const RunResult& result = results[n * runs + r];
+            s.passed += result.passed ? 1 : 0;
+            s.neverActive += result.active ? 0 : 1;
+            s.airtimePercent += result.airtimePercent / runs;
+            s.failsafes += result.failsafes;
+            s.drops += result.drops;
+            latency.insert(latency.end(), result.latencyUs.begin(), result.latencyUs.end());
+        }
+        s.samples = latency.size();
+        s.p50 = latency.empty() ? INFINITY : simPercentile(latency, 50) / 1000.0;
+        s.p95 = latency.empty() ? INFINITY : simPercentile(latency, 95) / 1000.0;
+        s.p99 = latency.empty() ? INFINITY : simPercentile(latency, 99) / 1000.0;
+        s.max = latency.empty() ? INFINITY : simPercentile(latency, 100) / 1000.0;
+    }
+
+    std::vector<size_t> front;
+    for (size_t a = 0; a < summaries.size(); a++) {
+        bool dominated = false;
+        for (size_t b = 0; b < summaries.size() && !dominated; b++) {
+            dominated = b != a && dominates(summaries[b], summaries[a]);
+        }
+        summaries[a].pareto = !dominated;
+        if (!dominated) {
+            front.push_back(a);
+        }
+    }
+
+    // Best p95 first; ties keep configuration order
+    std::vector<size_t> order(summaries.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return summaries[a].p95 < summaries[b].p95;
+    });
+    std::stable_sort(front.begin(), front.end(), [&](size_t a, size_t b) {
+        return summaries[a].p95 < summaries[b].p95;
+    });
+
+    if (csv) {
+        printCsv(summaries, order, runs);
+        return 0;
+    }
+
+    printf("%s: %s\n", scenarioPath, scenario.getName().c_str());
+    printf("Latency in ms (input change -> hub) over all runs, airtime as mean of runs, * = Pareto front\n\n");
+    printTable(summaries, order, runs);
+    printf("\nPareto front (p95 latency, airtime, failsafes): %zu of %zu\n\n", front.size(), summaries.size());
+    printTable(summaries, front, runs);
+    return 0;
+}
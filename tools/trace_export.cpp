@@ -0,0 +1,388 @@
+/**
+ * Trace Export - Session log dump to Chrome trace-event JSON
+ *
+ * Host tool (C++11, standard library only):
+ *
+ *     g++ -std=c++11 -O2 -o trace_export tools/trace_export.cpp
+ *     ./trace_export session_dump.txt > trace.json
+ *
+ * Input is the serial output of 'log dump' (other serial text is ignored).
+ * Open the result in Perfetto (ui.perfetto.dev) or chrome://tracing.
+ *
+ * Each boot is a process. Its tracks:
+ * - state:         one span per application state
+ * - control loop:  slow frames (SESSION_LOG_SLOW_FRAME_US) as late / map /
+ *                  write spans, ending at the hub write
+ * - gatt_xbox, gatt_lego: GATT operations as queued and run spans
+ * - scan:          scan start -> stop
+ * - session log:   flash writes of the log itself
+ * - xbox, lego:    link events (ready, disconnects) as instants
+ * - events:        everything else as instants
+ * Snapshot values (snap ... key=value) become counters.
+ *
+ * Line timestamps have 1 ms resolution; durations are in microseconds. A
+ * span that ends at a line starts its duration before that line's time.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// JSON Output
+// ============================================================================
+
+static std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+class TraceWriter {
+public:
+    TraceWriter(std::ostream& out) : out(out), first(true) {
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    }
+
+    ~TraceWriter() {
+        out << "\n]}\n";
+    }
+
+    void span(int pid, int tid, const std::string& name, long long startUs, long long durUs,
+              const std::string& args = "") {
+        if (startUs < 0) {
+            startUs = 0;
+        }
+        std::ostringstream event;
+        event << "{\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << tid
+              << ",\"name\":" << jsonString(name) << ",\"ts\":" << startUs
+              << ",\"dur\":" << (durUs > 0 ? durUs : 1);
+        if (!args.empty()) {
+            event << ",\"args\":{" << args << "}";
+        }
+        emit(event.str() + "}");
+    }
+
+    void instant(int pid, int tid, const std::string& name, long long tsUs, const std::string& detail) {
+        std::ostringstream event;
+        event << "{\"ph\":\"i\",\"s\":\"t\",\"pid\":" << pid << ",\"tid\":" << tid
+              << ",\"name\":" << jsonString(name) << ",\"ts\":" << tsUs
+              << ",\"args\":{\"line\":" << jsonString(detail) << "}}";
+        emit(event.str());
+    }
+
+    void counter(int pid, const std::string& name, long long tsUs, long value) {
+        std::ostringstream event;
+        event << "{\"ph\":\"C\",\"pid\":" << pid << ",\"name\":" << jsonString(name)
+              << ",\"ts\":" << tsUs << ",\"args\":{\"value\":" << value << "}}";
+        emit(event.str());
+    }
+
+    void processName(int pid, const std::string& name) {
+        std::ostringstream event;
+        event << "{\"ph\":\"M\",\"pid\":" << pid << ",\"name\":\"process_name\",\"args\":{\"name\":"
+              << jsonString(name) << "}}";
+        emit(event.str());
+    }
+
+    void threadName(int pid, int tid, const std::string& name) {
+        std::ostringstream event;
+        event << "{\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid
+              << ",\"name\":\"thread_name\",\"args\":{\"name\":" << jsonString(name) << "}}"
+              << ",\n{\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid
+              << ",\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":" << tid << "}}";
+        emit(event.str());
+    }
+
+private:
+    std::ostream& out;
+    bool first;
+
+    void emit(const std::string& event) {
+        out << (first ? "" : ",\n") << event;
+        first = false;
+    }
+};
+
+// ============================================================================
+// Line Parsing
+// ============================================================================
+
+// "123.456 rest of line" -> microseconds and text
+static bool parseLine(const std::string& line, long long& tsUs, std::string& text) {
+    unsigned long seconds;
+    unsigned millis;
+    int consumed = 0;
+    if (sscanf(line.c_str(), "%lu.%3u %n", &seconds, &millis, &consumed) != 2 || consumed == 0) {
+        return false;
+    }
+    // Exactly three fraction digits, or it is not a log line
+    size_t dot = line.find('.');
+    if (dot == std::string::npos || dot + 4 > line.size() || line[dot + 4] != ' ') {
+        return false;
+    }
+    tsUs = (long long)seconds * 1000000LL + millis * 1000LL;
+    text = line.substr(consumed);
+    while (!text.empty() && (text[text.size() - 1] == '\r' || text[text.size() - 1] == '\n')) {
+        text.erase(text.size() - 1);
+    }
+    return true;
+}
+
+static std::vector<std::string> splitWords(const std::string& text) {
+    std::vector<std::string> words;
+    std::istringstream in(text);
+    std::string word;
+    while (in >> word) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+// "key=123" anywhere in the line; false if absent
+static bool findValue(const std::vector<std::string>& words, const char* key, long& value) {
+    size_t keyLength = strlen(key);
+    for (size_t i = 0; i < words.size(); i++) {
+        const std::string& word = words[i];
+        if (word.size() > keyLength + 1 && word.compare(0, keyLength, key) == 0 && word[keyLength] == '=') {
+            value = strtol(word.c_str() + keyLength + 1, nullptr, 0);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// Session Conversion
+// ============================================================================
+
+enum Track {
+    TRACK_STATE = 1,
+    TRACK_CONTROL,
+    TRACK_SCAN,
+    TRACK_LOG,
+    TRACK_XBOX,
+    TRACK_LEGO,
+    TRACK_EVENTS,
+    TRACK_GATT_FIRST      // One per queue name, in order of appearance
+};
+
+static const char* const TRACK_NAMES[] = {
+    "", "state", "control loop", "scan", "session log", "xbox", "lego", "events"
+};
+
+class SessionConverter {
+public:
+    SessionConverter(TraceWriter& writer) : writer(writer), pid(0), lastUs(0) {}
+
+    void line(long long tsUs, const std::string& text) {
+        std::vector<std::string> words = splitWords(text);
+        if (words.empty()) {
+            return;
+        }
+
+        // A boot, or the clock going back, starts a new session
+        if (pid == 0 || words[0] == "boot" || tsUs < lastUs) {
+            startSession(tsUs);
+        }
+        lastUs = tsUs;
+
+        const std::string& kind = words[0];
+        if (kind == "state" && words.size() >= 4) {
+            closeState(tsUs);
+            stateName = words[3];
+            stateStartUs = tsUs;
+        } else if (kind == "frame") {
+            controlFrame(tsUs, words);
+        } else if (kind == "gatt" && words.size() >= 3) {
+            gattOp(tsUs, words, text);
+        } else if (kind == "scan" && words.size() >= 2) {
+            if (words[1] == "start" && scanStartUs < 0) {
+                scanStartUs = tsUs;
+            } else if (words[1] == "stop" && scanStartUs >= 0) {
+                writer.span(pid, TRACK_SCAN, "scan", scanStartUs, tsUs - scanStartUs);
+                scanStartUs = -1;
+            }
+        } else if (kind == "flush") {
+            long bytes = 0;
+            long runUs = 0;
+            findValue(words, "bytes", bytes);
+            findValue(words, "run", runUs);
+            std::ostringstream args;
+            args << "\"bytes\":" << bytes;
+            writer.span(pid, TRACK_LOG, "flash write", tsUs - runUs, runUs, args.str());
+        } else if (kind == "snap") {
+            for (size_t i = 2; i < words.size(); i++) {
+                size_t eq = words[i].find('=');
+                if (eq != std::string::npos && eq > 0) {
+                    std::string key = words[i].substr(0, eq);
+                    // Light flags are logged in hex
+                    int base = key == "lights" ? 16 : 10;
+                    writer.counter(pid, key, tsUs, strtol(words[i].c_str() + eq + 1, nullptr, base));
+                }
+            }
+        } else if (kind == "xbox" || kind == "lego") {
+            writer.instant(pid, kind == "xbox" ? TRACK_XBOX : TRACK_LEGO, text, tsUs, text);
+        } else if (kind == "error") {
+            writer.instant(pid, TRACK_EVENTS, "error " + (words.size() > 1 ? words[1] : ""), tsUs, text);
+        } else {
+            writer.instant(pid, TRACK_EVENTS, kind, tsUs, text);
+        }
+    }
+
+    void finish() {
+        if (pid == 0) {
+            return;
+        }
+        closeState(lastUs);
+        if (scanStartUs >= 0) {
+            writer.span(pid, TRACK_SCAN, "scan", scanStartUs, lastUs - scanStartUs);
+        }
+    }
+
+private:
+    TraceWriter& writer;
+    int pid;
+    long long lastUs;
+    std::string stateName;
+    long long stateStartUs;
+    long long scanStartUs;
+    std::map<std::string, int> gattTracks;
+
+    void startSession(long long tsUs) {
+        finish();
+        pid++;
+        stateName.clear();
+        stateStartUs = tsUs;
+        scanStartUs = -1;
+        gattTracks.clear();
+
+        std::ostringstream name;
+        name << "session " << pid;
+        writer.processName(pid, name.str());
+        for (int tid = TRACK_STATE; tid < TRACK_GATT_FIRST; tid++) {
+            writer.threadName(pid, tid, TRACK_NAMES[tid]);
+        }
+    }
+
+    void closeState(long long tsUs) {
+        if (!stateName.empty()) {
+            writer.span(pid, TRACK_STATE, stateName, stateStartUs, tsUs - stateStartUs);
+        }
+        stateName.clear();
+    }
+
+    void controlFrame(long long tsUs, const std::vector<std::string>& words) {
+        long lateUs = 0;
+        long mapUs = 0;
+        long writeUs = 0;
+        findValue(words, "late", lateUs);
+        findValue(words, "map", mapUs);
+        findValue(words, "write", writeUs);
+
+        // Logged just after the hub write - lay the stages out backwards
+        long long writeStart = tsUs - writeUs;
+        long long mapStart = writeStart - mapUs;
+        std::ostringstream args;
+        args << "\"late_us\":" << lateUs << ",\"map_us\":" << mapUs << ",\"write_us\":" << writeUs;
+
+        writer.span(pid, TRACK_CONTROL, "slow frame", mapStart - lateUs, lateUs + mapUs + writeUs, args.str());
+        if (lateUs > 0) {
+            writer.span(pid, TRACK_CONTROL, "late", mapStart - lateUs, lateUs);
+        }
+        writer.span(pid, TRACK_CONTROL, "map + submit", mapStart, mapUs);
+        writer.span(pid, TRACK_CONTROL, "hub write", writeStart, writeUs);
+    }
+
+    void gattOp(long long tsUs, const std::vector<std::string>& words, const std::string& text) {
+        const std::string& queue = words[1];
+        std::map<std::string, int>::iterator it = gattTracks.find(queue);
+        if (it == gattTracks.end()) {
+            int tid = TRACK_GATT_FIRST + (int)gattTracks.size();
+            it = gattTracks.insert(std::make_pair(queue, tid)).first;
+            writer.threadName(pid, tid, queue);
+        }
+
+        std::string op = words.size() > 2 ? words[2] : "?";
+        long waitUs = 0;
+        long runUs = 0;
+        findValue(words, "wait", waitUs);
+        findValue(words, "run", runUs);
+
+        // Status is whatever follows run=
+        std::string status;
+        size_t run = text.find("run=");
+        if (run != std::string::npos) {
+            size_t space = text.find(' ', run);
+            status = space == std::string::npos ? "" : text.substr(space + 1);
+        }
+
+        std::ostringstream args;
+        args << "\"status\":" << jsonString(status) << ",\"wait_us\":" << waitUs << ",\"run_us\":" << runUs;
+
+        long long runStart = tsUs - runUs;
+        if (waitUs > 0) {
+            writer.span(pid, it->second, op + " (queued)", runStart - waitUs, waitUs, args.str());
+        }
+        writer.span(pid, it->second, op, runStart, runUs, args.str());
+    }
+};
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+    if (argc > 2 || (argc == 2 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0))) {
+        fprintf(stderr, "Usage: %s [session_dump.txt] > trace.json\n", argv[0]);
+        return 2;
+    }
+
+    std::ifstream file;
+    if (argc == 2) {
+        file.open(argv[1]);
+        if (!file) {
+            fprintf(stderr, "Cannot open %s\n", argv[1]);
+            return 1;
+        }
+    }
+    std::istream& in = argc == 2 ? file : std::cin;
+
+    unsigned long lines = 0;
+    {
+        TraceWriter writer(std::cout);
+        SessionConverter converter(writer);
+
+        std::string raw;
+        long long tsUs;
+        std::string text;
+        while (std::getline(in, raw)) {
+            if (parseLine(raw, tsUs, text)) {
+                converter.line(tsUs, text);
+                lines++;
+            }
+        }
+        converter.finish();
+    }
+
+    fprintf(stderr, "%lu log lines converted\n", lines);
+    return lines ? 0 : 1;
+}